@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * @file arena.hpp
+ * @brief One up-front allocation carved into the scratch buffers of a chain.
+ *
+ * A DSP chain knows its worst-case buffer sizes once the block size is
+ * fixed. Taking them all from one arena at start-up leaves nothing to
+ * allocate per block, and keeps the buffers adjacent and cache-line
+ * aligned for the SIMD kernels.
+ */
+
+/**
+ * @class Arena
+ * @brief Bump allocator over a single aligned heap block.
+ *
+ * Buffers are handed out as spans and live as long as the arena; there is
+ * no per-buffer free. Moving the arena keeps every span valid, since the
+ * storage itself does not move.
+ */
+class Arena {
+public:
+    /// Alignment of every buffer (one cache line; covers AVX-512 loads).
+    static constexpr std::size_t kAlignment = 64;
+
+    Arena() = default;
+
+    /// Allocate @p bytes of storage (rounded up to kAlignment).
+    explicit Arena(std::size_t bytes)
+        : storage_{static_cast<std::byte*>(
+              ::operator new(round_up(bytes), std::align_val_t{kAlignment}))}
+        , capacity_{round_up(bytes)}
+    {
+    }
+
+    /// @return Bytes a buffer of @p n values of T takes from an arena.
+    template <typename T>
+    [[nodiscard]] static constexpr std::size_t footprint(std::size_t n) noexcept
+    {
+        return round_up(n * sizeof(T));
+    }
+
+    /**
+     * @brief Carve a zero-initialised buffer of @p n values.
+     * @throws std::length_error if the arena is exhausted
+     */
+    template <typename T>
+    [[nodiscard]] std::span<T> allocate(std::size_t n)
+    {
+        static_assert(std::is_trivially_destructible_v<T>,
+                      "Arena buffers are never destroyed");
+
+        const std::size_t bytes = footprint<T>(n);
+        if (bytes > capacity_ - used_)
+            throw std::length_error("Arena exhausted");
+
+        T* p = reinterpret_cast<T*>(storage_.get() + used_);
+        std::uninitialized_value_construct_n(p, n);
+        used_ += bytes;
+        return {p, n};
+    }
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+    [[nodiscard]] std::size_t used() const noexcept { return used_; }
+
+private:
+    struct Free {
+        void operator()(std::byte* p) const noexcept
+        {
+            ::operator delete(p, std::align_val_t{kAlignment});
+        }
+    };
+
+    std::unique_ptr<std::byte, Free> storage_;
+    std::size_t capacity_ = 0;
+    std::size_t used_ = 0;
+
+    static constexpr std::size_t round_up(std::size_t bytes) noexcept
+    {
+        return (bytes + kAlignment - 1) / kAlignment * kAlignment;
+    }
+};
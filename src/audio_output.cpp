@@ -0,0 +1,208 @@
+#include "audio_output.hpp"
+#include "dsp.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <unistd.h>
+
+#ifdef HAVE_OPUS
+#include <opus.h>
+#endif
+
+namespace {
+
+/// Largest Opus packet (RFC 6716, section 3.4)
+constexpr std::size_t kMaxOpusPacket = 1275;
+
+/// Big-endian length ahead of each Opus packet on stdout
+constexpr std::size_t kOpusLengthPrefix = 2;
+
+UdpDestination single_destination(const std::string& ip, int port)
+{
+    UdpDestination d;
+    d.ip = ip;
+    d.port = port;
+    return d;
+}
+
+} // namespace
+
+bool opus_supported() noexcept
+{
+#ifdef HAVE_OPUS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void OpusEncoderDeleter::operator()(OpusEncoder* enc) const noexcept {
+#ifdef HAVE_OPUS
+    if (enc) opus_encoder_destroy(enc);
+#else
+    (void)enc;
+#endif
+}
+
+AudioOutput::AudioOutput(const OutputOptions& opts)
+    : opts_{opts}
+{
+    open_encoder();
+}
+
+AudioOutput::AudioOutput(const std::string& ip, int port, const OutputOptions& opts)
+    : AudioOutput(std::span<const UdpDestination>(std::array{single_destination(ip, port)}), opts)
+{
+}
+
+AudioOutput::AudioOutput(std::span<const UdpDestination> destinations, const OutputOptions& opts)
+    : opts_{opts}
+{
+    if (destinations.empty())
+        throw std::runtime_error("No UDP destination");
+
+    open_encoder();
+
+    udp_.open(destinations, opts_.udp_backend);
+    udp_.set_packetized(opts_.max_datagram);
+    use_udp_ = true;
+}
+
+void AudioOutput::open_encoder()
+{
+    if (opts_.format != AudioFormat::Opus)
+        return;
+
+#ifdef HAVE_OPUS
+    int err = OPUS_OK;
+    opus_.reset(opus_encoder_create(kOpusSampleRateHz, opts_.channels, OPUS_APPLICATION_RESTRICTED_LOWDELAY, &err));
+    if (err != OPUS_OK || !opus_)
+        throw std::runtime_error(std::string("Failed to create Opus encoder: ") +
+                                 opus_strerror(err));
+
+    if (opus_encoder_ctl(opus_.get(), OPUS_SET_BITRATE(opts_.opus_bitrate)) != OPUS_OK)
+        throw std::runtime_error("Invalid Opus bitrate");
+
+    frame_.resize(kOpusFrameSamples * static_cast<std::size_t>(opts_.channels));
+    packet_.resize(kOpusLengthPrefix + kMaxOpusPacket);
+#else
+    throw std::runtime_error("Opus output not compiled in (rebuild with OPUS=1)");
+#endif
+}
+
+void AudioOutput::stamp(const BlockMeta& audio) noexcept
+{
+    if (!use_udp_)
+        return;
+
+    // Samples still waiting in the open Opus frame precede this block
+    const std::uint64_t index = audio.sample_index * static_cast<std::uint64_t>(opts_.channels);
+    udp_.stamp(index - frame_fill_, audio.captured_ns());
+}
+
+void AudioOutput::write(std::span<const float> audio)
+{
+    if (audio.empty()) return;
+
+    if (opts_.format == AudioFormat::F32) {
+        emit_samples(audio);
+        return;
+    }
+
+    dsp::float_to_s16(audio, pcm_);
+    write(std::span<const int16_t>(pcm_));
+}
+
+void AudioOutput::write(std::span<const int16_t> pcm)
+{
+    if (pcm.empty()) return;
+
+    switch (opts_.format) {
+    case AudioFormat::S16:
+        emit_samples(pcm);
+        break;
+    case AudioFormat::Opus:
+        encode_opus(pcm);
+        break;
+    case AudioFormat::F32:
+        f32_.resize(pcm.size());
+        std::transform(pcm.begin(), pcm.end(), f32_.begin(),
+                       [](int16_t v) { return static_cast<float>(v) / dsp::kS16FullScale; });
+        emit_samples(std::span<const float>(f32_));
+        break;
+    }
+}
+
+void AudioOutput::write_silence(std::size_t samples)
+{
+    if (samples == 0) return;
+
+    if (use_udp_) {
+        // Silence completes the open Opus frame, so its audio keeps its
+        // index and the gap marker starts where the frame ends
+        if (frame_fill_ > 0) {
+            const std::size_t pad = std::min(samples, frame_.size() - frame_fill_);
+            pcm_.assign(pad, 0);
+            encode_opus(pcm_);
+            samples -= pad;
+        }
+        udp_.send_gap(samples);
+        return;
+    }
+
+    if (opts_.format == AudioFormat::F32) {
+        f32_.assign(samples, 0.0f);
+        emit_samples(std::span<const float>(f32_));
+    } else {
+        pcm_.assign(samples, 0);
+        write(std::span<const int16_t>(pcm_));
+    }
+}
+
+void AudioOutput::encode_opus([[maybe_unused]] std::span<const int16_t> pcm)
+{
+#ifdef HAVE_OPUS
+    while (!pcm.empty()) {
+        const std::size_t n = std::min(pcm.size(), frame_.size() - frame_fill_);
+        std::copy_n(pcm.begin(), n, frame_.begin() + static_cast<std::ptrdiff_t>(frame_fill_));
+        frame_fill_ += n;
+        pcm = pcm.subspan(n);
+
+        if (frame_fill_ < frame_.size())
+            break;
+        frame_fill_ = 0;
+
+        unsigned char* const packet = packet_.data() + kOpusLengthPrefix;
+        const opus_int32 bytes = opus_encode(opus_.get(), frame_.data(),
+                                             static_cast<int>(kOpusFrameSamples),
+                                             packet, static_cast<opus_int32>(kMaxOpusPacket));
+        if (bytes <= 0)
+            continue;
+
+        if (use_udp_) {
+            udp_.send_frame(packet, static_cast<std::size_t>(bytes), frame_.size());
+        } else {
+            // Prefix and packet go out as one frame, so drops never split them
+            packet_[0] = static_cast<unsigned char>(bytes >> 8);
+            packet_[1] = static_cast<unsigned char>(bytes & 0xFF);
+            emit(packet_.data(), kOpusLengthPrefix + static_cast<std::size_t>(bytes));
+        }
+    }
+#endif
+}
+
+void AudioOutput::emit(const void* data, std::size_t bytes)
+{
+    if (!stdout_)
+        stdout_ = std::make_unique<StreamWriter>(STDOUT_FILENO, opts_.stdout_ring_frames,
+                                                 opts_.overflow);
+    stdout_->write(data, bytes);
+}
+
+std::optional<StreamWriterStats> AudioOutput::stdout_stats() const
+{
+    if (!stdout_)
+        return std::nullopt;
+    return stdout_->stats();
+}
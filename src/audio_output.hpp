@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "block_meta.hpp"
+#include "stream_writer.hpp"
+#include "udp_fanout.hpp"
+
+/**
+ * @file audio_output.hpp
+ * @brief Demodulated audio sink: sample format encoding plus UDP or stdout.
+ */
+
+/// Wire format of the audio stream.
+enum class AudioFormat {
+    F32,  ///< 32-bit float PCM (F32LE), the DSP chain's native format
+    S16,  ///< 16-bit signed PCM (S16LE), half the bandwidth of F32
+    Opus  ///< Opus frames (requires a build with OPUS=1)
+};
+
+/// Audio output selection.
+struct OutputOptions {
+    /// Encoding of every block
+    AudioFormat format = AudioFormat::F32;
+
+    /// Packetized UDP datagram limit, see UdpSender::set_packetized()
+    /// (0 = one datagram per block)
+    std::size_t max_datagram = 0;
+
+    /// Opus target bitrate in bits per second
+    int opus_bitrate = 64'000;
+
+    /// What happens to stdout audio when the consumer falls behind
+    OverflowPolicy overflow = OverflowPolicy::DropOldest;
+
+    /// Blocks buffered for a slow stdout consumer
+    std::size_t stdout_ring_frames = 16;
+
+    /// Interleaved channels of the audio handed to write() (2 for stereo)
+    int channels = 1;
+
+    /// Syscall path of UDP output, see UdpFanout
+    SendBackend udp_backend = SendBackend::Auto;
+};
+
+/// Opus encoder rate; equals the DSP chain's audio rate, so no resampling
+inline constexpr int kOpusSampleRateHz = 48'000;
+
+/// Opus samples per frame and channel: 10 ms
+inline constexpr std::size_t kOpusFrameSamples = kOpusSampleRateHz / 100;
+
+/// @return true if this build can encode AudioFormat::Opus.
+bool opus_supported() noexcept;
+
+/// Opaque libopus encoder (typedef'd by opus.h)
+struct OpusEncoder;
+
+/// RAII deleter for OpusEncoder
+struct OpusEncoderDeleter {
+    void operator()(OpusEncoder* enc) const noexcept;
+};
+
+using OpusEncoderPtr = std::unique_ptr<OpusEncoder, OpusEncoderDeleter>;
+
+/**
+ * @class AudioOutput
+ * @brief Encodes audio blocks in the selected format and sends them.
+ *
+ * PCM formats keep the block framing of the underlying transport (one
+ * datagram per block, or MTU-sized packets). Opus audio is cut into
+ * frames of kOpusFrameSamples per channel; a partial frame waits for the
+ * next block.
+ * Each frame is one UDP datagram, or on stdout a 2-byte big-endian length
+ * followed by the frame.
+ *
+ * Stdout goes through a StreamWriter, so a slow or paused consumer costs
+ * frames (per OutputOptions::overflow) rather than stalling the DSP chain.
+ *
+ * The DSP chain can produce 16-bit PCM directly (see wants_pcm()), which
+ * both S16 and Opus consume without a float intermediate.
+ */
+class AudioOutput {
+public:
+    /**
+     * @brief Write to stdout.
+     * @throws std::runtime_error if Opus is requested but not compiled in
+     */
+    explicit AudioOutput(const OutputOptions& opts = {});
+
+    /**
+     * @brief Send to a UDP destination.
+     * @throws std::runtime_error if Opus is requested but not compiled in,
+     *         or the socket cannot be opened
+     */
+    AudioOutput(const std::string& ip, int port, const OutputOptions& opts = {});
+
+    /**
+     * @brief Send the same stream to every destination (see UdpFanout).
+     * @throws std::runtime_error as the single-destination constructor, or
+     *         for an empty list
+     */
+    AudioOutput(std::span<const UdpDestination> destinations, const OutputOptions& opts = {});
+
+    /// @return UDP destinations (0 for stdout).
+    [[nodiscard]] std::size_t destinations() const noexcept { return udp_.size(); }
+
+    /// @return Send path of the UDP output.
+    [[nodiscard]] SendBackend udp_backend() const noexcept { return udp_.backend(); }
+
+    [[nodiscard]] AudioFormat format() const noexcept { return opts_.format; }
+
+    /// @return true if blocks should be handed over as int16 PCM.
+    [[nodiscard]] bool wants_pcm() const noexcept { return opts_.format != AudioFormat::F32; }
+
+    /**
+     * @brief Tag the next block with @p audio (see DemodPipeline::audio_meta()).
+     *
+     * Packetized datagrams then carry the block's sample index (frames
+     * times channels) and capture time; an Opus frame carries the index of
+     * its own first sample, which may come from the previous block. Raw
+     * UDP and stdout have no headers to put them in.
+     */
+    void stamp(const BlockMeta& audio) noexcept;
+
+    /// Output a block of float audio, converting it if the format is not F32.
+    void write(std::span<const float> audio);
+
+    /// Output a block of 16-bit PCM (for S16 or Opus; F32 widens it back).
+    void write(std::span<const int16_t> pcm);
+
+    /**
+     * @brief Account for @p samples of squelched audio.
+     *
+     * Stdout gets digital silence so players keep their timing. UDP sends
+     * no audio: packetized streams get one header-only marker datagram
+     * (see UdpSender::send_gap()), raw streams nothing at all. An open
+     * Opus frame is first completed with silence and sent.
+     */
+    void write_silence(std::size_t samples);
+
+    /// @return Counters of the stdout writer, or nullopt if nothing went to stdout.
+    [[nodiscard]] std::optional<StreamWriterStats> stdout_stats() const;
+
+private:
+    OutputOptions opts_;
+    UdpFanout udp_;
+    bool use_udp_ = false;
+
+    // Stdout writer, started on the first stdout frame
+    std::unique_ptr<StreamWriter> stdout_;
+
+    // Format conversion scratch
+    std::vector<int16_t> pcm_;
+    std::vector<float> f32_;
+
+    // Opus state: the encoder, the open frame and the encoded packet
+    // (after room for the stdout length prefix)
+    OpusEncoderPtr opus_;
+    std::vector<int16_t> frame_;
+    std::size_t frame_fill_ = 0;
+    std::vector<unsigned char> packet_;
+
+    void open_encoder();
+    void encode_opus(std::span<const int16_t> pcm);
+    void emit(const void* data, std::size_t bytes);
+
+    /// Send raw samples, keeping packetized UDP framing.
+    template <typename T>
+    void emit_samples(std::span<const T> v)
+    {
+        if (use_udp_)
+            udp_.send(v);
+        else
+            emit(v.data(), v.size_bytes());
+    }
+};
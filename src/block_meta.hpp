@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @file block_meta.hpp
+ * @brief Stream position and capture time travelling with each block.
+ */
+
+/**
+ * @brief Where a block sits in its stream and when it was captured.
+ *
+ * Stamped by the receiver when next_block() returns: `sample_index` counts
+ * IQ pairs since the start of the stream, including blocks lost to
+ * overruns or dropped by a full ring, so a gap in the index is a gap in
+ * the samples. DemodPipeline translates it to the audio rate.
+ */
+struct BlockMeta {
+    using Clock = std::chrono::steady_clock;
+
+    std::uint64_t sample_index = 0; ///< Stream position of the first sample, at the block's rate
+    Clock::time_point captured{};   ///< When the refill returned (CLOCK_MONOTONIC on Linux)
+
+    /// @return `captured` in ns since the clock's epoch, as sent in datagram headers.
+    [[nodiscard]] std::uint64_t captured_ns() const noexcept
+    {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(captured.time_since_epoch()).count());
+    }
+};
+
+/**
+ * @class StreamPosition
+ * @brief Audio-rate BlockMeta of a decimating chain.
+ *
+ * Within a contiguous input the output index counts the frames produced,
+ * so partial decimation windows carried between blocks never make it
+ * drift. A jump in the input index (lost blocks, a new stream) moves it by
+ * the same time at the output rate.
+ */
+class StreamPosition {
+public:
+    /// @param decimation  Input pairs per output frame
+    explicit StreamPosition(std::uint64_t decimation = 1) noexcept : decimation_{decimation} {}
+
+    /// @return Metadata of the output of the input block @p in.
+    BlockMeta begin(const BlockMeta& in) noexcept
+    {
+        if (!started_ || in.sample_index != next_input_)
+            offset_ = in.sample_index / decimation_ - frames_;
+        return {frames_ + offset_, in.captured};
+    }
+
+    /// Account the block begun last: input resumes at @p next_input, @p frames came out.
+    void end(std::uint64_t next_input, std::uint64_t frames) noexcept
+    {
+        started_ = true;
+        next_input_ = next_input;
+        frames_ += frames;
+    }
+
+    /// Resynchronise to the input at the next block.
+    void reset() noexcept { started_ = false; }
+
+private:
+    std::uint64_t decimation_;
+    bool started_ = false;
+    std::uint64_t next_input_ = 0; ///< Index of the pair after the last block
+    std::uint64_t frames_ = 0;     ///< Frames produced since construction
+    std::uint64_t offset_ = 0;     ///< Output index minus frames_ (mod 2^64)
+};
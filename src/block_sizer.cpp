@@ -0,0 +1,94 @@
+#include "block_sizer.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+using std::chrono::nanoseconds;
+
+namespace {
+
+/// @return Pairs of @p rate covered by @p t, at least one.
+std::size_t pairs_in(std::chrono::microseconds t, long long rate) noexcept
+{
+    return static_cast<std::size_t>(std::max<long long>(1, t.count() * rate / 1'000'000));
+}
+
+} // namespace
+
+BlockSizer::BlockSizer(const LowLatencyOptions& opts, long long sample_rate, std::size_t granule)
+    : opts_{opts}
+    , rate_{sample_rate}
+    , granule_{granule}
+{
+    if (rate_ <= 0 || granule_ == 0)
+        throw std::invalid_argument("Sample rate and granule must be positive");
+    if (opts.min_block.count() <= 0 || opts.min_block > opts.max_block)
+        throw std::invalid_argument("Invalid low-latency block range");
+    if (!(opts.target_load > 0.0) || !(opts.jitter_limit > 0.0) || !(opts.max_jittery >= 0.0) ||
+        !(opts.shrink_margin > 0.0 && opts.shrink_margin <= 1.0) || opts.window.count() <= 0)
+        throw std::invalid_argument("Invalid low-latency thresholds");
+
+    // Whole granules, at least one; the maximum rounds down but not below the minimum
+    min_ = std::max<std::size_t>(1, (pairs_in(opts.min_block, rate_) + granule_ - 1) / granule_) * granule_;
+    max_ = std::max(min_, pairs_in(opts.max_block, rate_) / granule_ * granule_);
+    size_ = min_;
+}
+
+nanoseconds BlockSizer::period(std::size_t pairs) const noexcept
+{
+    return nanoseconds{static_cast<long long>(pairs) * 1'000'000'000LL / rate_};
+}
+
+std::size_t BlockSizer::clamp(std::size_t pairs) const noexcept
+{
+    return std::clamp(pairs / granule_ * granule_, min_, max_);
+}
+
+std::size_t BlockSizer::resize(std::size_t pairs) noexcept
+{
+    pairs = clamp(pairs);
+    if (pairs != size_) {
+        size_ = pairs;
+        changes_++;
+        timed_ = false;
+    }
+    elapsed_ = work_ = nanoseconds{0};
+    blocks_ = jittery_ = 0;
+    return size_;
+}
+
+std::size_t BlockSizer::on_block(std::size_t pairs, Clock::time_point ready, Clock::time_point done) noexcept
+{
+    const nanoseconds block = period(pairs);
+    const nanoseconds work = done - ready;
+
+    // The first refill of a run, or the one after a resize, has no interval
+    const bool timed = timed_;
+    const nanoseconds interval = ready - last_ready_;
+    timed_ = true;
+    last_ready_ = ready;
+
+    // Falling behind right now: do not wait for the window
+    if (work > block)
+        return resize(size_ * 2);
+
+    blocks_++;
+    elapsed_ += block;
+    work_ += work;
+    if (timed) {
+        const nanoseconds deviation = interval > block ? interval - block : block - interval;
+        if (static_cast<double>(deviation.count()) > opts_.jitter_limit * static_cast<double>(block.count()))
+            jittery_++;
+    }
+
+    if (elapsed_ < opts_.window)
+        return size_;
+
+    const double load = static_cast<double>(work_.count()) / static_cast<double>(elapsed_.count());
+    const double jittery = static_cast<double>(jittery_) / static_cast<double>(blocks_);
+
+    if (load > opts_.target_load || jittery > opts_.max_jittery)
+        return resize(size_ * 2);
+    if (2.0 * load < opts_.shrink_margin * opts_.target_load && jittery_ == 0)
+        return resize(size_ / 2);
+    return resize(size_);
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file block_sizer.hpp
+ * @brief Capture block size that follows measured refill jitter and DSP load.
+ */
+
+/// Bounds and thresholds of the adaptive low-latency mode.
+struct LowLatencyOptions {
+    /// Smallest block, and the one a run starts with
+    std::chrono::microseconds min_block{4'000};
+
+    /// Largest block (the default 50 ms refill)
+    std::chrono::microseconds max_block{50'000};
+
+    /// Grow when DSP and output take more than this share of a block period
+    double target_load = 0.5;
+
+    /// Halve only while twice the load stays below this share of `target_load`,
+    /// so a block that just halved is not doubled straight back by noise
+    double shrink_margin = 0.75;
+
+    /// A refill is jittery when it arrives this share of a period early or late
+    double jitter_limit = 0.5;
+
+    /// Grow when more than this share of a window's refills are jittery
+    double max_jittery = 0.1;
+
+    /// Real time between two decisions
+    std::chrono::milliseconds window{500};
+};
+
+/**
+ * @class BlockSizer
+ * @brief Picks the capture block size of the next refills.
+ *
+ * Small refills cut capture latency but cost a syscall, a DMA hand-off and
+ * a pass over every DSP stage each; at 4 ms blocks that fixed cost is a
+ * large share of the period. The sizer watches each block's refill
+ * interval and the time spent on DSP and output, and once per window:
+ *
+ *  - doubles the block if the mean load exceeds `target_load`, or if too
+ *    many refills strayed from the nominal period by more than
+ *    `jitter_limit` (the host cannot keep up with the refill rate);
+ *  - halves it if the load would stay below `shrink_margin` of the target
+ *    even with twice the per-block overhead, and no refill was jittery.
+ *
+ * A block whose work alone takes longer than its period grows the size at
+ * once. Sizes are multiples of `granule` (the decimation product), so each
+ * block yields a whole number of audio samples.
+ */
+class BlockSizer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @param opts         Bounds and thresholds
+     * @param sample_rate  IQ pairs per second of the source
+     * @param granule      Block sizes are multiples of this many pairs
+     * @throws std::invalid_argument for non-positive bounds or thresholds,
+     *         a `shrink_margin` above 1, `min_block > max_block` or a zero
+     *         rate or granule
+     */
+    BlockSizer(const LowLatencyOptions& opts, long long sample_rate, std::size_t granule);
+
+    /// @return Pairs per block to capture next.
+    [[nodiscard]] std::size_t block_size() const noexcept { return size_; }
+
+    [[nodiscard]] std::size_t min_block() const noexcept { return min_; }
+    [[nodiscard]] std::size_t max_block() const noexcept { return max_; }
+
+    /// @return Times the block size was changed.
+    [[nodiscard]] std::uint64_t changes() const noexcept { return changes_; }
+
+    /// @return Real-time duration of a block of @p pairs.
+    [[nodiscard]] std::chrono::nanoseconds period(std::size_t pairs) const noexcept;
+
+    /**
+     * @brief Account one block of @p pairs.
+     *
+     * @param ready  When next_block() returned it
+     * @param done   When its audio was handed to the output
+     * @return Block size to use from now on
+     */
+    std::size_t on_block(std::size_t pairs, Clock::time_point ready, Clock::time_point done) noexcept;
+
+private:
+    LowLatencyOptions opts_;
+    long long rate_;
+    std::size_t granule_;
+    std::size_t min_;
+    std::size_t max_;
+    std::size_t size_;
+    std::uint64_t changes_ = 0;
+
+    // Current window
+    bool timed_ = false;                  ///< last_ready_ is from a block of this size
+    Clock::time_point last_ready_{};
+    std::chrono::nanoseconds elapsed_{0}; ///< Real time of the blocks seen
+    std::chrono::nanoseconds work_{0};
+    std::size_t blocks_ = 0;
+    std::size_t jittery_ = 0;
+
+    /// @return @p pairs rounded to a multiple of the granule within the bounds.
+    [[nodiscard]] std::size_t clamp(std::size_t pairs) const noexcept;
+
+    /// Switch to @p pairs and start a new window.
+    std::size_t resize(std::size_t pairs) noexcept;
+};
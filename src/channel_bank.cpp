@@ -0,0 +1,225 @@
+#include "channel_bank.hpp"
+#include "thread_util.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+/// IQ pairs mixed per pass, so the full-rate shifted signal stays in L1/L2
+constexpr std::size_t kMixChunk = 4096;
+
+// Channels run the default plan's fixed-factor filters
+constexpr long long kInputRateHz = kDefaultRatePlan.input_rate_hz;
+constexpr int kDecimIq = kDefaultRatePlan.decim_iq;
+constexpr int kDecimAudio = kDefaultRatePlan.decim_audio;
+
+unsigned pick_threads(unsigned requested, std::size_t channels)
+{
+    if (requested == 0) {
+        const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        requested = std::min<unsigned>(cores, static_cast<unsigned>(channels));
+    }
+    return std::clamp<unsigned>(requested, 1u, static_cast<unsigned>(channels));
+}
+
+} // namespace
+
+/// Per-station DSP state, buffers and output socket.
+struct ChannelBank::Channel {
+    ChannelConfig config;
+    double nco_frequency; ///< Cycles per input sample
+    dsp::NcoState nco;
+
+    dsp::FirDecimator<std::complex<float>, kDecimIq> iq_fir;
+    dsp::DemodState demod;
+    dsp::AudioDecimState audio_state;
+    dsp::FirDecimator<float, kDecimAudio> audio_fir;
+    float deemphasis_alpha = 0.0f; ///< 0 = flat
+    dsp::DeemphasisState deemphasis;
+    dsp::SquelchState squelch;
+    std::size_t muted_phase = 0; ///< Partial audio window while squelched
+
+    std::vector<std::complex<float>> mixed;
+    std::vector<std::complex<float>> iq_part;
+    std::vector<std::complex<float>> iq;
+    std::vector<float> freq;
+    std::vector<float> audio;
+    std::vector<int16_t> pcm;
+
+    AudioOutput out;
+    StreamPosition position{static_cast<std::uint64_t>(kDecimIq * kDecimAudio)};
+
+    void process(std::span<const int16_t> raw, const BlockMeta& meta, const DspOptions& dsp, float gain)
+    {
+        out.stamp(position.begin(meta));
+        position.end(meta.sample_index + raw.size() / 2, demodulate(raw, dsp, gain));
+    }
+
+    /// @return Audio frames written or muted.
+    std::size_t demodulate(std::span<const int16_t> raw, const DspOptions& dsp, float gain)
+    {
+        iq.clear();
+
+        for (std::size_t off = 0; off < raw.size(); off += 2 * kMixChunk) {
+            const auto chunk = raw.subspan(off, std::min(2 * kMixChunk, raw.size() - off));
+
+            dsp::mix_iq(chunk, mixed, nco_frequency, nco);
+            iq_fir.process(mixed, iq_part);
+            iq.insert(iq.end(), iq_part.begin(), iq_part.end());
+        }
+
+        std::size_t muted = 0;
+        if (dsp.squelch_dbfs && !pass_squelch(dsp, muted))
+            return muted;
+
+        dsp::demodulate_fm(iq, freq, demod, dsp.discriminator);
+
+        // Flat boxcar audio converts to s16 inside the decimator
+        if (dsp.decimator != DecimatorType::Fir && out.wants_pcm() && deemphasis_alpha == 0.0f) {
+            dsp::downsample_audio(freq, pcm, kDecimAudio, audio_state, gain);
+            out.write(pcm);
+            return pcm.size();
+        }
+
+        if (dsp.decimator == DecimatorType::Fir)
+            audio_fir.process(freq, audio, gain);
+        else
+            dsp::downsample_audio(freq, audio, kDecimAudio, audio_state, gain);
+        if (deemphasis_alpha > 0.0f)
+            dsp::deemphasis(audio, deemphasis_alpha, deemphasis);
+        out.write(audio);
+        return audio.size();
+    }
+
+    /// Gate the channel IQ; a squelched block only reports its @p muted frames of silence.
+    bool pass_squelch(const DspOptions& dsp, std::size_t& muted)
+    {
+        // The mixer and FIR keep int16 scale (unity DC gain)
+        const float level = dsp::power_dbfs(dsp::mean_power(iq, 32768.0f));
+        const bool was_open = squelch.open;
+
+        if (!dsp::squelch(level, *dsp.squelch_dbfs, dsp.squelch_hysteresis_db, squelch)) {
+            // The open audio window carries on as muted samples
+            if (was_open)
+                muted_phase = audio_phase(dsp);
+
+            const std::size_t total = muted_phase + iq.size();
+            muted_phase = total % kDecimAudio;
+            muted = total / kDecimAudio;
+            out.write_silence(muted);
+            return false;
+        }
+
+        if (!was_open) {
+            // Only the window phase the muted blocks kept carries over, so
+            // the frame count keeps following the input
+            demod = {};
+            audio_state = {};
+            deemphasis = {};
+            resume_audio(dsp, muted_phase);
+            muted_phase = 0;
+        }
+        return true;
+    }
+
+    /// @return Inputs taken toward the next frame by the audio decimator in use.
+    std::size_t audio_phase(const DspOptions& dsp) const noexcept
+    {
+        if (dsp.decimator == DecimatorType::Fir)
+            return audio_fir.phase();
+        return static_cast<std::size_t>(audio_state.counter);
+    }
+
+    /// Restart the audio decimator in use with @p phase inputs of its window taken.
+    void resume_audio(const DspOptions& dsp, std::size_t phase)
+    {
+        if (dsp.decimator == DecimatorType::Fir)
+            audio_fir.reset(phase);
+        else
+            audio_state.counter = static_cast<int>(phase);
+    }
+};
+
+ChannelBank::ChannelBank(const std::vector<ChannelConfig>& channels,
+                         const std::string& udp_ip,
+                         const DspOptions& dsp,
+                         float audio_gain,
+                         unsigned threads,
+                         const OutputOptions& output)
+    : dsp_{dsp}
+    , audio_gain_{audio_gain}
+    , threads_{pick_threads(threads, std::max<std::size_t>(channels.size(), 1))}
+    , start_{static_cast<std::ptrdiff_t>(threads_)}
+    , done_{static_cast<std::ptrdiff_t>(threads_)}
+{
+    if (channels.empty())
+        throw std::invalid_argument("Channel list must not be empty");
+    if (dsp.rates != kDefaultRatePlan)
+        throw std::invalid_argument("Channels require the default rate plan");
+    if (dsp.arithmetic != Arithmetic::Float)
+        throw std::invalid_argument("Channels run the float chain only");
+
+    for (const ChannelConfig& cfg : channels) {
+        if (2 * std::llabs(cfg.offset_hz) >= kInputRateHz)
+            throw std::invalid_argument("Channel offset outside capture bandwidth: " +
+                                        std::to_string(cfg.offset_hz) + " Hz");
+
+        auto ch = std::make_unique<Channel>();
+        ch->config = cfg;
+        ch->nco_frequency = -static_cast<double>(cfg.offset_hz) /
+                            static_cast<double>(kInputRateHz);
+        ch->out = AudioOutput(udp_ip, cfg.udp_port, output);
+        if (dsp.deemphasis_us > 0.0f)
+            ch->deemphasis_alpha = dsp::deemphasis_alpha(
+                dsp.deemphasis_us, static_cast<float>(kDefaultRatePlan.audio_rate_hz()));
+        // A fresh FIR emits on its first input: blocks muted from the start count from there
+        ch->muted_phase = ch->audio_phase(dsp);
+        channels_.push_back(std::move(ch));
+    }
+
+    for (unsigned w = 1; w < threads_; w++) {
+        workers_.emplace_back([this, w] {
+            const std::string name = "fm-chan-" + std::to_string(w);
+            set_current_thread_name(name.c_str());
+            if (dsp_.flush_denormals)
+                enable_flush_to_zero();
+
+            while (true) {
+                start_.arrive_and_wait();
+                if (stop_) break;
+                run_share(w);
+                done_.arrive_and_wait();
+            }
+        });
+    }
+}
+
+ChannelBank::~ChannelBank()
+{
+    stop_ = true;
+    start_.arrive_and_wait();
+}
+
+void ChannelBank::process(std::span<const int16_t> raw)
+{
+    process(raw, {next_index_, BlockMeta::Clock::now()});
+}
+
+void ChannelBank::process(std::span<const int16_t> raw, const BlockMeta& meta)
+{
+    block_ = raw;
+    meta_ = meta;
+    next_index_ = meta.sample_index + raw.size() / 2;
+    start_.arrive_and_wait();
+    run_share(0);
+    done_.arrive_and_wait();
+}
+
+void ChannelBank::run_share(unsigned index)
+{
+    for (std::size_t c = index; c < channels_.size(); c += threads_)
+        channels_[c]->process(block_, meta_, dsp_, audio_gain_);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <barrier>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio_output.hpp"
+#include "pipeline.hpp"
+
+/**
+ * @file channel_bank.hpp
+ * @brief Multi-station receiver sharing one wideband capture.
+ */
+
+/// One station inside the captured band.
+struct ChannelConfig {
+    /// Station frequency minus the capture centre frequency (Hz)
+    long long offset_hz = 0;
+
+    /// UDP destination port for this station's audio
+    int udp_port = 0;
+};
+
+/**
+ * @class ChannelBank
+ * @brief Demodulates several FM stations from the same IQ block in parallel.
+ *
+ * Each channel shifts its station to DC with an NCO, isolates it with the
+ * polyphase FIR decimator (a boxcar would let the neighbouring stations
+ * alias in), then runs the discriminator, audio decimation and de-emphasis
+ * selected by DspOptions, and sends the audio to its own UDP port.
+ *
+ * Channels are spread round-robin over worker threads. process() hands
+ * the shared block to every worker through a std::barrier and returns once
+ * all channels are done, so the caller may refill the IIO buffer right
+ * after. The calling thread works on its own share of the channels rather
+ * than idling.
+ */
+class ChannelBank {
+public:
+    /**
+     * @param channels    Stations to receive (at least one)
+     * @param udp_ip      Audio destination address shared by all channels
+     * @param dsp         Discriminator and audio decimator selection
+     * @param audio_gain  Audio gain applied after DSP
+     * @param threads     Worker threads including the caller
+     *                    (0 = one per channel, capped at the core count)
+     * @param output      Audio format and UDP framing of every channel
+     *
+     * @throws std::invalid_argument if a channel lies outside the capture,
+     *         or @p dsp asks for a rate plan other than kDefaultRatePlan or
+     *         for fixed-point arithmetic
+     */
+    ChannelBank(const std::vector<ChannelConfig>& channels,
+                const std::string& udp_ip,
+                const DspOptions& dsp = {},
+                float audio_gain = 0.3f,
+                unsigned threads = 0,
+                const OutputOptions& output = {});
+
+    ~ChannelBank();
+
+    ChannelBank(const ChannelBank&) = delete;
+    ChannelBank& operator=(const ChannelBank&) = delete;
+
+    /**
+     * @brief Demodulate one capture block on every channel and send the audio.
+     *
+     * Each channel's datagrams carry @p meta at its audio rate (see
+     * AudioOutput::stamp()). Blocks until all channels have finished with @p raw.
+     */
+    void process(std::span<const int16_t> raw, const BlockMeta& meta);
+
+    /// process() of a block captured now, right after the previous one.
+    void process(std::span<const int16_t> raw);
+
+    /// Number of channels.
+    [[nodiscard]] std::size_t size() const noexcept { return channels_.size(); }
+
+    /// Number of threads sharing the work, including the caller.
+    [[nodiscard]] unsigned threads() const noexcept { return threads_; }
+
+    /// @return true if the workers flush denormals; the caller's thread is
+    ///         left to the caller (Receiver::run_channels() sets it).
+    [[nodiscard]] bool flush_denormals() const noexcept { return dsp_.flush_denormals; }
+
+private:
+    struct Channel;
+
+    std::vector<std::unique_ptr<Channel>> channels_;
+    DspOptions dsp_;
+    float audio_gain_;
+    unsigned threads_ = 1;
+
+    // Block handed to the workers; valid between the start and done phases
+    std::span<const int16_t> block_;
+    BlockMeta meta_;
+    std::uint64_t next_index_ = 0; ///< sample_index after the last block
+    bool stop_ = false;
+
+    std::barrier<> start_;
+    std::barrier<> done_;
+    std::vector<std::jthread> workers_;
+
+    /// Process the channels assigned to worker @p index.
+    void run_share(unsigned index);
+};
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <numbers>
+#include <span>
+#include <vector>
+
+#include "fft.hpp"
+
+/**
+ * @file channelizer.hpp
+ * @brief Polyphase filter bank (PFB) channelizer: M subbands in one pass.
+ */
+
+namespace dsp {
+
+namespace detail {
+
+/// cos(x) usable in constant expressions (range reduction + Taylor series).
+constexpr double constexpr_cos(double x)
+{
+    constexpr double kTwoPi = 2.0 * std::numbers::pi;
+
+    x -= kTwoPi * static_cast<double>(static_cast<long long>(x / kTwoPi));
+    if (x > std::numbers::pi)  x -= kTwoPi;
+    if (x < -std::numbers::pi) x += kTwoPi;
+
+    const double x2 = x * x;
+    double term = 1.0, sum = 1.0;
+    for (int k = 1; k < 30; k++) {
+        term *= -x2 / static_cast<double>((2 * k - 1) * (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+/// sin(x) usable in constant expressions.
+constexpr double constexpr_sin(double x)
+{
+    return constexpr_cos(x - std::numbers::pi / 2.0);
+}
+
+/**
+ * @brief PFB prototype low-pass, reversed and duplicated for interleaved I/Q.
+ *
+ * Windowed sinc of M * P taps with its -6 dB corner at half the channel
+ * spacing (fs / 2M), 4-term Blackman-Harris window, unity DC gain.
+ */
+template <std::size_t M, std::size_t P>
+constexpr std::array<float, 2 * M * P> pfb_prototype()
+{
+    constexpr std::size_t L = M * P;
+    constexpr double kPi = std::numbers::pi;
+
+    std::array<double, L> h{};
+    double sum = 0.0;
+
+    for (std::size_t n = 0; n < L; n++) {
+        const double t = static_cast<double>(n) - static_cast<double>(L - 1) / 2.0;
+        const double x = kPi * t / static_cast<double>(M);
+        const double sinc = (t == 0.0) ? 1.0 : constexpr_sin(x) / x;
+
+        const double r = 2.0 * kPi * static_cast<double>(n) / static_cast<double>(L - 1);
+        const double window = 0.35875 - 0.48829 * constexpr_cos(r)
+                            + 0.14128 * constexpr_cos(2.0 * r)
+                            - 0.01168 * constexpr_cos(3.0 * r);
+
+        h[n] = sinc * window;
+        sum += h[n];
+    }
+
+    std::array<float, 2 * L> taps2{};
+    for (std::size_t i = 0; i < L; i++) {
+        const float c = static_cast<float>(h[L - 1 - i] / sum);
+        taps2[2 * i]     = c;
+        taps2[2 * i + 1] = c;
+    }
+    return taps2;
+}
+
+} // namespace detail
+
+/**
+ * @class PfbChannelizer
+ * @brief Critically sampled polyphase FFT filter bank.
+ *
+ * Splits a complex stream into M equally spaced subbands, each decimated
+ * by M. Channel k is centred on k * fs / M (channels above M / 2 are the
+ * negative frequencies). Per output frame the filter bank does M * P real
+ * multiply-accumulates on the prototype filter and one M-point FFT, so the
+ * cost per input sample is P + O(log M) rather than growing linearly with
+ * the channel count as in per-channel NCO + FIR (see ChannelBank).
+ *
+ * This is a separate engine from the single-channel chain; feed it the
+ * output of downsample_iq() (or raw samples widened to float) and pick the
+ * channels of interest from the frames.
+ *
+ * @tparam M Number of channels (power of two)
+ * @tparam P Prototype taps per polyphase branch
+ */
+template <std::size_t M, std::size_t P = 8>
+class PfbChannelizer {
+    static_assert(M >= 2 && (M & (M - 1)) == 0, "Channel count must be a power of two");
+    static_assert(P >= 1, "Need at least one tap per branch");
+
+public:
+    static constexpr std::size_t kChannels      = M;
+    static constexpr std::size_t kTapsPerBranch = P;
+    static constexpr std::size_t kTaps          = M * P;
+
+    /// Prototype filter, built at compile time
+    static constexpr std::array<float, 2 * kTaps> kPrototype = detail::pfb_prototype<M, P>();
+
+    PfbChannelizer()
+        : fft_(M)
+    {
+        reset();
+    }
+
+    /// Centre of channel @p k in cycles per input sample, in [-0.5, 0.5).
+    [[nodiscard]] static constexpr double channel_frequency(std::size_t k) noexcept
+    {
+        const double f = static_cast<double>(k) / static_cast<double>(M);
+        return (2 * k < M) ? f : f - 1.0;
+    }
+
+    /// Clear the filter history.
+    void reset()
+    {
+        buf_.assign(kTaps - M, std::complex<float>{});
+    }
+
+    /**
+     * @brief Channelize one block.
+     *
+     * @param in   Complex input samples
+     * @param out  Receives frames of M channel samples: `out[t * M + k]` is
+     *             sample t of channel k (cleared first)
+     *
+     * @note Input not completing a frame is kept for the next call.
+     */
+    void process(std::span<const std::complex<float>> in,
+                 std::vector<std::complex<float>>& out)
+    {
+        buf_.insert(buf_.end(), in.begin(), in.end());
+        out.clear();
+
+        if (buf_.size() < kTaps)
+            return;
+
+        const std::size_t frames = (buf_.size() - kTaps) / M + 1;
+        out.resize(frames * M);
+
+        for (std::size_t f = 0; f < frames; f++) {
+            const float* w = reinterpret_cast<const float*>(buf_.data() + f * M);
+            std::array<float, 2 * M> v{};
+
+            // Window the last M * P samples and fold the P branches
+            for (std::size_t q = 0; q < P; q++) {
+                const float* wq = w + 2 * q * M;
+                const float* hq = kPrototype.data() + 2 * q * M;
+                for (std::size_t i = 0; i < 2 * M; i++)
+                    v[i] += hq[i] * wq[i];
+            }
+
+            // Newest sample first, then the inverse DFT across branches
+            std::complex<float>* y = out.data() + f * M;
+            for (std::size_t m = 0; m < M; m++)
+                y[m] = {v[2 * (M - 1 - m)], v[2 * (M - 1 - m) + 1]};
+
+            fft_.inverse({y, M});
+        }
+
+        buf_.erase(buf_.begin(), buf_.begin() + static_cast<std::ptrdiff_t>(frames * M));
+    }
+
+private:
+    Fft fft_;
+    std::vector<std::complex<float>> buf_;
+};
+
+} // namespace dsp
@@ -0,0 +1,34 @@
+#include "cpu_features.hpp"
+
+#if defined(__arm__) || defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+namespace {
+
+CpuFeatures detect() noexcept
+{
+    CpuFeatures f;
+
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    f.sse41  = __builtin_cpu_supports("sse4.1");
+    f.avx2   = __builtin_cpu_supports("avx2");
+    f.avx512 = __builtin_cpu_supports("avx512f");
+#elif defined(__aarch64__)
+    f.neon = (getauxval(AT_HWCAP) & HWCAP_ASIMD) != 0;
+#elif defined(__arm__)
+    f.neon = (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#endif
+
+    return f;
+}
+
+} // namespace
+
+const CpuFeatures& cpu_features() noexcept
+{
+    static const CpuFeatures features = detect();
+    return features;
+}
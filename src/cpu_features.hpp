@@ -0,0 +1,22 @@
+#pragma once
+
+/**
+ * @file cpu_features.hpp
+ * @brief Runtime detection of SIMD instruction set extensions.
+ */
+
+/// SIMD extensions available on the running CPU.
+struct CpuFeatures {
+    bool neon   = false; ///< ARM Advanced SIMD
+    bool sse41  = false; ///< x86 SSE4.1
+    bool avx2   = false; ///< x86 AVX2
+    bool avx512 = false; ///< x86 AVX-512 Foundation
+};
+
+/**
+ * @brief Query the running CPU once and cache the result.
+ *
+ * Uses CPUID (via the compiler builtins) on x86 and the ELF auxiliary vector
+ * (AT_HWCAP) on ARM, so one binary adapts to the host it runs on.
+ */
+const CpuFeatures& cpu_features() noexcept;
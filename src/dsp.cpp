@@ -1,145 +1,616 @@
 #include "dsp.hpp"
+#include "dsp_detail.hpp"
+#include "dsp_kernels.hpp"
 
-#if defined(__ARM_NEON) || defined(__ARM_NEON__)
-#include <arm_neon.h>
-#endif
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <stdexcept>
+#include <type_traits>
 
 namespace dsp {
 
-#if defined(__ARM_NEON) || defined(__ARM_NEON__)
-static inline int32_t horizontal_sum_8(int16x8_t v) {
-    // Widen to int32 to prevent overflow during accumulation
-    int32x4_t low32 = vmovl_s16(vget_low_s16(v));
-    int32x4_t high32 = vmovl_s16(vget_high_s16(v));
-    
-    // Sum the two halves
-    int32x4_t sum4 = vaddq_s32(low32, high32);
-    
-    // Horizontal add to get final sum
-    int32x2_t sum2 = vadd_s32(vget_low_s32(sum4), vget_high_s32(sum4));
-    int32x2_t sum1 = vpadd_s32(sum2, sum2);
-    
-    return vget_lane_s32(sum1, 0);
-}
-#endif
+using detail::kAtanC1;
+using detail::kAtanC3;
+using detail::kAtanC5;
+using detail::kAtanC7;
+using detail::kAtanC9;
+using detail::kHalfPi;
+using detail::kPi;
+using detail::require_output;
+
+float fast_atan2(float y, float x) noexcept
+{
+    const float ax = std::fabs(x);
+    const float ay = std::fabs(y);
+
+    // Denominator clamped so (0, 0) yields 0 instead of NaN
+    const float a = std::fmin(ax, ay) / std::fmax(std::fmax(ax, ay), FLT_MIN);
+    const float z = a * a;
+
+    float r = ((((kAtanC9 * z + kAtanC7) * z + kAtanC5) * z + kAtanC3) * z + kAtanC1) * a;
+
+    if (ay > ax) r = kHalfPi - r;
+    if (x < 0.0f) r = kPi - r;
+    return std::signbit(y) ? -r : r;
+}
+
+namespace {
+
+/// Segments of the lut_atan2() tables; 8 mantissa bits index the reciprocal
+constexpr int kLutBits = 8;
+constexpr std::size_t kLutSize = std::size_t{1} << kLutBits;
+
+/// atan(x) for |x| <= 1 by its Taylor series around 0 or, above tan(pi/8),
+/// around 1 via atan(x) = pi/4 + atan((x - 1) / (x + 1)). Compile time only.
+constexpr double constexpr_atan(double x)
+{
+    double offset = 0.0;
+    if (x > 0.41421356237309503) {
+        offset = std::numbers::pi / 4.0;
+        x = (x - 1.0) / (x + 1.0);
+    }
+
+    // |x| <= tan(pi/8): 30 terms are far below float resolution
+    double term = x, sum = 0.0;
+    for (int n = 0; n < 30; n++) {
+        sum += term / static_cast<double>(2 * n + 1);
+        term *= -x * x;
+    }
+    return offset + sum;
+}
+
+/// atan(k / 256) for k = 0..256: the end points of the interpolation
+constexpr auto kAtanTable = [] {
+    std::array<float, kLutSize + 1> t{};
+    for (std::size_t k = 0; k <= kLutSize; k++)
+        t[k] = static_cast<float>(constexpr_atan(static_cast<double>(k) / kLutSize));
+    return t;
+}();
+
+/// 1 / m at the midpoint of each mantissa segment m in [1, 2)
+constexpr auto kRecipTable = [] {
+    std::array<float, kLutSize> t{};
+    for (std::size_t k = 0; k < kLutSize; k++)
+        t[k] = static_cast<float>(1.0 / (1.0 + (static_cast<double>(k) + 0.5) / kLutSize));
+    return t;
+}();
+
+static_assert(kAtanTable[kLutSize] == std::numbers::pi_v<float> / 4.0f);
+
+} // namespace
+
+float lut_atan2(float y, float x) noexcept
+{
+    const float ax = std::fabs(x);
+    const float ay = std::fabs(y);
+    const float hi = std::max(ax, ay);
+    const float lo = std::min(ax, ay);
+
+    // hi = m * 2^e with m in [1, 2): 1 / hi = (1 / m) * 2^-e, the table
+    // entry refined by one Newton step (relative error 2^-18)
+    const uint32_t bits = std::bit_cast<uint32_t>(hi);
+    const uint32_t biased = bits >> 23;
+    if (biased == 0 || biased > 253)
+        return 0.0f;
+
+    const float m = std::bit_cast<float>((bits & 0x007fffffu) | 0x3f800000u);
+    float r = kRecipTable[(bits >> (23 - kLutBits)) & (kLutSize - 1)];
+    r *= 2.0f - m * r;
+    const float scale = std::bit_cast<float>((254u - biased) << 23);
+
+    // Linear interpolation between the two neighbouring table entries; a
+    // ratio a hair above 1 from the reciprocal extrapolates the last one
+    const float t = lo * scale * r * static_cast<float>(kLutSize);
+    const int i = std::min(static_cast<int>(t), static_cast<int>(kLutSize) - 1);
+    const float f = t - static_cast<float>(i);
+    float a = kAtanTable[i] + f * (kAtanTable[i + 1] - kAtanTable[i]);
+
+    // Octant fix-ups on the bit patterns, as compilers turn float selects
+    // back into branches, which on FM are coin flips: with an all-ones
+    // mask, a becomes k - a; with zero it stays a
+    const auto reflect = [](float v, bool cond, float k) {
+        const uint32_t mask = 0u - static_cast<uint32_t>(cond);
+        return std::bit_cast<float>(std::bit_cast<uint32_t>(v) ^ (mask & 0x80000000u)) +
+               std::bit_cast<float>(mask & std::bit_cast<uint32_t>(k));
+    };
+    a = reflect(a, ay > ax, kHalfPi);
+    a = reflect(a, x < 0.0f, kPi);
+    return std::copysign(a, y);
+}
+
+// ---------------------------------------------------------------------------
+// Scalar reference kernels
+// ---------------------------------------------------------------------------
+
+namespace {
+
+std::size_t downsample_iq_scalar(const int16_t* in, std::size_t pairs,
+                                 int decim, std::complex<float>* out)
+{
+    const std::size_t blocks = pairs / static_cast<std::size_t>(decim);
+
+    for (std::size_t b = 0; b < blocks; b++) {
+        int32_t si = 0, sq = 0;
+        for (int k = 0; k < decim; k++) {
+            si += in[k * 2];
+            sq += in[k * 2 + 1];
+        }
+
+        out[b] = {static_cast<float>(si), static_cast<float>(sq)};
+        in += decim * 2;
+    }
+
+    return blocks;
+}
+
+void demodulate_fm_scalar(const std::complex<float>* in, std::size_t n,
+                          std::complex<float> prev, float* out)
+{
+    for (std::size_t i = 0; i < n; i++) {
+        const auto prod = in[i] * std::conj(prev);
+        out[i] = fast_atan2(prod.imag(), prod.real());
+        prev = in[i];
+    }
+}
+
+void demodulate_am_scalar(const std::complex<float>* in, std::size_t n,
+                          float* out)
+{
+    for (std::size_t i = 0; i < n; i++)
+        out[i] = std::abs(in[i]);
+}
+
+std::size_t downsample_audio_scalar(const float* in, std::size_t n,
+                                    int decim, float scale,
+                                    AudioDecimState& state, float* out)
+{
+    std::size_t written = 0;
+
+    for (std::size_t i = 0; i < n; i++) {
+        state.accumulator += in[i];
+
+        if (++state.counter == decim) {
+            out[written++] = state.accumulator * scale;
+            state.accumulator = 0.0f;
+            state.counter = 0;
+        }
+    }
+
+    return written;
+}
+
+void fir_decimate_scalar(const float* x, std::size_t n_out, std::size_t step,
+                         const float* taps, std::size_t ntaps, float* out)
+{
+    for (std::size_t m = 0; m < n_out; m++) {
+        const float* w = x + m * step;
+        float acc = 0.0f;
+        for (std::size_t j = 0; j < ntaps; j++)
+            acc += taps[j] * w[j];
+        out[m] = acc;
+    }
+}
+
+void fir_decimate_cf_scalar(const std::complex<float>* x, std::size_t n_out,
+                            std::size_t step, const float* taps2,
+                            std::size_t ntaps, std::complex<float>* out)
+{
+    for (std::size_t m = 0; m < n_out; m++) {
+        const std::complex<float>* w = x + m * step;
+        float re = 0.0f, im = 0.0f;
+        for (std::size_t j = 0; j < ntaps; j++) {
+            re += taps2[2 * j] * w[j].real();
+            im += taps2[2 * j] * w[j].imag();
+        }
+        out[m] = {re, im};
+    }
+}
+
+void mix_iq_scalar(const int16_t* in, std::size_t pairs,
+                   std::complex<float> phase, std::complex<float> step,
+                   std::complex<float>* out)
+{
+    for (std::size_t i = 0; i < pairs; i++) {
+        out[i] = std::complex<float>(in[2 * i], in[2 * i + 1]) * phase;
+        phase *= step;
+    }
+}
+
+void fft_pass_scalar(std::complex<float>* data, std::size_t n, std::size_t half,
+                     const std::complex<float>* tw)
+{
+    for (std::size_t base = 0; base < n; base += 2 * half) {
+        std::complex<float>* a = data + base;
+        std::complex<float>* b = a + half;
+
+        for (std::size_t k = 0; k < half; k++) {
+            const std::complex<float> t = b[k] * tw[k];
+            b[k] = a[k] - t;
+            a[k] += t;
+        }
+    }
+}
+
+void float_to_s16_scalar(const float* in, std::size_t n, float scale, int16_t* out)
+{
+    for (std::size_t i = 0; i < n; i++) {
+        float v = std::nearbyint(in[i] * scale);
+        if (!(v > -32768.0f)) v = -32768.0f;
+        if (v > 32767.0f) v = 32767.0f;
+        out[i] = static_cast<int16_t>(v);
+    }
+}
+
+float power_cf_scalar(const std::complex<float>* in, std::size_t n)
+{
+    double sum = 0.0;
+    for (std::size_t i = 0; i < n; i++)
+        sum += static_cast<double>(std::norm(in[i]));
+    return static_cast<float>(sum);
+}
+
+std::complex<float> pilot_mix_scalar(const float* mpx, std::size_t n,
+                                     std::complex<float> phase, std::complex<float> step,
+                                     float pilot, float diff_gain, float* sum, float* diff)
+{
+    float cr = 0.0f;
+    float ci = 0.0f;
+    for (std::size_t i = 0; i < n; i++) {
+        const float m = mpx[i];
+        cr += m * phase.real();
+        ci += m * phase.imag();
+        const float s = m - pilot * phase.imag();
+        sum[i]  = s;
+        diff[i] = diff_gain * s * phase.real() * phase.imag();
+        phase *= step;
+    }
+    return {cr, ci};
+}
+
+float deemphasis_scalar(float* data, std::size_t n, float a, float y)
+{
+    for (std::size_t i = 0; i < n; i++) {
+        y += a * (data[i] - y);
+        data[i] = y;
+    }
+    return y;
+}
+
+std::size_t downsample_iq_q15_scalar(const int16_t* in, std::size_t pairs,
+                                     int decim, int shift, int16_t* out)
+{
+    const std::size_t blocks = pairs / static_cast<std::size_t>(decim);
+
+    for (std::size_t b = 0; b < blocks; b++) {
+        int32_t si = 0, sq = 0;
+        for (int k = 0; k < decim; k++) {
+            si += in[k * 2];
+            sq += in[k * 2 + 1];
+        }
+
+        out[2 * b]     = detail::saturate_q15(si >> shift);
+        out[2 * b + 1] = detail::saturate_q15(sq >> shift);
+        in += decim * 2;
+    }
+
+    return blocks;
+}
+
+void demodulate_fm_q15_scalar(const int16_t* in, std::size_t n,
+                              int16_t prev_i, int16_t prev_q, int16_t* out)
+{
+    for (std::size_t i = 0; i < n; i++) {
+        const int32_t ci = in[2 * i];
+        const int32_t cq = in[2 * i + 1];
+
+        // cur * conj(prev), exact for components within +-kQ15Max
+        out[i] = cordic_atan2_q15(cq * prev_i - ci * prev_q, ci * prev_i + cq * prev_q);
+        prev_i = static_cast<int16_t>(ci);
+        prev_q = static_cast<int16_t>(cq);
+    }
+}
+
+std::size_t downsample_audio_q15_scalar(const int16_t* in, std::size_t n,
+                                        int decim, FixedGain gain,
+                                        AudioDecimStateQ15& state, int16_t* out)
+{
+    std::size_t written = 0;
+
+    for (std::size_t i = 0; i < n; i++) {
+        state.accumulator += in[i];
+
+        if (++state.counter == decim) {
+            out[written++] = detail::apply_gain_q15(state.accumulator, gain);
+            state.accumulator = 0;
+            state.counter = 0;
+        }
+    }
+
+    return written;
+}
+
+/// Reference discriminator of FmDiscriminator::Exact
+void demodulate_fm_exact(const std::complex<float>* in, std::size_t n,
+                         std::complex<float> prev, float* out)
+{
+    for (std::size_t i = 0; i < n; i++) {
+        const auto prod = in[i] * std::conj(prev);
+        out[i] = std::atan2(prod.imag(), prod.real());
+        prev = in[i];
+    }
+}
+
+/// Discriminator of FmDiscriminator::Lut
+void demodulate_fm_lut(const std::complex<float>* in, std::size_t n,
+                       std::complex<float> prev, float* out)
+{
+    for (std::size_t i = 0; i < n; i++) {
+        const auto prod = in[i] * std::conj(prev);
+        out[i] = lut_atan2(prod.imag(), prod.real());
+        prev = in[i];
+    }
+}
+
+/// Discriminator function of the tier @p accuracy
+DemodulateFmFn discriminator(FmDiscriminator accuracy) noexcept
+{
+    switch (accuracy) {
+    case FmDiscriminator::Exact: return demodulate_fm_exact;
+    case FmDiscriminator::Lut:   return demodulate_fm_lut;
+    default:                     return kernels().demodulate_fm.fn;
+    }
+}
+
+/**
+ * detail::downsample_iq_stream() into float samples.
+ * @param out Room for `(state.count + pairs) / decim` samples
+ * @return Number of samples written
+ */
+std::size_t downsample_iq_stream(const int16_t* in, std::size_t pairs, int decim,
+                                 IqDecimState& state, std::complex<float>* out)
+{
+    return detail::downsample_iq_stream(
+        in, pairs, decim, state,
+        [out](const IqDecimState& s) {
+            out[0] = {static_cast<float>(s.sum_i), static_cast<float>(s.sum_q)};
+        },
+        [=](const int16_t* p, std::size_t n, std::size_t first) {
+            return kernels().downsample_iq.fn(p, n, decim, out + first);
+        });
+}
+
+/// Longest run rotated by the float phasor recurrence before re-seeding
+constexpr std::size_t kMixRun = 1024;
+
+/// Complex samples per fused chunk; keeps both intermediates within 4 KiB
+constexpr std::size_t kFusedChunk = 256;
+
+} // namespace
+
+KernelTable detail::scalar_kernels() noexcept
+{
+    KernelTable t;
+    t.downsample_iq    = {downsample_iq_scalar,    Isa::Scalar};
+    t.demodulate_fm    = {demodulate_fm_scalar,    Isa::Scalar};
+    t.demodulate_am    = {demodulate_am_scalar,    Isa::Scalar};
+    t.downsample_audio = {downsample_audio_scalar, Isa::Scalar};
+    t.fir_decimate     = {fir_decimate_scalar,     Isa::Scalar};
+    t.fir_decimate_cf  = {fir_decimate_cf_scalar,  Isa::Scalar};
+    t.mix_iq           = {mix_iq_scalar,           Isa::Scalar};
+    t.fft_pass         = {fft_pass_scalar,         Isa::Scalar};
+    t.float_to_s16     = {float_to_s16_scalar,     Isa::Scalar};
+    t.power_cf         = {power_cf_scalar,         Isa::Scalar};
+    t.pilot_mix        = {pilot_mix_scalar,        Isa::Scalar};
+    t.deemphasis       = {deemphasis_scalar,       Isa::Scalar};
+    t.downsample_iq_q15    = {downsample_iq_q15_scalar,    Isa::Scalar};
+    t.demodulate_fm_q15    = {demodulate_fm_q15_scalar,    Isa::Scalar};
+    t.downsample_audio_q15 = {downsample_audio_q15_scalar, Isa::Scalar};
+    return t;
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+
+std::size_t downsample_iq(std::span<const int16_t> in,
+                          std::span<std::complex<float>> out,
+                          int decim)
+{
+    if (decim <= 0)
+        return 0;
+
+    const std::size_t pairs = in.size() / 2;
+    require_output(out.size(), pairs / static_cast<std::size_t>(decim), "downsample_iq");
+
+    return kernels().downsample_iq.fn(in.data(), pairs, decim, out.data());
+}
 
 void downsample_iq(std::span<const int16_t> in,
                    std::vector<std::complex<float>>& out,
                    int decim)
 {
-    constexpr int kIQComponents = 2;
-    const int stride = decim * kIQComponents;
+    out.resize(decim > 0 ? in.size() / 2 / static_cast<std::size_t>(decim) : 0);
+    out.resize(downsample_iq(in, std::span(out), decim));
+}
 
-    out.clear();
+std::size_t downsample_iq(std::span<const int16_t> in,
+                          std::span<std::complex<float>> out,
+                          int decim,
+                          IqDecimState& state)
+{
+    if (decim <= 0)
+        return 0;
 
-    if (in.size() < static_cast<size_t>(stride))
-        return;
+    const std::size_t pairs = in.size() / 2;
+    require_output(out.size(), decimated_size(state.count, pairs, decim), "downsample_iq");
 
-#if defined(__ARM_NEON) || defined(__ARM_NEON__)
-
-        size_t total_pairs = in.size() / 2;
-        size_t blocks = total_pairs / decim;
-
-        out.reserve(out.size() + blocks);
-
-        const int16_t* ptr = in.data();
-        const int16_t* endptr = ptr + blocks * stride;
-
-        while (ptr < endptr) {
-            int32_t si = 0, sq = 0;
-            
-            // Process 8 pairs at a time using NEON
-            size_t pairs_remaining = decim;
-            const int16_t* block_ptr = ptr;
-            
-            while (pairs_remaining >= 8) {
-                int16x8x2_t iq = vld2q_s16(block_ptr);
-                si += horizontal_sum_8(iq.val[0]);
-                sq += horizontal_sum_8(iq.val[1]);
-                block_ptr += 16;  // 8 pairs = 16 int16 values
-                pairs_remaining -= 8;
-            }
-            
-            // Handle remaining pairs with scalar code
-            for (size_t i = 0; i < pairs_remaining; i++) {
-                si += block_ptr[i * 2];
-                sq += block_ptr[i * 2 + 1];
-            }
-
-            out.emplace_back(static_cast<float>(si),
-                             static_cast<float>(sq));
-
-            ptr += stride;
-        }
-#else //__ARM_NEON || __ARM_NEON__
+    return downsample_iq_stream(in.data(), pairs, decim, state, out.data());
+}
 
-    const size_t n = in.size();
-    out.reserve(out.size() + n / stride + 1);
+void downsample_iq(std::span<const int16_t> in,
+                   std::vector<std::complex<float>>& out,
+                   int decim,
+                   IqDecimState& state)
+{
+    out.resize(decimated_size(state.count, in.size() / 2, decim));
+    out.resize(downsample_iq(in, std::span(out), decim, state));
+}
 
-    for (size_t i = 0; i + stride <= n; i += stride) {
-        float si = 0.f, sq = 0.f;
-        for (size_t k = 0; k < stride; k += 2) {
-            si += in[i + k];
-            sq += in[i + k + 1];
-        }
+std::size_t mix_iq(std::span<const int16_t> in,
+                   std::span<std::complex<float>> out,
+                   double frequency,
+                   NcoState& state)
+{
+    const std::size_t pairs = in.size() / 2;
+    require_output(out.size(), pairs, "mix_iq");
+
+    const MixIqFn fn = kernels().mix_iq.fn;
+    const double w = 2.0 * std::numbers::pi;
+    const auto step = std::polar(1.0f, static_cast<float>(w * frequency));
+
+    for (std::size_t i = 0; i < pairs; i += kMixRun) {
+        const std::size_t len = std::min(kMixRun, pairs - i);
+        const auto phase = std::polar(1.0f, static_cast<float>(w * state.phase));
 
-        out.emplace_back(si, sq);
+        fn(in.data() + 2 * i, len, phase, step, out.data() + i);
+
+        state.phase += frequency * static_cast<double>(len);
+        state.phase -= std::floor(state.phase);
     }
-#endif //__ARM_NEON || __ARM_NEON__
+    return pairs;
+}
+
+void mix_iq(std::span<const int16_t> in,
+            std::vector<std::complex<float>>& out,
+            double frequency,
+            NcoState& state)
+{
+    out.resize(in.size() / 2);
+    mix_iq(in, std::span(out), frequency, state);
+}
+
+std::size_t demodulate_fm(std::span<const std::complex<float>> in,
+                          std::span<float> out,
+                          DemodState& state,
+                          FmDiscriminator accuracy)
+{
+    if (in.empty())
+        return 0;
+
+    require_output(out.size(), in.size(), "demodulate_fm");
+
+    discriminator(accuracy)(in.data(), in.size(), state.prev_iq, out.data());
+    state.prev_iq = in.back();
+    return in.size();
 }
 
 void demodulate_fm(std::span<const std::complex<float>> in,
                 std::vector<float>& out,
-                DemodState& state)
+                DemodState& state,
+                FmDiscriminator accuracy)
 {
     out.resize(in.size());
-    auto out_it = out.begin();
+    demodulate_fm(in, std::span(out), state, accuracy);
+}
 
-    for (const auto& sample : in) {
-        const auto prod = sample * std::conj(state.prev_iq);
-        *out_it++ = std::atan2(prod.imag(), prod.real());
-        state.prev_iq = sample;
-    }
+std::size_t demodulate_am(std::span<const std::complex<float>> in,
+                          std::span<float> out)
+{
+    require_output(out.size(), in.size(), "demodulate_am");
+    kernels().demodulate_am.fn(in.data(), in.size(), out.data());
+    return in.size();
 }
 
 void demodulate_am(std::span<const std::complex<float>> in,
                    std::vector<float>& out)
 {
-    out.clear();
-    out.reserve(in.size());
+    out.resize(in.size());
+    demodulate_am(in, std::span(out));
+}
 
-#if defined(__ARM_NEON) || defined(__ARM_NEON__)
-    const float* ptr = reinterpret_cast<const float*>(in.data());
-    size_t count = in.size();
-    size_t i = 0;
+void remove_carrier(std::span<float> env, AmCarrierState& state, float alpha)
+{
+    if (env.empty())
+        return;
 
-    // Process 4 complex samples (8 floats) at a time
-    for (; i + 4 <= count; i += 4) {
-        float32x4x2_t iq = vld2q_f32(ptr);  // loads I=iq.val[0], Q=iq.val[1]
+    float c = state.carrier > 0.0f ? state.carrier : env.front();
+    for (float& x : env) {
+        c += alpha * (x - c);
+        x = c > 0.0f ? x / c - 1.0f : 0.0f;
+    }
+    state.carrier = c;
+}
 
-        float32x4_t i2 = vmulq_f32(iq.val[0], iq.val[0]);
-        float32x4_t q2 = vmulq_f32(iq.val[1], iq.val[1]);
+float deemphasis_alpha(float tau_us, float rate_hz) noexcept
+{
+    return static_cast<float>(1.0 - std::exp(-1e6 / (static_cast<double>(tau_us) * rate_hz)));
+}
 
-        float32x4_t sum = vaddq_f32(i2, q2);
-        float32x4_t mag = vsqrtq_f32(sum);
+void deemphasis(std::span<float> audio, float alpha, DeemphasisState& state)
+{
+    state.y = kernels().deemphasis.fn(audio.data(), audio.size(), alpha, state.y);
+}
 
-        size_t old_size = out.size();
-        out.resize(old_size + 4);
-        vst1q_f32(&out[old_size], mag);
+float mean_power(std::span<const int16_t> iq)
+{
+    const std::size_t pairs = iq.size() / 2;
+    if (pairs == 0)
+        return 0.0f;
 
-        ptr += 8; // 8 floats per 4 complex samples
-    }
+    // Exact: each pair adds at most 2^31, so any block below 2^32 pairs fits
+    std::int64_t sum = 0;
+    for (std::size_t i = 0; i < 2 * pairs; i++)
+        sum += static_cast<std::int32_t>(iq[i]) * iq[i];
 
-    // Process leftovers
-    for (; i < count; i++) {
-        out.push_back(std::abs(in[i]));
-    }
+    constexpr double kFullScale = 32768.0 * 32768.0;
+    return static_cast<float>(static_cast<double>(sum) / (kFullScale * static_cast<double>(pairs)));
+}
 
-#else //__ARM_NEON || __ARM_NEON__
-    for (auto& s : in) {
-        out.push_back(std::abs(s));
-    }
-#endif //__ARM_NEON || __ARM_NEON__
+float mean_power(std::span<const std::complex<float>> iq, float full_scale)
+{
+    if (iq.empty())
+        return 0.0f;
+
+    const float sum = kernels().power_cf.fn(iq.data(), iq.size());
+    return sum / (full_scale * full_scale * static_cast<float>(iq.size()));
+}
+
+bool squelch(float level_dbfs, float open_dbfs, float hysteresis_db,
+             SquelchState& state) noexcept
+{
+    if (state.open)
+        state.open = level_dbfs >= open_dbfs - hysteresis_db;
+    else
+        state.open = level_dbfs >= open_dbfs;
+    return state.open;
+}
+
+float power_dbfs(float power) noexcept
+{
+    constexpr float kFloor = 1e-20f; // -200 dBFS
+    return 10.0f * std::log10(std::max(power, kFloor));
+}
+
+std::size_t downsample_audio(std::span<const float> in,
+                             std::span<float> out,
+                             int decim,
+                             AudioDecimState& state,
+                             float gain)
+{
+    if (decim <= 0)
+        return 0;
+
+    require_output(out.size(), decimated_size(state.counter, in.size(), decim),
+                   "downsample_audio");
+
+    const float scale = gain / static_cast<float>(decim);
+    return kernels().downsample_audio.fn(in.data(), in.size(), decim,
+                                         scale, state, out.data());
 }
 
 void downsample_audio(std::span<const float> in,
@@ -148,19 +619,208 @@ void downsample_audio(std::span<const float> in,
                       AudioDecimState& state,
                       float gain)
 {
-    const float scale = gain / static_cast<float>(decim);
-  
-    out.clear();
+    out.resize(decimated_size(state.counter, in.size(), decim));
+    out.resize(downsample_audio(in, std::span(out), decim, state, gain));
+}
 
-    for (float v : in) {
-        state.accumulator += v;
+std::size_t float_to_s16(std::span<const float> in,
+                         std::span<int16_t> out,
+                         float gain)
+{
+    require_output(out.size(), in.size(), "float_to_s16");
+    kernels().float_to_s16.fn(in.data(), in.size(), gain * kS16FullScale, out.data());
+    return in.size();
+}
 
-        if (++state.counter == decim) {
-            out.push_back(state.accumulator * scale);
-            state.accumulator = 0.0f;
-            state.counter = 0;
+void float_to_s16(std::span<const float> in,
+                  std::vector<int16_t>& out,
+                  float gain)
+{
+    out.resize(in.size());
+    float_to_s16(in, std::span(out), gain);
+}
+
+std::size_t downsample_audio(std::span<const float> in,
+                             std::span<int16_t> out,
+                             int decim,
+                             AudioDecimState& state,
+                             float gain)
+{
+    if (decim <= 0)
+        return 0;
+
+    require_output(out.size(), decimated_size(state.counter, in.size(), decim),
+                   "downsample_audio");
+
+    const KernelTable& k = kernels();
+    const std::size_t d = static_cast<std::size_t>(decim);
+    const float scale = gain * kS16FullScale / static_cast<float>(decim);
+
+    // A carried-in partial window never pushes a chunk past kFusedChunk outputs
+    const std::size_t chunk = kFusedChunk * d;
+    float audio[kFusedChunk];
+    std::size_t written = 0;
+
+    for (std::size_t done = 0; done < in.size(); done += chunk) {
+        const std::size_t len = std::min(chunk, in.size() - done);
+        const std::size_t n = k.downsample_audio.fn(in.data() + done, len, decim,
+                                                    scale, state, audio);
+
+        k.float_to_s16.fn(audio, n, 1.0f, out.data() + written);
+        written += n;
+    }
+    return written;
+}
+
+void downsample_audio(std::span<const float> in,
+                      std::vector<int16_t>& out,
+                      int decim,
+                      AudioDecimState& state,
+                      float gain)
+{
+    out.resize(decimated_size(state.counter, in.size(), decim));
+    out.resize(downsample_audio(in, std::span(out), decim, state, gain));
+}
+
+namespace {
+
+/**
+ * Shared body of both demodulate_fm_fused() overloads. For int16 output the
+ * audio of each chunk is converted while it is still in L1.
+ */
+template <typename Out>
+std::size_t fused_fm_chain(std::span<const int16_t> in,
+                           std::span<Out> out,
+                           int decim_iq,
+                           int decim_audio,
+                           FusedFmState& state,
+                           float gain,
+                           FmDiscriminator accuracy,
+                           float* iq_power)
+{
+    constexpr bool kPcm = std::is_same_v<Out, int16_t>;
+
+    if (iq_power)
+        *iq_power = 0.0f;
+    if (decim_iq <= 0 || decim_audio <= 0)
+        return 0;
+
+    require_output(out.size(), fused_fm_size(in.size() / 2, decim_iq, decim_audio, state),
+                   "demodulate_fm_fused");
+
+    const KernelTable& k = kernels();
+    const DemodulateFmFn discriminate = discriminator(accuracy);
+
+    const std::size_t d_iq  = static_cast<std::size_t>(decim_iq);
+    const std::size_t pairs = in.size() / 2;
+    const float scale = (kPcm ? gain * kS16FullScale : gain) / static_cast<float>(decim_audio);
+
+    std::complex<float> iq[kFusedChunk];
+    float freq[kFusedChunk];
+    [[maybe_unused]] float audio[kPcm ? kFusedChunk : 1];
+    std::size_t written = 0;
+    double power_sum = 0.0;
+    std::size_t power_count = 0;
+
+    // A carried-in partial window never pushes a chunk past kFusedChunk outputs
+    const std::size_t chunk_pairs = kFusedChunk * d_iq;
+
+    for (std::size_t done = 0; done < pairs; done += chunk_pairs) {
+        const std::size_t len = std::min(chunk_pairs, pairs - done);
+
+        const std::size_t n = downsample_iq_stream(in.data() + 2 * done, len,
+                                                   decim_iq, state.iq, iq);
+        if (n == 0)
+            continue;
+
+        if (iq_power) {
+            power_sum += k.power_cf.fn(iq, n);
+            power_count += n;
+        }
+
+        discriminate(iq, n, state.demod.prev_iq, freq);
+        state.demod.prev_iq = iq[n - 1];
+
+        if constexpr (kPcm) {
+            const std::size_t m = k.downsample_audio.fn(freq, n, decim_audio, scale,
+                                                        state.audio, audio);
+            k.float_to_s16.fn(audio, m, 1.0f, out.data() + written);
+            written += m;
+        } else {
+            written += k.downsample_audio.fn(freq, n, decim_audio, scale,
+                                             state.audio, out.data() + written);
         }
     }
+
+    if (iq_power && power_count) {
+        // Boxcar windows are sums of decim_iq pairs, as in the staged chain
+        const double full_scale = 32768.0 * static_cast<double>(decim_iq);
+        *iq_power = static_cast<float>(power_sum / (full_scale * full_scale *
+                                                    static_cast<double>(power_count)));
+    }
+    return written;
+}
+
+} // namespace
+
+std::size_t fused_fm_size(std::size_t pairs, int iq_decimation, int audio_decimation,
+                          const FusedFmState& state) noexcept
+{
+    if (iq_decimation <= 0 || audio_decimation <= 0)
+        return 0;
+
+    const std::size_t iq = decimated_size(state.iq.count, pairs, iq_decimation);
+    return decimated_size(state.audio.counter, iq, audio_decimation);
+}
+
+std::size_t demodulate_fm_fused(std::span<const int16_t> in,
+                                std::span<float> out,
+                                int decim_iq,
+                                int decim_audio,
+                                FusedFmState& state,
+                                float gain,
+                                FmDiscriminator accuracy,
+                                float* iq_power)
+{
+    return fused_fm_chain(in, out, decim_iq, decim_audio, state, gain, accuracy, iq_power);
+}
+
+std::size_t demodulate_fm_fused(std::span<const int16_t> in,
+                                std::span<int16_t> out,
+                                int decim_iq,
+                                int decim_audio,
+                                FusedFmState& state,
+                                float gain,
+                                FmDiscriminator accuracy,
+                                float* iq_power)
+{
+    return fused_fm_chain(in, out, decim_iq, decim_audio, state, gain, accuracy, iq_power);
+}
+
+void demodulate_fm_fused(std::span<const int16_t> in,
+                         std::vector<float>& out,
+                         int decim_iq,
+                         int decim_audio,
+                         FusedFmState& state,
+                         float gain,
+                         FmDiscriminator accuracy)
+{
+    out.resize(fused_fm_size(in.size() / 2, decim_iq, decim_audio, state));
+    out.resize(fused_fm_chain(in, std::span(out), decim_iq, decim_audio, state, gain, accuracy,
+                              nullptr));
+}
+
+void demodulate_fm_fused(std::span<const int16_t> in,
+                         std::vector<int16_t>& out,
+                         int decim_iq,
+                         int decim_audio,
+                         FusedFmState& state,
+                         float gain,
+                         FmDiscriminator accuracy)
+{
+    out.resize(fused_fm_size(in.size() / 2, decim_iq, decim_audio, state));
+    out.resize(fused_fm_chain(in, std::span(out), decim_iq, decim_audio, state, gain, accuracy,
+                              nullptr));
 }
 
 } // namespace dsp
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <complex>
+#include <cstddef>
+#include <cstdint>
 #include <span>
 #include <vector>
 
@@ -25,6 +27,55 @@ enum class DemodulationMode {
     AM  ///< Amplitude Modulation demodulator
 };
 
+/**
+ * @enum FmDiscriminator
+ * @brief Accuracy tier of the FM phase discriminator.
+ *
+ * - Exact: scalar `std::atan2` per sample.
+ * - Fast:  vectorized polynomial atan2 approximation, absolute phase error
+ *          bounded by kFastAtan2MaxError.
+ * - Lut:   scalar table-driven atan2 (see lut_atan2()), for cores where the
+ *          SIMD kernels are unavailable and std::atan2 dominates.
+ */
+enum class FmDiscriminator {
+    Exact, ///< Reference std::atan2 discriminator
+    Fast,  ///< SIMD polynomial atan2 approximation
+    Lut    ///< Scalar lookup-table atan2 without a division
+};
+
+/// Maximum absolute error (radians) of fast_atan2() and FmDiscriminator::Fast.
+inline constexpr float kFastAtan2MaxError = 2e-5f;
+
+/// Maximum absolute error (radians) of lut_atan2() and FmDiscriminator::Lut.
+inline constexpr float kLutAtan2MaxError = 4e-6f;
+
+/**
+ * @brief Polynomial approximation of std::atan2.
+ *
+ * Reduces the argument to the first octant and evaluates a 9th order odd
+ * minimax polynomial; the absolute error is below kFastAtan2MaxError.
+ * This is the scalar reference of the SIMD discriminator kernels.
+ *
+ * @return Angle of (x, y) in radians, in [-pi, pi]. Returns 0 for (0, 0).
+ */
+float fast_atan2(float y, float x) noexcept;
+
+/**
+ * @brief Table-driven approximation of std::atan2.
+ *
+ * Reduces the argument to the first octant like fast_atan2(), but forms
+ * min/max without a division: the reciprocal of the larger magnitude
+ * comes from a table indexed by its top mantissa bits, refined by one
+ * Newton step and scaled by its exponent. The ratio then interpolates
+ * linearly in a table of atan(k / 256). Both tables are generated at
+ * compile time and take 2 KiB together, so they stay in L1 next to the
+ * sample blocks. The absolute error is below kLutAtan2MaxError.
+ *
+ * @return Angle of (x, y) in radians, in [-pi, pi]. Returns 0 for (0, 0)
+ *         and when both magnitudes are below FLT_MIN or above 2^126.
+ */
+float lut_atan2(float y, float x) noexcept;
+
 /**
  * @brief Stateful information required for continuous FM demodulation.
  *
@@ -54,6 +105,63 @@ struct AudioDecimState {
     int counter     = 0;
 };
 
+/**
+ * @brief Stateful accumulator for block-based IQ decimation.
+ *
+ * Holds the partial boxcar window left over when a block's pair count is not
+ * a multiple of the decimation, so successive blocks produce the same output
+ * as one contiguous stream.
+ */
+struct IqDecimState {
+    int32_t sum_i = 0; ///< Partial in-phase sum
+    int32_t sum_q = 0; ///< Partial quadrature sum
+    int     count = 0; ///< IQ pairs accumulated so far
+};
+
+/**
+ * @brief Phase accumulator of a numerically controlled oscillator (NCO).
+ *
+ * Kept in double precision so the oscillator phase stays exact over long
+ * runs; the SIMD mixer only ever rotates short runs from it in float.
+ */
+struct NcoState {
+    /// Oscillator phase in cycles, kept in [0, 1)
+    double phase = 0.0;
+};
+
+/**
+ * @brief Combined state of the fused IQ-to-audio FM chain.
+ *
+ * Holds both stateful stages of demodulate_fm_fused(), so one object carries
+ * a stream across blocks exactly as a DemodState / AudioDecimState pair does
+ * for the staged functions.
+ */
+struct FusedFmState {
+    IqDecimState iq;       ///< Partial IQ decimation window
+    DemodState demod;      ///< Discriminator history
+    AudioDecimState audio; ///< Partial audio decimation window
+};
+
+/**
+ * @name Span outputs
+ *
+ * Every block function comes in two forms. The `std::vector&` form sizes
+ * its output to fit, which may allocate while a vector still grows. The
+ * `std::span` form writes into caller-provided storage of at least the
+ * documented size and returns the number of samples written; it never
+ * allocates, so a chain built from preallocated buffers (see Arena) runs
+ * without heap traffic. A span that is too short throws
+ * std::invalid_argument before anything is written.
+ */
+
+/// @return Outputs of a decimator holding @p pending inputs when fed @p n more.
+constexpr std::size_t decimated_size(int pending, std::size_t n, int decimation) noexcept
+{
+    return decimation > 0
+        ? (static_cast<std::size_t>(pending) + n) / static_cast<std::size_t>(decimation)
+        : 0;
+}
+
 /**
  * @brief Downsample interleaved IQ samples using simple boxcar averaging.
  *
@@ -78,6 +186,66 @@ void downsample_iq(std::span<const int16_t> input,
                    std::vector<std::complex<float>>& output,
                    int decimation);
 
+/// downsample_iq() into @p output of at least `pairs / decimation` samples.
+std::size_t downsample_iq(std::span<const int16_t> input,
+                          std::span<std::complex<float>> output,
+                          int decimation);
+
+/**
+ * @brief Streaming variant of downsample_iq().
+ *
+ * Pairs that do not complete a decimation window are kept in @p state and
+ * summed into the first output of the next call, so block sizes need not be
+ * multiples of @p decimation.
+ *
+ * @param input         Interleaved I/Q input samples as a span of int16_t.
+ * @param output        Vector to store downsampled complex<float> IQ samples.
+ * @param decimation    Number of IQ pairs to combine into one output sample.
+ * @param state         Partial window carried between blocks.
+ *
+ * @note Output vector is cleared and resized appropriately.
+ */
+void downsample_iq(std::span<const int16_t> input,
+                   std::vector<std::complex<float>>& output,
+                   int decimation,
+                   IqDecimState& state);
+
+/// Streaming downsample_iq() into @p output of at least
+/// `decimated_size(state.count, pairs, decimation)` samples.
+std::size_t downsample_iq(std::span<const int16_t> input,
+                          std::span<std::complex<float>> output,
+                          int decimation,
+                          IqDecimState& state);
+
+/**
+ * @brief Frequency-shift interleaved IQ samples with an NCO.
+ *
+ * Computes:
+ * @f[
+ *     y[n] = x[n] \cdot e^{j 2 \pi (\phi + f n)}
+ * @f]
+ *
+ * Used to move a station at offset +f from the capture centre to DC by
+ * passing `frequency = -f / sample_rate`.
+ *
+ * @param input      Interleaved I/Q input samples as a span of int16_t.
+ * @param output     Vector to store shifted complex<float> samples.
+ * @param frequency  Shift in cycles per sample.
+ * @param state      NCO phase carried between blocks.
+ *
+ * @note Output vector is resized to the number of IQ pairs.
+ */
+void mix_iq(std::span<const int16_t> input,
+            std::vector<std::complex<float>>& output,
+            double frequency,
+            NcoState& state);
+
+/// mix_iq() into @p output of at least one sample per IQ pair.
+std::size_t mix_iq(std::span<const int16_t> input,
+                   std::span<std::complex<float>> output,
+                   double frequency,
+                   NcoState& state);
+
 /**
  * @brief Perform FM demodulation (phase differencing) on complex IQ data.
  *
@@ -93,12 +261,20 @@ void downsample_iq(std::span<const int16_t> input,
  * @param out       Vector to receive demodulated floating point samples.
  * @param state     DemodState containing the previous IQ sample needed
  *                  for continuous phase demodulation across block boundaries.
+ * @param accuracy  Discriminator tier (exact std::atan2 or SIMD approximation).
  *
  * @note Output vector is resized to match input size.
  */
 void demodulate_fm(std::span<const std::complex<float>> in,
                 std::vector<float>& out,
-                DemodState& state);
+                DemodState& state,
+                FmDiscriminator accuracy = FmDiscriminator::Exact);
+
+/// demodulate_fm() into @p out of at least `in.size()` samples.
+std::size_t demodulate_fm(std::span<const std::complex<float>> in,
+                          std::span<float> out,
+                          DemodState& state,
+                          FmDiscriminator accuracy = FmDiscriminator::Exact);
 
 /**
  * @brief Demodulates AM (Amplitude Modulated) IQ samples using envelope detection.
@@ -111,12 +287,120 @@ void demodulate_fm(std::span<const std::complex<float>> in,
  * @param in   Input span of complex IQ samples at baseband.
  * @param out  Vector that receives the AM-demodulated audio samples.
  *
- * The output vector is cleared before new samples are appended.
+ * @note Output vector is resized once to match input size; the kernel then
+ *       writes in place.
  * @note No state is required for AM, so this function is stateless.
  */
 void demodulate_am(std::span<const std::complex<float>> in,
                    std::vector<float>& out);
 
+/// demodulate_am() into @p out of at least `in.size()` samples.
+std::size_t demodulate_am(std::span<const std::complex<float>> in,
+                          std::span<float> out);
+
+/**
+ * @brief Carrier level tracked by remove_carrier() across blocks.
+ */
+struct AmCarrierState {
+    /// Smoothed envelope (0 = not yet seen a sample)
+    float carrier = 0.0f;
+};
+
+/**
+ * @brief Turn an AM envelope into modulation audio, in place.
+ *
+ * Tracks the carrier with a one-pole low-pass and replaces each sample by
+ * its modulation relative to it:
+ * \f[
+ *     c[n] = c[n-1] + \alpha (x[n] - c[n-1]), \qquad
+ *     y[n] = x[n] / c[n] - 1
+ * \f]
+ *
+ * The result is independent of the signal level and of any gain earlier in
+ * the chain; 100 % modulation spans [-1, 1].
+ *
+ * @param envelope  Envelope samples (see demodulate_am()), overwritten.
+ * @param state     Carrier level, seeded from the first sample.
+ * @param alpha     Low-pass coefficient, about 2*pi*f_c/f_s.
+ */
+void remove_carrier(std::span<float> envelope, AmCarrierState& state, float alpha);
+
+/**
+ * @brief Output of deemphasis() carried across blocks.
+ */
+struct DeemphasisState {
+    float y = 0.0f; ///< Last filter output
+};
+
+/**
+ * @brief Coefficient of deemphasis() for a time constant.
+ *
+ * Matches the pole of the analogue RC network: \f$ \alpha = 1 - e^{-1/(\tau f_s)} \f$.
+ *
+ * @param tau_us   Time constant in microseconds (50 Europe, 75 Americas)
+ * @param rate_hz  Sample rate of the audio it filters
+ */
+float deemphasis_alpha(float tau_us, float rate_hz) noexcept;
+
+/**
+ * @brief Broadcast FM de-emphasis, in place.
+ *
+ * First-order low-pass undoing the transmitter's pre-emphasis:
+ * \f[
+ *     y[n] = y[n-1] + \alpha (x[n] - y[n-1])
+ * \f]
+ * Unity gain at DC, -3 dB at \f$ 1 / (2 \pi \tau) \f$ (3.2 kHz for 50 us).
+ *
+ * @param audio  Mono (or one channel of) audio, overwritten
+ * @param alpha  See deemphasis_alpha()
+ */
+void deemphasis(std::span<float> audio, float alpha, DeemphasisState& state);
+
+/**
+ * @brief Mean power of raw interleaved int16 IQ, relative to full scale.
+ *
+ * \f[
+ *     P = \frac{1}{N} \sum_n \frac{I[n]^2 + Q[n]^2}{32768^2}
+ * \f]
+ *
+ * A full-scale complex tone reads 1.0 (0 dBFS).
+ *
+ * @return Mean power; 0 for an empty span
+ */
+float mean_power(std::span<const int16_t> iq);
+
+/**
+ * @brief Mean power of a complex baseband block, relative to @p full_scale.
+ *
+ * Cheap SIMD estimate for gating decisions (see squelch()):
+ * mean |x[n]|^2 / full_scale^2.
+ *
+ * @param full_scale  Magnitude of a full-scale sample at this point of the
+ *                    chain (e.g. 32768 * decimation after boxcar IQ sums)
+ * @return Mean power; 0 for an empty span
+ */
+float mean_power(std::span<const std::complex<float>> iq, float full_scale);
+
+/// @return @p power in dB relative to full scale, floored at -200 dBFS.
+float power_dbfs(float power) noexcept;
+
+/// Open/closed state of a squelch gate.
+struct SquelchState {
+    bool open = false; ///< Audio currently passes
+};
+
+/**
+ * @brief Squelch gate with hysteresis.
+ *
+ * Opens once the block level reaches @p open_dbfs and closes only when it
+ * drops below `open_dbfs - hysteresis_db`, so a signal hovering around the
+ * threshold does not chop the audio block by block.
+ *
+ * @return true if the block should be demodulated
+ */
+bool squelch(float level_dbfs, float open_dbfs, float hysteresis_db,
+             SquelchState& state) noexcept;
+
 /**
  * @brief Downsample audio via simple decimation averaging.
  *
@@ -141,4 +425,128 @@ void downsample_audio(std::span<const float> input,
                       AudioDecimState& state,
                       float gain = 1.0f);
 
+/// downsample_audio() into @p output of at least
+/// `decimated_size(state.counter, input.size(), decimation)` samples.
+std::size_t downsample_audio(std::span<const float> input,
+                             std::span<float> output,
+                             int decimation,
+                             AudioDecimState& state,
+                             float gain = 1.0f);
+
+/// Scale mapping float audio in [-1, 1] onto the full s16 range.
+inline constexpr float kS16FullScale = 32767.0f;
+
+/**
+ * @brief Convert float audio to 16-bit PCM with saturation.
+ *
+ * @code
+ *   y[n] = clamp(round(x[n] * gain * kS16FullScale), -32768, 32767)
+ * @endcode
+ *
+ * Rounds to nearest (ties to even); out-of-range samples clip instead of
+ * wrapping.
+ *
+ * @note Output vector is resized to the input size.
+ */
+void float_to_s16(std::span<const float> input,
+                  std::vector<int16_t>& output,
+                  float gain = 1.0f);
+
+/// float_to_s16() into @p output of at least `input.size()` samples.
+std::size_t float_to_s16(std::span<const float> input,
+                         std::span<int16_t> output,
+                         float gain = 1.0f);
+
+/**
+ * @brief downsample_audio() straight to 16-bit PCM.
+ *
+ * Same decimation as the float overload, with the s16 scale folded into the
+ * boxcar gain and the saturating conversion run on each cache-resident
+ * chunk, so no block-sized float intermediate is written.
+ *
+ * @note Output vector is resized to the number of samples produced.
+ */
+void downsample_audio(std::span<const float> input,
+                      std::vector<int16_t>& output,
+                      int decimation,
+                      AudioDecimState& state,
+                      float gain = 1.0f);
+
+/// PCM downsample_audio() into @p output, sized as for the float version.
+std::size_t downsample_audio(std::span<const float> input,
+                             std::span<int16_t> output,
+                             int decimation,
+                             AudioDecimState& state,
+                             float gain = 1.0f);
+
+/**
+ * @brief Raw IQ to decimated FM audio in one cache-resident pass.
+ *
+ * Equivalent to downsample_iq() -> demodulate_fm() -> downsample_audio(),
+ * but the input is strip-mined into chunks small enough that the IQ and
+ * discriminator intermediates stay in L1 between stages instead of being
+ * written out as block-sized vectors. Every stage still runs on the
+ * runtime-selected SIMD kernel.
+ *
+ * @param input             Interleaved int16 I/Q samples.
+ * @param output            Decimated audio samples.
+ * @param iq_decimation     IQ pairs per complex sample (as downsample_iq()).
+ * @param audio_decimation  Discriminator samples per audio sample.
+ * @param state             Discriminator and audio decimation state.
+ * @param gain              Gain applied to output audio.
+ * @param accuracy          Discriminator tier.
+ *
+ * @note Partial IQ and audio windows are carried in @p state.
+ * @note Output vector is resized to the number of samples produced.
+ */
+void demodulate_fm_fused(std::span<const int16_t> input,
+                         std::vector<float>& output,
+                         int iq_decimation,
+                         int audio_decimation,
+                         FusedFmState& state,
+                         float gain = 1.0f,
+                         FmDiscriminator accuracy = FmDiscriminator::Exact);
+
+/**
+ * @brief demodulate_fm_fused() ending in saturated 16-bit PCM
+ *        (see float_to_s16()).
+ */
+void demodulate_fm_fused(std::span<const int16_t> input,
+                         std::vector<int16_t>& output,
+                         int iq_decimation,
+                         int audio_decimation,
+                         FusedFmState& state,
+                         float gain = 1.0f,
+                         FmDiscriminator accuracy = FmDiscriminator::Exact);
+
+/// @return Audio samples demodulate_fm_fused() produces for @p pairs from @p state.
+std::size_t fused_fm_size(std::size_t pairs, int iq_decimation, int audio_decimation,
+                          const FusedFmState& state) noexcept;
+
+/**
+ * @brief demodulate_fm_fused() into @p output of at least fused_fm_size() samples.
+ *
+ * @param iq_power  If set, receives the mean power of the decimated IQ
+ *                  relative to int16 full scale, as mean_power() of the
+ *                  downsample_iq() output would report it (0 without output)
+ */
+std::size_t demodulate_fm_fused(std::span<const int16_t> input,
+                                std::span<float> output,
+                                int iq_decimation,
+                                int audio_decimation,
+                                FusedFmState& state,
+                                float gain = 1.0f,
+                                FmDiscriminator accuracy = FmDiscriminator::Exact,
+                                float* iq_power = nullptr);
+
+/// PCM demodulate_fm_fused() into @p output of at least fused_fm_size() samples.
+std::size_t demodulate_fm_fused(std::span<const int16_t> input,
+                                std::span<int16_t> output,
+                                int iq_decimation,
+                                int audio_decimation,
+                                FusedFmState& state,
+                                float gain = 1.0f,
+                                FmDiscriminator accuracy = FmDiscriminator::Exact,
+                                float* iq_power = nullptr);
+
 } // namespace dsp
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "dsp.hpp"
+
+/**
+ * @file dsp_detail.hpp
+ * @brief Helpers shared by the float (dsp.cpp) and Q15 (fixed_point.cpp) chains.
+ */
+
+namespace dsp::detail {
+
+/// Reject a caller-provided output span shorter than @p needed samples.
+inline void require_output(std::size_t have, std::size_t needed, const char* fn)
+{
+    if (have < needed)
+        throw std::invalid_argument(std::string(fn) + ": output span too small");
+}
+
+/// Add `pairs` IQ pairs to the open window (pairs < decim - state.count)
+inline void accumulate_iq(const int16_t* in, std::size_t pairs, IqDecimState& state) noexcept
+{
+    for (std::size_t k = 0; k < pairs; k++) {
+        state.sum_i += in[2 * k];
+        state.sum_q += in[2 * k + 1];
+    }
+    state.count += static_cast<int>(pairs);
+}
+
+/**
+ * Stateful boxcar over raw pointers: completes the window left open by the
+ * previous block, runs a SIMD kernel over whole windows and keeps the tail.
+ *
+ * @param close   `close(state)` writes the completed window as output 0
+ * @param kernel  `kernel(in, pairs, first)` writes whole windows from output
+ *                `first` on and returns their number
+ * @return Number of outputs written, at most `(state.count + pairs) / decim`
+ */
+template <typename Close, typename Kernel>
+std::size_t downsample_iq_stream(const int16_t* in, std::size_t pairs, int decim,
+                                 IqDecimState& state, Close&& close, Kernel&& kernel)
+{
+    const std::size_t d = static_cast<std::size_t>(decim);
+    std::size_t written = 0;
+
+    if (state.count > 0) {
+        const std::size_t need = std::min(pairs, d - static_cast<std::size_t>(state.count));
+        accumulate_iq(in, need, state);
+        in += 2 * need;
+        pairs -= need;
+
+        if (static_cast<std::size_t>(state.count) < d)
+            return 0;
+
+        close(state);
+        written = 1;
+        state = {};
+    }
+
+    const std::size_t blocks = kernel(in, pairs, written);
+    written += blocks;
+
+    accumulate_iq(in + 2 * blocks * d, pairs - blocks * d, state);
+    return written;
+}
+
+} // namespace dsp::detail
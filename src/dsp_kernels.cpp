@@ -0,0 +1,92 @@
+#include "dsp_kernels.hpp"
+#include "cpu_features.hpp"
+
+namespace dsp {
+
+namespace {
+
+constexpr Isa kPreferenceOrder[] = {
+    Isa::Scalar, Isa::Neon, Isa::Sse41, Isa::Avx2, Isa::Avx512
+};
+
+template <typename Fn>
+void override_with(Kernel<Fn>& dst, const Kernel<Fn>& src) noexcept
+{
+    if (src) dst = src;
+}
+
+KernelTable resolve() noexcept
+{
+    KernelTable best = detail::scalar_kernels();
+
+    for (Isa isa : kPreferenceOrder) {
+        if (!isa_supported(isa)) continue;
+
+        const KernelTable t = kernels_for(isa);
+        override_with(best.downsample_iq,    t.downsample_iq);
+        override_with(best.demodulate_fm,    t.demodulate_fm);
+        override_with(best.demodulate_am,    t.demodulate_am);
+        override_with(best.downsample_audio, t.downsample_audio);
+        override_with(best.fir_decimate,     t.fir_decimate);
+        override_with(best.fir_decimate_cf,  t.fir_decimate_cf);
+        override_with(best.mix_iq,           t.mix_iq);
+        override_with(best.fft_pass,         t.fft_pass);
+        override_with(best.float_to_s16,     t.float_to_s16);
+        override_with(best.power_cf,         t.power_cf);
+        override_with(best.pilot_mix,        t.pilot_mix);
+        override_with(best.deemphasis,       t.deemphasis);
+        override_with(best.downsample_iq_q15,    t.downsample_iq_q15);
+        override_with(best.demodulate_fm_q15,    t.demodulate_fm_q15);
+        override_with(best.downsample_audio_q15, t.downsample_audio_q15);
+    }
+
+    return best;
+}
+
+} // namespace
+
+const char* isa_name(Isa isa) noexcept
+{
+    switch (isa) {
+    case Isa::Scalar: return "scalar";
+    case Isa::Neon:   return "neon";
+    case Isa::Sse41:  return "sse4.1";
+    case Isa::Avx2:   return "avx2";
+    case Isa::Avx512: return "avx512";
+    }
+    return "unknown";
+}
+
+bool isa_supported(Isa isa) noexcept
+{
+    const CpuFeatures& f = cpu_features();
+
+    switch (isa) {
+    case Isa::Scalar: return true;
+    case Isa::Neon:   return f.neon;
+    case Isa::Sse41:  return f.sse41;
+    case Isa::Avx2:   return f.avx2;
+    case Isa::Avx512: return f.avx512;
+    }
+    return false;
+}
+
+KernelTable kernels_for(Isa isa) noexcept
+{
+    switch (isa) {
+    case Isa::Scalar: return detail::scalar_kernels();
+    case Isa::Neon:   return detail::neon_kernels();
+    case Isa::Sse41:  return detail::sse41_kernels();
+    case Isa::Avx2:   return detail::avx2_kernels();
+    case Isa::Avx512: return detail::avx512_kernels();
+    }
+    return {};
+}
+
+const KernelTable& kernels() noexcept
+{
+    static const KernelTable table = resolve();
+    return table;
+}
+
+} // namespace dsp
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+
+#include "dsp.hpp"
+#include "fixed_point.hpp"
+
+/**
+ * @file dsp_kernels.hpp
+ * @brief Runtime-dispatched SIMD kernel registry behind the dsp:: API.
+ *
+ * Every hot loop of the DSP chain exists as one raw-pointer kernel per
+ * instruction set. At startup the registry checks the CPU (cpu_features())
+ * and binds each entry point to the best available implementation, so the
+ * same binary runs the AVX2 path on a modern x86 host and the scalar path on
+ * an older one.
+ */
+
+namespace dsp {
+
+/// Instruction set a kernel was written for, in ascending preference.
+enum class Isa {
+    Scalar, ///< Portable C++
+    Neon,   ///< ARM Advanced SIMD
+    Sse41,  ///< x86 SSE4.1
+    Avx2,   ///< x86 AVX2
+    Avx512  ///< x86 AVX-512F
+};
+
+/// @return Short lowercase name of an instruction set ("avx2", "neon", ...).
+const char* isa_name(Isa isa) noexcept;
+
+/// @return true if kernels for @p isa can run on this CPU.
+bool isa_supported(Isa isa) noexcept;
+
+/**
+ * @brief Sum `decim` consecutive IQ pairs into one complex sample.
+ * @param in     Interleaved int16 I/Q, `pairs` pairs long
+ * @param out    Room for `pairs / decim` samples
+ * @return Number of samples written; a trailing partial window is ignored
+ */
+using DownsampleIqFn = std::size_t (*)(const int16_t* in, std::size_t pairs,
+                                       int decim, std::complex<float>* out);
+
+/**
+ * @brief Fast-tier FM discriminator: out[i] = arg(in[i] * conj(in[i-1])).
+ * @param prev   Sample preceding in[0] (last sample of the previous block)
+ */
+using DemodulateFmFn = void (*)(const std::complex<float>* in, std::size_t n,
+                                std::complex<float> prev, float* out);
+
+/// Envelope detector: out[i] = |in[i]|.
+using DemodulateAmFn = void (*)(const std::complex<float>* in, std::size_t n,
+                                float* out);
+
+/**
+ * @brief Streaming boxcar decimator: out[j] = scale * sum of `decim` inputs.
+ * @param out    Room for `(state.counter + n) / decim` samples
+ * @return Number of samples written; the partial window is kept in @p state
+ */
+using DownsampleAudioFn = std::size_t (*)(const float* in, std::size_t n,
+                                          int decim, float scale,
+                                          AudioDecimState& state, float* out);
+
+/**
+ * @brief Decimating real FIR: out[m] = sum_j taps[j] * x[m * step + j].
+ * @param ntaps  Number of taps; must be a multiple of kFirTapAlign
+ */
+using FirDecimateFn = void (*)(const float* x, std::size_t n_out,
+                               std::size_t step, const float* taps,
+                               std::size_t ntaps, float* out);
+
+/**
+ * @brief Decimating complex FIR with real taps.
+ *
+ * out[m] = sum_j taps[j] * x[m * step + j], where @p taps2 holds every tap
+ * twice ({h0, h0, h1, h1, ...}) so it lines up with interleaved I/Q.
+ *
+ * @param ntaps  Number of (real) taps; must be a multiple of kFirTapAlign
+ */
+using FirDecimateCfFn = void (*)(const std::complex<float>* x, std::size_t n_out,
+                                 std::size_t step, const float* taps2,
+                                 std::size_t ntaps, std::complex<float>* out);
+
+/**
+ * @brief NCO mixer: out[i] = in[i] * phase * step^i.
+ *
+ * Widens interleaved int16 I/Q to complex float while rotating it by a
+ * unit phasor that advances by @p step per sample. Callers keep runs short
+ * (see mix_iq()) so the float phasor recurrence does not drift.
+ */
+using MixIqFn = void (*)(const int16_t* in, std::size_t pairs,
+                         std::complex<float> phase, std::complex<float> step,
+                         std::complex<float>* out);
+
+/**
+ * @brief One radix-2 decimation-in-time FFT stage, in place.
+ *
+ * For every group of `2 * half` samples: b' = b * twiddles[k];
+ * a, b = a + b', a - b'. @p twiddles holds the `half` factors of the stage.
+ *
+ * @param n  Transform size (multiple of `2 * half`)
+ */
+using FftPassFn = void (*)(std::complex<float>* data, std::size_t n,
+                           std::size_t half, const std::complex<float>* twiddles);
+
+/**
+ * @brief Saturating float to int16 conversion.
+ *
+ * out[i] = clamp(round(in[i] * scale), -32768, 32767), rounding to nearest
+ * with ties to even. The result for NaN input is unspecified.
+ */
+using ConvertS16Fn = void (*)(const float* in, std::size_t n, float scale,
+                              int16_t* out);
+
+/// Block power: returns sum |in[i]|^2.
+using PowerCfFn = float (*)(const std::complex<float>* in, std::size_t n);
+
+/**
+ * @brief Pilot correlator and 38 kHz demodulator of the stereo decoder.
+ *
+ * With p[i] = phase * step^i (p = cos + j sin of the pilot reference):
+ *
+ *     sum[i]  = mpx[i] - pilot * Im(p[i])            (pilot cancelled)
+ *     diff[i] = diff_gain * sum[i] * Re(p[i]) * Im(p[i])
+ *
+ * and returns sum mpx[i] * p[i], whose argument is the phase error of the
+ * reference. As with MixIqFn, callers keep runs short.
+ */
+using PilotMixFn = std::complex<float> (*)(const float* mpx, std::size_t n,
+                                           std::complex<float> phase,
+                                           std::complex<float> step,
+                                           float pilot, float diff_gain,
+                                           float* sum, float* diff);
+
+/**
+ * @brief One-pole low-pass in place: y[i] = y[i-1] + a * (x[i] - y[i-1]).
+ * @param y  Output preceding data[0]
+ * @return Last output, to seed the next call
+ */
+using DeemphasisFn = float (*)(float* data, std::size_t n, float a, float y);
+
+/**
+ * @brief Fixed-point boxcar: sum `decim` IQ pairs, shift right, saturate.
+ *
+ * out[b] = clamp(sum >> shift, -kQ15Max, kQ15Max) per component, with the
+ * sums formed in int32 and the shift arithmetic.
+ *
+ * @param out  Interleaved, room for `pairs / decim` pairs
+ * @return Number of pairs written; a trailing partial window is ignored
+ */
+using DownsampleIqQ15Fn = std::size_t (*)(const int16_t* in, std::size_t pairs,
+                                          int decim, int shift, int16_t* out);
+
+/**
+ * @brief Fixed-point FM discriminator (see demodulate_fm_q15()).
+ * @param in              Interleaved Q15 I/Q, components within +-kQ15Max
+ * @param prev_i, prev_q  Pair preceding in[0]
+ */
+using DemodulateFmQ15Fn = void (*)(const int16_t* in, std::size_t n,
+                                   int16_t prev_i, int16_t prev_q, int16_t* out);
+
+/**
+ * @brief Streaming fixed-point boxcar: out[j] = gain applied to the sum of
+ *        `decim` inputs (see FixedGain), saturated to int16.
+ * @return Number of samples written; the partial window is kept in @p state
+ */
+using DownsampleAudioQ15Fn = std::size_t (*)(const int16_t* in, std::size_t n,
+                                             int decim, FixedGain gain,
+                                             AudioDecimStateQ15& state, int16_t* out);
+
+/// Tap counts passed to FIR kernels are padded to this multiple.
+inline constexpr std::size_t kFirTapAlign = 8;
+
+/// One kernel entry point and the instruction set it was built for.
+template <typename Fn>
+struct Kernel {
+    Fn  fn  = nullptr;
+    Isa isa = Isa::Scalar;
+
+    explicit operator bool() const noexcept { return fn != nullptr; }
+};
+
+/// Set of DSP kernels; entries may be empty when an ISA has no variant.
+struct KernelTable {
+    Kernel<DownsampleIqFn>    downsample_iq;
+    Kernel<DemodulateFmFn>    demodulate_fm;
+    Kernel<DemodulateAmFn>    demodulate_am;
+    Kernel<DownsampleAudioFn> downsample_audio;
+    Kernel<FirDecimateFn>     fir_decimate;
+    Kernel<FirDecimateCfFn>   fir_decimate_cf;
+    Kernel<MixIqFn>           mix_iq;
+    Kernel<FftPassFn>         fft_pass;
+    Kernel<ConvertS16Fn>      float_to_s16;
+    Kernel<PowerCfFn>         power_cf;
+    Kernel<PilotMixFn>        pilot_mix;
+    Kernel<DeemphasisFn>      deemphasis;
+    Kernel<DownsampleIqQ15Fn>    downsample_iq_q15;
+    Kernel<DemodulateFmQ15Fn>    demodulate_fm_q15;
+    Kernel<DownsampleAudioQ15Fn> downsample_audio_q15;
+};
+
+/**
+ * @brief Kernels bound for this CPU.
+ *
+ * Resolved on first use: starting from the scalar table, every supported
+ * instruction set, in ascending preference, overrides the entries it
+ * implements.
+ */
+const KernelTable& kernels() noexcept;
+
+/**
+ * @brief Kernels compiled for one instruction set.
+ *
+ * Entries the ISA does not implement (or that were not compiled in for this
+ * architecture) are empty. Callers must check isa_supported() before
+ * invoking them; used by tests to validate each variant against scalar.
+ */
+KernelTable kernels_for(Isa isa) noexcept;
+
+namespace detail {
+
+// Per-ISA tables, defined in dsp.cpp, dsp_neon.cpp and dsp_x86.cpp
+KernelTable scalar_kernels() noexcept;
+KernelTable neon_kernels() noexcept;
+KernelTable sse41_kernels() noexcept;
+KernelTable avx2_kernels() noexcept;
+KernelTable avx512_kernels() noexcept;
+
+// atan(z) on [0, 1] as z * P(z^2) (Abramowitz & Stegun 4.4.49, |err| < 1e-5)
+inline constexpr float kAtanC1 =  0.9998660f;
+inline constexpr float kAtanC3 = -0.3302995f;
+inline constexpr float kAtanC5 =  0.1801410f;
+inline constexpr float kAtanC7 = -0.0851330f;
+inline constexpr float kAtanC9 =  0.0208351f;
+
+inline constexpr float kPi     = 3.14159265358979323846f;
+inline constexpr float kHalfPi = kPi / 2.0f;
+
+// CORDIC rotation angles atan(2^-k) in Q31 half-turns (2^31 = pi)
+inline constexpr std::array<int32_t, kCordicSteps> kCordicAtan{
+    536870912, 316933406, 167458907, 85004756, 42667331, 21354465, 10679838,
+    5340245, 2670163, 1335087, 667544, 333772, 166886, 83443, 41722,
+};
+
+/**
+ * @brief Left shift (plus a fixed >> 2) that normalises a CORDIC input.
+ *
+ * @p m is |x| | |y|, below 2^31. The shift moves its top bit to 30, or
+ * 23 bits up if it is below 2^7; the >> 2 then leaves it at 28. Seven
+ * bits are dropped first so the count is exact in a float exponent too,
+ * which is how the x86 kernels, lacking a vector lzcnt, compute it.
+ */
+constexpr int cordic_norm_shift(uint32_t m) noexcept
+{
+    return 24 - std::bit_width((m >> 7) | 1u);
+}
+
+/// @return @p v clamped to the symmetric Q15 range of the IQ stage.
+constexpr int16_t saturate_q15(int32_t v) noexcept
+{
+    return static_cast<int16_t>(v < -kQ15Max ? -kQ15Max : v > kQ15Max ? kQ15Max : v);
+}
+
+/// @return A window sum of the Q15 audio decimator scaled by @p g, as PCM.
+constexpr int16_t apply_gain_q15(int32_t sum, FixedGain g) noexcept
+{
+    const int32_t v = ((sum >> g.pre_shift) * g.mul + (1 << (g.shift - 1))) >> g.shift;
+    return static_cast<int16_t>(v < -32768 ? -32768 : v > 32767 ? 32767 : v);
+}
+
+} // namespace detail
+
+} // namespace dsp
@@ -0,0 +1,720 @@
+#include "dsp_kernels.hpp"
+
+/**
+ * @file dsp_neon.cpp
+ * @brief ARM NEON DSP kernels.
+ *
+ * This is the only translation unit built with NEON code generation flags
+ * (see Makefile), so the rest of the binary stays runnable on ARM cores
+ * without Advanced SIMD. On other architectures it provides an empty table.
+ */
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+#include <arm_neon.h>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+
+namespace dsp {
+
+using detail::kCordicAtan;
+using detail::kAtanC1;
+using detail::kAtanC3;
+using detail::kAtanC5;
+using detail::kAtanC7;
+using detail::kAtanC9;
+using detail::kHalfPi;
+using detail::kPi;
+
+namespace {
+
+inline int32_t horizontal_sum_8(int16x8_t v) {
+    // Widen to int32 to prevent overflow during accumulation
+    int32x4_t low32 = vmovl_s16(vget_low_s16(v));
+    int32x4_t high32 = vmovl_s16(vget_high_s16(v));
+
+    // Sum the two halves
+    int32x4_t sum4 = vaddq_s32(low32, high32);
+
+    // Horizontal add to get final sum
+    int32x2_t sum2 = vadd_s32(vget_low_s32(sum4), vget_high_s32(sum4));
+    int32x2_t sum1 = vpadd_s32(sum2, sum2);
+
+    return vget_lane_s32(sum1, 0);
+}
+
+inline float32x4_t fast_atan2_neon(float32x4_t y, float32x4_t x)
+{
+    const float32x4_t ax = vabsq_f32(x);
+    const float32x4_t ay = vabsq_f32(y);
+    const float32x4_t mn = vminq_f32(ax, ay);
+    const float32x4_t mx = vmaxq_f32(vmaxq_f32(ax, ay), vdupq_n_f32(FLT_MIN));
+
+#if defined(__aarch64__)
+    const float32x4_t a = vdivq_f32(mn, mx);
+#else
+    // ARMv7 has no vector divide: reciprocal estimate + two Newton steps
+    float32x4_t inv = vrecpeq_f32(mx);
+    inv = vmulq_f32(vrecpsq_f32(mx, inv), inv);
+    inv = vmulq_f32(vrecpsq_f32(mx, inv), inv);
+    const float32x4_t a = vmulq_f32(mn, inv);
+#endif
+    const float32x4_t z = vmulq_f32(a, a);
+
+    float32x4_t r = vmlaq_f32(vdupq_n_f32(kAtanC7), vdupq_n_f32(kAtanC9), z);
+    r = vmlaq_f32(vdupq_n_f32(kAtanC5), r, z);
+    r = vmlaq_f32(vdupq_n_f32(kAtanC3), r, z);
+    r = vmlaq_f32(vdupq_n_f32(kAtanC1), r, z);
+    r = vmulq_f32(r, a);
+
+    r = vbslq_f32(vcgtq_f32(ay, ax), vsubq_f32(vdupq_n_f32(kHalfPi), r), r);
+    r = vbslq_f32(vcltq_f32(x, vdupq_n_f32(0.0f)), vsubq_f32(vdupq_n_f32(kPi), r), r);
+
+    // Copy the sign of y
+    const uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(y), vdupq_n_u32(0x80000000u));
+    return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(r), sign));
+}
+
+/// Window sums of downsample_iq_neon() and downsample_iq_q15_neon(), handed to
+/// @p store as store(b, sum_i, sum_q); D > 0 compiles the window length in.
+template <int D, typename Store>
+inline std::size_t downsample_iq_neon_impl(const int16_t* in, std::size_t pairs,
+                                           int decim, Store store)
+{
+    const int d = D > 0 ? D : decim;
+    const std::size_t blocks = pairs / static_cast<std::size_t>(d);
+
+    for (std::size_t b = 0; b < blocks; b++) {
+        int32_t si = 0, sq = 0;
+
+        // Process 8 pairs at a time using NEON
+        int pairs_remaining = d;
+        const int16_t* block_ptr = in;
+
+        while (pairs_remaining >= 8) {
+            int16x8x2_t iq = vld2q_s16(block_ptr);
+            si += horizontal_sum_8(iq.val[0]);
+            sq += horizontal_sum_8(iq.val[1]);
+            block_ptr += 16;  // 8 pairs = 16 int16 values
+            pairs_remaining -= 8;
+        }
+
+        // Handle remaining pairs with scalar code
+        for (int i = 0; i < pairs_remaining; i++) {
+            si += block_ptr[i * 2];
+            sq += block_ptr[i * 2 + 1];
+        }
+
+        store(b, si, sq);
+        in += d * 2;
+    }
+
+    return blocks;
+}
+
+std::size_t downsample_iq_neon(const int16_t* in, std::size_t pairs,
+                               int decim, std::complex<float>* out)
+{
+    const auto store = [out](std::size_t b, int32_t si, int32_t sq) {
+        out[b] = {static_cast<float>(si), static_cast<float>(sq)};
+    };
+
+    switch (decim) {
+    case 8:  return downsample_iq_neon_impl<8>(in, pairs, decim, store);
+    case 10: return downsample_iq_neon_impl<10>(in, pairs, decim, store);
+    case 16: return downsample_iq_neon_impl<16>(in, pairs, decim, store);
+    default: return downsample_iq_neon_impl<0>(in, pairs, decim, store);
+    }
+}
+
+std::size_t downsample_iq_q15_neon(const int16_t* in, std::size_t pairs,
+                                   int decim, int shift, int16_t* out)
+{
+    const auto store = [out, shift](std::size_t b, int32_t si, int32_t sq) {
+        out[2 * b]     = detail::saturate_q15(si >> shift);
+        out[2 * b + 1] = detail::saturate_q15(sq >> shift);
+    };
+
+    switch (decim) {
+    case 8:  return downsample_iq_neon_impl<8>(in, pairs, decim, store);
+    case 10: return downsample_iq_neon_impl<10>(in, pairs, decim, store);
+    case 16: return downsample_iq_neon_impl<16>(in, pairs, decim, store);
+    default: return downsample_iq_neon_impl<0>(in, pairs, decim, store);
+    }
+}
+
+void demodulate_fm_neon(const std::complex<float>* in, std::size_t n,
+                        std::complex<float> prev, float* out)
+{
+    if (n == 0) return;
+
+    const auto first = in[0] * std::conj(prev);
+    out[0] = fast_atan2(first.imag(), first.real());
+
+    const float* p = reinterpret_cast<const float*>(in);
+    std::size_t i = 1;
+
+    for (; i + 4 <= n; i += 4) {
+        const float32x4x2_t cur  = vld2q_f32(p + 2 * i);
+        const float32x4x2_t prv  = vld2q_f32(p + 2 * (i - 1));
+
+        // cur * conj(prev)
+        const float32x4_t re = vmlaq_f32(vmulq_f32(cur.val[0], prv.val[0]),
+                                         cur.val[1], prv.val[1]);
+        const float32x4_t im = vmlsq_f32(vmulq_f32(cur.val[1], prv.val[0]),
+                                         cur.val[0], prv.val[1]);
+
+        vst1q_f32(out + i, fast_atan2_neon(im, re));
+    }
+
+    for (; i < n; i++) {
+        const auto prod = in[i] * std::conj(in[i - 1]);
+        out[i] = fast_atan2(prod.imag(), prod.real());
+    }
+}
+
+void demodulate_am_neon(const std::complex<float>* in, std::size_t n,
+                        float* out)
+{
+    const float* ptr = reinterpret_cast<const float*>(in);
+    std::size_t i = 0;
+
+    // Process 4 complex samples (8 floats) at a time
+    for (; i + 4 <= n; i += 4) {
+        float32x4x2_t iq = vld2q_f32(ptr);  // loads I=iq.val[0], Q=iq.val[1]
+
+        float32x4_t i2 = vmulq_f32(iq.val[0], iq.val[0]);
+        float32x4_t q2 = vmulq_f32(iq.val[1], iq.val[1]);
+
+        float32x4_t sum = vaddq_f32(i2, q2);
+#if defined(__aarch64__)
+        float32x4_t mag = vsqrtq_f32(sum);
+#else
+        // ARMv7: sqrt(x) = x * rsqrt(x); the 8-bit estimate needs two
+        // Newton steps for float precision. Zero stays zero
+        float32x4_t rs = vrsqrteq_f32(sum);
+        rs = vmulq_f32(vrsqrtsq_f32(vmulq_f32(sum, rs), rs), rs);
+        rs = vmulq_f32(vrsqrtsq_f32(vmulq_f32(sum, rs), rs), rs);
+        float32x4_t mag = vbslq_f32(vceqq_f32(sum, vdupq_n_f32(0.0f)),
+                                    sum, vmulq_f32(sum, rs));
+#endif
+
+        vst1q_f32(out + i, mag);
+
+        ptr += 8; // 8 floats per 4 complex samples
+    }
+
+    // Process leftovers
+    for (; i < n; i++)
+        out[i] = std::abs(in[i]);
+}
+
+/// Body of downsample_audio_neon(); D > 0 compiles the window length in.
+template <int D>
+inline std::size_t downsample_audio_neon_impl(const float* in, std::size_t n,
+                                              int decim, float scale,
+                                              AudioDecimState& state, float* out)
+{
+    std::size_t written = 0;
+    std::size_t i = 0;
+
+    auto step = [&](float v) {
+        state.accumulator += v;
+
+        if (++state.counter == decim) {
+            out[written++] = state.accumulator * scale;
+            state.accumulator = 0.0f;
+            state.counter = 0;
+        }
+    };
+
+    // Complete the window left open by the previous block
+    while (state.counter != 0 && i < n)
+        step(in[i++]);
+
+    // Four output windows per iteration, one per lane
+    const std::size_t d = static_cast<std::size_t>(D > 0 ? D : decim);
+    for (; i + 4 * d <= n; i += 4 * d) {
+        const float* p = in + i;
+        float32x4_t acc = vdupq_n_f32(0.0f);
+
+        for (std::size_t k = 0; k < d; k++) {
+            float32x4_t v = vdupq_n_f32(p[k]);
+            v = vsetq_lane_f32(p[d + k],     v, 1);
+            v = vsetq_lane_f32(p[2 * d + k], v, 2);
+            v = vsetq_lane_f32(p[3 * d + k], v, 3);
+            acc = vaddq_f32(acc, v);
+        }
+
+        vst1q_f32(out + written, vmulq_n_f32(acc, scale));
+        written += 4;
+    }
+
+    for (; i < n; i++)
+        step(in[i]);
+
+    return written;
+}
+
+std::size_t downsample_audio_neon(const float* in, std::size_t n,
+                                  int decim, float scale,
+                                  AudioDecimState& state, float* out)
+{
+    switch (decim) {
+    case 5:  return downsample_audio_neon_impl<5>(in, n, decim, scale, state, out);
+    default: return downsample_audio_neon_impl<0>(in, n, decim, scale, state, out);
+    }
+}
+
+inline float hsum_neon(float32x4_t v)
+{
+#if defined(__aarch64__)
+    return vaddvq_f32(v);
+#else
+    float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpadd_f32(s, s), 0);
+#endif
+}
+
+void fir_decimate_neon(const float* x, std::size_t n_out, std::size_t step,
+                       const float* taps, std::size_t ntaps, float* out)
+{
+    for (std::size_t m = 0; m < n_out; m++) {
+        const float* w = x + m * step;
+        float32x4_t acc0 = vdupq_n_f32(0.0f);
+        float32x4_t acc1 = vdupq_n_f32(0.0f);
+
+        for (std::size_t j = 0; j < ntaps; j += 8) {
+            acc0 = vmlaq_f32(acc0, vld1q_f32(taps + j),     vld1q_f32(w + j));
+            acc1 = vmlaq_f32(acc1, vld1q_f32(taps + j + 4), vld1q_f32(w + j + 4));
+        }
+
+        out[m] = hsum_neon(vaddq_f32(acc0, acc1));
+    }
+}
+
+void fir_decimate_cf_neon(const std::complex<float>* x, std::size_t n_out,
+                          std::size_t step, const float* taps2,
+                          std::size_t ntaps, std::complex<float>* out)
+{
+    const std::size_t nf = 2 * ntaps;
+
+    for (std::size_t m = 0; m < n_out; m++) {
+        const float* w = reinterpret_cast<const float*>(x + m * step);
+        float32x4_t acc0 = vdupq_n_f32(0.0f);
+        float32x4_t acc1 = vdupq_n_f32(0.0f);
+
+        for (std::size_t j = 0; j < nf; j += 8) {
+            acc0 = vmlaq_f32(acc0, vld1q_f32(taps2 + j),     vld1q_f32(w + j));
+            acc1 = vmlaq_f32(acc1, vld1q_f32(taps2 + j + 4), vld1q_f32(w + j + 4));
+        }
+
+        // [re, im, re, im] -> [re + re, im + im]
+        const float32x4_t acc = vaddq_f32(acc0, acc1);
+        const float32x2_t ri  = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+        vst1_f32(reinterpret_cast<float*>(out + m), ri);
+    }
+}
+
+void mix_iq_neon(const int16_t* in, std::size_t pairs,
+                 std::complex<float> phase, std::complex<float> step,
+                 std::complex<float>* out)
+{
+    // Lane phasors phase * step^k (k = 0..3) in split re/im form,
+    // advanced by step^4 per iteration
+    float lre[4], lim[4];
+    std::complex<float> p = phase;
+    for (int k = 0; k < 4; k++) {
+        lre[k] = p.real();
+        lim[k] = p.imag();
+        p *= step;
+    }
+
+    float32x4_t pr = vld1q_f32(lre);
+    float32x4_t pi = vld1q_f32(lim);
+    const std::complex<float> s4 = (step * step) * (step * step);
+    const float32x4_t ar = vdupq_n_f32(s4.real());
+    const float32x4_t ai = vdupq_n_f32(s4.imag());
+
+    std::size_t i = 0;
+    for (; i + 4 <= pairs; i += 4) {
+        const int16x4x2_t raw = vld2_s16(in + 2 * i);
+        const float32x4_t xr = vcvtq_f32_s32(vmovl_s16(raw.val[0]));
+        const float32x4_t xi = vcvtq_f32_s32(vmovl_s16(raw.val[1]));
+
+        float32x4x2_t y;
+        y.val[0] = vmlsq_f32(vmulq_f32(xr, pr), xi, pi);
+        y.val[1] = vmlaq_f32(vmulq_f32(xr, pi), xi, pr);
+        vst2q_f32(reinterpret_cast<float*>(out + i), y);
+
+        const float32x4_t nr = vmlsq_f32(vmulq_f32(pr, ar), pi, ai);
+        pi = vmlaq_f32(vmulq_f32(pr, ai), pi, ar);
+        pr = nr;
+    }
+
+    phase = {vgetq_lane_f32(pr, 0), vgetq_lane_f32(pi, 0)};
+
+    for (; i < pairs; i++) {
+        out[i] = std::complex<float>(in[2 * i], in[2 * i + 1]) * phase;
+        phase *= step;
+    }
+}
+
+void fft_pass_neon(std::complex<float>* data, std::size_t n, std::size_t half,
+                   const std::complex<float>* tw)
+{
+    if (half < 4) {
+        for (std::size_t base = 0; base < n; base += 2 * half) {
+            std::complex<float>* a = data + base;
+            std::complex<float>* b = a + half;
+
+            for (std::size_t k = 0; k < half; k++) {
+                const std::complex<float> t = b[k] * tw[k];
+                b[k] = a[k] - t;
+                a[k] += t;
+            }
+        }
+        return;
+    }
+
+    for (std::size_t base = 0; base < n; base += 2 * half) {
+        float* a = reinterpret_cast<float*>(data + base);
+        float* b = reinterpret_cast<float*>(data + base + half);
+        const float* w = reinterpret_cast<const float*>(tw);
+
+        // Four butterflies per iteration in split re/im form
+        for (std::size_t k = 0; k < 2 * half; k += 8) {
+            const float32x4x2_t va = vld2q_f32(a + k);
+            const float32x4x2_t vb = vld2q_f32(b + k);
+            const float32x4x2_t vw = vld2q_f32(w + k);
+
+            const float32x4_t tr = vmlsq_f32(vmulq_f32(vb.val[0], vw.val[0]), vb.val[1], vw.val[1]);
+            const float32x4_t ti = vmlaq_f32(vmulq_f32(vb.val[0], vw.val[1]), vb.val[1], vw.val[0]);
+
+            float32x4x2_t ya, yb;
+            ya.val[0] = vaddq_f32(va.val[0], tr);
+            ya.val[1] = vaddq_f32(va.val[1], ti);
+            yb.val[0] = vsubq_f32(va.val[0], tr);
+            yb.val[1] = vsubq_f32(va.val[1], ti);
+            vst2q_f32(a + k, ya);
+            vst2q_f32(b + k, yb);
+        }
+    }
+}
+
+void float_to_s16_neon(const float* in, std::size_t n, float scale, int16_t* out)
+{
+    std::size_t i = 0;
+
+    // float->int32 saturates on ARM and vqmovn saturates to int16
+    for (; i + 8 <= n; i += 8) {
+        const float32x4_t a = vmulq_n_f32(vld1q_f32(in + i),     scale);
+        const float32x4_t b = vmulq_n_f32(vld1q_f32(in + i + 4), scale);
+#if defined(__aarch64__)
+        const int32x4_t ia = vcvtnq_s32_f32(a);
+        const int32x4_t ib = vcvtnq_s32_f32(b);
+#else
+        // ARMv7 only truncates: round half away from zero instead of to even
+        const float32x4_t half = vdupq_n_f32(0.5f);
+        const int32x4_t ia = vcvtq_s32_f32(vaddq_f32(a, vbslq_f32(vcltq_f32(a, vdupq_n_f32(0.0f)),
+                                                                 vnegq_f32(half), half)));
+        const int32x4_t ib = vcvtq_s32_f32(vaddq_f32(b, vbslq_f32(vcltq_f32(b, vdupq_n_f32(0.0f)),
+                                                                 vnegq_f32(half), half)));
+#endif
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(ia), vqmovn_s32(ib)));
+    }
+
+    for (; i < n; i++) {
+        float v = std::nearbyint(in[i] * scale);
+        if (!(v > -32768.0f)) v = -32768.0f;
+        if (v > 32767.0f) v = 32767.0f;
+        out[i] = static_cast<int16_t>(v);
+    }
+}
+
+float power_cf_neon(const std::complex<float>* in, std::size_t n)
+{
+    const float* p = reinterpret_cast<const float*>(in);
+    const std::size_t nf = 2 * n;
+    float32x4_t a0 = vdupq_n_f32(0.0f);
+    float32x4_t a1 = vdupq_n_f32(0.0f);
+    std::size_t i = 0;
+
+    // |z|^2 summed over a block is the sum of squares of every float
+    for (; i + 8 <= nf; i += 8) {
+        const float32x4_t v0 = vld1q_f32(p + i);
+        const float32x4_t v1 = vld1q_f32(p + i + 4);
+        a0 = vmlaq_f32(a0, v0, v0);
+        a1 = vmlaq_f32(a1, v1, v1);
+    }
+
+    float sum = hsum_neon(vaddq_f32(a0, a1));
+    for (; i < nf; i++)
+        sum += p[i] * p[i];
+    return sum;
+}
+
+std::complex<float> pilot_mix_neon(const float* mpx, std::size_t n,
+                                   std::complex<float> phase, std::complex<float> step,
+                                   float pilot, float diff_gain, float* sum, float* diff)
+{
+    // Lane phasors phase * step^k (k = 0..3) in split re/im form,
+    // advanced by step^4 per iteration
+    float lre[4], lim[4];
+    std::complex<float> p = phase;
+    for (int k = 0; k < 4; k++) {
+        lre[k] = p.real();
+        lim[k] = p.imag();
+        p *= step;
+    }
+
+    float32x4_t pr = vld1q_f32(lre);
+    float32x4_t pi = vld1q_f32(lim);
+    const std::complex<float> s4 = (step * step) * (step * step);
+    const float32x4_t ar = vdupq_n_f32(s4.real());
+    const float32x4_t ai = vdupq_n_f32(s4.imag());
+    float32x4_t cr = vdupq_n_f32(0.0f);
+    float32x4_t ci = vdupq_n_f32(0.0f);
+
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t m = vld1q_f32(mpx + i);
+        cr = vmlaq_f32(cr, m, pr);
+        ci = vmlaq_f32(ci, m, pi);
+        const float32x4_t s = vmlsq_n_f32(m, pi, pilot);
+        vst1q_f32(sum + i, s);
+        vst1q_f32(diff + i, vmulq_f32(vmulq_n_f32(s, diff_gain), vmulq_f32(pr, pi)));
+
+        const float32x4_t nr = vmlsq_f32(vmulq_f32(pr, ar), pi, ai);
+        pi = vmlaq_f32(vmulq_f32(pr, ai), pi, ar);
+        pr = nr;
+    }
+
+    phase = {vgetq_lane_f32(pr, 0), vgetq_lane_f32(pi, 0)};
+    float re = hsum_neon(cr);
+    float im = hsum_neon(ci);
+
+    for (; i < n; i++) {
+        const float m = mpx[i];
+        re += m * phase.real();
+        im += m * phase.imag();
+        const float s = m - pilot * phase.imag();
+        sum[i]  = s;
+        diff[i] = diff_gain * s * phase.real() * phase.imag();
+        phase *= step;
+    }
+    return {re, im};
+}
+
+float deemphasis_neon(float* data, std::size_t n, float a, float y)
+{
+    // Four outputs per step from their inputs and the output before them:
+    // y[k] = sum_{j<=k} a b^(k-j) x[j] + b^(k+1) y[-1], with b = 1 - a
+    const float b = 1.0f - a;
+    const float b2 = b * b;
+    const float b3 = b2 * b;
+    const float c0v[4] = {a, a * b, a * b2, a * b3};
+    const float c1v[4] = {0.0f, a, a * b, a * b2};
+    const float c2v[4] = {0.0f, 0.0f, a, a * b};
+    const float c3v[4] = {0.0f, 0.0f, 0.0f, a};
+    const float cyv[4] = {b, b2, b3, b2 * b2};
+    const float32x4_t c0 = vld1q_f32(c0v);
+    const float32x4_t c1 = vld1q_f32(c1v);
+    const float32x4_t c2 = vld1q_f32(c2v);
+    const float32x4_t c3 = vld1q_f32(c3v);
+    const float32x4_t cy = vld1q_f32(cyv);
+
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t x = vld1q_f32(data + i);
+        const float32x2_t lo = vget_low_f32(x);
+        const float32x2_t hi = vget_high_f32(x);
+
+        float32x4_t acc = vmulq_n_f32(cy, y);
+        acc = vmlaq_lane_f32(acc, c0, lo, 0);
+        acc = vmlaq_lane_f32(acc, c1, lo, 1);
+        acc = vmlaq_lane_f32(acc, c2, hi, 0);
+        acc = vmlaq_lane_f32(acc, c3, hi, 1);
+        vst1q_f32(data + i, acc);
+        y = vgetq_lane_f32(acc, 3);
+    }
+
+    for (; i < n; i++) {
+        y += a * (data[i] - y);
+        data[i] = y;
+    }
+    return y;
+}
+
+// Fixed-point FM chain: the int16 multiply-accumulates and 32-bit CORDIC
+// lanes that make it cheaper than the float chain on cores with a weak FPU.
+// Bit-exact against the scalar kernels.
+
+/// Scalar discriminator for the samples around the vector loop.
+inline int16_t discriminate_q15(const int16_t* cur, int32_t prev_i, int32_t prev_q)
+{
+    return cordic_atan2_q15(cur[1] * prev_i - cur[0] * prev_q, cur[0] * prev_i + cur[1] * prev_q);
+}
+
+/// cordic_atan2_q15() of four lanes.
+inline int16x4_t cordic_neon(int32x4_t im, int32x4_t re)
+{
+    // cordic_norm_shift() is clz((m >> 7) | 1) - 8
+    const int32x4_t m = vorrq_s32(vabsq_s32(re), vabsq_s32(im));
+    const int32x4_t shift = vsubq_s32(vclzq_s32(vorrq_s32(vshrq_n_s32(m, 7), vdupq_n_s32(1))),
+                                      vdupq_n_s32(8));
+
+    int32x4_t x = vshrq_n_s32(vshlq_s32(re, shift), 2);
+    int32x4_t y = vshrq_n_s32(vshlq_s32(im, shift), 2);
+
+    const int32x4_t s = vshrq_n_s32(x, 31);
+    x = vsubq_s32(veorq_s32(x, s), s);
+    y = vsubq_s32(veorq_s32(y, s), s);
+    int32x4_t z = vandq_s32(s, vdupq_n_s32(INT32_MIN));
+
+    for (int k = 0; k < kCordicSteps; k++) {
+        // vshl by a negative count is an arithmetic right shift
+        const int32x4_t cnt = vdupq_n_s32(-k);
+        const int32x4_t d  = vshrq_n_s32(y, 31);
+        const int32x4_t dx = vsubq_s32(veorq_s32(vshlq_s32(y, cnt), d), d);
+        const int32x4_t dy = vsubq_s32(veorq_s32(vshlq_s32(x, cnt), d), d);
+        const int32x4_t a  = vdupq_n_s32(kCordicAtan[static_cast<std::size_t>(k)]);
+        x = vaddq_s32(x, dx);
+        y = vsubq_s32(y, dy);
+        z = vaddq_s32(z, vsubq_s32(veorq_s32(a, d), d));
+    }
+    const int16x4_t a = vshrn_n_s32(vaddq_s32(z, vdupq_n_s32(0x8000)), 16);
+    return vbic_s16(a, vreinterpret_s16_u16(vmovn_u32(vceqq_s32(m, vdupq_n_s32(0)))));
+}
+
+void demodulate_fm_q15_neon(const int16_t* in, std::size_t n,
+                            int16_t prev_i, int16_t prev_q, int16_t* out)
+{
+    if (n == 0) return;
+
+    out[0] = discriminate_q15(in, prev_i, prev_q);
+    std::size_t i = 1;
+
+    for (; i + 8 <= n; i += 8) {
+        const int16x8x2_t cur = vld2q_s16(in + 2 * i);
+        const int16x8x2_t prv = vld2q_s16(in + 2 * (i - 1));
+
+        const int16x4_t ci0 = vget_low_s16(cur.val[0]);
+        const int16x4_t cq0 = vget_low_s16(cur.val[1]);
+        const int16x4_t pi0 = vget_low_s16(prv.val[0]);
+        const int16x4_t pq0 = vget_low_s16(prv.val[1]);
+        const int16x4_t ci1 = vget_high_s16(cur.val[0]);
+        const int16x4_t cq1 = vget_high_s16(cur.val[1]);
+        const int16x4_t pi1 = vget_high_s16(prv.val[0]);
+        const int16x4_t pq1 = vget_high_s16(prv.val[1]);
+
+        // cur * conj(prev), exact in 32 bits
+        const int32x4_t re0 = vmlal_s16(vmull_s16(ci0, pi0), cq0, pq0);
+        const int32x4_t im0 = vmlsl_s16(vmull_s16(cq0, pi0), ci0, pq0);
+        const int32x4_t re1 = vmlal_s16(vmull_s16(ci1, pi1), cq1, pq1);
+        const int32x4_t im1 = vmlsl_s16(vmull_s16(cq1, pi1), ci1, pq1);
+
+        vst1q_s16(out + i, vcombine_s16(cordic_neon(im0, re0), cordic_neon(im1, re1)));
+    }
+
+    for (; i < n; i++)
+        out[i] = discriminate_q15(in + 2 * i, in[2 * i - 2], in[2 * i - 1]);
+}
+
+/// Body of downsample_audio_q15_neon(); D > 0 compiles the window length in.
+template <int D>
+inline std::size_t downsample_audio_q15_neon_impl(const int16_t* in, std::size_t n,
+                                                  int decim, FixedGain gain,
+                                                  AudioDecimStateQ15& state, int16_t* out)
+{
+    std::size_t written = 0;
+    std::size_t i = 0;
+
+    auto step = [&](int16_t v) {
+        state.accumulator += v;
+
+        if (++state.counter == decim) {
+            out[written++] = detail::apply_gain_q15(state.accumulator, gain);
+            state.accumulator = 0;
+            state.counter = 0;
+        }
+    };
+
+    // Complete the window left open by the previous block
+    while (state.counter != 0 && i < n)
+        step(in[i++]);
+
+    // Four output windows per iteration, one per lane; the rounding shift
+    // and saturating narrow match apply_gain_q15()
+    const std::size_t d = static_cast<std::size_t>(D > 0 ? D : decim);
+    const int32x4_t pre = vdupq_n_s32(-gain.pre_shift);
+    const int32x4_t post = vdupq_n_s32(-gain.shift);
+
+    for (; i + 4 * d <= n; i += 4 * d) {
+        const int16_t* p = in + i;
+        int32x4_t acc = vdupq_n_s32(0);
+
+        for (std::size_t k = 0; k < d; k++) {
+            int32x4_t v = vdupq_n_s32(p[k]);
+            v = vsetq_lane_s32(p[d + k],     v, 1);
+            v = vsetq_lane_s32(p[2 * d + k], v, 2);
+            v = vsetq_lane_s32(p[3 * d + k], v, 3);
+            acc = vaddq_s32(acc, v);
+        }
+
+        const int32x4_t v = vrshlq_s32(vmulq_n_s32(vshlq_s32(acc, pre), gain.mul), post);
+        vst1_s16(out + written, vqmovn_s32(v));
+        written += 4;
+    }
+
+    for (; i < n; i++)
+        step(in[i]);
+
+    return written;
+}
+
+std::size_t downsample_audio_q15_neon(const int16_t* in, std::size_t n,
+                                      int decim, FixedGain gain,
+                                      AudioDecimStateQ15& state, int16_t* out)
+{
+    switch (decim) {
+    case 5:  return downsample_audio_q15_neon_impl<5>(in, n, decim, gain, state, out);
+    default: return downsample_audio_q15_neon_impl<0>(in, n, decim, gain, state, out);
+    }
+}
+
+} // namespace
+
+KernelTable detail::neon_kernels() noexcept
+{
+    KernelTable t;
+    t.downsample_iq    = {downsample_iq_neon,    Isa::Neon};
+    t.demodulate_fm    = {demodulate_fm_neon,    Isa::Neon};
+    t.demodulate_am    = {demodulate_am_neon,    Isa::Neon};
+    t.downsample_audio = {downsample_audio_neon, Isa::Neon};
+    t.fir_decimate     = {fir_decimate_neon,     Isa::Neon};
+    t.fir_decimate_cf  = {fir_decimate_cf_neon,  Isa::Neon};
+    t.mix_iq           = {mix_iq_neon,           Isa::Neon};
+    t.fft_pass         = {fft_pass_neon,         Isa::Neon};
+    t.float_to_s16     = {float_to_s16_neon,     Isa::Neon};
+    t.power_cf         = {power_cf_neon,         Isa::Neon};
+    t.pilot_mix        = {pilot_mix_neon,        Isa::Neon};
+    t.deemphasis       = {deemphasis_neon,       Isa::Neon};
+    t.downsample_iq_q15    = {downsample_iq_q15_neon,    Isa::Neon};
+    t.demodulate_fm_q15    = {demodulate_fm_q15_neon,    Isa::Neon};
+    t.downsample_audio_q15 = {downsample_audio_q15_neon, Isa::Neon};
+    return t;
+}
+
+} // namespace dsp
+
+#else // __ARM_NEON || __ARM_NEON__
+
+namespace dsp {
+
+KernelTable detail::neon_kernels() noexcept { return {}; }
+
+} // namespace dsp
+
+#endif // __ARM_NEON || __ARM_NEON__
@@ -0,0 +1,1374 @@
+#include "dsp_kernels.hpp"
+
+/**
+ * @file dsp_x86.cpp
+ * @brief SSE4.1, AVX2 and AVX-512 DSP kernels.
+ *
+ * The file is compiled for the baseline x86 target; each kernel enables its
+ * instruction set with a function-level target attribute and is only
+ * reached through the registry after cpu_features() confirmed support.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <cfloat>
+#include <cstdint>
+#include <immintrin.h>
+
+#define DSP_TARGET_SSE41  __attribute__((target("sse4.1")))
+#define DSP_TARGET_AVX2   __attribute__((target("avx2")))
+#define DSP_TARGET_AVX512 __attribute__((target("avx512f")))
+
+namespace dsp {
+
+using detail::kCordicAtan;
+using detail::kAtanC1;
+using detail::kAtanC3;
+using detail::kAtanC5;
+using detail::kAtanC7;
+using detail::kAtanC9;
+using detail::kHalfPi;
+using detail::kPi;
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// SSE4.1
+// ---------------------------------------------------------------------------
+
+DSP_TARGET_SSE41
+inline __m128 fast_atan2_sse41(__m128 y, __m128 x)
+{
+    const __m128 sign_mask = _mm_set1_ps(-0.0f);
+    const __m128 ax = _mm_andnot_ps(sign_mask, x);
+    const __m128 ay = _mm_andnot_ps(sign_mask, y);
+    const __m128 mn = _mm_min_ps(ax, ay);
+    const __m128 mx = _mm_max_ps(_mm_max_ps(ax, ay), _mm_set1_ps(FLT_MIN));
+    const __m128 a  = _mm_div_ps(mn, mx);
+    const __m128 z  = _mm_mul_ps(a, a);
+
+    __m128 r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(kAtanC9), z), _mm_set1_ps(kAtanC7));
+    r = _mm_add_ps(_mm_mul_ps(r, z), _mm_set1_ps(kAtanC5));
+    r = _mm_add_ps(_mm_mul_ps(r, z), _mm_set1_ps(kAtanC3));
+    r = _mm_add_ps(_mm_mul_ps(r, z), _mm_set1_ps(kAtanC1));
+    r = _mm_mul_ps(r, a);
+
+    r = _mm_blendv_ps(r, _mm_sub_ps(_mm_set1_ps(kHalfPi), r), _mm_cmpgt_ps(ay, ax));
+    r = _mm_blendv_ps(r, _mm_sub_ps(_mm_set1_ps(kPi), r),
+                      _mm_cmplt_ps(x, _mm_setzero_ps()));
+
+    return _mm_xor_ps(r, _mm_and_ps(y, sign_mask));
+}
+
+/// Window sums of downsample_iq_sse41() and downsample_iq_q15_sse41(), handed to
+/// @p store as store(b, sum_i, sum_q); D > 0 compiles the window length in.
+template <int D, typename Store>
+DSP_TARGET_SSE41
+inline std::size_t downsample_iq_sse41_impl(const int16_t* in, std::size_t pairs,
+                                            int decim, Store store)
+{
+    const int d = D > 0 ? D : decim;
+    const std::size_t blocks = pairs / static_cast<std::size_t>(d);
+
+    for (std::size_t b = 0; b < blocks; b++) {
+        // Lanes hold [I, Q, I, Q] partial sums
+        __m128i acc = _mm_setzero_si128();
+        int k = 0;
+
+        for (; k + 4 <= d; k += 4) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + k * 2));
+            acc = _mm_add_epi32(acc, _mm_cvtepi16_epi32(v));
+            acc = _mm_add_epi32(acc, _mm_cvtepi16_epi32(_mm_srli_si128(v, 8)));
+        }
+        for (; k + 2 <= d; k += 2) {
+            const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + k * 2));
+            acc = _mm_add_epi32(acc, _mm_cvtepi16_epi32(v));
+        }
+        acc = _mm_add_epi32(acc, _mm_srli_si128(acc, 8));
+
+        int32_t si = _mm_cvtsi128_si32(acc);
+        int32_t sq = _mm_extract_epi32(acc, 1);
+        for (; k < d; k++) {
+            si += in[k * 2];
+            sq += in[k * 2 + 1];
+        }
+
+        store(b, si, sq);
+        in += d * 2;
+    }
+
+    return blocks;
+}
+
+DSP_TARGET_SSE41
+std::size_t downsample_iq_sse41(const int16_t* in, std::size_t pairs,
+                                int decim, std::complex<float>* out)
+{
+    const auto store = [out](std::size_t b, int32_t si, int32_t sq) {
+        out[b] = {static_cast<float>(si), static_cast<float>(sq)};
+    };
+
+    switch (decim) {
+    case 8:  return downsample_iq_sse41_impl<8>(in, pairs, decim, store);
+    case 10: return downsample_iq_sse41_impl<10>(in, pairs, decim, store);
+    case 16: return downsample_iq_sse41_impl<16>(in, pairs, decim, store);
+    default: return downsample_iq_sse41_impl<0>(in, pairs, decim, store);
+    }
+}
+
+DSP_TARGET_SSE41
+std::size_t downsample_iq_q15_sse41(const int16_t* in, std::size_t pairs,
+                                    int decim, int shift, int16_t* out)
+{
+    const auto store = [out, shift](std::size_t b, int32_t si, int32_t sq) {
+        out[2 * b]     = detail::saturate_q15(si >> shift);
+        out[2 * b + 1] = detail::saturate_q15(sq >> shift);
+    };
+
+    switch (decim) {
+    case 8:  return downsample_iq_sse41_impl<8>(in, pairs, decim, store);
+    case 10: return downsample_iq_sse41_impl<10>(in, pairs, decim, store);
+    case 16: return downsample_iq_sse41_impl<16>(in, pairs, decim, store);
+    default: return downsample_iq_sse41_impl<0>(in, pairs, decim, store);
+    }
+}
+
+DSP_TARGET_SSE41
+void demodulate_fm_sse41(const std::complex<float>* in, std::size_t n,
+                         std::complex<float> prev, float* out)
+{
+    if (n == 0) return;
+
+    const auto first = in[0] * std::conj(prev);
+    out[0] = fast_atan2(first.imag(), first.real());
+
+    const float* p = reinterpret_cast<const float*>(in);
+    std::size_t i = 1;
+
+    for (; i + 4 <= n; i += 4) {
+        const __m128 c0 = _mm_loadu_ps(p + 2 * i);
+        const __m128 c1 = _mm_loadu_ps(p + 2 * i + 4);
+        const __m128 p0 = _mm_loadu_ps(p + 2 * (i - 1));
+        const __m128 p1 = _mm_loadu_ps(p + 2 * (i - 1) + 4);
+
+        const __m128 cr = _mm_shuffle_ps(c0, c1, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 ci = _mm_shuffle_ps(c0, c1, _MM_SHUFFLE(3, 1, 3, 1));
+        const __m128 pr = _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 pi = _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(3, 1, 3, 1));
+
+        // cur * conj(prev)
+        const __m128 re = _mm_add_ps(_mm_mul_ps(cr, pr), _mm_mul_ps(ci, pi));
+        const __m128 im = _mm_sub_ps(_mm_mul_ps(ci, pr), _mm_mul_ps(cr, pi));
+
+        _mm_storeu_ps(out + i, fast_atan2_sse41(im, re));
+    }
+
+    for (; i < n; i++) {
+        const auto prod = in[i] * std::conj(in[i - 1]);
+        out[i] = fast_atan2(prod.imag(), prod.real());
+    }
+}
+
+DSP_TARGET_SSE41
+void demodulate_am_sse41(const std::complex<float>* in, std::size_t n,
+                         float* out)
+{
+    const float* p = reinterpret_cast<const float*>(in);
+    std::size_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        const __m128 v0 = _mm_loadu_ps(p + 2 * i);
+        const __m128 v1 = _mm_loadu_ps(p + 2 * i + 4);
+        const __m128 re = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 im = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1));
+
+        const __m128 mag2 = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+        _mm_storeu_ps(out + i, _mm_sqrt_ps(mag2));
+    }
+
+    for (; i < n; i++)
+        out[i] = std::abs(in[i]);
+}
+
+/// Feed samples one by one until the pending decimation window is complete.
+inline std::size_t finish_audio_window(const float* in, std::size_t n, int decim,
+                                       float scale, AudioDecimState& state,
+                                       float* out, std::size_t& written)
+{
+    std::size_t i = 0;
+
+    while (state.counter != 0 && i < n) {
+        state.accumulator += in[i++];
+
+        if (++state.counter == decim) {
+            out[written++] = state.accumulator * scale;
+            state.accumulator = 0.0f;
+            state.counter = 0;
+        }
+    }
+
+    return i;
+}
+
+/// Accumulate the trailing samples that do not fill a vector of windows.
+inline void audio_tail(const float* in, std::size_t n, int decim, float scale,
+                       AudioDecimState& state, float* out, std::size_t& written)
+{
+    for (std::size_t i = 0; i < n; i++) {
+        state.accumulator += in[i];
+
+        if (++state.counter == decim) {
+            out[written++] = state.accumulator * scale;
+            state.accumulator = 0.0f;
+            state.counter = 0;
+        }
+    }
+}
+
+/// Body of downsample_audio_sse41(); D > 0 compiles the window length in.
+template <int D>
+DSP_TARGET_SSE41
+inline std::size_t downsample_audio_sse41_impl(const float* in, std::size_t n,
+                                               int decim, float scale,
+                                               AudioDecimState& state, float* out)
+{
+    std::size_t written = 0;
+    std::size_t i = finish_audio_window(in, n, decim, scale, state, out, written);
+
+    // Four output windows per iteration, one per lane
+    const std::size_t d = static_cast<std::size_t>(D > 0 ? D : decim);
+    const __m128 vscale = _mm_set1_ps(scale);
+
+    for (; i + 4 * d <= n; i += 4 * d) {
+        const float* p = in + i;
+        __m128 acc = _mm_setzero_ps();
+
+        for (std::size_t k = 0; k < d; k++)
+            acc = _mm_add_ps(acc, _mm_set_ps(p[3 * d + k], p[2 * d + k], p[d + k], p[k]));
+
+        _mm_storeu_ps(out + written, _mm_mul_ps(acc, vscale));
+        written += 4;
+    }
+
+    audio_tail(in + i, n - i, decim, scale, state, out, written);
+    return written;
+}
+
+DSP_TARGET_SSE41
+std::size_t downsample_audio_sse41(const float* in, std::size_t n,
+                                   int decim, float scale,
+                                   AudioDecimState& state, float* out)
+{
+    switch (decim) {
+    case 5:  return downsample_audio_sse41_impl<5>(in, n, decim, scale, state, out);
+    default: return downsample_audio_sse41_impl<0>(in, n, decim, scale, state, out);
+    }
+}
+
+
+DSP_TARGET_SSE41
+inline float hsum_sse41(__m128 v)
+{
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(v);
+}
+
+DSP_TARGET_SSE41
+void fir_decimate_sse41(const float* x, std::size_t n_out, std::size_t step,
+                        const float* taps, std::size_t ntaps, float* out)
+{
+    for (std::size_t m = 0; m < n_out; m++) {
+        const float* w = x + m * step;
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+
+        for (std::size_t j = 0; j < ntaps; j += 8) {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(taps + j),     _mm_loadu_ps(w + j)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(taps + j + 4), _mm_loadu_ps(w + j + 4)));
+        }
+
+        out[m] = hsum_sse41(_mm_add_ps(acc0, acc1));
+    }
+}
+
+DSP_TARGET_SSE41
+void fir_decimate_cf_sse41(const std::complex<float>* x, std::size_t n_out,
+                           std::size_t step, const float* taps2,
+                           std::size_t ntaps, std::complex<float>* out)
+{
+    const std::size_t nf = 2 * ntaps;
+
+    for (std::size_t m = 0; m < n_out; m++) {
+        const float* w = reinterpret_cast<const float*>(x + m * step);
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+
+        for (std::size_t j = 0; j < nf; j += 8) {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(taps2 + j),     _mm_loadu_ps(w + j)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(taps2 + j + 4), _mm_loadu_ps(w + j + 4)));
+        }
+
+        // [re, im, re, im] -> [re + re, im + im]
+        __m128 acc = _mm_add_ps(acc0, acc1);
+        acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+        _mm_storel_pi(reinterpret_cast<__m64*>(out + m), acc);
+    }
+}
+
+/// Interleaved complex multiply of two packed [re, im, re, im] vectors
+DSP_TARGET_SSE41
+inline __m128 cmul_sse41(__m128 a, __m128 b)
+{
+    const __m128 re = _mm_moveldup_ps(b);
+    const __m128 im = _mm_movehdup_ps(b);
+    const __m128 sw = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm_addsub_ps(_mm_mul_ps(a, re), _mm_mul_ps(sw, im));
+}
+
+DSP_TARGET_SSE41
+void mix_iq_sse41(const int16_t* in, std::size_t pairs,
+                  std::complex<float> phase, std::complex<float> step,
+                  std::complex<float>* out)
+{
+    // Lane phasors {phase, phase * step}, advanced by step^2 per iteration
+    const std::complex<float> p1 = phase * step;
+    __m128 ph = _mm_setr_ps(phase.real(), phase.imag(), p1.real(), p1.imag());
+    const std::complex<float> s2 = step * step;
+    const __m128 adv = _mm_setr_ps(s2.real(), s2.imag(), s2.real(), s2.imag());
+
+    std::size_t i = 0;
+    for (; i + 2 <= pairs; i += 2) {
+        const __m128i raw = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + 2 * i));
+        const __m128 x = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(raw));
+
+        _mm_storeu_ps(reinterpret_cast<float*>(out + i), cmul_sse41(x, ph));
+        ph = cmul_sse41(ph, adv);
+    }
+
+    alignas(16) float lane[4];
+    _mm_store_ps(lane, ph);
+    phase = {lane[0], lane[1]};
+
+    for (; i < pairs; i++) {
+        out[i] = std::complex<float>(in[2 * i], in[2 * i + 1]) * phase;
+        phase *= step;
+    }
+}
+
+DSP_TARGET_SSE41
+void fft_pass_sse41(std::complex<float>* data, std::size_t n, std::size_t half,
+                    const std::complex<float>* tw)
+{
+    if (half < 2) {
+        // First stage: twiddle is 1, plain sum and difference of pairs
+        for (std::size_t i = 0; i < n; i += 2) {
+            const std::complex<float> a = data[i], b = data[i + 1];
+            data[i]     = a + b;
+            data[i + 1] = a - b;
+        }
+        return;
+    }
+
+    for (std::size_t base = 0; base < n; base += 2 * half) {
+        float* a = reinterpret_cast<float*>(data + base);
+        float* b = reinterpret_cast<float*>(data + base + half);
+        const float* w = reinterpret_cast<const float*>(tw);
+
+        for (std::size_t k = 0; k < 2 * half; k += 4) {
+            const __m128 va = _mm_loadu_ps(a + k);
+            const __m128 t  = cmul_sse41(_mm_loadu_ps(b + k), _mm_loadu_ps(w + k));
+            _mm_storeu_ps(a + k, _mm_add_ps(va, t));
+            _mm_storeu_ps(b + k, _mm_sub_ps(va, t));
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// AVX2
+// ---------------------------------------------------------------------------
+
+DSP_TARGET_AVX2
+inline __m256 fast_atan2_avx2(__m256 y, __m256 x)
+{
+    const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+    const __m256 ax = _mm256_andnot_ps(sign_mask, x);
+    const __m256 ay = _mm256_andnot_ps(sign_mask, y);
+    const __m256 mn = _mm256_min_ps(ax, ay);
+    const __m256 mx = _mm256_max_ps(_mm256_max_ps(ax, ay), _mm256_set1_ps(FLT_MIN));
+    const __m256 a  = _mm256_div_ps(mn, mx);
+    const __m256 z  = _mm256_mul_ps(a, a);
+
+    __m256 r = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(kAtanC9), z), _mm256_set1_ps(kAtanC7));
+    r = _mm256_add_ps(_mm256_mul_ps(r, z), _mm256_set1_ps(kAtanC5));
+    r = _mm256_add_ps(_mm256_mul_ps(r, z), _mm256_set1_ps(kAtanC3));
+    r = _mm256_add_ps(_mm256_mul_ps(r, z), _mm256_set1_ps(kAtanC1));
+    r = _mm256_mul_ps(r, a);
+
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(kHalfPi), r),
+                         _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(kPi), r),
+                         _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+
+    return _mm256_xor_ps(r, _mm256_and_ps(y, sign_mask));
+}
+
+/// Undo the 0 1 4 5 | 2 3 6 7 lane order left by an in-lane deinterleave.
+DSP_TARGET_AVX2
+inline __m256 restore_order_avx2(__m256 v)
+{
+    return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(v),
+                                                  _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+/// Window sums of downsample_iq_avx2() and downsample_iq_q15_avx2(), handed to
+/// @p store as store(b, sum_i, sum_q); D > 0 compiles the window length in.
+template <int D, typename Store>
+DSP_TARGET_AVX2
+inline std::size_t downsample_iq_avx2_impl(const int16_t* in, std::size_t pairs,
+                                           int decim, Store store)
+{
+    const int d = D > 0 ? D : decim;
+    const std::size_t blocks = pairs / static_cast<std::size_t>(d);
+
+    for (std::size_t b = 0; b < blocks; b++) {
+        __m256i acc = _mm256_setzero_si256();
+        int k = 0;
+
+        for (; k + 8 <= d; k += 8) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + k * 2));
+            acc = _mm256_add_epi32(acc, _mm256_cvtepi16_epi32(_mm256_castsi256_si128(v)));
+            acc = _mm256_add_epi32(acc, _mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1)));
+        }
+
+        __m128i acc4 = _mm_add_epi32(_mm256_castsi256_si128(acc),
+                                     _mm256_extracti128_si256(acc, 1));
+        for (; k + 4 <= d; k += 4) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + k * 2));
+            acc4 = _mm_add_epi32(acc4, _mm_cvtepi16_epi32(v));
+            acc4 = _mm_add_epi32(acc4, _mm_cvtepi16_epi32(_mm_srli_si128(v, 8)));
+        }
+        for (; k + 2 <= d; k += 2) {
+            const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + k * 2));
+            acc4 = _mm_add_epi32(acc4, _mm_cvtepi16_epi32(v));
+        }
+        acc4 = _mm_add_epi32(acc4, _mm_srli_si128(acc4, 8));
+
+        int32_t si = _mm_cvtsi128_si32(acc4);
+        int32_t sq = _mm_extract_epi32(acc4, 1);
+        for (; k < d; k++) {
+            si += in[k * 2];
+            sq += in[k * 2 + 1];
+        }
+
+        store(b, si, sq);
+        in += d * 2;
+    }
+
+    return blocks;
+}
+
+DSP_TARGET_AVX2
+std::size_t downsample_iq_avx2(const int16_t* in, std::size_t pairs,
+                               int decim, std::complex<float>* out)
+{
+    const auto store = [out](std::size_t b, int32_t si, int32_t sq) {
+        out[b] = {static_cast<float>(si), static_cast<float>(sq)};
+    };
+
+    switch (decim) {
+    case 8:  return downsample_iq_avx2_impl<8>(in, pairs, decim, store);
+    case 10: return downsample_iq_avx2_impl<10>(in, pairs, decim, store);
+    case 16: return downsample_iq_avx2_impl<16>(in, pairs, decim, store);
+    default: return downsample_iq_avx2_impl<0>(in, pairs, decim, store);
+    }
+}
+
+DSP_TARGET_AVX2
+std::size_t downsample_iq_q15_avx2(const int16_t* in, std::size_t pairs,
+                                   int decim, int shift, int16_t* out)
+{
+    const auto store = [out, shift](std::size_t b, int32_t si, int32_t sq) {
+        out[2 * b]     = detail::saturate_q15(si >> shift);
+        out[2 * b + 1] = detail::saturate_q15(sq >> shift);
+    };
+
+    switch (decim) {
+    case 8:  return downsample_iq_avx2_impl<8>(in, pairs, decim, store);
+    case 10: return downsample_iq_avx2_impl<10>(in, pairs, decim, store);
+    case 16: return downsample_iq_avx2_impl<16>(in, pairs, decim, store);
+    default: return downsample_iq_avx2_impl<0>(in, pairs, decim, store);
+    }
+}
+
+DSP_TARGET_AVX2
+void demodulate_fm_avx2(const std::complex<float>* in, std::size_t n,
+                        std::complex<float> prev, float* out)
+{
+    if (n == 0) return;
+
+    const auto first = in[0] * std::conj(prev);
+    out[0] = fast_atan2(first.imag(), first.real());
+
+    const float* p = reinterpret_cast<const float*>(in);
+    std::size_t i = 1;
+
+    for (; i + 8 <= n; i += 8) {
+        const __m256 c0 = _mm256_loadu_ps(p + 2 * i);
+        const __m256 c1 = _mm256_loadu_ps(p + 2 * i + 8);
+        const __m256 p0 = _mm256_loadu_ps(p + 2 * (i - 1));
+        const __m256 p1 = _mm256_loadu_ps(p + 2 * (i - 1) + 8);
+
+        const __m256 cr = _mm256_shuffle_ps(c0, c1, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m256 ci = _mm256_shuffle_ps(c0, c1, _MM_SHUFFLE(3, 1, 3, 1));
+        const __m256 pr = _mm256_shuffle_ps(p0, p1, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m256 pi = _mm256_shuffle_ps(p0, p1, _MM_SHUFFLE(3, 1, 3, 1));
+
+        const __m256 re = _mm256_add_ps(_mm256_mul_ps(cr, pr), _mm256_mul_ps(ci, pi));
+        const __m256 im = _mm256_sub_ps(_mm256_mul_ps(ci, pr), _mm256_mul_ps(cr, pi));
+
+        _mm256_storeu_ps(out + i, restore_order_avx2(fast_atan2_avx2(im, re)));
+    }
+
+    for (; i < n; i++) {
+        const auto prod = in[i] * std::conj(in[i - 1]);
+        out[i] = fast_atan2(prod.imag(), prod.real());
+    }
+}
+
+DSP_TARGET_AVX2
+void demodulate_am_avx2(const std::complex<float>* in, std::size_t n,
+                        float* out)
+{
+    const float* p = reinterpret_cast<const float*>(in);
+    std::size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        const __m256 v0 = _mm256_loadu_ps(p + 2 * i);
+        const __m256 v1 = _mm256_loadu_ps(p + 2 * i + 8);
+        const __m256 re = _mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m256 im = _mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1));
+
+        const __m256 mag2 = _mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im));
+        _mm256_storeu_ps(out + i, restore_order_avx2(_mm256_sqrt_ps(mag2)));
+    }
+
+    for (; i < n; i++)
+        out[i] = std::abs(in[i]);
+}
+
+/// Body of downsample_audio_avx2(); D > 0 compiles the window length in.
+template <int D>
+DSP_TARGET_AVX2
+inline std::size_t downsample_audio_avx2_impl(const float* in, std::size_t n,
+                                              int decim, float scale,
+                                              AudioDecimState& state, float* out)
+{
+    std::size_t written = 0;
+    std::size_t i = finish_audio_window(in, n, decim, scale, state, out, written);
+
+    // Eight output windows per iteration, gathered with a stride of decim
+    const std::size_t d = static_cast<std::size_t>(D > 0 ? D : decim);
+    const __m256i idx = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                           _mm256_set1_epi32(static_cast<int>(d)));
+    const __m256 vscale = _mm256_set1_ps(scale);
+
+    for (; i + 8 * d <= n; i += 8 * d) {
+        const float* p = in + i;
+        __m256 acc = _mm256_setzero_ps();
+
+        for (std::size_t k = 0; k < d; k++)
+            acc = _mm256_add_ps(acc, _mm256_i32gather_ps(p + k, idx, 4));
+
+        _mm256_storeu_ps(out + written, _mm256_mul_ps(acc, vscale));
+        written += 8;
+    }
+
+    audio_tail(in + i, n - i, decim, scale, state, out, written);
+    return written;
+}
+
+DSP_TARGET_AVX2
+std::size_t downsample_audio_avx2(const float* in, std::size_t n,
+                                  int decim, float scale,
+                                  AudioDecimState& state, float* out)
+{
+    switch (decim) {
+    case 5:  return downsample_audio_avx2_impl<5>(in, n, decim, scale, state, out);
+    default: return downsample_audio_avx2_impl<0>(in, n, decim, scale, state, out);
+    }
+}
+
+
+DSP_TARGET_AVX2
+void fir_decimate_avx2(const float* x, std::size_t n_out, std::size_t step,
+                       const float* taps, std::size_t ntaps, float* out)
+{
+    for (std::size_t m = 0; m < n_out; m++) {
+        const float* w = x + m * step;
+        __m256 acc = _mm256_setzero_ps();
+
+        for (std::size_t j = 0; j < ntaps; j += 8)
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(taps + j),
+                                                   _mm256_loadu_ps(w + j)));
+
+        out[m] = hsum_sse41(_mm_add_ps(_mm256_castps256_ps128(acc),
+                                       _mm256_extractf128_ps(acc, 1)));
+    }
+}
+
+DSP_TARGET_AVX2
+void fir_decimate_cf_avx2(const std::complex<float>* x, std::size_t n_out,
+                          std::size_t step, const float* taps2,
+                          std::size_t ntaps, std::complex<float>* out)
+{
+    const std::size_t nf = 2 * ntaps;
+
+    for (std::size_t m = 0; m < n_out; m++) {
+        const float* w = reinterpret_cast<const float*>(x + m * step);
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+
+        for (std::size_t j = 0; j < nf; j += 16) {
+            acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(taps2 + j),
+                                                     _mm256_loadu_ps(w + j)));
+            acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(taps2 + j + 8),
+                                                     _mm256_loadu_ps(w + j + 8)));
+        }
+
+        const __m256 acc8 = _mm256_add_ps(acc0, acc1);
+        __m128 acc = _mm_add_ps(_mm256_castps256_ps128(acc8),
+                                _mm256_extractf128_ps(acc8, 1));
+        acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+        _mm_storel_pi(reinterpret_cast<__m64*>(out + m), acc);
+    }
+}
+
+/// Interleaved complex multiply of two packed [re, im, ...] vectors
+DSP_TARGET_AVX2
+inline __m256 cmul_avx2(__m256 a, __m256 b)
+{
+    const __m256 re = _mm256_moveldup_ps(b);
+    const __m256 im = _mm256_movehdup_ps(b);
+    const __m256 sw = _mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm256_addsub_ps(_mm256_mul_ps(a, re), _mm256_mul_ps(sw, im));
+}
+
+DSP_TARGET_AVX2
+void mix_iq_avx2(const int16_t* in, std::size_t pairs,
+                 std::complex<float> phase, std::complex<float> step,
+                 std::complex<float>* out)
+{
+    // Lane phasors phase * step^k (k = 0..3), advanced by step^4
+    alignas(32) std::complex<float> lanes[4];
+    lanes[0] = phase;
+    for (int k = 1; k < 4; k++) lanes[k] = lanes[k - 1] * step;
+
+    __m256 ph = _mm256_load_ps(reinterpret_cast<const float*>(lanes));
+    const std::complex<float> s4 = (step * step) * (step * step);
+    const __m256 adv = _mm256_setr_ps(s4.real(), s4.imag(), s4.real(), s4.imag(),
+                                      s4.real(), s4.imag(), s4.real(), s4.imag());
+
+    std::size_t i = 0;
+    for (; i + 4 <= pairs; i += 4) {
+        const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i));
+        const __m256 x = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(raw));
+
+        _mm256_storeu_ps(reinterpret_cast<float*>(out + i), cmul_avx2(x, ph));
+        ph = cmul_avx2(ph, adv);
+    }
+
+    _mm256_store_ps(reinterpret_cast<float*>(lanes), ph);
+    phase = lanes[0];
+
+    for (; i < pairs; i++) {
+        out[i] = std::complex<float>(in[2 * i], in[2 * i + 1]) * phase;
+        phase *= step;
+    }
+}
+
+DSP_TARGET_AVX2
+void fft_pass_avx2(std::complex<float>* data, std::size_t n, std::size_t half,
+                   const std::complex<float>* tw)
+{
+    // Stages narrower than one vector use the 128-bit butterflies
+    if (half < 4) {
+        fft_pass_sse41(data, n, half, tw);
+        return;
+    }
+
+    for (std::size_t base = 0; base < n; base += 2 * half) {
+        float* a = reinterpret_cast<float*>(data + base);
+        float* b = reinterpret_cast<float*>(data + base + half);
+        const float* w = reinterpret_cast<const float*>(tw);
+
+        for (std::size_t k = 0; k < 2 * half; k += 8) {
+            const __m256 va = _mm256_loadu_ps(a + k);
+            const __m256 t  = cmul_avx2(_mm256_loadu_ps(b + k), _mm256_loadu_ps(w + k));
+            _mm256_storeu_ps(a + k, _mm256_add_ps(va, t));
+            _mm256_storeu_ps(b + k, _mm256_sub_ps(va, t));
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// AVX-512
+// ---------------------------------------------------------------------------
+
+// GCC 12's AVX-512 headers seed results with _mm512_undefined_ps(), which
+// trips -Wmaybe-uninitialized wherever those intrinsics are inlined.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+DSP_TARGET_AVX512
+inline __m512 fast_atan2_avx512(__m512 y, __m512 x)
+{
+    const __m512 ax = _mm512_abs_ps(x);
+    const __m512 ay = _mm512_abs_ps(y);
+    const __m512 mn = _mm512_min_ps(ax, ay);
+    const __m512 mx = _mm512_max_ps(_mm512_max_ps(ax, ay), _mm512_set1_ps(FLT_MIN));
+    const __m512 a  = _mm512_div_ps(mn, mx);
+    const __m512 z  = _mm512_mul_ps(a, a);
+
+    __m512 r = _mm512_fmadd_ps(_mm512_set1_ps(kAtanC9), z, _mm512_set1_ps(kAtanC7));
+    r = _mm512_fmadd_ps(r, z, _mm512_set1_ps(kAtanC5));
+    r = _mm512_fmadd_ps(r, z, _mm512_set1_ps(kAtanC3));
+    r = _mm512_fmadd_ps(r, z, _mm512_set1_ps(kAtanC1));
+    r = _mm512_mul_ps(r, a);
+
+    r = _mm512_mask_sub_ps(r, _mm512_cmp_ps_mask(ay, ax, _CMP_GT_OQ),
+                           _mm512_set1_ps(kHalfPi), r);
+    r = _mm512_mask_sub_ps(r, _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_LT_OQ),
+                           _mm512_set1_ps(kPi), r);
+
+    // Copy the sign of y (integer ops: float logic needs AVX-512DQ)
+    const __m512i sign = _mm512_and_epi32(_mm512_castps_si512(y),
+                                          _mm512_set1_epi32(static_cast<int>(0x80000000u)));
+    return _mm512_castsi512_ps(_mm512_xor_epi32(_mm512_castps_si512(r), sign));
+}
+
+DSP_TARGET_AVX512
+inline void deinterleave_avx512(const float* p, __m512& re, __m512& im)
+{
+    const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14,
+                                           16, 18, 20, 22, 24, 26, 28, 30);
+    const __m512i odd  = _mm512_add_epi32(even, _mm512_set1_epi32(1));
+
+    const __m512 v0 = _mm512_loadu_ps(p);
+    const __m512 v1 = _mm512_loadu_ps(p + 16);
+    re = _mm512_permutex2var_ps(v0, even, v1);
+    im = _mm512_permutex2var_ps(v0, odd, v1);
+}
+
+DSP_TARGET_AVX512
+void demodulate_fm_avx512(const std::complex<float>* in, std::size_t n,
+                          std::complex<float> prev, float* out)
+{
+    if (n == 0) return;
+
+    const auto first = in[0] * std::conj(prev);
+    out[0] = fast_atan2(first.imag(), first.real());
+
+    const float* p = reinterpret_cast<const float*>(in);
+    std::size_t i = 1;
+
+    for (; i + 16 <= n; i += 16) {
+        __m512 cr, ci, pr, pi;
+        deinterleave_avx512(p + 2 * i, cr, ci);
+        deinterleave_avx512(p + 2 * (i - 1), pr, pi);
+
+        const __m512 re = _mm512_fmadd_ps(cr, pr, _mm512_mul_ps(ci, pi));
+        const __m512 im = _mm512_fmsub_ps(ci, pr, _mm512_mul_ps(cr, pi));
+
+        _mm512_storeu_ps(out + i, fast_atan2_avx512(im, re));
+    }
+
+    for (; i < n; i++) {
+        const auto prod = in[i] * std::conj(in[i - 1]);
+        out[i] = fast_atan2(prod.imag(), prod.real());
+    }
+}
+
+DSP_TARGET_AVX512
+void demodulate_am_avx512(const std::complex<float>* in, std::size_t n,
+                          float* out)
+{
+    const float* p = reinterpret_cast<const float*>(in);
+    std::size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m512 re, im;
+        deinterleave_avx512(p + 2 * i, re, im);
+
+        const __m512 mag2 = _mm512_fmadd_ps(re, re, _mm512_mul_ps(im, im));
+        _mm512_storeu_ps(out + i, _mm512_sqrt_ps(mag2));
+    }
+
+    for (; i < n; i++)
+        out[i] = std::abs(in[i]);
+}
+
+DSP_TARGET_AVX512
+void fir_decimate_cf_avx512(const std::complex<float>* x, std::size_t n_out,
+                            std::size_t step, const float* taps2,
+                            std::size_t ntaps, std::complex<float>* out)
+{
+    const std::size_t nf = 2 * ntaps;
+
+    for (std::size_t m = 0; m < n_out; m++) {
+        const float* w = reinterpret_cast<const float*>(x + m * step);
+        __m512 acc = _mm512_setzero_ps();
+
+        for (std::size_t j = 0; j < nf; j += 16)
+            acc = _mm512_fmadd_ps(_mm512_loadu_ps(taps2 + j), _mm512_loadu_ps(w + j), acc);
+
+        // Fold 16 lanes down to [re, im]
+        const __m256 a8 = _mm256_add_ps(_mm512_castps512_ps256(acc),
+                                        _mm256_castpd_ps(_mm512_extractf64x4_pd(
+                                            _mm512_castps_pd(acc), 1)));
+        __m128 a4 = _mm_add_ps(_mm256_castps256_ps128(a8), _mm256_extractf128_ps(a8, 1));
+        a4 = _mm_add_ps(a4, _mm_movehl_ps(a4, a4));
+        _mm_storel_pi(reinterpret_cast<__m64*>(out + m), a4);
+    }
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+DSP_TARGET_SSE41
+void float_to_s16_sse41(const float* in, std::size_t n, float scale, int16_t* out)
+{
+    // Clamp in float first: cvtps2dq turns out-of-range values into INT_MIN
+    const __m128 k  = _mm_set1_ps(scale);
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    std::size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        const __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i),     k), lo), hi);
+        const __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 4), k), lo), hi);
+
+        const __m128i s16 = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), s16);
+    }
+
+    for (; i < n; i++) {
+        const __m128 v = _mm_min_ss(_mm_max_ss(_mm_mul_ss(_mm_set_ss(in[i]), k), lo), hi);
+        out[i] = static_cast<int16_t>(_mm_cvtss_si32(v));
+    }
+}
+
+DSP_TARGET_AVX2
+void float_to_s16_avx2(const float* in, std::size_t n, float scale, int16_t* out)
+{
+    const __m256 k  = _mm256_set1_ps(scale);
+    const __m256 lo = _mm256_set1_ps(-32768.0f);
+    const __m256 hi = _mm256_set1_ps(32767.0f);
+    std::size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        const __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i),     k), lo), hi);
+        const __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i + 8), k), lo), hi);
+
+        // packs works per 128-bit lane: [a0 b0 a1 b1] -> [a0 a1 b0 b1]
+        const __m256i s16 = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+                            _mm256_permute4x64_epi64(s16, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+
+    // Tail stays VEX-encoded: tail-calling the SSE4.1 kernel with dirty
+    // upper halves costs an AVX-SSE transition on every chunk
+    const __m128 lo1 = _mm256_castps256_ps128(lo);
+    const __m128 hi1 = _mm256_castps256_ps128(hi);
+    for (; i < n; i++) {
+        const __m128 v = _mm_min_ss(_mm_max_ss(_mm_mul_ss(_mm_set_ss(in[i]), _mm_set_ss(scale)), lo1), hi1);
+        out[i] = static_cast<int16_t>(_mm_cvtss_si32(v));
+    }
+}
+
+// Block power: |z|^2 summed over a block is the sum of squares of every
+// float, so no deinterleave is needed. Two accumulators hide the add latency.
+
+DSP_TARGET_SSE41
+float power_cf_sse41(const std::complex<float>* in, std::size_t n)
+{
+    const float* p = reinterpret_cast<const float*>(in);
+    const std::size_t nf = 2 * n;
+    __m128 a0 = _mm_setzero_ps();
+    __m128 a1 = _mm_setzero_ps();
+    std::size_t i = 0;
+
+    for (; i + 8 <= nf; i += 8) {
+        const __m128 v0 = _mm_loadu_ps(p + i);
+        const __m128 v1 = _mm_loadu_ps(p + i + 4);
+        a0 = _mm_add_ps(a0, _mm_mul_ps(v0, v0));
+        a1 = _mm_add_ps(a1, _mm_mul_ps(v1, v1));
+    }
+
+    __m128 a = _mm_add_ps(a0, a1);
+    a = _mm_add_ps(a, _mm_movehl_ps(a, a));
+    a = _mm_add_ss(a, _mm_shuffle_ps(a, a, 1));
+
+    float sum = _mm_cvtss_f32(a);
+    for (; i < nf; i++)
+        sum += p[i] * p[i];
+    return sum;
+}
+
+DSP_TARGET_AVX2
+float power_cf_avx2(const std::complex<float>* in, std::size_t n)
+{
+    const float* p = reinterpret_cast<const float*>(in);
+    const std::size_t nf = 2 * n;
+    __m256 a0 = _mm256_setzero_ps();
+    __m256 a1 = _mm256_setzero_ps();
+    std::size_t i = 0;
+
+    for (; i + 16 <= nf; i += 16) {
+        const __m256 v0 = _mm256_loadu_ps(p + i);
+        const __m256 v1 = _mm256_loadu_ps(p + i + 8);
+        a0 = _mm256_add_ps(a0, _mm256_mul_ps(v0, v0));
+        a1 = _mm256_add_ps(a1, _mm256_mul_ps(v1, v1));
+    }
+
+    const __m256 a8 = _mm256_add_ps(a0, a1);
+    __m128 a = _mm_add_ps(_mm256_castps256_ps128(a8), _mm256_extractf128_ps(a8, 1));
+    a = _mm_add_ps(a, _mm_movehl_ps(a, a));
+    a = _mm_add_ss(a, _mm_shuffle_ps(a, a, 1));
+
+    float sum = _mm_cvtss_f32(a);
+    for (; i < nf; i++)
+        sum += p[i] * p[i];
+    return sum;
+}
+
+// Stereo pilot correlator: lane phasors in split re/im form, advanced by
+// step^lanes per iteration like the NCO mixers.
+
+/// Scalar remainder of the pilot_mix kernels; accumulates into @p acc.
+inline std::complex<float> pilot_mix_tail(const float* mpx, std::size_t n,
+                                          std::complex<float> phase, std::complex<float> step,
+                                          float pilot, float diff_gain, float* sum, float* diff,
+                                          std::complex<float> acc)
+{
+    float re = acc.real();
+    float im = acc.imag();
+    for (std::size_t i = 0; i < n; i++) {
+        const float m = mpx[i];
+        re += m * phase.real();
+        im += m * phase.imag();
+        const float s = m - pilot * phase.imag();
+        sum[i]  = s;
+        diff[i] = diff_gain * s * phase.real() * phase.imag();
+        phase *= step;
+    }
+    return {re, im};
+}
+
+DSP_TARGET_SSE41
+std::complex<float> pilot_mix_sse41(const float* mpx, std::size_t n,
+                                    std::complex<float> phase, std::complex<float> step,
+                                    float pilot, float diff_gain, float* sum, float* diff)
+{
+    alignas(16) float lre[4];
+    alignas(16) float lim[4];
+    std::complex<float> p = phase;
+    for (int k = 0; k < 4; k++) {
+        lre[k] = p.real();
+        lim[k] = p.imag();
+        p *= step;
+    }
+
+    __m128 pr = _mm_load_ps(lre);
+    __m128 pi = _mm_load_ps(lim);
+    const std::complex<float> s4 = (step * step) * (step * step);
+    const __m128 ar = _mm_set1_ps(s4.real());
+    const __m128 ai = _mm_set1_ps(s4.imag());
+    const __m128 vp = _mm_set1_ps(pilot);
+    const __m128 vg = _mm_set1_ps(diff_gain);
+    __m128 cr = _mm_setzero_ps();
+    __m128 ci = _mm_setzero_ps();
+
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 m = _mm_loadu_ps(mpx + i);
+        cr = _mm_add_ps(cr, _mm_mul_ps(m, pr));
+        ci = _mm_add_ps(ci, _mm_mul_ps(m, pi));
+        const __m128 s = _mm_sub_ps(m, _mm_mul_ps(vp, pi));
+        _mm_storeu_ps(sum + i, s);
+        _mm_storeu_ps(diff + i, _mm_mul_ps(_mm_mul_ps(vg, s), _mm_mul_ps(pr, pi)));
+
+        const __m128 nr = _mm_sub_ps(_mm_mul_ps(pr, ar), _mm_mul_ps(pi, ai));
+        pi = _mm_add_ps(_mm_mul_ps(pr, ai), _mm_mul_ps(pi, ar));
+        pr = nr;
+    }
+
+    phase = {_mm_cvtss_f32(pr), _mm_cvtss_f32(pi)};
+    return pilot_mix_tail(mpx + i, n - i, phase, step, pilot, diff_gain, sum + i, diff + i,
+                          {hsum_sse41(cr), hsum_sse41(ci)});
+}
+
+DSP_TARGET_AVX2
+std::complex<float> pilot_mix_avx2(const float* mpx, std::size_t n,
+                                   std::complex<float> phase, std::complex<float> step,
+                                   float pilot, float diff_gain, float* sum, float* diff)
+{
+    alignas(32) float lre[8];
+    alignas(32) float lim[8];
+    std::complex<float> p = phase;
+    for (int k = 0; k < 8; k++) {
+        lre[k] = p.real();
+        lim[k] = p.imag();
+        p *= step;
+    }
+
+    __m256 pr = _mm256_load_ps(lre);
+    __m256 pi = _mm256_load_ps(lim);
+    const std::complex<float> s2 = step * step;
+    const std::complex<float> s8 = (s2 * s2) * (s2 * s2);
+    const __m256 ar = _mm256_set1_ps(s8.real());
+    const __m256 ai = _mm256_set1_ps(s8.imag());
+    const __m256 vp = _mm256_set1_ps(pilot);
+    const __m256 vg = _mm256_set1_ps(diff_gain);
+    __m256 cr = _mm256_setzero_ps();
+    __m256 ci = _mm256_setzero_ps();
+
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 m = _mm256_loadu_ps(mpx + i);
+        cr = _mm256_add_ps(cr, _mm256_mul_ps(m, pr));
+        ci = _mm256_add_ps(ci, _mm256_mul_ps(m, pi));
+        const __m256 s = _mm256_sub_ps(m, _mm256_mul_ps(vp, pi));
+        _mm256_storeu_ps(sum + i, s);
+        _mm256_storeu_ps(diff + i, _mm256_mul_ps(_mm256_mul_ps(vg, s), _mm256_mul_ps(pr, pi)));
+
+        const __m256 nr = _mm256_sub_ps(_mm256_mul_ps(pr, ar), _mm256_mul_ps(pi, ai));
+        pi = _mm256_add_ps(_mm256_mul_ps(pr, ai), _mm256_mul_ps(pi, ar));
+        pr = nr;
+    }
+
+    phase = {_mm256_cvtss_f32(pr), _mm256_cvtss_f32(pi)};
+    const float re = hsum_sse41(_mm_add_ps(_mm256_castps256_ps128(cr), _mm256_extractf128_ps(cr, 1)));
+    const float im = hsum_sse41(_mm_add_ps(_mm256_castps256_ps128(ci), _mm256_extractf128_ps(ci, 1)));
+    return pilot_mix_tail(mpx + i, n - i, phase, step, pilot, diff_gain, sum + i, diff + i,
+                          {re, im});
+}
+
+// De-emphasis: the one-pole recursion unrolled four outputs at a time,
+// y[k] = sum_{j<=k} a b^(k-j) x[j] + b^(k+1) y[-1] with b = 1 - a, so each
+// step depends on the previous one through a single multiply-add. Wider
+// vectors would only lengthen that chain, so AVX2 keeps this kernel.
+
+DSP_TARGET_SSE41
+float deemphasis_sse41(float* data, std::size_t n, float a, float y)
+{
+    const float b = 1.0f - a;
+    const float b2 = b * b;
+    const float b3 = b2 * b;
+    const __m128 c0 = _mm_setr_ps(a, a * b, a * b2, a * b3);
+    const __m128 c1 = _mm_setr_ps(0.0f, a, a * b, a * b2);
+    const __m128 c2 = _mm_setr_ps(0.0f, 0.0f, a, a * b);
+    const __m128 c3 = _mm_setr_ps(0.0f, 0.0f, 0.0f, a);
+    const __m128 cy = _mm_setr_ps(b, b2, b3, b2 * b2);
+    __m128 vy = _mm_set1_ps(y);
+
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 x = _mm_loadu_ps(data + i);
+        __m128 acc = _mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(0, 0, 0, 0)), c0);
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1)), c1));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 2, 2)), c2));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3)), c3));
+        acc = _mm_add_ps(acc, _mm_mul_ps(vy, cy));
+        _mm_storeu_ps(data + i, acc);
+        vy = _mm_shuffle_ps(acc, acc, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+
+    y = _mm_cvtss_f32(vy);
+    for (; i < n; i++) {
+        y += a * (data[i] - y);
+        data[i] = y;
+    }
+    return y;
+}
+
+// Fixed-point FM chain. The discriminator forms cur * conj(prev) with
+// pmaddwd straight on interleaved pairs and runs the CORDIC of
+// cordic_atan2_q15() on 32-bit lanes; both are bit-exact against scalar.
+// The audio decimator sees a fifth of the discriminator's samples, so AVX2
+// keeps its SSE4.1 kernel.
+
+/// Scalar discriminator for the samples around the vector loops.
+inline int16_t discriminate_q15(const int16_t* cur, int32_t prev_i, int32_t prev_q)
+{
+    return cordic_atan2_q15(cur[1] * prev_i - cur[0] * prev_q, cur[0] * prev_i + cur[1] * prev_q);
+}
+
+/// Re and Im of cur * conj(prev) for the four pairs in @p c and @p p.
+DSP_TARGET_SSE41
+inline void conj_product_q15_sse41(__m128i c, __m128i p, __m128i& re, __m128i& im)
+{
+    // [prev_q, prev_i] per pair, prev_q negated: 0xffff is -1 in the low half
+    const __m128i sw = _mm_shufflehi_epi16(_mm_shufflelo_epi16(p, _MM_SHUFFLE(2, 3, 0, 1)),
+                                           _MM_SHUFFLE(2, 3, 0, 1));
+    re = _mm_madd_epi16(c, p);
+    im = _mm_madd_epi16(c, _mm_sign_epi16(sw, _mm_set1_epi32(0x0001ffff)));
+}
+
+/// cordic_atan2_q15() of four lanes, the Q15 angle sign-extended to 32 bits.
+DSP_TARGET_SSE41
+inline __m128i cordic_sse41(__m128i im, __m128i re)
+{
+    // cordic_norm_shift() from the float exponent e of (m >> 7) | 1, which
+    // is exact; 2^(150 - e) is rebuilt as a float and scales by mullo
+    const __m128i m = _mm_or_si128(_mm_abs_epi32(re), _mm_abs_epi32(im));
+    const __m128i e = _mm_srli_epi32(_mm_castps_si128(_mm_cvtepi32_ps(
+        _mm_or_si128(_mm_srli_epi32(m, 7), _mm_set1_epi32(1)))), 23);
+    const __m128i scale = _mm_cvttps_epi32(_mm_castsi128_ps(
+        _mm_slli_epi32(_mm_sub_epi32(_mm_set1_epi32(277), e), 23)));
+
+    __m128i x = _mm_srai_epi32(_mm_mullo_epi32(re, scale), 2);
+    __m128i y = _mm_srai_epi32(_mm_mullo_epi32(im, scale), 2);
+
+    const __m128i s = _mm_srai_epi32(x, 31);
+    x = _mm_sub_epi32(_mm_xor_si128(x, s), s);
+    y = _mm_sub_epi32(_mm_xor_si128(y, s), s);
+    __m128i z = _mm_and_si128(s, _mm_set1_epi32(INT32_MIN));
+
+    for (int k = 0; k < kCordicSteps; k++) {
+        const __m128i cnt = _mm_cvtsi32_si128(k);
+        const __m128i d  = _mm_srai_epi32(y, 31);
+        const __m128i dx = _mm_sub_epi32(_mm_xor_si128(_mm_sra_epi32(y, cnt), d), d);
+        const __m128i dy = _mm_sub_epi32(_mm_xor_si128(_mm_sra_epi32(x, cnt), d), d);
+        const __m128i a  = _mm_set1_epi32(kCordicAtan[static_cast<std::size_t>(k)]);
+        x = _mm_add_epi32(x, dx);
+        y = _mm_sub_epi32(y, dy);
+        z = _mm_add_epi32(z, _mm_sub_epi32(_mm_xor_si128(a, d), d));
+    }
+    const __m128i a = _mm_srai_epi32(_mm_add_epi32(z, _mm_set1_epi32(0x8000)), 16);
+    return _mm_andnot_si128(_mm_cmpeq_epi32(m, _mm_setzero_si128()), a);
+}
+
+DSP_TARGET_SSE41
+void demodulate_fm_q15_sse41(const int16_t* in, std::size_t n,
+                             int16_t prev_i, int16_t prev_q, int16_t* out)
+{
+    if (n == 0) return;
+
+    out[0] = discriminate_q15(in, prev_i, prev_q);
+    std::size_t i = 1;
+
+    // Two sets of four lanes per iteration keep both CORDIC chains in flight
+    for (; i + 8 <= n; i += 8) {
+        const __m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i));
+        const __m128i c1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i + 8));
+        const __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * (i - 1)));
+        const __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * (i - 1) + 8));
+
+        __m128i re0, im0, re1, im1;
+        conj_product_q15_sse41(c0, p0, re0, im0);
+        conj_product_q15_sse41(c1, p1, re1, im1);
+
+        const __m128i a = _mm_packs_epi32(cordic_sse41(im0, re0), cordic_sse41(im1, re1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), a);
+    }
+
+    for (; i < n; i++)
+        out[i] = discriminate_q15(in + 2 * i, in[2 * i - 2], in[2 * i - 1]);
+}
+
+DSP_TARGET_AVX2
+inline __m256i cordic_avx2(__m256i im, __m256i re)
+{
+    // As cordic_sse41(), with the shift count 150 - e applied by sllv
+    const __m256i m = _mm256_or_si256(_mm256_abs_epi32(re), _mm256_abs_epi32(im));
+    const __m256i e = _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(
+        _mm256_or_si256(_mm256_srli_epi32(m, 7), _mm256_set1_epi32(1)))), 23);
+    const __m256i shift = _mm256_sub_epi32(_mm256_set1_epi32(150), e);
+
+    __m256i x = _mm256_srai_epi32(_mm256_sllv_epi32(re, shift), 2);
+    __m256i y = _mm256_srai_epi32(_mm256_sllv_epi32(im, shift), 2);
+
+    const __m256i s = _mm256_srai_epi32(x, 31);
+    x = _mm256_sub_epi32(_mm256_xor_si256(x, s), s);
+    y = _mm256_sub_epi32(_mm256_xor_si256(y, s), s);
+    __m256i z = _mm256_and_si256(s, _mm256_set1_epi32(INT32_MIN));
+
+    for (int k = 0; k < kCordicSteps; k++) {
+        const __m128i cnt = _mm_cvtsi32_si128(k);
+        const __m256i d  = _mm256_srai_epi32(y, 31);
+        const __m256i dx = _mm256_sub_epi32(_mm256_xor_si256(_mm256_sra_epi32(y, cnt), d), d);
+        const __m256i dy = _mm256_sub_epi32(_mm256_xor_si256(_mm256_sra_epi32(x, cnt), d), d);
+        const __m256i a  = _mm256_set1_epi32(kCordicAtan[static_cast<std::size_t>(k)]);
+        x = _mm256_add_epi32(x, dx);
+        y = _mm256_sub_epi32(y, dy);
+        z = _mm256_add_epi32(z, _mm256_sub_epi32(_mm256_xor_si256(a, d), d));
+    }
+    const __m256i a = _mm256_srai_epi32(_mm256_add_epi32(z, _mm256_set1_epi32(0x8000)), 16);
+    return _mm256_andnot_si256(_mm256_cmpeq_epi32(m, _mm256_setzero_si256()), a);
+}
+
+DSP_TARGET_AVX2
+void demodulate_fm_q15_avx2(const int16_t* in, std::size_t n,
+                            int16_t prev_i, int16_t prev_q, int16_t* out)
+{
+    if (n == 0) return;
+
+    out[0] = discriminate_q15(in, prev_i, prev_q);
+    std::size_t i = 1;
+
+    const __m256i neg_q = _mm256_set1_epi32(0x0001ffff);
+    for (; i + 8 <= n; i += 8) {
+        const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 2 * i));
+        const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 2 * (i - 1)));
+
+        const __m256i sw = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(p, _MM_SHUFFLE(2, 3, 0, 1)),
+                                                  _MM_SHUFFLE(2, 3, 0, 1));
+        const __m256i re = _mm256_madd_epi16(c, p);
+        const __m256i im = _mm256_madd_epi16(c, _mm256_sign_epi16(sw, neg_q));
+
+        // madd keeps pair order within each 128-bit lane
+        const __m256i a = cordic_avx2(im, re);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                         _mm_packs_epi32(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1)));
+    }
+
+    for (; i < n; i++)
+        out[i] = discriminate_q15(in + 2 * i, in[2 * i - 2], in[2 * i - 1]);
+}
+
+/// Feed one sample to the open Q15 audio window.
+inline void audio_q15_step(int16_t x, int decim, FixedGain gain, AudioDecimStateQ15& state,
+                           int16_t* out, std::size_t& written)
+{
+    state.accumulator += x;
+
+    if (++state.counter == decim) {
+        out[written++] = detail::apply_gain_q15(state.accumulator, gain);
+        state.accumulator = 0;
+        state.counter = 0;
+    }
+}
+
+/// Body of downsample_audio_q15_sse41(); D > 0 compiles the window length in.
+template <int D>
+DSP_TARGET_SSE41
+inline std::size_t downsample_audio_q15_sse41_impl(const int16_t* in, std::size_t n,
+                                                   int decim, FixedGain gain,
+                                                   AudioDecimStateQ15& state, int16_t* out)
+{
+    std::size_t written = 0;
+    std::size_t i = 0;
+
+    // Complete the window left open by the previous block
+    for (; state.counter != 0 && i < n; i++)
+        audio_q15_step(in[i], decim, gain, state, out, written);
+
+    // Four output windows per iteration, one per lane; packs saturates
+    const std::size_t d = static_cast<std::size_t>(D > 0 ? D : decim);
+    const __m128i pre = _mm_cvtsi32_si128(gain.pre_shift);
+    const __m128i post = _mm_cvtsi32_si128(gain.shift);
+    const __m128i mul = _mm_set1_epi32(gain.mul);
+    const __m128i rnd = _mm_set1_epi32(1 << (gain.shift - 1));
+
+    for (; i + 4 * d <= n; i += 4 * d) {
+        const int16_t* p = in + i;
+        __m128i acc = _mm_setzero_si128();
+
+        for (std::size_t k = 0; k < d; k++)
+            acc = _mm_add_epi32(acc, _mm_setr_epi32(p[k], p[d + k], p[2 * d + k], p[3 * d + k]));
+
+        __m128i v = _mm_mullo_epi32(_mm_sra_epi32(acc, pre), mul);
+        v = _mm_sra_epi32(_mm_add_epi32(v, rnd), post);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + written), _mm_packs_epi32(v, v));
+        written += 4;
+    }
+
+    for (; i < n; i++)
+        audio_q15_step(in[i], decim, gain, state, out, written);
+
+    return written;
+}
+
+DSP_TARGET_SSE41
+std::size_t downsample_audio_q15_sse41(const int16_t* in, std::size_t n,
+                                       int decim, FixedGain gain,
+                                       AudioDecimStateQ15& state, int16_t* out)
+{
+    switch (decim) {
+    case 5:  return downsample_audio_q15_sse41_impl<5>(in, n, decim, gain, state, out);
+    default: return downsample_audio_q15_sse41_impl<0>(in, n, decim, gain, state, out);
+    }
+}
+
+} // namespace
+
+KernelTable detail::sse41_kernels() noexcept
+{
+    KernelTable t;
+    t.downsample_iq    = {downsample_iq_sse41,    Isa::Sse41};
+    t.demodulate_fm    = {demodulate_fm_sse41,    Isa::Sse41};
+    t.demodulate_am    = {demodulate_am_sse41,    Isa::Sse41};
+    t.downsample_audio = {downsample_audio_sse41, Isa::Sse41};
+    t.fir_decimate     = {fir_decimate_sse41,     Isa::Sse41};
+    t.fir_decimate_cf  = {fir_decimate_cf_sse41,  Isa::Sse41};
+    t.mix_iq           = {mix_iq_sse41,           Isa::Sse41};
+    t.fft_pass         = {fft_pass_sse41,         Isa::Sse41};
+    t.float_to_s16     = {float_to_s16_sse41,     Isa::Sse41};
+    t.power_cf         = {power_cf_sse41,         Isa::Sse41};
+    t.pilot_mix        = {pilot_mix_sse41,        Isa::Sse41};
+    t.deemphasis       = {deemphasis_sse41,       Isa::Sse41};
+    t.downsample_iq_q15    = {downsample_iq_q15_sse41,    Isa::Sse41};
+    t.demodulate_fm_q15    = {demodulate_fm_q15_sse41,    Isa::Sse41};
+    t.downsample_audio_q15 = {downsample_audio_q15_sse41, Isa::Sse41};
+    return t;
+}
+
+KernelTable detail::avx2_kernels() noexcept
+{
+    KernelTable t;
+    t.downsample_iq    = {downsample_iq_avx2,    Isa::Avx2};
+    t.demodulate_fm    = {demodulate_fm_avx2,    Isa::Avx2};
+    t.demodulate_am    = {demodulate_am_avx2,    Isa::Avx2};
+    t.downsample_audio = {downsample_audio_avx2, Isa::Avx2};
+    t.fir_decimate     = {fir_decimate_avx2,     Isa::Avx2};
+    t.fir_decimate_cf  = {fir_decimate_cf_avx2,  Isa::Avx2};
+    t.mix_iq           = {mix_iq_avx2,           Isa::Avx2};
+    t.fft_pass         = {fft_pass_avx2,         Isa::Avx2};
+    t.float_to_s16     = {float_to_s16_avx2,     Isa::Avx2};
+    t.power_cf         = {power_cf_avx2,         Isa::Avx2};
+    t.pilot_mix        = {pilot_mix_avx2,        Isa::Avx2};
+    t.downsample_iq_q15 = {downsample_iq_q15_avx2, Isa::Avx2};
+    t.demodulate_fm_q15 = {demodulate_fm_q15_avx2, Isa::Avx2};
+    return t;
+}
+
+KernelTable detail::avx512_kernels() noexcept
+{
+    // Integer decimation, audio decimation, PCM conversion and block power are
+    // load-bound; the AVX2 variants already saturate them, so only the
+    // arithmetic-heavy kernels get 16-lane versions. The real FIR keeps AVX2 because tap
+    // counts are only padded to 8.
+    KernelTable t;
+    t.demodulate_fm   = {demodulate_fm_avx512,   Isa::Avx512};
+    t.demodulate_am   = {demodulate_am_avx512,   Isa::Avx512};
+    t.fir_decimate_cf = {fir_decimate_cf_avx512, Isa::Avx512};
+    return t;
+}
+
+} // namespace dsp
+
+#else // __x86_64__ || __i386__
+
+namespace dsp {
+
+KernelTable detail::sse41_kernels() noexcept { return {}; }
+KernelTable detail::avx2_kernels() noexcept { return {}; }
+KernelTable detail::avx512_kernels() noexcept { return {}; }
+
+} // namespace dsp
+
+#endif // __x86_64__ || __i386__
@@ -0,0 +1,64 @@
+#include "fft.hpp"
+#include "dsp_kernels.hpp"
+
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+#include <utility>
+
+namespace dsp {
+
+Fft::Fft(std::size_t n)
+    : n_{n}
+{
+    if (n < 2 || (n & (n - 1)) != 0)
+        throw std::invalid_argument("FFT size must be a power of two >= 2");
+
+    std::size_t bits = 0;
+    while ((std::size_t{1} << bits) < n) bits++;
+
+    bitrev_.resize(n);
+    for (std::size_t i = 0; i < n; i++) {
+        std::size_t r = 0;
+        for (std::size_t b = 0; b < bits; b++)
+            r |= ((i >> b) & 1u) << (bits - 1 - b);
+        bitrev_[i] = static_cast<std::uint32_t>(r);
+    }
+
+    twiddle_fwd_.resize(n - 1);
+    twiddle_inv_.resize(n - 1);
+    for (std::size_t half = 1; half < n; half <<= 1) {
+        for (std::size_t k = 0; k < half; k++) {
+            const double a = -std::numbers::pi * static_cast<double>(k) / static_cast<double>(half);
+            const std::complex<float> w(static_cast<float>(std::cos(a)),
+                                        static_cast<float>(std::sin(a)));
+            twiddle_fwd_[half - 1 + k] = w;
+            twiddle_inv_[half - 1 + k] = std::conj(w);
+        }
+    }
+}
+
+void Fft::forward(std::span<std::complex<float>> data) const noexcept
+{
+    execute(data.data(), twiddle_fwd_);
+}
+
+void Fft::inverse(std::span<std::complex<float>> data) const noexcept
+{
+    execute(data.data(), twiddle_inv_);
+}
+
+void Fft::execute(std::complex<float>* data,
+                  const std::vector<std::complex<float>>& twiddles) const noexcept
+{
+    for (std::size_t i = 0; i < n_; i++) {
+        const std::size_t r = bitrev_[i];
+        if (i < r) std::swap(data[i], data[r]);
+    }
+
+    const FftPassFn pass = kernels().fft_pass.fn;
+    for (std::size_t half = 1; half < n_; half <<= 1)
+        pass(data, n_, half, twiddles.data() + half - 1);
+}
+
+} // namespace dsp
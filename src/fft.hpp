@@ -0,0 +1,59 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * @file fft.hpp
+ * @brief In-place radix-2 complex FFT on the runtime-dispatched SIMD kernels.
+ */
+
+namespace dsp {
+
+/**
+ * @class Fft
+ * @brief Power-of-two complex FFT with precomputed twiddles.
+ *
+ * The bit-reversal table and per-stage twiddle tables are built once at
+ * construction; transforms then run log2(n) butterfly stages through
+ * kernels().fft_pass without allocating.
+ */
+class Fft {
+public:
+    /**
+     * @param n Transform size, a power of two >= 2
+     * @throws std::invalid_argument for other sizes
+     */
+    explicit Fft(std::size_t n);
+
+    /// Transform size.
+    [[nodiscard]] std::size_t size() const noexcept { return n_; }
+
+    /**
+     * @brief X[k] = sum_n x[n] e^{-j 2 pi k n / N}, in place.
+     * @param data Exactly size() samples
+     */
+    void forward(std::span<std::complex<float>> data) const noexcept;
+
+    /**
+     * @brief x[n] = sum_k X[k] e^{+j 2 pi k n / N}, in place (unnormalized).
+     * @param data Exactly size() samples
+     */
+    void inverse(std::span<std::complex<float>> data) const noexcept;
+
+private:
+    std::size_t n_;
+    std::vector<std::uint32_t> bitrev_;
+
+    // Stage twiddles, stage with half-size h at offset h - 1
+    std::vector<std::complex<float>> twiddle_fwd_;
+    std::vector<std::complex<float>> twiddle_inv_;
+
+    void execute(std::complex<float>* data,
+                 const std::vector<std::complex<float>>& twiddles) const noexcept;
+};
+
+} // namespace dsp
@@ -0,0 +1,230 @@
+#include "file_source.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <fcntl.h>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+void MappingDeleter::operator()(const int16_t* addr) const noexcept {
+    if (addr) ::munmap(const_cast<int16_t*>(addr), length);
+}
+
+namespace {
+
+constexpr std::string_view kSigmfData = ".sigmf-data";
+constexpr std::string_view kSigmfMeta = ".sigmf-meta";
+constexpr std::string_view kSigmfCi16 = "ci16_le";
+
+/// Bytes per interleaved int16 I/Q pair
+constexpr std::size_t kPairBytes = 2 * sizeof(int16_t);
+
+/// Closes a descriptor on scope exit (the mapping outlives it)
+struct FdGuard {
+    int fd;
+    ~FdGuard() { if (fd >= 0) ::close(fd); }
+};
+
+/**
+ * Raw text of the value following `"key":` in a JSON document, with string
+ * quotes stripped. Enough for the flat scalar fields SigMF keeps in
+ * `global`; not a general JSON parser.
+ */
+std::optional<std::string> json_value(const std::string& doc, std::string_view key)
+{
+    const std::string quoted = '"' + std::string(key) + '"';
+
+    auto pos = doc.find(quoted);
+    if (pos == std::string::npos) return std::nullopt;
+
+    pos = doc.find(':', pos + quoted.size());
+    if (pos == std::string::npos) return std::nullopt;
+
+    pos = doc.find_first_not_of(" \t\r\n", pos + 1);
+    if (pos == std::string::npos) return std::nullopt;
+
+    if (doc[pos] == '"') {
+        const auto end = doc.find('"', pos + 1);
+        if (end == std::string::npos) return std::nullopt;
+        return doc.substr(pos + 1, end - pos - 1);
+    }
+
+    const auto end = doc.find_first_of(",}] \t\r\n", pos);
+    return doc.substr(pos, end == std::string::npos ? end : end - pos);
+}
+
+/// Read `core:sample_rate` of a SigMF metadata file, checking the datatype.
+long long read_sigmf_rate(const std::string& meta_path)
+{
+    std::ifstream meta(meta_path);
+    if (!meta)
+        throw std::runtime_error("Failed to open SigMF metadata: " + meta_path);
+
+    std::ostringstream text;
+    text << meta.rdbuf();
+    const std::string doc = text.str();
+
+    const auto datatype = json_value(doc, "core:datatype");
+    if (datatype != kSigmfCi16)
+        throw std::runtime_error("Unsupported SigMF datatype (expected ci16_le): " +
+                                 datatype.value_or("missing"));
+
+    const auto rate = json_value(doc, "core:sample_rate");
+    double hz = 0.0;
+    try { hz = rate ? std::stod(*rate) : 0.0; }
+    catch (...) { hz = 0.0; }
+
+    if (!(hz >= 1.0))
+        throw std::runtime_error("Missing or invalid SigMF core:sample_rate");
+
+    return std::llround(hz);
+}
+
+} // namespace
+
+FileSource::FileSource(const std::string& path,
+                       std::size_t block_size,
+                       Pacing pacing,
+                       long long sample_rate_hz)
+    : block_size_{block_size}
+    , pacing_{pacing}
+    , sample_rate_{sample_rate_hz}
+{
+    if (block_size_ == 0)
+        throw std::invalid_argument("Block size must be non-zero");
+
+    std::string data_path = path;
+    const std::string_view p = path;
+
+    if (p.ends_with(kSigmfData) || p.ends_with(kSigmfMeta)) {
+        const std::string base = path.substr(0, path.size() - kSigmfData.size());
+        data_path    = base + std::string(kSigmfData);
+        sample_rate_ = read_sigmf_rate(base + std::string(kSigmfMeta));
+    }
+
+    if (sample_rate_ <= 0)
+        throw std::invalid_argument("Sample rate must be positive");
+
+    const FdGuard file{::open(data_path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (file.fd < 0)
+        throw std::runtime_error("Failed to open IQ file: " + data_path);
+
+    struct stat st{};
+    if (::fstat(file.fd, &st) < 0)
+        throw std::runtime_error("Failed to stat IQ file: " + data_path);
+
+    // A trailing partial I/Q pair is ignored; an empty file never maps
+    const std::size_t bytes = static_cast<std::size_t>(st.st_size);
+    const std::size_t pairs = bytes / kPairBytes;
+    if (pairs == 0)
+        return;
+
+    void* addr = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, file.fd, 0);
+    if (addr == MAP_FAILED)
+        throw std::runtime_error("Failed to map IQ file: " + data_path);
+
+    mapping_ = MappingPtr(static_cast<const int16_t*>(addr), MappingDeleter{bytes});
+    samples_ = {mapping_.get(), pairs * 2};
+
+    // Read-ahead hint only; failure is harmless
+    ::madvise(addr, bytes, MADV_SEQUENTIAL);
+}
+
+std::span<const int16_t> FileSource::next_block()
+{
+    if (offset_ >= samples_.size())
+        return {};
+
+    if (offset_ == 0)
+        start_ = std::chrono::steady_clock::now();
+
+    const std::size_t len = std::min(block_size_ * 2, samples_.size() - offset_);
+    const auto block = samples_.subspan(offset_, len);
+    offset_ += len;
+
+    // Release each block when the SDR would have finished capturing it
+    if (pacing_ == Pacing::Realtime) {
+        const std::chrono::duration<double> captured{
+            static_cast<double>(offset_ / 2) / static_cast<double>(sample_rate_)};
+        std::this_thread::sleep_until(
+            start_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(captured));
+    }
+
+    return block;
+}
+
+bool FileSource::set_block_size(std::size_t pairs)
+{
+    if (pairs == 0)
+        return false;
+    block_size_ = pairs;
+    return true;
+}
+
+void FileSource::rewind() noexcept
+{
+    offset_ = 0;
+}
+
+StreamSource::StreamSource(int fd, std::size_t block_size, long long sample_rate_hz)
+    : fd_{fd}
+    , block_size_{block_size}
+    , sample_rate_{sample_rate_hz}
+{
+    if (block_size_ == 0)
+        throw std::invalid_argument("Block size must be non-zero");
+
+    buffer_.resize(block_size_ * 2);
+}
+
+bool StreamSource::set_block_size(std::size_t pairs)
+{
+    if (pairs == 0 || eof_)
+        return false;
+    block_size_ = pairs;
+    buffer_.resize(block_size_ * 2);
+    return true;
+}
+
+std::span<const int16_t> StreamSource::next_block()
+{
+    if (eof_)
+        return {};
+
+    auto* bytes = reinterpret_cast<char*>(buffer_.data());
+    const std::size_t want = buffer_.size() * sizeof(int16_t);
+    std::size_t got = 0;
+
+    // Pipes return short reads; only end of stream or an error ends a block early
+    while (got < want) {
+        const ssize_t r = ::read(fd_, bytes + got, want - got);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0) {
+            eof_ = true;
+            break;
+        }
+        got += static_cast<std::size_t>(r);
+    }
+
+    return {buffer_.data(), got / kPairBytes * 2};
+}
+
+std::unique_ptr<SampleSource> open_recording(const std::string& path,
+                                             std::size_t block_size,
+                                             Pacing pacing,
+                                             long long sample_rate_hz)
+{
+    if (path == "-")
+        return std::make_unique<StreamSource>(STDIN_FILENO, block_size, sample_rate_hz);
+
+    return std::make_unique<FileSource>(path, block_size, pacing, sample_rate_hz);
+}
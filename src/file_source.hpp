@@ -0,0 +1,135 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "sample_source.hpp"
+
+/**
+ * @file file_source.hpp
+ * @brief Recorded IQ replay sources: memory-mapped files and pipes.
+ */
+
+/// Rate assumed for a raw recording without metadata (the PlutoSDR rate).
+inline constexpr long long kDefaultRecordingRateHz = 2'400'000;
+
+/// Replay speed of a recorded capture.
+enum class Pacing {
+    MaxSpeed, ///< Hand out blocks as fast as the receiver consumes them
+    Realtime  ///< Throttle to the recording's sample rate, like the SDR
+};
+
+/// RAII deleter for a read-only file mapping of `length` bytes.
+struct MappingDeleter {
+    std::size_t length = 0;
+    void operator()(const int16_t* addr) const noexcept;
+};
+
+using MappingPtr = std::unique_ptr<const int16_t, MappingDeleter>;
+
+/**
+ * @class FileSource
+ * @brief Replays a raw int16 interleaved IQ recording straight from its
+ *        mapped pages.
+ *
+ * The file is mapped read-only and next_block() returns spans into the
+ * mapping, so no sample is copied between the page cache and the DSP chain.
+ *
+ * Paths ending in `.sigmf-data` or `.sigmf-meta` are read as a SigMF
+ * recording: the sample rate comes from `core:sample_rate` of the metadata
+ * file and `core:datatype` must be `ci16_le`. Any other path is raw IQ at
+ * the rate given to the constructor.
+ */
+class FileSource final : public SampleSource {
+public:
+    /**
+     * @param path            Raw IQ file, or either file of a SigMF pair
+     * @param block_size      IQ pairs per block
+     * @param pacing          Replay speed
+     * @param sample_rate_hz  Rate of a raw recording (ignored for SigMF)
+     *
+     * @throws std::runtime_error if the file cannot be opened or mapped, or
+     *         the SigMF metadata is missing or unsupported
+     * @throws std::invalid_argument if @p block_size is zero
+     */
+    FileSource(const std::string& path,
+               std::size_t block_size,
+               Pacing pacing = Pacing::MaxSpeed,
+               long long sample_rate_hz = kDefaultRecordingRateHz);
+
+    std::span<const int16_t> next_block() override;
+
+    [[nodiscard]] std::size_t block_size() const noexcept override { return block_size_; }
+    [[nodiscard]] long long sample_rate() const noexcept override { return sample_rate_; }
+    [[nodiscard]] bool live() const noexcept override { return false; }
+    bool set_block_size(std::size_t pairs) override;
+
+    /// Number of IQ pairs in the recording.
+    [[nodiscard]] std::size_t total_pairs() const noexcept { return samples_.size() / 2; }
+
+    /// Restart the replay from the first sample.
+    void rewind() noexcept;
+
+private:
+    std::size_t block_size_;
+    Pacing pacing_;
+    long long sample_rate_;
+
+    MappingPtr mapping_;
+    std::span<const int16_t> samples_;
+    std::size_t offset_ = 0; ///< Next int16 to hand out
+
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @class StreamSource
+ * @brief Reads raw int16 interleaved IQ from a pipe or terminal (e.g. stdin).
+ *
+ * Unlike FileSource the data cannot be mapped, so each block is read into
+ * one reused buffer, filled completely unless the stream ends. The writer
+ * on the other end sets the pace.
+ */
+class StreamSource final : public SampleSource {
+public:
+    /**
+     * @param fd              Descriptor to read from; not closed by this object
+     * @param block_size      IQ pairs per block
+     * @param sample_rate_hz  Rate of the stream
+     *
+     * @throws std::invalid_argument if @p block_size is zero
+     */
+    StreamSource(int fd, std::size_t block_size, long long sample_rate_hz = kDefaultRecordingRateHz);
+
+    std::span<const int16_t> next_block() override;
+
+    [[nodiscard]] std::size_t block_size() const noexcept override { return block_size_; }
+    [[nodiscard]] long long sample_rate() const noexcept override { return sample_rate_; }
+    [[nodiscard]] bool live() const noexcept override { return false; }
+
+    /// Resizes the read buffer (allocates when growing).
+    bool set_block_size(std::size_t pairs) override;
+
+private:
+    int fd_;
+    std::size_t block_size_;
+    long long sample_rate_;
+
+    std::vector<int16_t> buffer_;
+    bool eof_ = false;
+};
+
+/**
+ * @brief Open a recorded capture as a sample source.
+ * @param path  File path, or "-" for standard input
+ * @return FileSource for a path, StreamSource for "-"
+ */
+std::unique_ptr<SampleSource> open_recording(const std::string& path,
+                                             std::size_t block_size,
+                                             Pacing pacing = Pacing::MaxSpeed,
+                                             long long sample_rate_hz = kDefaultRecordingRateHz);
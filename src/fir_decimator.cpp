@@ -0,0 +1,55 @@
+#include "fir_decimator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+namespace dsp {
+
+namespace {
+
+/// Zeroth-order modified Bessel function of the first kind (power series).
+double bessel_i0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    const double q = x * x / 4.0;
+
+    for (int k = 1; k < 50; k++) {
+        term *= q / (static_cast<double>(k) * k);
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+} // namespace
+
+void design_lowpass(std::span<float> taps, float cutoff, float kaiser_beta)
+{
+    const std::size_t n = taps.size();
+    if (n == 0) return;
+
+    const double mid  = (static_cast<double>(n) - 1.0) / 2.0;
+    const double norm = bessel_i0(kaiser_beta);
+    double sum = 0.0;
+    std::vector<double> h(n);
+
+    for (std::size_t i = 0; i < n; i++) {
+        const double t = static_cast<double>(i) - mid;
+        const double x = 2.0 * cutoff * t;
+        const double sinc = (t == 0.0) ? 1.0
+            : std::sin(std::numbers::pi * x) / (std::numbers::pi * x);
+
+        const double r = (n > 1) ? t / mid : 0.0;
+        const double window = bessel_i0(kaiser_beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / norm;
+
+        h[i] = sinc * window;
+        sum += h[i];
+    }
+
+    for (std::size_t i = 0; i < n; i++)
+        taps[i] = static_cast<float>(h[i] / sum);
+}
+
+} // namespace dsp
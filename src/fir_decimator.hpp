@@ -0,0 +1,334 @@
+#pragma once
+
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "dsp_kernels.hpp"
+
+/**
+ * @file fir_decimator.hpp
+ * @brief Streaming polyphase FIR decimators (anti-aliased alternative to the
+ *        boxcar downsample_iq / downsample_audio stages).
+ */
+
+namespace dsp {
+
+/**
+ * @brief Design a Kaiser-windowed sinc low-pass filter.
+ *
+ * @param taps        Output coefficients (filter length = taps.size())
+ * @param cutoff      -6 dB corner as a fraction of the input sample rate
+ *                    (0 < cutoff < 0.5)
+ * @param kaiser_beta Kaiser window shape; 7 gives roughly 70 dB stopband
+ *
+ * @note Coefficients are normalized to unity DC gain.
+ */
+void design_lowpass(std::span<float> taps, float cutoff, float kaiser_beta = 7.0f);
+
+/**
+ * @brief Default filter length and corner for a decimation factor.
+ *
+ * The generic design keeps 8 taps per polyphase branch and places the corner
+ * just below the output Nyquist frequency. Specializations tune the factors
+ * used by the receiver.
+ */
+template <int Decim>
+struct FirDesign {
+    static constexpr int   kTaps   = 8 * Decim;
+    static constexpr float kCutoff = 0.45f / static_cast<float>(Decim);
+};
+
+/// 2.4 MS/s -> 240 kS/s: pass the +-100 kHz broadcast FM channel.
+template <>
+struct FirDesign<10> {
+    static constexpr int   kTaps   = 96;
+    static constexpr float kCutoff = 0.045f;  ///< 108 kHz at 2.4 MS/s
+};
+
+/// 1.92 MS/s -> 240 kS/s: the FirDesign<10> passband and transition in Hz.
+template <>
+struct FirDesign<8> {
+    static constexpr int   kTaps   = 80;
+    static constexpr float kCutoff = 0.05625f; ///< 108 kHz at 1.92 MS/s
+};
+
+/// 3.84 MS/s -> 240 kS/s: the FirDesign<10> passband and transition in Hz.
+template <>
+struct FirDesign<16> {
+    static constexpr int   kTaps   = 160;
+    static constexpr float kCutoff = 0.028125f; ///< 108 kHz at 3.84 MS/s
+};
+
+/// 240 kS/s -> 48 kS/s: pass mono audio up to 15 kHz.
+template <>
+struct FirDesign<5> {
+    static constexpr int   kTaps   = 48;
+    static constexpr float kCutoff = 0.08f;   ///< 19.2 kHz at 240 kS/s
+};
+
+/// Decimation template argument of a FirDecimator whose factor is chosen at runtime.
+inline constexpr int kRuntimeDecimation = 0;
+
+/// No compile-time geometry; the runtime decimator designs its own (see FirDecimator).
+template <>
+struct FirDesign<kRuntimeDecimation> {
+    static constexpr int   kTaps   = 0;
+    static constexpr float kCutoff = 0.0f;
+};
+
+/**
+ * @brief Streaming decimating FIR filter in polyphase form.
+ *
+ * Only every `Decim`-th output of the full-rate filter is computed, so
+ * the cost is `Taps` multiply-accumulates per *output* sample. That is the
+ * same work as running `Decim` polyphase sub-filters of `Taps / Decim` taps
+ * each. The inner dot products run on the SIMD kernels from kernels().
+ *
+ * Input that does not complete a decimation window is kept, together with
+ * the filter history, between calls (like AudioDecimState for the boxcar
+ * path), so arbitrary block sizes produce a continuous output stream.
+ *
+ * With `Decim == kRuntimeDecimation` the factor is a constructor argument
+ * instead, and the filter takes the generic FirDesign geometry for it
+ * (8 taps per branch, corner below the output Nyquist frequency). This
+ * serves rate plans without a compiled-in design; the per-sample work is
+ * the same, only the geometry is no longer a constant.
+ *
+ * @tparam T     float (audio) or std::complex<float> (IQ)
+ * @tparam Decim Decimation factor, or kRuntimeDecimation
+ * @tparam Taps  Filter length (padded internally to kFirTapAlign)
+ */
+template <typename T, int Decim, int Taps = FirDesign<Decim>::kTaps>
+class FirDecimator {
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, std::complex<float>>,
+                  "FirDecimator supports float and std::complex<float>");
+    static_assert((Decim > 0 && Taps > 0) || (Decim == kRuntimeDecimation && Taps == 0),
+                  "Invalid decimator geometry");
+
+    static constexpr bool kComplex = std::is_same_v<T, std::complex<float>>;
+
+public:
+    static constexpr int kDecimation = Decim;
+    static constexpr int kTaps       = Taps;
+
+    /// true if the factor and filter length are constructor arguments.
+    static constexpr bool kRuntime = Decim == kRuntimeDecimation;
+
+    /// Tap count rounded up for the kernels; extra taps are zero.
+    static constexpr std::size_t padded(std::size_t taps) noexcept
+    {
+        return (taps + kFirTapAlign - 1) / kFirTapAlign * kFirTapAlign;
+    }
+
+    static constexpr std::size_t kPaddedTaps = padded(static_cast<std::size_t>(Taps));
+
+    /**
+     * @param cutoff -6 dB corner as a fraction of the input sample rate
+     */
+    explicit FirDecimator(float cutoff = FirDesign<Decim>::kCutoff)
+        requires (!kRuntime)
+    {
+        design(Taps, cutoff);
+    }
+
+    /**
+     * @brief Runtime-factor decimator with the generic FirDesign geometry.
+     * @throws std::invalid_argument unless @p decimation is positive
+     */
+    explicit FirDecimator(int decimation)
+        requires kRuntime
+        : decim_{decimation}
+    {
+        if (decimation < 1)
+            throw std::invalid_argument("FirDecimator: decimation must be positive");
+        design(8 * decimation, 0.45f / static_cast<float>(decimation));
+    }
+
+    /// @return Decimation factor.
+    [[nodiscard]] int decimation() const noexcept
+    {
+        if constexpr (kRuntime) return decim_;
+        else                    return Decim;
+    }
+
+    /// @return Padded filter length.
+    [[nodiscard]] std::size_t padded_taps() const noexcept
+    {
+        if constexpr (kRuntime) return padded_taps_;
+        else                    return kPaddedTaps;
+    }
+
+    /// Clear filter history and any partial decimation window.
+    void reset()
+    {
+        buf_.assign(padded_taps() - 1, T{});
+    }
+
+    /**
+     * @brief Clear filter history, resuming with @p phase inputs of the next
+     *        output window taken (as zeros).
+     *
+     * The next output then comes after `decimation() - phase` inputs;
+     * reset() is `reset(decimation() - 1)`.
+     */
+    void reset(std::size_t phase)
+    {
+        buf_.assign(padded_taps() - static_cast<std::size_t>(decimation()) + phase, T{});
+    }
+
+    /// @return Inputs taken toward the next output, 0 to `decimation() - 1`.
+    [[nodiscard]] std::size_t phase() const noexcept
+    {
+        return buf_.size() + static_cast<std::size_t>(decimation()) - padded_taps();
+    }
+
+    /// Size the input buffer for blocks of up to @p samples, so process() never allocates.
+    void reserve(std::size_t samples)
+    {
+        buf_.reserve(padded_taps() - 1 + static_cast<std::size_t>(decimation()) - 1 + samples);
+    }
+
+    /// @return Outputs the next process() call produces for @p samples of input.
+    [[nodiscard]] std::size_t output_size(std::size_t samples) const noexcept
+    {
+        const std::size_t n = buf_.size() + samples;
+        const std::size_t taps = padded_taps();
+        return n < taps ? 0 : (n - taps) / static_cast<std::size_t>(decimation()) + 1;
+    }
+
+    /**
+     * @brief Filter and decimate one block.
+     *
+     * @param in    Input samples at the full rate
+     * @param out   Receives the decimated samples (cleared first)
+     * @param gain  Gain applied to the output
+     */
+    void process(std::span<const T> in, std::vector<T>& out, float gain = 1.0f)
+    {
+        out.resize(output_size(in.size()));
+        out.resize(process(in, std::span<T>(out), gain));
+    }
+
+    /**
+     * @brief Filter and decimate one block into caller storage.
+     *
+     * @param out  At least output_size() samples
+     * @return Samples written
+     * @throws std::invalid_argument if @p out is too short
+     */
+    std::size_t process(std::span<const T> in, std::span<T> out, float gain = 1.0f)
+    {
+        require_output(out.size(), output_size(in.size()));
+        buf_.insert(buf_.end(), in.begin(), in.end());
+        return run(out, gain);
+    }
+
+    /**
+     * @brief Filter and decimate interleaved int16 I/Q directly.
+     *
+     * Samples are widened to float while appended to the filter buffer, so
+     * this replaces downsample_iq without an extra conversion pass.
+     */
+    void process(std::span<const int16_t> iq, std::vector<T>& out)
+        requires kComplex
+    {
+        out.resize(output_size(iq.size() / 2));
+        out.resize(process(iq, std::span<T>(out)));
+    }
+
+    /// Interleaved int16 I/Q into at least output_size() samples of @p out.
+    std::size_t process(std::span<const int16_t> iq, std::span<T> out)
+        requires kComplex
+    {
+        const std::size_t pairs = iq.size() / 2;
+        require_output(out.size(), output_size(pairs));
+
+        const std::size_t base = buf_.size();
+        buf_.resize(base + pairs);
+
+        for (std::size_t i = 0; i < pairs; i++)
+            buf_[base + i] = {static_cast<float>(iq[2 * i]),
+                              static_cast<float>(iq[2 * i + 1])};
+
+        return run(out, 1.0f);
+    }
+
+    /// Input samples buffered for the next output (history + partial window).
+    [[nodiscard]] std::size_t pending() const noexcept { return buf_.size(); }
+
+private:
+    // Coefficients: fixed geometry in place, runtime geometry on the heap
+    using Coeffs = std::conditional_t<kRuntime, std::vector<float>,
+                                      std::array<float, kPaddedTaps * (kComplex ? 2 : 1)>>;
+
+    Coeffs coeffs_{};
+    std::vector<T> buf_;
+    int decim_ = Decim;                       ///< Only read when kRuntime
+    std::size_t padded_taps_ = kPaddedTaps;   ///< Only read when kRuntime
+
+    /// Lay out a @p taps long low-pass in kernel order and clear the history.
+    void design(int taps, float cutoff)
+    {
+        const std::size_t n = static_cast<std::size_t>(taps);
+        if constexpr (kRuntime) {
+            padded_taps_ = padded(n);
+            coeffs_.assign(padded_taps_ * (kComplex ? 2 : 1), 0.0f);
+        }
+
+        std::vector<float> h(n);
+        design_lowpass(h, cutoff);
+
+        // Window position j multiplies buffer sample s + j, newest last
+        const std::size_t lead = padded_taps() - n;
+        for (std::size_t k = 0; k < n; k++) {
+            const float c = h[n - 1 - k];
+            if constexpr (kComplex) {
+                coeffs_[2 * (lead + k)]     = c;
+                coeffs_[2 * (lead + k) + 1] = c;
+            } else {
+                coeffs_[lead + k] = c;
+            }
+        }
+
+        reset();
+    }
+
+    static void require_output(std::size_t have, std::size_t needed)
+    {
+        if (have < needed)
+            throw std::invalid_argument("FirDecimator: output span too small");
+    }
+
+    std::size_t run(std::span<T> out, float gain)
+    {
+        const std::size_t taps = padded_taps();
+        const auto step = static_cast<std::size_t>(decimation());
+        if (buf_.size() < taps)
+            return 0;
+
+        const std::size_t n_out = (buf_.size() - taps) / step + 1;
+
+        if constexpr (kComplex) {
+            kernels().fir_decimate_cf.fn(buf_.data(), n_out, step,
+                                         coeffs_.data(), taps, out.data());
+        } else {
+            kernels().fir_decimate.fn(buf_.data(), n_out, step,
+                                      coeffs_.data(), taps, out.data());
+        }
+
+        if (gain != 1.0f)
+            for (auto& v : out.first(n_out)) v *= gain;
+
+        // Keep history and the partial window for the next block
+        buf_.erase(buf_.begin(), buf_.begin() + static_cast<std::ptrdiff_t>(n_out * step));
+        return n_out;
+    }
+};
+
+} // namespace dsp
@@ -0,0 +1,296 @@
+#include "fixed_point.hpp"
+#include "dsp_detail.hpp"
+#include "dsp_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace dsp {
+
+using detail::kCordicAtan;
+using detail::require_output;
+
+int16_t cordic_atan2_q15(int32_t y, int32_t x) noexcept
+{
+    // Normalise so the larger component has its top bit at 28: room for
+    // the sqrt(2) of the diagonal and the CORDIC gain without losing the
+    // low bits of a weak signal (see cordic_norm_shift())
+    const uint32_t m = static_cast<uint32_t>(std::abs(x)) | static_cast<uint32_t>(std::abs(y));
+    if (m == 0)
+        return 0;
+
+    const int32_t scale = int32_t{1} << detail::cordic_norm_shift(m);
+    x = (x * scale) >> 2;
+    y = (y * scale) >> 2;
+
+    // Left half-plane: rotate by pi; s is -1 there, else 0
+    const int32_t s = x >> 31;
+    x = (x ^ s) - s;
+    y = (y ^ s) - s;
+    uint32_t z = static_cast<uint32_t>(s) & 0x80000000u;
+
+    for (int k = 0; k < kCordicSteps; k++) {
+        // Rotate towards the x axis: clockwise above it, else anticlockwise
+        const int32_t d = y >> 31;
+        const int32_t dx = ((y >> k) ^ d) - d;
+        const int32_t dy = ((x >> k) ^ d) - d;
+        x += dx;
+        y -= dy;
+        z += static_cast<uint32_t>((kCordicAtan[static_cast<std::size_t>(k)] ^ d) - d);
+    }
+
+    // Round the Q31 accumulator to Q15; the angle wraps with the integer
+    return static_cast<int16_t>((z + 0x8000u) >> 16);
+}
+
+namespace {
+
+/// Complex samples per fixed-point chunk; keeps both intermediates within 2 KiB
+constexpr std::size_t kFixedChunk = 256;
+
+/**
+ * detail::downsample_iq_stream() into Q15 pairs.
+ * @param out Room for `(state.count + pairs) / decim` pairs
+ * @return Number of pairs written
+ */
+std::size_t downsample_iq_q15_stream(const int16_t* in, std::size_t pairs, int decim,
+                                     IqDecimState& state, int16_t* out)
+{
+    const int shift = iq_q15_shift(decim);
+    return detail::downsample_iq_stream(
+        in, pairs, decim, state,
+        [out, shift](const IqDecimState& s) {
+            out[0] = detail::saturate_q15(s.sum_i >> shift);
+            out[1] = detail::saturate_q15(s.sum_q >> shift);
+        },
+        [=](const int16_t* p, std::size_t n, std::size_t first) {
+            return kernels().downsample_iq_q15.fn(p, n, decim, shift, out + 2 * first);
+        });
+}
+
+/// @return Sum of the squared components of @p pairs Q15 IQ pairs.
+std::int64_t sum_squares_q15(const int16_t* iq, std::size_t pairs) noexcept
+{
+    std::int64_t sum = 0;
+    for (std::size_t i = 0; i < 2 * pairs; i++)
+        sum += static_cast<std::int32_t>(iq[i]) * iq[i];
+    return sum;
+}
+
+/// Fold Q15 phase units into an audio gain of the float chain's meaning:
+/// radians times @p gain, mapped to PCM by kS16FullScale.
+float phase_to_pcm(float gain) noexcept
+{
+    return gain * kQ15PhaseRad * kS16FullScale;
+}
+
+} // namespace
+
+FixedGain fixed_gain(float scale, int decimation)
+{
+    if (decimation < 1)
+        throw std::invalid_argument("fixed_gain: decimation must be positive");
+
+    FixedGain g;
+    g.pre_shift = iq_q15_shift(decimation);
+
+    int e = 0;
+    const float f = std::frexp(std::fabs(scale) * static_cast<float>(1 << g.pre_shift), &e);
+    if (f == 0.0f)
+        return g;
+
+    // |scale| * 2^pre = f * 2^e with f in [0.5, 1): a 15-bit mantissa over 2^(15 - e)
+    int32_t mul = static_cast<int32_t>(std::lround(f * 32768.0f));
+    int shift = 15 - e;
+    if (mul == 32768) {
+        mul = 16384;
+        shift--;
+    }
+    if (shift < 1)
+        throw std::invalid_argument("fixed_gain: gain too large for the Q15 audio stage");
+    if (shift > 30) {
+        mul >>= shift - 30;
+        shift = 30;
+    }
+
+    g.mul = scale < 0.0f ? -mul : mul;
+    g.shift = shift;
+    return g;
+}
+
+std::size_t downsample_iq_q15(std::span<const int16_t> in,
+                              std::span<int16_t> out,
+                              int decim,
+                              IqDecimState& state)
+{
+    if (decim <= 0)
+        return 0;
+
+    const std::size_t pairs = in.size() / 2;
+    require_output(out.size(), 2 * decimated_size(state.count, pairs, decim), "downsample_iq_q15");
+
+    return downsample_iq_q15_stream(in.data(), pairs, decim, state, out.data());
+}
+
+void downsample_iq_q15(std::span<const int16_t> in,
+                       std::vector<int16_t>& out,
+                       int decim,
+                       IqDecimState& state)
+{
+    out.resize(2 * decimated_size(state.count, in.size() / 2, decim));
+    out.resize(2 * downsample_iq_q15(in, std::span(out), decim, state));
+}
+
+std::size_t demodulate_fm_q15(std::span<const int16_t> in,
+                              std::span<int16_t> out,
+                              DemodStateQ15& state)
+{
+    const std::size_t n = in.size() / 2;
+    if (n == 0)
+        return 0;
+
+    require_output(out.size(), n, "demodulate_fm_q15");
+
+    kernels().demodulate_fm_q15.fn(in.data(), n, state.prev_i, state.prev_q, out.data());
+    state.prev_i = in[2 * n - 2];
+    state.prev_q = in[2 * n - 1];
+    return n;
+}
+
+void demodulate_fm_q15(std::span<const int16_t> in,
+                       std::vector<int16_t>& out,
+                       DemodStateQ15& state)
+{
+    out.resize(in.size() / 2);
+    demodulate_fm_q15(in, std::span(out), state);
+}
+
+std::size_t downsample_audio_q15(std::span<const int16_t> in,
+                                 std::span<int16_t> out,
+                                 int decim,
+                                 AudioDecimStateQ15& state,
+                                 float gain)
+{
+    if (decim <= 0)
+        return 0;
+
+    require_output(out.size(), decimated_size(state.counter, in.size(), decim),
+                   "downsample_audio_q15");
+
+    const FixedGain g = fixed_gain(gain / static_cast<float>(decim), decim);
+    return kernels().downsample_audio_q15.fn(in.data(), in.size(), decim, g, state, out.data());
+}
+
+void downsample_audio_q15(std::span<const int16_t> in,
+                          std::vector<int16_t>& out,
+                          int decim,
+                          AudioDecimStateQ15& state,
+                          float gain)
+{
+    out.resize(decimated_size(state.counter, in.size(), decim));
+    out.resize(downsample_audio_q15(in, std::span(out), decim, state, gain));
+}
+
+int32_t deemphasis_alpha_q15(float tau_us, float rate_hz) noexcept
+{
+    return static_cast<int32_t>(std::lround(deemphasis_alpha(tau_us, rate_hz) * 32768.0f));
+}
+
+void deemphasis_q15(std::span<int16_t> audio, int32_t alpha, DeemphasisStateQ15& state) noexcept
+{
+    // y += a (x - y) with y in s16 Q16; the recursion is serial, so it
+    // stays scalar like the float filter's dependency chain
+    int64_t y = state.y;
+    for (int16_t& x : audio) {
+        y += ((static_cast<int64_t>(x) * 65536 - y) * alpha) >> 15;
+        const int64_t v = (y + 32768) >> 16;
+        x = static_cast<int16_t>(std::clamp<int64_t>(v, -32768, 32767));
+    }
+    state.y = y;
+}
+
+std::size_t fixed_fm_size(std::size_t pairs, int iq_decimation, int audio_decimation,
+                          const FixedFmState& state) noexcept
+{
+    if (iq_decimation <= 0 || audio_decimation <= 0)
+        return 0;
+
+    const std::size_t iq = decimated_size(state.iq.count, pairs, iq_decimation);
+    return decimated_size(state.audio.counter, iq, audio_decimation);
+}
+
+std::size_t demodulate_fm_fixed(std::span<const int16_t> in,
+                                std::span<int16_t> out,
+                                int decim_iq,
+                                int decim_audio,
+                                FixedFmState& state,
+                                float gain,
+                                float* iq_power)
+{
+    if (iq_power)
+        *iq_power = 0.0f;
+    if (decim_iq <= 0 || decim_audio <= 0)
+        return 0;
+
+    require_output(out.size(), fixed_fm_size(in.size() / 2, decim_iq, decim_audio, state),
+                   "demodulate_fm_fixed");
+
+    const KernelTable& k = kernels();
+    const FixedGain g = fixed_gain(phase_to_pcm(gain) / static_cast<float>(decim_audio),
+                                   decim_audio);
+
+    const std::size_t pairs = in.size() / 2;
+    int16_t iq[2 * kFixedChunk];
+    int16_t freq[kFixedChunk];
+    std::size_t written = 0;
+    std::int64_t power_sum = 0;
+    std::size_t power_count = 0;
+
+    // A carried-in partial window never pushes a chunk past kFixedChunk outputs
+    const std::size_t chunk_pairs = kFixedChunk * static_cast<std::size_t>(decim_iq);
+
+    for (std::size_t done = 0; done < pairs; done += chunk_pairs) {
+        const std::size_t len = std::min(chunk_pairs, pairs - done);
+
+        const std::size_t n = downsample_iq_q15_stream(in.data() + 2 * done, len,
+                                                       decim_iq, state.iq, iq);
+        if (n == 0)
+            continue;
+
+        if (iq_power) {
+            power_sum += sum_squares_q15(iq, n);
+            power_count += n;
+        }
+
+        k.demodulate_fm_q15.fn(iq, n, state.demod.prev_i, state.demod.prev_q, freq);
+        state.demod.prev_i = iq[2 * n - 2];
+        state.demod.prev_q = iq[2 * n - 1];
+
+        written += k.downsample_audio_q15.fn(freq, n, decim_audio, g, state.audio,
+                                             out.data() + written);
+    }
+
+    if (iq_power && power_count) {
+        // Windows were summed then shifted right; the float chain divides
+        // its sums by 32768 * decim_iq
+        const double scale = std::ldexp(1.0, iq_q15_shift(decim_iq)) /
+                             (32768.0 * static_cast<double>(decim_iq));
+        *iq_power = static_cast<float>(static_cast<double>(power_sum) * scale * scale /
+                                       static_cast<double>(power_count));
+    }
+    return written;
+}
+
+void demodulate_fm_fixed(std::span<const int16_t> in,
+                         std::vector<int16_t>& out,
+                         int decim_iq,
+                         int decim_audio,
+                         FixedFmState& state,
+                         float gain)
+{
+    out.resize(fixed_fm_size(in.size() / 2, decim_iq, decim_audio, state));
+    out.resize(demodulate_fm_fixed(in, std::span(out), decim_iq, decim_audio, state, gain, nullptr));
+}
+
+} // namespace dsp
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <span>
+#include <vector>
+
+#include "dsp.hpp"
+
+/**
+ * @file fixed_point.hpp
+ * @brief Q15 fixed-point FM chain, for cores whose int16 SIMD outruns float.
+ *
+ * Number formats along the chain:
+ * - IQ: interleaved int16 pairs, as the SDR delivers them. Boxcar sums are
+ *   formed in 32 bits and shifted back into Q15 (see iq_q15_shift()).
+ * - Phase: int16 in half-turns, 32768 = pi radians (kQ15PhaseRad per unit),
+ *   so phase differences wrap for free.
+ * - Audio: signed 16-bit PCM.
+ *
+ * The discriminator is a CORDIC in vectoring mode on 32-bit lanes with a
+ * Q31 angle accumulator. All stages saturate instead of wrapping, and every
+ * SIMD kernel is bit-exact against its scalar reference.
+ */
+
+namespace dsp {
+
+/// Largest Q15 magnitude of the IQ stage; symmetric, so a product of two
+/// samples and its conjugate sum fit in int32.
+inline constexpr int32_t kQ15Max = 32767;
+
+/// Radians per unit of Q15 phase.
+inline constexpr float kQ15PhaseRad = std::numbers::pi_v<float> / 32768.0f;
+
+/// CORDIC iterations of cordic_atan2_q15(); the last step is 2^-14 rad.
+inline constexpr int kCordicSteps = 15;
+
+/// Maximum error of cordic_atan2_q15(), in Q15 phase units.
+inline constexpr int kCordicMaxErrorQ15 = 2;
+
+/**
+ * @brief Angle of (x, y) by CORDIC, in Q15 half-turns.
+ *
+ * Normalises the vector to 29 bits, rotates it into the right half-plane,
+ * then runs kCordicSteps shift-and-add rotations towards the x axis,
+ * summing the rotation angles in a Q31 accumulator. The normalisation
+ * keeps the error bound independent of the vector length, so a weak
+ * signal's conjugate product resolves as well as a strong one. This is
+ * the scalar reference of the fixed-point discriminator kernels.
+ *
+ * @param y, x  Components above INT32_MIN
+ * @return Angle in [-32768, 32767] (-pi to pi); 0 for (0, 0)
+ */
+int16_t cordic_atan2_q15(int32_t y, int32_t x) noexcept;
+
+/// Discriminator history of demodulate_fm_q15().
+struct DemodStateQ15 {
+    int16_t prev_i = static_cast<int16_t>(kQ15Max); ///< Last I of the previous block
+    int16_t prev_q = 0;                             ///< Last Q of the previous block
+};
+
+/// Partial window of downsample_audio_q15().
+struct AudioDecimStateQ15 {
+    int32_t accumulator = 0; ///< Sum of the open window
+    int     counter     = 0; ///< Samples in the open window
+};
+
+/// Output of deemphasis_q15() carried across blocks.
+struct DeemphasisStateQ15 {
+    int64_t y = 0; ///< Last output, s16 with 16 fraction bits
+};
+
+/// Combined state of demodulate_fm_fixed().
+struct FixedFmState {
+    IqDecimState iq;          ///< Partial IQ decimation window
+    DemodStateQ15 demod;      ///< Discriminator history
+    AudioDecimStateQ15 audio; ///< Partial audio decimation window
+};
+
+/**
+ * @brief Integer multiplier of the Q15 audio decimator.
+ *
+ * A window sum s becomes `((s >> pre_shift) * mul) >> shift`, rounded and
+ * saturated. The pre-shift brings any sum back to 16 bits, so the product
+ * fits in int32 with |mul| <= 32768.
+ */
+struct FixedGain {
+    int32_t mul = 0;       ///< Mantissa, below 2^15 in magnitude
+    int     pre_shift = 0; ///< Right shift of the window sum
+    int     shift = 15;    ///< Right shift of the product, 1 to 30
+};
+
+/**
+ * @brief FixedGain closest to multiplying a window sum of @p decimation
+ *        samples by @p scale.
+ *
+ * @throws std::invalid_argument if @p decimation < 1 or @p scale is too
+ *         large to represent (|scale| * 2^pre_shift >= 2^14)
+ */
+FixedGain fixed_gain(float scale, int decimation);
+
+/**
+ * @brief Right shift that brings a sum of @p decimation int16 pairs back
+ *        into Q15: ceil(log2(decimation)).
+ *
+ * A 12-bit ADC in an int16 container (the PlutoSDR) keeps 4 bits of
+ * headroom on top, so real captures never saturate.
+ */
+constexpr int iq_q15_shift(int decimation) noexcept
+{
+    return decimation > 1 ? std::bit_width(static_cast<unsigned>(decimation - 1)) : 0;
+}
+
+/**
+ * @brief Fixed-point streaming boxcar IQ decimator.
+ *
+ * Sums `decimation` pairs in 32 bits like downsample_iq(), then shifts the
+ * sums right by iq_q15_shift() and saturates them to +-kQ15Max.
+ *
+ * @param output  Interleaved Q15 I/Q, two values per output sample
+ * @return Samples (pairs) written
+ */
+std::size_t downsample_iq_q15(std::span<const int16_t> input,
+                              std::span<int16_t> output,
+                              int decimation,
+                              IqDecimState& state);
+
+/// downsample_iq_q15() into a vector resized to the pairs produced.
+void downsample_iq_q15(std::span<const int16_t> input,
+                       std::vector<int16_t>& output,
+                       int decimation,
+                       IqDecimState& state);
+
+/**
+ * @brief Fixed-point FM discriminator: arg(x[n] * conj(x[n-1])) in Q15 phase.
+ *
+ * The conjugate product is formed exactly in int32 and its angle taken by
+ * cordic_atan2_q15(). Output unit: kQ15PhaseRad rad/sample.
+ *
+ * @param in   Interleaved Q15 I/Q, components within +-kQ15Max
+ * @param out  At least one sample per pair of @p in
+ * @return Samples written
+ */
+std::size_t demodulate_fm_q15(std::span<const int16_t> in,
+                              std::span<int16_t> out,
+                              DemodStateQ15& state);
+
+/// demodulate_fm_q15() into a vector resized to the input pairs.
+void demodulate_fm_q15(std::span<const int16_t> in,
+                       std::vector<int16_t>& out,
+                       DemodStateQ15& state);
+
+/**
+ * @brief Fixed-point boxcar audio decimator with saturation.
+ *
+ * @code
+ *   y[n] = sat16(round((x[k] + ... + x[k+decimation-1]) * gain / decimation))
+ * @endcode
+ *
+ * with the multiplier quantised by fixed_gain().
+ *
+ * @param output  At least `decimated_size(state.counter, input.size(), decimation)` samples
+ * @return Samples written
+ * @throws std::invalid_argument as fixed_gain()
+ */
+std::size_t downsample_audio_q15(std::span<const int16_t> input,
+                                 std::span<int16_t> output,
+                                 int decimation,
+                                 AudioDecimStateQ15& state,
+                                 float gain = 1.0f);
+
+/// downsample_audio_q15() into a vector resized to the samples produced.
+void downsample_audio_q15(std::span<const int16_t> input,
+                          std::vector<int16_t>& output,
+                          int decimation,
+                          AudioDecimStateQ15& state,
+                          float gain = 1.0f);
+
+/// deemphasis_alpha() in Q15.
+int32_t deemphasis_alpha_q15(float tau_us, float rate_hz) noexcept;
+
+/**
+ * @brief deemphasis() on 16-bit PCM, in place.
+ *
+ * The filter state keeps 16 fraction bits, so the response matches the
+ * float filter down to the PCM rounding.
+ *
+ * @param alpha  See deemphasis_alpha_q15()
+ */
+void deemphasis_q15(std::span<int16_t> audio, int32_t alpha, DeemphasisStateQ15& state) noexcept;
+
+/// @return PCM samples demodulate_fm_fixed() produces for @p pairs from @p state.
+std::size_t fixed_fm_size(std::size_t pairs, int iq_decimation, int audio_decimation,
+                          const FixedFmState& state) noexcept;
+
+/**
+ * @brief Raw IQ to 16-bit PCM FM audio in one fixed-point pass.
+ *
+ * downsample_iq_q15() -> demodulate_fm_q15() -> downsample_audio_q15(),
+ * strip-mined into cache-resident chunks like demodulate_fm_fused(). The
+ * gain has the meaning it has there, so for the same @p gain the output
+ * matches the PCM of the float chain to within the fixed-point noise.
+ *
+ * @param output    At least fixed_fm_size() samples
+ * @param iq_power  If set, receives the mean power of the decimated IQ
+ *                  relative to int16 full scale, on the scale of the float
+ *                  chain (0 without output)
+ * @return Samples written
+ * @throws std::invalid_argument if @p output is too short, or as fixed_gain()
+ */
+std::size_t demodulate_fm_fixed(std::span<const int16_t> input,
+                                std::span<int16_t> output,
+                                int iq_decimation,
+                                int audio_decimation,
+                                FixedFmState& state,
+                                float gain = 1.0f,
+                                float* iq_power = nullptr);
+
+/// demodulate_fm_fixed() into a vector resized to the samples produced.
+void demodulate_fm_fixed(std::span<const int16_t> input,
+                         std::vector<int16_t>& output,
+                         int iq_decimation,
+                         int audio_decimation,
+                         FixedFmState& state,
+                         float gain = 1.0f);
+
+} // namespace dsp
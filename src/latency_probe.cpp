@@ -0,0 +1,213 @@
+#include "latency_probe.hpp"
+#include "thread_util.hpp"
+#include "udp_sender.hpp"
+
+#include <arpa/inet.h>
+#include <endian.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+#include <stdexcept>
+
+namespace {
+
+/// Carrier amplitude: a quarter of int16 full scale
+constexpr double kAmplitude = 8'192.0;
+
+} // namespace
+
+ToneBurstSource::ToneBurstSource(const ToneBurstOptions& opts, std::size_t block_size)
+    : opts_{opts}
+    , block_size_{block_size}
+{
+    if (block_size_ == 0)
+        throw std::invalid_argument("Block size must be non-zero");
+    if (opts_.sample_rate_hz <= 0 || opts_.period.count() <= 0)
+        throw std::invalid_argument("Sample rate and burst period must be positive");
+    if (opts_.burst > opts_.period || opts_.burst.count() < 0)
+        throw std::invalid_argument("Burst must fit into the period");
+
+    const auto rate = static_cast<double>(opts_.sample_rate_hz);
+    const auto period = static_cast<std::size_t>(opts_.period.count() * opts_.sample_rate_hz / 1'000);
+    total_pairs_ = static_cast<std::uint64_t>(opts_.duration.count() * opts_.sample_rate_hz / 1'000);
+
+    // Whole tone cycles, so the phase returns to where it started
+    const double cycles = std::round(static_cast<double>(opts_.burst.count()) * opts_.tone_hz / 1e3);
+    const auto burst = std::min(period, static_cast<std::size_t>(cycles * rate / opts_.tone_hz));
+
+    cycle_.resize(period * 2);
+    double phase = 0.0;
+    for (std::size_t n = 0; n < period; n++) {
+        if (n < burst) {
+            const double tone = std::sin(2.0 * std::numbers::pi * opts_.tone_hz * static_cast<double>(n) / rate);
+            phase += 2.0 * std::numbers::pi * opts_.deviation_hz * tone / rate;
+        }
+        cycle_[2 * n]     = static_cast<int16_t>(std::lround(kAmplitude * std::cos(phase)));
+        cycle_[2 * n + 1] = static_cast<int16_t>(std::lround(kAmplitude * std::sin(phase)));
+    }
+
+    block_.resize(block_size_ * 2);
+}
+
+bool ToneBurstSource::set_block_size(std::size_t pairs)
+{
+    if (pairs == 0)
+        return false;
+    block_size_ = pairs;
+    block_.resize(block_size_ * 2);
+    return true;
+}
+
+std::span<const int16_t> ToneBurstSource::next_block()
+{
+    if (total_pairs_ && position_ >= total_pairs_)
+        return {};
+
+    if (position_ == 0)
+        epoch_.store(Clock::now().time_since_epoch().count(), std::memory_order_release);
+
+    std::size_t pairs = block_size_;
+    if (total_pairs_)
+        pairs = static_cast<std::size_t>(std::min<std::uint64_t>(pairs, total_pairs_ - position_));
+
+    // Copy out of the cycle, wrapping at the end of a period
+    const std::size_t period = period_pairs();
+    for (std::size_t done = 0; done < pairs;) {
+        const std::size_t at = static_cast<std::size_t>((position_ + done) % period);
+        const std::size_t n = std::min(pairs - done, period - at);
+        std::copy_n(cycle_.begin() + static_cast<std::ptrdiff_t>(at * 2), n * 2,
+                    block_.begin() + static_cast<std::ptrdiff_t>(done * 2));
+        done += n;
+    }
+    position_ += pairs;
+
+    // Released when the SDR would have finished capturing it
+    const std::chrono::duration<double> captured{
+        static_cast<double>(position_) / static_cast<double>(opts_.sample_rate_hz)};
+    std::this_thread::sleep_until(epoch() + std::chrono::duration_cast<Clock::duration>(captured));
+
+    return std::span<const int16_t>(block_).first(pairs * 2);
+}
+
+LatencyProbe::LatencyProbe(const ToneBurstSource& source, std::size_t decimation,
+                           AudioFormat format, float threshold)
+    : source_{source}
+    , decimation_{decimation}
+    , format_{format}
+    , threshold_{threshold}
+{
+    if (format_ != AudioFormat::F32 && format_ != AudioFormat::S16)
+        throw std::invalid_argument("Latency probe needs F32 or S16 audio");
+    if (decimation_ == 0)
+        throw std::invalid_argument("Decimation must be non-zero");
+
+    fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0)
+        throw std::runtime_error("Failed to create probe socket");
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len) < 0) {
+        ::close(fd_);
+        throw std::runtime_error("Failed to bind probe socket");
+    }
+    port_ = ntohs(addr.sin_port);
+
+    // Wake up regularly to notice stop(); a large queue rides out a slow start
+    const timeval tv{0, 20'000};
+    const int rcvbuf = 1 << 20;
+    ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    thread_ = std::jthread([this](std::stop_token stop) { receive(stop); });
+}
+
+LatencyProbe::~LatencyProbe()
+{
+    stop();
+    ::close(fd_);
+}
+
+void LatencyProbe::stop()
+{
+    if (thread_.joinable()) {
+        thread_.request_stop();
+        thread_.join();
+    }
+}
+
+void LatencyProbe::receive(std::stop_token stop)
+{
+    set_current_thread_name("fm-probe");
+
+    std::vector<char> buf(65'536);
+    while (true) {
+        // Once stopped, only drain what is already queued
+        const bool stopping = stop.stop_requested();
+        const ssize_t n = ::recv(fd_, buf.data(), buf.size(), stopping ? MSG_DONTWAIT : 0);
+        const auto arrival = ToneBurstSource::Clock::now();
+
+        if (n > 0)
+            on_datagram(std::span<const char>(buf.data(), static_cast<std::size_t>(n)), arrival);
+        else if (stopping)
+            break;
+    }
+}
+
+void LatencyProbe::on_datagram(std::span<const char> datagram, ToneBurstSource::Clock::time_point arrival)
+{
+    AudioPacketHeader h{};
+    if (datagram.size() < sizeof(h))
+        return;
+    std::memcpy(&h, datagram.data(), sizeof(h));
+    if (ntohl(h.magic) != kAudioPacketMagic)
+        return;
+
+    const std::uint64_t first = be64toh(h.sample_index);
+    const auto payload = datagram.subspan(sizeof(h));
+
+    const bool f32 = format_ == AudioFormat::F32;
+    const std::size_t width = f32 ? sizeof(float) : sizeof(int16_t);
+    const std::size_t samples = payload.size() / width;
+    const std::size_t period = source_.period_pairs();
+
+    for (std::size_t i = 0; i < samples; i++) {
+        float level;
+        if (f32) {
+            float v;
+            std::memcpy(&v, payload.data() + i * width, sizeof(v));
+            level = std::fabs(v);
+        } else {
+            int16_t v;
+            std::memcpy(&v, payload.data() + i * width, sizeof(v));
+            level = std::fabs(static_cast<float>(v) / 32'768.0f);
+        }
+        if (!(level > threshold_))
+            continue;
+
+        // Audio sample -> IQ pair -> the period it belongs to
+        const auto burst = static_cast<long long>((first + i) * decimation_ / period);
+        if (burst <= last_burst_)
+            continue;
+        last_burst_ = burst;
+
+        const auto onset = source_.epoch() + std::chrono::duration_cast<ToneBurstSource::Clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(static_cast<std::uint64_t>(burst) * period) /
+                                          static_cast<double>(source_.sample_rate())));
+        const auto ns = static_cast<std::uint64_t>(std::max<long long>(
+            0, std::chrono::duration_cast<std::chrono::nanoseconds>(arrival - onset).count()));
+
+        latency_.record(ns);
+        if (ns > max_ns_.load(std::memory_order_relaxed))
+            max_ns_.store(ns, std::memory_order_relaxed);
+        return;
+    }
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "audio_output.hpp"
+#include "metrics.hpp"
+#include "sample_source.hpp"
+
+/**
+ * @file latency_probe.hpp
+ * @brief Glass-to-glass latency harness: a timestamped synthetic station
+ *        and a loopback receiver of its audio.
+ */
+
+/// Signal and length of a ToneBurstSource.
+struct ToneBurstOptions {
+    long long sample_rate_hz = 2'400'000;
+    std::chrono::milliseconds period{200}; ///< Time between burst onsets
+    std::chrono::milliseconds burst{20};   ///< Length of each tone burst
+    std::chrono::milliseconds duration{0}; ///< Stream length (0 = endless)
+    double tone_hz = 1'000.0;
+    double deviation_hz = 30'000.0;        ///< FM deviation of the tone
+};
+
+/**
+ * @class ToneBurstSource
+ * @brief Live FM carrier that is silent except for a tone burst every period.
+ *
+ * Blocks are released when the last of their samples would have left an
+ * SDR's ADC, counted from the first next_block() call (the epoch), so the
+ * source behaves like the Pluto at any block size. Burst `n` starts at
+ * sample `n * period_pairs()`, which makes `epoch() + n * period` the
+ * moment its first sample "hit the antenna".
+ */
+class ToneBurstSource final : public SampleSource {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// @throws std::invalid_argument for a zero block size, a non-positive
+    ///         rate or period, or a burst longer than the period
+    ToneBurstSource(const ToneBurstOptions& opts, std::size_t block_size);
+
+    std::span<const int16_t> next_block() override;
+
+    [[nodiscard]] std::size_t block_size() const noexcept override { return block_size_; }
+    [[nodiscard]] long long sample_rate() const noexcept override { return opts_.sample_rate_hz; }
+    [[nodiscard]] bool live() const noexcept override { return true; }
+
+    /// Resizes the block buffer (allocates when growing).
+    bool set_block_size(std::size_t pairs) override;
+
+    /// @return IQ pairs between two burst onsets.
+    [[nodiscard]] std::size_t period_pairs() const noexcept { return cycle_.size() / 2; }
+
+    /// @return Wall time of sample 0, or the clock's epoch before the first block; any thread.
+    [[nodiscard]] Clock::time_point epoch() const noexcept
+    {
+        return Clock::time_point(Clock::duration(epoch_.load(std::memory_order_acquire)));
+    }
+
+private:
+    ToneBurstOptions opts_;
+    std::size_t block_size_;
+    std::uint64_t total_pairs_;   ///< Stream length (0 = endless)
+
+    std::vector<int16_t> cycle_;  ///< One period of interleaved IQ
+    std::vector<int16_t> block_;
+    std::uint64_t position_ = 0;  ///< Next pair to hand out
+
+    std::atomic<Clock::rep> epoch_{0};
+};
+
+/**
+ * @class LatencyProbe
+ * @brief Receives the packetized audio of a ToneBurstSource on loopback and
+ *        times every burst from antenna to socket.
+ *
+ * A background thread reads the datagrams and tracks the audio stream
+ * position from their headers. The first sample above the threshold in a
+ * burst's stretch of audio is its onset; its latency is the arrival time of
+ * that datagram minus the moment the burst's first IQ sample was taken.
+ * This covers block capture, DSP including filter delay, encoding and the
+ * UDP hand-off — everything but the listener's own playback buffer.
+ *
+ * Expects mono F32 or S16 output with packetized headers.
+ */
+class LatencyProbe {
+public:
+    /**
+     * @param source      Station looped through the receiver
+     * @param decimation  IQ pairs per audio sample of the DSP chain
+     * @param format      AudioFormat::F32 or AudioFormat::S16
+     * @param threshold   Onset level relative to full scale
+     * @throws std::invalid_argument for another format or a zero decimation
+     * @throws std::runtime_error if the socket cannot be opened
+     */
+    LatencyProbe(const ToneBurstSource& source, std::size_t decimation,
+                 AudioFormat format = AudioFormat::F32, float threshold = 0.05f);
+
+    ~LatencyProbe();
+
+    LatencyProbe(const LatencyProbe&) = delete;
+    LatencyProbe& operator=(const LatencyProbe&) = delete;
+
+    /// @return Loopback port to send the audio to.
+    [[nodiscard]] int port() const noexcept { return port_; }
+
+    /// Read what is still queued, then stop the receive thread.
+    void stop();
+
+    /// @return Glass-to-glass latency of every burst detected so far; any thread.
+    [[nodiscard]] HistogramSnapshot latency() const noexcept { return latency_.snapshot(); }
+
+    /// @return Largest latency seen, in ns.
+    [[nodiscard]] std::uint64_t max_ns() const noexcept { return max_ns_.load(std::memory_order_relaxed); }
+
+private:
+    const ToneBurstSource& source_;
+    std::size_t decimation_;
+    AudioFormat format_;
+    float threshold_;
+
+    int fd_ = -1;
+    int port_ = 0;
+    std::jthread thread_;
+
+    LatencyHistogram latency_;
+    std::atomic<std::uint64_t> max_ns_{0};
+    long long last_burst_ = -1;
+
+    void receive(std::stop_token stop);
+
+    /// Look for a burst onset in one datagram received at @p arrival.
+    void on_datagram(std::span<const char> datagram, ToneBurstSource::Clock::time_point arrival);
+};
@@ -3,32 +3,88 @@
  * @brief PlutoSDR FM receiver entry point with CLI parsing.
  */
 
+#include <algorithm>
 #include <charconv>
+#include <chrono>
 #include <cmath>
 #include <exception>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
+#include "channel_bank.hpp"
+#include "cpu_features.hpp"
+#include "dsp_kernels.hpp"
+#include "file_source.hpp"
+#include "latency_probe.hpp"
 #include "plutosdr.hpp"
+#include "receiver.hpp"
+#include "spectrum_tap.hpp"
+#include "supervisor.hpp"
+#include "thread_util.hpp"
 
 /// Print available command-line options.
 static void print_usage(std::string_view prog)
 {
     std::cerr <<
         "Usage:\n"
-        "  " << prog << " -f <freq_mhz> [-g <gain_db>] [-a <ip>] [-p <port>]\n";
+        "  " << prog << " (-f <freq_mhz> | -i <file|->) [-g <gain_db>] [-a <ip>] [-p <port>]\n"
+        "      [-b <samples>] [-k <count>] [--uri <iio_uri>] [--rate <msps>]\n"
+        "      [--decimation <iq>:<audio>] [-m fm|am] [--fast-demod | --lut-demod]\n"
+        "      [--fir | --fused] [--fixed-point] [--stereo] [--deemphasis 50|75|0]\n"
+        "      [--flush-denormals]\n"
+        "      [-t] [--pin <capture>,<dsp>,<output>] [--ring-depth <n>]\n"
+        "      [-c <offset_khz>:<port> ...] [--channel-threads <n>] [--realtime]\n"
+        "      [--packetize] [--datagram-size <bytes>] [--format f32|s16|opus]\n"
+        "      [--opus-bitrate <bps>] [--stdout-policy drop-oldest|drop-newest|block]\n"
+        "      [--stdout-ring <frames>] [--stats <seconds>] [--stats-addr <ip>:<port>]\n"
+        "      [--squelch <dbfs>] [--squelch-hysteresis <db>]\n"
+        "      [--dest <ip>:<port>[,ttl=<n>][,if=<name>][,loop] ...]\n"
+        "      [--udp-backend auto|sendmmsg|io_uring] [--low-latency]\n"
+        "      [--latency-test <seconds>] [--spectrum <ip>:<port>] [--spectrum-fft <n>]\n"
+        "      [--spectrum-bins <n>] [--spectrum-rate <fps>]\n"
+        "  " << prog << " --scan <start_mhz>:<stop_mhz>:<step_khz> [--dwell <ms>]\n"
+        "      [--scan-passes <n>] [-g <gain_db>] [-b <samples>] [-k <count>]\n"
+        "      [--uri <iio_uri>] [--rate <msps>] [--decimation <iq>:<audio>]\n"
+        "  " << prog << " --supervisor <config> [--pool-threads <n>] [-b <samples>] [-k <count>]\n"
+        "      [--rate <msps>] [--decimation <iq>:<audio>] [DSP, output and stats options]\n";
 }
 
-/// Print compile-time SIMD configuration.
+/// Print detected SIMD extensions and the DSP kernels bound to them.
 static void print_simd_info()
 {
-#if defined(__ARM_NEON) || defined(__ARM_NEON__)
-    std::cerr << "NEON SIMD enabled\n";
-#else
-    std::cerr << "NEON SIMD disabled\n";
-#endif
+    const CpuFeatures& cpu = cpu_features();
+    std::cerr << "CPU SIMD:"
+              << " neon=" << cpu.neon
+              << " sse4.1=" << cpu.sse41
+              << " avx2=" << cpu.avx2
+              << " avx512=" << cpu.avx512 << '\n';
+
+    const dsp::KernelTable& k = dsp::kernels();
+    std::cerr << "DSP kernels:"
+              << " downsample_iq=" << dsp::isa_name(k.downsample_iq.isa)
+              << " demodulate_fm=" << dsp::isa_name(k.demodulate_fm.isa)
+              << " demodulate_am=" << dsp::isa_name(k.demodulate_am.isa)
+              << " downsample_audio=" << dsp::isa_name(k.downsample_audio.isa)
+              << " fir_decimate=" << dsp::isa_name(k.fir_decimate.isa)
+              << " fir_decimate_cf=" << dsp::isa_name(k.fir_decimate_cf.isa)
+              << " float_to_s16=" << dsp::isa_name(k.float_to_s16.isa)
+              << " demodulate_fm_q15=" << dsp::isa_name(k.demodulate_fm_q15.isa) << '\n';
+}
+
+/// Print the rate plan and whether its decimations have a fixed-factor chain.
+static void print_rate_plan(const RatePlan& plan)
+{
+    const bool fixed = std::ranges::any_of(kCompiledRatePlans, [&](const RatePlan& p) {
+        return p.decim_iq == plan.decim_iq && p.decim_audio == plan.decim_audio;
+    });
+    std::cerr << "Rate plan: " << plan.input_rate_hz << " Hz, decimation "
+              << plan.decim_iq << ':' << plan.decim_audio << ", "
+              << plan.audio_rate_hz() << " Hz audio ("
+              << (fixed ? "fixed-factor" : "runtime") << " chain)\n";
 }
 
 static bool parse_double(std::string_view sv, double& out)
@@ -54,6 +110,123 @@ static bool parse_port(std::string_view sv, int& out)
     return true;
 }
 
+static bool parse_int(std::string_view sv, int& out)
+{
+    auto r = std::from_chars(sv.data(), sv.data() + sv.size(), out);
+    return r.ec == std::errc{} && r.ptr == sv.data() + sv.size();
+}
+
+/// Parse "<iq>:<audio>" decimation factors, e.g. "8:5".
+static bool parse_decimation(std::string_view sv, RatePlan& out)
+{
+    const auto colon = sv.find(':');
+    if (colon == std::string_view::npos) return false;
+    return parse_int(sv.substr(0, colon), out.decim_iq) &&
+           parse_int(sv.substr(colon + 1), out.decim_audio);
+}
+
+/// Parse "<capture>,<dsp>,<output>" CPU core list.
+static bool parse_pin_list(std::string_view sv, PipelineOptions& opts)
+{
+    int* cores[] = {&opts.capture_cpu, &opts.dsp_cpu, &opts.output_cpu};
+
+    for (int* core : cores) {
+        const auto comma = sv.find(',');
+        if (!parse_int(sv.substr(0, comma), *core) || *core < 0) return false;
+        if (comma == std::string_view::npos) return core == cores[2];
+        sv.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+/// Parse "<offset_khz>:<port>", e.g. "-400:5001".
+static bool parse_channel(std::string_view sv, ChannelConfig& out)
+{
+    const auto colon = sv.find(':');
+    if (colon == std::string_view::npos) return false;
+
+    double khz{};
+    if (!parse_double(sv.substr(0, colon), khz)) return false;
+    if (!parse_port(sv.substr(colon + 1), out.udp_port)) return false;
+
+    out.offset_hz = std::llround(khz * 1e3);
+    return true;
+}
+
+/// Parse "<start_mhz>:<stop_mhz>:<step_khz>" into the list of scan frequencies.
+static bool parse_scan_range(std::string_view sv, std::vector<long long>& out)
+{
+    const auto c1 = sv.find(':');
+    const auto c2 = sv.find(':', c1 == std::string_view::npos ? c1 : c1 + 1);
+    if (c2 == std::string_view::npos) return false;
+
+    long long start{}, stop{};
+    double step_khz{};
+    if (!parse_freq_mhz(sv.substr(0, c1), start)) return false;
+    if (!parse_freq_mhz(sv.substr(c1 + 1, c2 - c1 - 1), stop)) return false;
+    if (!parse_double(sv.substr(c2 + 1), step_khz) || !(step_khz > 0.0)) return false;
+
+    const long long step = std::llround(step_khz * 1e3);
+    if (step <= 0 || stop < start) return false;
+
+    out.clear();
+    for (long long f = start; f <= stop; f += step)
+        out.push_back(f);
+    return true;
+}
+
+/// Parse "<ip>:<port>" into the statistics destination.
+static bool parse_stats_addr(std::string_view sv, StatsOptions& out)
+{
+    const auto colon = sv.rfind(':');
+    if (colon == std::string_view::npos || colon == 0) return false;
+    if (!parse_port(sv.substr(colon + 1), out.udp_port)) return false;
+
+    out.udp_ip = std::string(sv.substr(0, colon));
+    return true;
+}
+
+/// Parse "<ip>:<port>" into the spectrum destination.
+static bool parse_spectrum_addr(std::string_view sv, SpectrumOptions& out)
+{
+    const auto colon = sv.rfind(':');
+    if (colon == std::string_view::npos || colon == 0) return false;
+    if (!parse_port(sv.substr(colon + 1), out.udp_port)) return false;
+
+    out.udp_ip = std::string(sv.substr(0, colon));
+    return true;
+}
+
+/// Parse the --udp-backend name.
+static bool parse_backend(std::string_view sv, SendBackend& out)
+{
+    if (sv == "auto")          out = SendBackend::Auto;
+    else if (sv == "sendmmsg") out = SendBackend::Sendmmsg;
+    else if (sv == "io_uring") out = SendBackend::IoUring;
+    else return false;
+    return true;
+}
+
+/// Parse an audio format name ("f32", "s16", "opus").
+static bool parse_format(std::string_view sv, AudioFormat& out)
+{
+    if (sv == "f32")       out = AudioFormat::F32;
+    else if (sv == "s16")  out = AudioFormat::S16;
+    else if (sv == "opus") out = AudioFormat::Opus;
+    else return false;
+    return true;
+}
+
+/// Parse a stdout overflow policy ("drop-oldest", "drop-newest", "block").
+static bool parse_overflow(std::string_view sv, OverflowPolicy& out)
+{
+    if (sv == "drop-oldest")      out = OverflowPolicy::DropOldest;
+    else if (sv == "drop-newest") out = OverflowPolicy::DropNewest;
+    else if (sv == "block")       out = OverflowPolicy::Block;
+    else return false;
+    return true;
+}
+
 int main(int argc, char* argv[])
 {
     std::ios::sync_with_stdio(false);
@@ -62,6 +235,27 @@ int main(int argc, char* argv[])
     double gain_db = 0.0;
     std::optional<std::string> udp_ip;
     std::optional<int> udp_port;
+    std::vector<UdpDestination> destinations;
+    CaptureOptions capture;
+    std::optional<std::size_t> buffer_size;
+    std::optional<RatePlan> decimation;
+    DspOptions dsp;
+    dsp.deemphasis_us = 50.0f;
+    bool threaded = false;
+    PipelineOptions pipeline;
+    std::vector<ChannelConfig> channels;
+    unsigned channel_threads = 0;
+    std::optional<std::string> input;
+    Pacing pacing = Pacing::MaxSpeed;
+    OutputOptions output;
+    std::optional<OverflowPolicy> overflow;
+    StatsOptions stats;
+    ScanOptions scan;
+    std::optional<std::string> supervisor_config;
+    unsigned pool_threads = 0;
+    bool low_latency = false;
+    double latency_test_s = 0.0;
+    SpectrumOptions spectrum;
 
     if (argc < 2) {
         print_usage(argv[0]);
@@ -98,20 +292,411 @@ int main(int argc, char* argv[])
                     throw std::runtime_error("Invalid port");
                 udp_port = p;
             }
+            else if (arg == "--dest") {
+                UdpDestination d;
+                if (!parse_udp_destination(next(arg), d))
+                    throw std::runtime_error("Invalid destination, expected "
+                                             "<ip>:<port>[,ttl=<n>][,if=<name>][,loop]");
+                destinations.push_back(std::move(d));
+            }
+            else if (arg == "--udp-backend") {
+                if (!parse_backend(next(arg), output.udp_backend))
+                    throw std::runtime_error("Invalid UDP backend, expected auto, sendmmsg or io_uring");
+            }
+            else if (arg == "-b" || arg == "--buffer-size") {
+                int samples;
+                if (!parse_int(next(arg), samples) || samples < 1)
+                    throw std::runtime_error("Invalid buffer size");
+                buffer_size = static_cast<std::size_t>(samples);
+            }
+            else if (arg == "-k" || arg == "--kernel-buffers") {
+                int count;
+                if (!parse_int(next(arg), count) || count < 0)
+                    throw std::runtime_error("Invalid kernel buffer count");
+                capture.kernel_buffers = static_cast<unsigned>(count);
+            }
+            else if (arg == "--uri") {
+                capture.uri = std::string(next(arg));
+            }
+            else if (arg == "--rate") {
+                if (!parse_freq_mhz(next(arg), dsp.rates.input_rate_hz) || dsp.rates.input_rate_hz <= 0)
+                    throw std::runtime_error("Invalid sample rate");
+            }
+            else if (arg == "--decimation") {
+                RatePlan plan;
+                if (!parse_decimation(next(arg), plan))
+                    throw std::runtime_error("Invalid decimation, expected <iq>:<audio>");
+                decimation = plan;
+            }
+            else if (arg == "--squelch") {
+                double dbfs;
+                if (!parse_double(next(arg), dbfs) || dbfs > 0.0)
+                    throw std::runtime_error("Invalid squelch level, expected dBFS <= 0");
+                dsp.squelch_dbfs = static_cast<float>(dbfs);
+            }
+            else if (arg == "--squelch-hysteresis") {
+                double db;
+                if (!parse_double(next(arg), db) || db < 0.0)
+                    throw std::runtime_error("Invalid squelch hysteresis");
+                dsp.squelch_hysteresis_db = static_cast<float>(db);
+            }
+            else if (arg == "-m" || arg == "--mode") {
+                const auto mode = next(arg);
+                if (mode == "fm")
+                    dsp.mode = dsp::DemodulationMode::FM;
+                else if (mode == "am")
+                    dsp.mode = dsp::DemodulationMode::AM;
+                else
+                    throw std::runtime_error("Invalid mode, expected fm or am");
+            }
+            else if (arg == "--fast-demod") {
+                dsp.discriminator = dsp::FmDiscriminator::Fast;
+            }
+            else if (arg == "--lut-demod") {
+                dsp.discriminator = dsp::FmDiscriminator::Lut;
+            }
+            else if (arg == "--fir") {
+                dsp.decimator = DecimatorType::Fir;
+            }
+            else if (arg == "--fused") {
+                dsp.fused = true;
+            }
+            else if (arg == "--flush-denormals") {
+                dsp.flush_denormals = true;
+            }
+            else if (arg == "--fixed-point") {
+                dsp.arithmetic = Arithmetic::Fixed;
+            }
+            else if (arg == "--stereo") {
+                dsp.stereo = true;
+            }
+            else if (arg == "--deemphasis") {
+                int us;
+                if (!parse_int(next(arg), us) || (us != 0 && us != 50 && us != 75))
+                    throw std::runtime_error("Invalid de-emphasis, expected 50, 75 or 0");
+                dsp.deemphasis_us = static_cast<float>(us);
+            }
+            else if (arg == "--low-latency") {
+                low_latency = true;
+            }
+            else if (arg == "--latency-test") {
+                if (!parse_double(next(arg), latency_test_s) || !(latency_test_s > 0.0))
+                    throw std::runtime_error("Invalid latency test duration");
+            }
+            else if (arg == "--spectrum") {
+                if (!parse_spectrum_addr(next(arg), spectrum))
+                    throw std::runtime_error("Invalid spectrum address, expected <ip>:<port>");
+            }
+            else if (arg == "--spectrum-fft" || arg == "--spectrum-bins") {
+                int n;
+                if (!parse_int(next(arg), n) || n < 1)
+                    throw std::runtime_error("Invalid spectrum size");
+                (arg == "--spectrum-fft" ? spectrum.fft_size : spectrum.bins) = static_cast<std::size_t>(n);
+            }
+            else if (arg == "--spectrum-rate") {
+                if (!parse_double(next(arg), spectrum.frame_rate) || !(spectrum.frame_rate > 0.0))
+                    throw std::runtime_error("Invalid spectrum frame rate");
+            }
+            else if (arg == "-t" || arg == "--threaded") {
+                threaded = true;
+            }
+            else if (arg == "--pin") {
+                if (!parse_pin_list(next(arg), pipeline))
+                    throw std::runtime_error("Invalid CPU list");
+                threaded = true;
+            }
+            else if (arg == "--ring-depth") {
+                int depth;
+                if (!parse_int(next(arg), depth) || depth < 1)
+                    throw std::runtime_error("Invalid ring depth");
+                pipeline.capture_ring_depth = static_cast<std::size_t>(depth);
+                pipeline.audio_ring_depth   = static_cast<std::size_t>(depth);
+            }
+            else if (arg == "-c" || arg == "--channel") {
+                ChannelConfig ch;
+                if (!parse_channel(next(arg), ch))
+                    throw std::runtime_error("Invalid channel, expected <offset_khz>:<port>");
+                channels.push_back(ch);
+            }
+            else if (arg == "--channel-threads") {
+                int n;
+                if (!parse_int(next(arg), n) || n < 0)
+                    throw std::runtime_error("Invalid channel thread count");
+                channel_threads = static_cast<unsigned>(n);
+            }
+            else if (arg == "-i" || arg == "--input") {
+                input = std::string(next(arg));
+            }
+            else if (arg == "--realtime") {
+                pacing = Pacing::Realtime;
+            }
+            else if (arg == "--packetize") {
+                if (output.max_datagram == 0) output.max_datagram = kDefaultMaxDatagram;
+            }
+            else if (arg == "--datagram-size") {
+                int bytes;
+                if (!parse_int(next(arg), bytes) || bytes < 1)
+                    throw std::runtime_error("Invalid datagram size");
+                output.max_datagram = static_cast<std::size_t>(bytes);
+            }
+            else if (arg == "--format") {
+                if (!parse_format(next(arg), output.format))
+                    throw std::runtime_error("Invalid format, expected f32, s16 or opus");
+            }
+            else if (arg == "--opus-bitrate") {
+                if (!parse_int(next(arg), output.opus_bitrate) || output.opus_bitrate < 500)
+                    throw std::runtime_error("Invalid Opus bitrate");
+            }
+            else if (arg == "--stdout-policy") {
+                OverflowPolicy policy;
+                if (!parse_overflow(next(arg), policy))
+                    throw std::runtime_error("Invalid stdout policy, expected drop-oldest, drop-newest or block");
+                overflow = policy;
+            }
+            else if (arg == "--stdout-ring") {
+                int frames;
+                if (!parse_int(next(arg), frames) || frames < 1)
+                    throw std::runtime_error("Invalid stdout ring size");
+                output.stdout_ring_frames = static_cast<std::size_t>(frames);
+            }
+            else if (arg == "--scan") {
+                if (!parse_scan_range(next(arg), scan.frequencies_hz))
+                    throw std::runtime_error("Invalid scan range, expected <start_mhz>:<stop_mhz>:<step_khz>");
+            }
+            else if (arg == "--dwell") {
+                if (!parse_double(next(arg), scan.dwell_ms) || !(scan.dwell_ms > 0.0))
+                    throw std::runtime_error("Invalid dwell time");
+            }
+            else if (arg == "--scan-passes") {
+                int n;
+                if (!parse_int(next(arg), n) || n < 0)
+                    throw std::runtime_error("Invalid scan pass count");
+                scan.passes = static_cast<unsigned>(n);
+            }
+            else if (arg == "--stats") {
+                if (!parse_double(next(arg), stats.interval_s) || !(stats.interval_s > 0.0))
+                    throw std::runtime_error("Invalid stats interval");
+            }
+            else if (arg == "--stats-addr") {
+                if (!parse_stats_addr(next(arg), stats))
+                    throw std::runtime_error("Invalid stats address, expected <ip>:<port>");
+            }
+            else if (arg == "--supervisor") {
+                supervisor_config = std::string(next(arg));
+            }
+            else if (arg == "--pool-threads") {
+                int n;
+                if (!parse_int(next(arg), n) || n < 0)
+                    throw std::runtime_error("Invalid pool thread count");
+                pool_threads = static_cast<unsigned>(n);
+            }
             else {
                 throw std::runtime_error("Unknown argument");
             }
         }
 
-        if (!freq_hz) {
+        if (!scan.frequencies_hz.empty() && !freq_hz)
+            freq_hz = scan.frequencies_hz.front();
+
+        if (!freq_hz && !input && !supervisor_config && latency_test_s <= 0.0) {
             print_usage(argv[0]);
             return 1;
         }
 
+        if (dsp.flush_denormals && !flush_to_zero_supported())
+            std::cerr << "Warning: --flush-denormals is not supported on this target\n";
+
+        // Without explicit factors the rate must be one of the compiled plans
+        if (decimation) {
+            dsp.rates.decim_iq = decimation->decim_iq;
+            dsp.rates.decim_audio = decimation->decim_audio;
+        } else if (const auto plan = compiled_rate_plan(dsp.rates.input_rate_hz)) {
+            dsp.rates = *plan;
+        } else {
+            throw std::runtime_error("No built-in rate plan for " +
+                                     std::to_string(dsp.rates.input_rate_hz) +
+                                     " Hz, give --decimation <iq>:<audio>");
+        }
+        validate_rate_plan(dsp.rates);
+
+        if (dsp.stereo && dsp.mode != dsp::DemodulationMode::FM)
+            throw std::runtime_error("Stereo requires FM");
+        if (dsp.fused && dsp.decimator == DecimatorType::Fir)
+            throw std::runtime_error("--fir and --fused cannot be combined");
+        if (output.format == AudioFormat::Opus && dsp.rates.audio_rate_hz() != kOpusSampleRateHz)
+            throw std::runtime_error("Opus requires " + std::to_string(kOpusSampleRateHz) +
+                                     " Hz audio");
+        output.channels = dsp.stereo ? 2 : 1;
+
+        // 50 ms refills unless given
+        capture.sample_rate_hz = dsp.rates.input_rate_hz;
+        capture.buffer_size = buffer_size.value_or(
+            static_cast<std::size_t>(dsp.rates.input_rate_hz / 20));
+
         print_simd_info();
+        print_rate_plan(dsp.rates);
+
+        if (stats.udp_ip && stats.interval_s <= 0.0)
+            stats.interval_s = 1.0;
+
+        if (supervisor_config) {
+            if (input || !channels.empty() || !scan.frequencies_hz.empty() || threaded ||
+                low_latency || latency_test_s > 0.0 || spectrum.udp_port)
+                throw std::runtime_error("--supervisor takes its devices from the config file "
+                                         "and cannot be combined with -i, -c, --scan, -t, "
+                                         "--low-latency, --latency-test or --spectrum");
+
+            // Every device shares the capture geometry; uri= or file= picks the source
+            auto open = [&](const DeviceConfig& dev) -> std::unique_ptr<SampleSource> {
+                if (!dev.file.empty())
+                    return open_recording(dev.file, capture.buffer_size, pacing,
+                                          dsp.rates.input_rate_hz);
+                CaptureOptions c = capture;
+                c.uri = dev.uri;
+                return std::make_unique<PlutoSDR>(dev.frequency_hz, dev.gain_db, c);
+            };
+
+            SupervisorOptions sv;
+            sv.pool_threads = pool_threads;
+            sv.ring_depth = pipeline.capture_ring_depth;
+            sv.block_size = capture.buffer_size;
+
+            Supervisor supervisor(load_device_config(*supervisor_config), open, dsp, output, sv);
+            std::cerr << "Supervising " << supervisor.size() << " devices, DSP on "
+                      << supervisor.pool_threads() << " threads\n";
+            if (stats.interval_s > 0.0)
+                supervisor.enable_stats(stats);
+            supervisor.run();
+            return 0;
+        }
+
+        if (low_latency && (threaded || !channels.empty() || !scan.frequencies_hz.empty()))
+            throw std::runtime_error("--low-latency runs the single-threaded loop only "
+                                     "(no -t, -c or --scan)");
+
+        if (latency_test_s > 0.0) {
+            if (input || !channels.empty() || !scan.frequencies_hz.empty() || dsp.stereo ||
+                spectrum.udp_port)
+                throw std::runtime_error("--latency-test runs one mono station and cannot be "
+                                         "combined with -i, -c, --scan, --stereo or --spectrum");
+
+            ToneBurstOptions tone;
+            tone.sample_rate_hz = dsp.rates.input_rate_hz;
+            tone.duration = std::chrono::milliseconds(std::llround(latency_test_s * 1e3));
+            ToneBurstSource tones(tone, capture.buffer_size);
+
+            // The probe maps audio back to IQ through the datagram headers
+            if (output.max_datagram == 0)
+                output.max_datagram = kDefaultMaxDatagram;
+            LatencyProbe probe(tones, static_cast<std::size_t>(dsp.rates.decim_iq * dsp.rates.decim_audio),
+                               output.format);
+
+            Receiver receiver(tones, "127.0.0.1", probe.port(), dsp, 0.3f, output);
+            if (stats.interval_s > 0.0)
+                receiver.enable_stats(stats);
+            if (low_latency)
+                receiver.enable_low_latency({});
+            if (threaded)
+                receiver.run_pipelined(pipeline);
+            else
+                receiver.run();
+            probe.stop();
+
+            // Bucket upper bounds can exceed the largest sample
+            const auto lat = probe.latency();
+            const auto ms = [&](std::uint64_t ns) {
+                return static_cast<double>(std::min(ns, probe.max_ns())) / 1e6;
+            };
+            std::cerr << "Glass-to-glass latency over " << lat.count << " bursts: p50 "
+                      << ms(lat.percentile(0.5)) << " ms, p99 " << ms(lat.percentile(0.99))
+                      << " ms, max " << ms(probe.max_ns()) << " ms\n";
+            return 0;
+        }
+
+        std::unique_ptr<SampleSource> source;
+        if (input)
+            source = open_recording(*input, capture.buffer_size, pacing, dsp.rates.input_rate_hz);
+        else
+            source = std::make_unique<PlutoSDR>(freq_hz, gain_db, capture);
+
+        if (source->sample_rate() != dsp.rates.input_rate_hz)
+            throw std::runtime_error("Input sample rate is " +
+                                     std::to_string(source->sample_rate()) + " Hz, expected " +
+                                     std::to_string(dsp.rates.input_rate_hz) + " Hz (--rate)");
+
+        // A live capture must not wait for the consumer; a recording loses nothing
+        output.overflow = overflow.value_or(source->live() ? OverflowPolicy::DropOldest
+                                                           : OverflowPolicy::Block);
+
+        if (spectrum.udp_port && !scan.frequencies_hz.empty())
+            throw std::runtime_error("--spectrum cannot follow a --scan");
+
+        // Spectrum frames of the whole captured band, on a thread of their own
+        std::optional<SpectrumTap> spectrum_tap;
+        if (spectrum.udp_port)
+            spectrum_tap.emplace(spectrum, source->sample_rate());
+        const auto report_spectrum = [&] {
+            if (!spectrum_tap)
+                return;
+            spectrum_tap->stop();
+            std::cerr << "Spectrum frames sent:    " << spectrum_tap->frames() << '\n'
+                      << "Spectrum FFTs skipped:   " << spectrum_tap->dropped() << '\n';
+        };
+
+        if (!scan.frequencies_hz.empty()) {
+            Receiver receiver(*source, std::nullopt, std::nullopt, dsp);
+            if (stats.interval_s > 0.0)
+                receiver.enable_stats(stats);
+            receiver.run_scan(scan, std::cout);
+            return 0;
+        }
+
+        if (!channels.empty()) {
+            if (!udp_ip)
+                throw std::runtime_error("Channels require a UDP address (-a)");
+            if (dsp.mode != dsp::DemodulationMode::FM)
+                throw std::runtime_error("Channels only support FM");
+            if (dsp.stereo)
+                throw std::runtime_error("Channels only support mono");
+            if (dsp.rates != kDefaultRatePlan)
+                throw std::runtime_error("Channels only support the default rate plan");
+
+            ChannelBank bank(channels, *udp_ip, dsp, 0.3f, channel_threads, output);
+            std::cerr << "Receiving " << bank.size() << " channels on "
+                      << bank.threads() << " threads\n";
+
+            Receiver receiver(*source, std::nullopt, std::nullopt, dsp);
+            if (stats.interval_s > 0.0)
+                receiver.enable_stats(stats);
+            receiver.attach_spectrum(spectrum_tap ? &*spectrum_tap : nullptr);
+            receiver.run_channels(bank);
+            report_spectrum();
+            return 0;
+        }
+
+        // -a/-p is the first destination of a --dest list
+        if (!destinations.empty() && (udp_ip || udp_port)) {
+            if (!udp_ip || !udp_port)
+                throw std::runtime_error("-a and -p must be given together with --dest");
+            UdpDestination first;
+            first.ip = *udp_ip;
+            first.port = *udp_port;
+            destinations.insert(destinations.begin(), std::move(first));
+        }
 
-        PlutoSDR radio(freq_hz, gain_db, udp_ip, udp_port);
-        radio.run();
+        auto receiver = destinations.empty()
+            ? Receiver(*source, udp_ip, udp_port, dsp, 0.3f, output)
+            : Receiver(*source, destinations, dsp, 0.3f, output);
+        if (stats.interval_s > 0.0)
+            receiver.enable_stats(stats);
+        if (low_latency)
+            receiver.enable_low_latency({});
+        receiver.attach_spectrum(spectrum_tap ? &*spectrum_tap : nullptr);
+        if (threaded)
+            receiver.run_pipelined(pipeline);
+        else
+            receiver.run();
+        report_spectrum();
     }
     catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << '\n';
@@ -0,0 +1,250 @@
+#include "metrics.hpp"
+
+#include <bit>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+using std::chrono::nanoseconds;
+
+constexpr const char* kStageNames[kStageCount] = {
+    "capture", "downsample_iq", "demodulate", "downsample_audio", "fused", "dsp", "output",
+    "latency",
+};
+
+/// Block period over the p99 busy time (DSP + output) of @p s; 0 if unknown.
+double headroom(const MetricsSnapshot& s, std::uint64_t block_period_ns)
+{
+    const std::uint64_t busy = s[Stage::Dsp].percentile(0.99) + s[Stage::Output].percentile(0.99);
+    return busy ? static_cast<double>(block_period_ns) / static_cast<double>(busy) : 0.0;
+}
+
+} // namespace
+
+const char* stage_name(Stage stage) noexcept
+{
+    const auto i = static_cast<std::size_t>(stage);
+    return i < kStageCount ? kStageNames[i] : "unknown";
+}
+
+std::size_t HistogramSnapshot::bucket_of(std::uint64_t ns) noexcept
+{
+    if (ns < kSubBuckets)
+        return static_cast<std::size_t>(ns);
+
+    // 8 linear sub-buckets between 2^e and 2^(e+1)
+    const int e = std::bit_width(ns) - 1;
+    const auto sub = static_cast<std::size_t>((ns >> (e - 3)) & (kSubBuckets - 1));
+    return static_cast<std::size_t>(e - 2) * kSubBuckets + sub;
+}
+
+std::uint64_t HistogramSnapshot::bucket_upper(std::size_t index) noexcept
+{
+    if (index < kSubBuckets)
+        return index;
+
+    const std::size_t e = index / kSubBuckets + 2;
+    const std::uint64_t sub = index % kSubBuckets;
+    const std::uint64_t width = std::uint64_t{1} << (e - 3);
+    return (kSubBuckets + sub) * width + (width - 1);
+}
+
+std::uint64_t HistogramSnapshot::percentile(double q) const noexcept
+{
+    if (count == 0)
+        return 0;
+
+    const auto rank = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(count))));
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBuckets; i++) {
+        seen += buckets[i];
+        if (seen >= rank)
+            return bucket_upper(i);
+    }
+    return bucket_upper(kBuckets - 1);
+}
+
+double HistogramSnapshot::mean_ns() const noexcept
+{
+    return count ? static_cast<double>(sum_ns) / static_cast<double>(count) : 0.0;
+}
+
+HistogramSnapshot HistogramSnapshot::since(const HistogramSnapshot& earlier) const noexcept
+{
+    HistogramSnapshot d;
+    for (std::size_t i = 0; i < kBuckets; i++)
+        d.buckets[i] = buckets[i] - earlier.buckets[i];
+    d.count  = count - earlier.count;
+    d.sum_ns = sum_ns - earlier.sum_ns;
+    return d;
+}
+
+HistogramSnapshot LatencyHistogram::snapshot() const noexcept
+{
+    // Count first: a sample recorded meanwhile shows in the buckets but not
+    // in the count, which percentile() tolerates
+    HistogramSnapshot s;
+    s.count  = count_.load(std::memory_order_relaxed);
+    s.sum_ns = sum_ns_.load(std::memory_order_relaxed);
+    for (std::size_t i = 0; i < HistogramSnapshot::kBuckets; i++)
+        s.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    return s;
+}
+
+MetricsSnapshot MetricsSnapshot::since(const MetricsSnapshot& earlier) const noexcept
+{
+    MetricsSnapshot d;
+    for (std::size_t i = 0; i < kStageCount; i++)
+        d.stages[i] = stages[i].since(earlier.stages[i]);
+    d.blocks   = blocks - earlier.blocks;
+    d.overruns = overruns - earlier.overruns;
+    return d;
+}
+
+MetricsSnapshot PipelineMetrics::snapshot() const noexcept
+{
+    MetricsSnapshot s;
+    for (std::size_t i = 0; i < kStageCount; i++)
+        s.stages[i] = stages_[i].snapshot();
+    s.blocks   = blocks_.load(std::memory_order_relaxed);
+    s.overruns = overruns_.load(std::memory_order_relaxed);
+    return s;
+}
+
+OverrunDetector::OverrunDetector(long long sample_rate, std::size_t slack_blocks)
+    : rate_{sample_rate}
+    , slack_blocks_{slack_blocks}
+{
+}
+
+std::uint64_t OverrunDetector::on_block(std::size_t pairs, Clock::time_point now) noexcept
+{
+    // Timeline starts at the first block: whatever the driver queued before
+    // it is unknown
+    if (!started_) {
+        started_ = true;
+        origin_ = now;
+        return 0;
+    }
+
+    const nanoseconds block{static_cast<long long>(pairs) * 1'000'000'000LL / rate_};
+    credited_ += block;
+
+    const nanoseconds lag = std::chrono::duration_cast<nanoseconds>(now - origin_) - credited_;
+    const nanoseconds slack = block * static_cast<long long>(slack_blocks_);
+    if (block.count() <= 0 || lag <= slack)
+        return 0;
+
+    const auto lost = static_cast<std::uint64_t>((lag - slack + block - nanoseconds{1}) / block);
+    credited_ += block * static_cast<long long>(lost);
+    return lost;
+}
+
+std::string format_stats_line(const MetricsSnapshot& interval, std::uint64_t block_period_ns)
+{
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(2);
+    os << "Stats: " << interval.blocks << " blocks, " << interval.overruns << " overruns";
+
+    if (const double h = headroom(interval, block_period_ns); h > 0.0)
+        os << ", headroom " << std::setprecision(1) << h << 'x' << std::setprecision(2);
+
+    os << " | p50/p99/max ms:";
+    for (std::size_t i = 0; i < kStageCount; i++) {
+        const HistogramSnapshot& h = interval.stages[i];
+        if (h.count == 0)
+            continue;
+        os << ' ' << kStageNames[i] << ' '
+           << static_cast<double>(h.percentile(0.50)) / 1e6 << '/'
+           << static_cast<double>(h.percentile(0.99)) / 1e6 << '/'
+           << static_cast<double>(h.percentile(1.00)) / 1e6;
+    }
+    return os.str();
+}
+
+std::string format_prometheus(const MetricsSnapshot& total, std::uint64_t block_period_ns,
+                              std::string_view device)
+{
+    std::ostringstream os;
+    os << std::setprecision(9);
+
+    // Label of every sample: `device="x",` ahead of the stage, `{device="x"}` alone
+    const std::string dev = device.empty() ? std::string()
+                                           : "device=\"" + std::string(device) + '"';
+    const std::string only = dev.empty() ? std::string() : '{' + dev + '}';
+
+    os << "# TYPE fm_radio_stage_seconds summary\n";
+    for (std::size_t i = 0; i < kStageCount; i++) {
+        const HistogramSnapshot& h = total.stages[i];
+        if (h.count == 0)
+            continue;
+
+        const std::string label = (dev.empty() ? std::string() : dev + ',') +
+                                  "stage=\"" + kStageNames[i] + '"';
+        for (const double q : {0.5, 0.9, 0.99})
+            os << "fm_radio_stage_seconds{" << label << ",quantile=\"" << q << "\"} "
+               << static_cast<double>(h.percentile(q)) / 1e9 << '\n';
+        os << "fm_radio_stage_seconds_sum{" << label << "} "
+           << static_cast<double>(h.sum_ns) / 1e9 << '\n'
+           << "fm_radio_stage_seconds_count{" << label << "} " << h.count << '\n';
+    }
+
+    os << "# TYPE fm_radio_blocks_total counter\n"
+       << "fm_radio_blocks_total" << only << ' ' << total.blocks << '\n'
+       << "# TYPE fm_radio_overruns_total counter\n"
+       << "fm_radio_overruns_total" << only << ' ' << total.overruns << '\n'
+       << "# TYPE fm_radio_realtime_headroom gauge\n"
+       << "fm_radio_realtime_headroom" << only << ' ' << headroom(total, block_period_ns) << '\n';
+    return os.str();
+}
+
+StatsReporter::StatsReporter(const PipelineMetrics& metrics, const StatsOptions& opts)
+    : metrics_{metrics}
+    , opts_{opts}
+    , last_{metrics.snapshot()}
+{
+    if (opts_.udp_ip)
+        udp_.open(*opts_.udp_ip, opts_.udp_port);
+
+    const auto interval = std::chrono::duration_cast<nanoseconds>(
+        std::chrono::duration<double>(opts_.interval_s));
+
+    thread_ = std::jthread([this, interval] {
+        std::unique_lock lock(mutex_);
+        while (!wake_.wait_for(lock, interval, [this] { return stop_; }))
+            report();
+    });
+}
+
+StatsReporter::~StatsReporter()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+
+    report();
+}
+
+void StatsReporter::report()
+{
+    const MetricsSnapshot now = metrics_.snapshot();
+    // One write per line: the reporters of several devices share stderr
+    std::string line = opts_.label.empty() ? std::string() : '[' + opts_.label + "] ";
+    line += format_stats_line(now.since(last_), metrics_.block_period_ns());
+    line += '\n';
+    std::cerr << line;
+    last_ = now;
+
+    if (udp_.is_open()) {
+        const std::string text = format_prometheus(now, metrics_.block_period_ns(), opts_.label);
+        udp_.send_frame(text.data(), text.size(), 0);
+    }
+}
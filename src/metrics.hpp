@@ -0,0 +1,299 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "udp_sender.hpp"
+
+/**
+ * @file metrics.hpp
+ * @brief Low-overhead per-stage timing, overrun detection and stats reports.
+ *
+ * Every instrumented stage owns one LatencyHistogram that only the thread
+ * running the stage writes to, so recording a sample is a couple of relaxed
+ * atomic stores and no lock or read-modify-write. A StatsReporter thread
+ * reads the histograms concurrently and periodically prints per-stage
+ * percentiles and the real-time headroom.
+ */
+
+/// Instrumented stages of the receive loops.
+enum class Stage : std::size_t {
+    Capture,         ///< SampleSource::next_block() (iio_buffer_refill on the Pluto)
+    DownsampleIq,    ///< IQ decimation (boxcar or FIR)
+    Demodulate,      ///< FM discriminator
+    DownsampleAudio, ///< Audio decimation and sample conversion
+    Fused,           ///< Whole fused boxcar chain
+    Dsp,             ///< FmPipeline::process_block() as a whole
+    Output,          ///< Audio encoding and hand-off to the sink
+    Latency,         ///< Refill to output hand-off of a block, ring waits included (BlockMeta::captured)
+    Count
+};
+
+inline constexpr std::size_t kStageCount = static_cast<std::size_t>(Stage::Count);
+
+/// @return Short lowercase name of a stage ("capture", "dsp", ...).
+const char* stage_name(Stage stage) noexcept;
+
+/**
+ * @brief Counts of a LatencyHistogram at one point in time.
+ *
+ * Buckets are log-linear: 8 per power of two. Percentiles are reported as
+ * the upper bound of their bucket, so they err high by at most 12.5 %.
+ */
+struct HistogramSnapshot {
+    static constexpr std::size_t kSubBuckets = 8;
+    static constexpr std::size_t kBuckets = 62 * kSubBuckets;
+
+    std::array<std::uint64_t, kBuckets> buckets{};
+    std::uint64_t count  = 0;
+    std::uint64_t sum_ns = 0;
+
+    /// @return Bucket index of a duration.
+    static std::size_t bucket_of(std::uint64_t ns) noexcept;
+
+    /// @return Largest duration that falls into bucket @p index.
+    static std::uint64_t bucket_upper(std::size_t index) noexcept;
+
+    /// @return @p q quantile (0..1) in ns; 0 when empty.
+    [[nodiscard]] std::uint64_t percentile(double q) const noexcept;
+
+    /// @return Mean duration in ns; 0 when empty.
+    [[nodiscard]] double mean_ns() const noexcept;
+
+    /// @return Samples recorded after @p earlier was taken.
+    [[nodiscard]] HistogramSnapshot since(const HistogramSnapshot& earlier) const noexcept;
+};
+
+/**
+ * @class LatencyHistogram
+ * @brief Histogram of durations with one writer and any number of readers.
+ */
+class LatencyHistogram {
+public:
+    /// Record one duration; must only be called from a single thread.
+    void record(std::uint64_t ns) noexcept
+    {
+        bump(buckets_[HistogramSnapshot::bucket_of(ns)], 1);
+        bump(sum_ns_, ns);
+        bump(count_, 1);
+    }
+
+    /// Consistent enough copy for reporting; safe from any thread.
+    [[nodiscard]] HistogramSnapshot snapshot() const noexcept;
+
+private:
+    std::array<std::atomic<std::uint64_t>, HistogramSnapshot::kBuckets> buckets_{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> sum_ns_{0};
+
+    // Single writer: a plain load and store, no locked instruction
+    static void bump(std::atomic<std::uint64_t>& v, std::uint64_t n) noexcept
+    {
+        v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+};
+
+/// Counters of every stage at one point in time.
+struct MetricsSnapshot {
+    std::array<HistogramSnapshot, kStageCount> stages{};
+    std::uint64_t blocks   = 0;
+    std::uint64_t overruns = 0;
+
+    [[nodiscard]] const HistogramSnapshot& operator[](Stage s) const noexcept
+    {
+        return stages[static_cast<std::size_t>(s)];
+    }
+
+    /// @return Activity after @p earlier was taken.
+    [[nodiscard]] MetricsSnapshot since(const MetricsSnapshot& earlier) const noexcept;
+};
+
+/**
+ * @class PipelineMetrics
+ * @brief Stage histograms and block counters of one receive loop.
+ *
+ * The capture thread owns `blocks` and `overruns`; each stage histogram is
+ * written by the thread that runs the stage.
+ */
+class PipelineMetrics {
+public:
+    /// @param block_period_ns  Real-time duration of one capture block
+    explicit PipelineMetrics(std::uint64_t block_period_ns) : block_period_ns_{block_period_ns} {}
+
+    PipelineMetrics(const PipelineMetrics&) = delete;
+    PipelineMetrics& operator=(const PipelineMetrics&) = delete;
+
+    [[nodiscard]] LatencyHistogram& stage(Stage s) noexcept
+    {
+        return stages_[static_cast<std::size_t>(s)];
+    }
+
+    /// Count a captured block and @p lost blocks the source dropped before it.
+    void add_block(std::uint64_t lost = 0) noexcept
+    {
+        blocks_.store(blocks_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (lost)
+            overruns_.store(overruns_.load(std::memory_order_relaxed) + lost,
+                            std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] MetricsSnapshot snapshot() const noexcept;
+
+    [[nodiscard]] std::uint64_t block_period_ns() const noexcept
+    {
+        return block_period_ns_.load(std::memory_order_relaxed);
+    }
+
+    /// Follow a change of the capture block size (see BlockSizer).
+    void set_block_period_ns(std::uint64_t ns) noexcept
+    {
+        block_period_ns_.store(ns, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<std::uint64_t> block_period_ns_;
+    std::array<LatencyHistogram, kStageCount> stages_{};
+    std::atomic<std::uint64_t> blocks_{0};
+    std::atomic<std::uint64_t> overruns_{0};
+};
+
+/**
+ * @class StageTimer
+ * @brief Records the lifetime of the object into a stage histogram.
+ *
+ * A null @p metrics makes the timer a no-op, so instrumented code costs a
+ * branch when statistics are off.
+ */
+class StageTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    StageTimer(PipelineMetrics* metrics, Stage stage) noexcept
+        : hist_{metrics ? &metrics->stage(stage) : nullptr}
+    {
+        if (hist_) start_ = Clock::now();
+    }
+
+    ~StageTimer()
+    {
+        if (hist_)
+            hist_->record(static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_).count()));
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    LatencyHistogram* hist_;
+    Clock::time_point start_{};
+};
+
+/**
+ * @class OverrunDetector
+ * @brief Infers dropped hardware buffers from refill timing.
+ *
+ * A live source produces samples at a fixed rate. Each block is credited
+ * with its real-time duration; when the wall clock runs ahead of the
+ * credited time by more than the driver can queue, the difference must
+ * have been discarded by the hardware. Lost blocks are counted once and the
+ * timeline is re-synchronised.
+ */
+class OverrunDetector {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @param sample_rate   IQ pairs per second of the source
+     * @param slack_blocks  Blocks the driver buffers before it drops
+     */
+    OverrunDetector(long long sample_rate, std::size_t slack_blocks);
+
+    /**
+     * @brief Account a block of @p pairs that arrived at @p now.
+     * @return Blocks presumed lost since the previous block
+     */
+    std::uint64_t on_block(std::size_t pairs, Clock::time_point now = Clock::now()) noexcept;
+
+    /// Start a new timeline at the next block, after a stall the caller accounted itself.
+    void restart() noexcept
+    {
+        started_ = false;
+        credited_ = std::chrono::nanoseconds{0};
+    }
+
+private:
+    long long rate_;
+    std::size_t slack_blocks_;
+    bool started_ = false;
+    Clock::time_point origin_{};
+    std::chrono::nanoseconds credited_{0};
+};
+
+/// Periodic statistics reporting.
+struct StatsOptions {
+    /// Seconds between reports (0 disables statistics)
+    double interval_s = 0.0;
+
+    /// Optional destination of Prometheus text-format datagrams
+    std::optional<std::string> udp_ip;
+    int udp_port = 0;
+
+    /// Device name prefixed to each report line and set as the Prometheus
+    /// `device` label (empty for a single receiver)
+    std::string label;
+};
+
+/**
+ * @brief One-line human-readable report of @p interval.
+ *
+ * Lists p50/p99/max of every active stage, the blocks and overruns of the
+ * interval and the real-time headroom: the block period divided by the p99
+ * time spent in DSP and output per block.
+ */
+std::string format_stats_line(const MetricsSnapshot& interval, std::uint64_t block_period_ns);
+
+/// Prometheus text exposition of the cumulative counters in @p total,
+/// labelled `device="<device>"` unless @p device is empty.
+std::string format_prometheus(const MetricsSnapshot& total, std::uint64_t block_period_ns,
+                              std::string_view device = {});
+
+/**
+ * @class StatsReporter
+ * @brief Background thread printing PipelineMetrics every interval.
+ *
+ * Each report goes to stderr as one line covering the last interval and,
+ * if an address is set, as one Prometheus text datagram with the
+ * cumulative counters. The destructor prints a final report.
+ */
+class StatsReporter {
+public:
+    /// @throws std::runtime_error if the UDP socket cannot be opened
+    StatsReporter(const PipelineMetrics& metrics, const StatsOptions& opts);
+    ~StatsReporter();
+
+    StatsReporter(const StatsReporter&) = delete;
+    StatsReporter& operator=(const StatsReporter&) = delete;
+
+private:
+    const PipelineMetrics& metrics_;
+    StatsOptions opts_;
+    UdpSender udp_;
+    MetricsSnapshot last_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    std::jthread thread_;
+
+    void report();
+};
@@ -0,0 +1,484 @@
+#include "pipeline.hpp"
+
+#include <numbers>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+/// Magnitude of a full-scale int16 IQ sample
+constexpr float kIqFullScale = 32768.0f;
+
+/// Corner of the AM carrier tracker; audio below it is removed with the carrier
+constexpr double kAmCarrierCornerHz = 10.0;
+
+/// A FirDecimator of @p Fir's factor: its template argument, or @p decimation.
+template <typename Fir>
+Fir make_fir(int decimation)
+{
+    if constexpr (Fir::kRuntime)
+        return Fir(decimation);
+    else
+        return Fir();
+}
+
+/// First alternative from @p I on of mode @p dsp.mode that supports @p dsp.rates.
+template <std::size_t I = 0>
+AnyPipeline make_alternative(const DspOptions& dsp, float audio_gain, std::size_t block_size)
+{
+    using Pipeline = std::variant_alternative_t<I, AnyPipeline>;
+
+    if (Pipeline::kMode == dsp.mode && Pipeline::supports(dsp.rates))
+        return AnyPipeline{std::in_place_index<I>, dsp, audio_gain, block_size};
+
+    // The runtime chains take any plan, so the last alternative always matches
+    if constexpr (I + 1 < std::variant_size_v<AnyPipeline>)
+        return make_alternative<I + 1>(dsp, audio_gain, block_size);
+    else
+        throw std::invalid_argument("No pipeline for the demodulation mode");
+}
+
+/// @return true if AnyPipeline has a fixed-factor chain of mode @p Mode for @p plan.
+template <dsp::DemodulationMode Mode, std::size_t... I>
+constexpr bool has_fixed_chain(const RatePlan& plan, std::index_sequence<I...>)
+{
+    return ((std::variant_alternative_t<I, AnyPipeline>::kMode == Mode &&
+             !std::variant_alternative_t<I, AnyPipeline>::kRuntimeRates &&
+             std::variant_alternative_t<I, AnyPipeline>::supports(plan)) || ...);
+}
+
+constexpr bool all_plans_compiled()
+{
+    constexpr auto kAlternatives = std::make_index_sequence<std::variant_size_v<AnyPipeline>>{};
+    for (const RatePlan& plan : kCompiledRatePlans)
+        if (!has_fixed_chain<dsp::DemodulationMode::FM>(plan, kAlternatives) ||
+            !has_fixed_chain<dsp::DemodulationMode::AM>(plan, kAlternatives))
+            return false;
+    return true;
+}
+
+static_assert(all_plans_compiled(), "Every compiled rate plan needs an AnyPipeline alternative per mode");
+
+} // namespace
+
+void validate_rate_plan(const RatePlan& plan)
+{
+    if (plan.input_rate_hz <= 0)
+        throw std::invalid_argument("Sample rate must be positive");
+    if (plan.decim_iq < 1 || plan.decim_iq > kMaxDecimation ||
+        plan.decim_audio < 1 || plan.decim_audio > kMaxDecimation)
+        throw std::invalid_argument("Decimation must be between 1 and " +
+                                    std::to_string(kMaxDecimation));
+    if (plan.input_rate_hz % (static_cast<long long>(plan.decim_iq) * plan.decim_audio) != 0)
+        throw std::invalid_argument("Decimation " + std::to_string(plan.decim_iq) + ":" +
+                                    std::to_string(plan.decim_audio) + " does not divide " +
+                                    std::to_string(plan.input_rate_hz) + " Hz");
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+DemodPipeline<Mode, DecimIq, DecimAudio>::DemodPipeline(const DspOptions& dsp, float audio_gain,
+                                                        std::size_t block_size)
+    : dsp_{dsp}
+    , audio_gain_{audio_gain}
+    , iq_fir_{make_fir<decltype(iq_fir_)>(dsp.rates.decim_iq)}
+    , audio_fir_{make_fir<decltype(audio_fir_)>(dsp.rates.decim_audio)}
+    , stereo_{dsp.deemphasis_us}
+{
+    validate_rate_plan(dsp.rates);
+    if (!supports(dsp.rates))
+        throw std::invalid_argument("Rate plan decimations differ from the compiled chain");
+
+    const RatePlan& rates = dsp.rates;
+    if (Mode == dsp::DemodulationMode::FM && dsp.stereo &&
+        (static_cast<double>(rates.iq_rate_hz()) != dsp::StereoDecoder::kMpxRateHz ||
+         rates.decim_audio != dsp::StereoDecoder::kDecimation))
+        throw std::invalid_argument("Stereo needs a 240 kS/s IQ rate and 5:1 audio decimation");
+
+    if (dsp.arithmetic == Arithmetic::Fixed) {
+        if (Mode != dsp::DemodulationMode::FM)
+            throw std::invalid_argument("Fixed-point arithmetic supports FM only");
+        if (dsp.decimator != DecimatorType::Boxcar || dsp.stereo)
+            throw std::invalid_argument("Fixed-point arithmetic runs the mono boxcar chain only");
+    }
+
+    if (Mode == dsp::DemodulationMode::FM && dsp.deemphasis_us > 0.0f) {
+        const auto audio_rate = static_cast<float>(rates.audio_rate_hz());
+        deemphasis_alpha_ = dsp::deemphasis_alpha(dsp.deemphasis_us, audio_rate);
+        deemphasis_alpha_q15_ = dsp::deemphasis_alpha_q15(dsp.deemphasis_us, audio_rate);
+    }
+
+    carrier_alpha_ = static_cast<float>(2.0 * std::numbers::pi * kAmCarrierCornerHz /
+                                        static_cast<double>(rates.iq_rate_hz()));
+
+    position_ = StreamPosition(static_cast<std::uint64_t>(decim_iq() * decim_audio()));
+    reserve(block_size);
+
+    // A fresh FIR emits on its first input: blocks muted from the start count from there
+    muted_phase_ = audio_phase();
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+void DemodPipeline<Mode, DecimIq, DecimAudio>::reserve(std::size_t pairs)
+{
+    const std::size_t iq = pairs / static_cast<std::size_t>(decim_iq()) + 64;
+    const std::size_t audio = max_audio_samples(pairs);
+
+    const std::size_t pcm = fixed_point() ? audio : 0;
+
+    arena_ = Arena(Arena::footprint<std::complex<float>>(iq) +
+                   Arena::footprint<float>(iq) +
+                   Arena::footprint<float>(audio) +
+                   Arena::footprint<int16_t>(pcm));
+    iq_buf_    = arena_.allocate<std::complex<float>>(iq);
+    demod_buf_ = arena_.allocate<float>(iq);
+    audio_buf_ = arena_.allocate<float>(audio);
+    pcm_buf_   = arena_.allocate<int16_t>(pcm);
+
+    iq_fir_.reserve(pairs);
+    audio_fir_.reserve(iq);
+    if (channels() == 2)
+        stereo_.reserve(iq);
+    capacity_pairs_ = pairs;
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+std::size_t DemodPipeline<Mode, DecimIq, DecimAudio>::process_block(std::span<const int16_t> raw, std::span<float> audio_out)
+{
+    return run(raw, audio_out);
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+std::size_t DemodPipeline<Mode, DecimIq, DecimAudio>::process_block(std::span<const int16_t> raw, std::span<int16_t> audio_out)
+{
+    return run(raw, audio_out);
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+void DemodPipeline<Mode, DecimIq, DecimAudio>::process_block(std::span<const int16_t> raw, std::vector<float>& audio_out)
+{
+    audio_out.resize(max_audio_samples(raw.size() / 2));
+    audio_out.resize(run(raw, std::span(audio_out)));
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+void DemodPipeline<Mode, DecimIq, DecimAudio>::process_block(std::span<const int16_t> raw, std::vector<int16_t>& audio_out)
+{
+    audio_out.resize(max_audio_samples(raw.size() / 2));
+    audio_out.resize(run(raw, std::span(audio_out)));
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+std::size_t DemodPipeline<Mode, DecimIq, DecimAudio>::process_block(std::span<const int16_t> raw, const BlockMeta& meta,
+                                                                    std::span<float> audio_out)
+{
+    return run_stamped(raw, meta, audio_out);
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+std::size_t DemodPipeline<Mode, DecimIq, DecimAudio>::process_block(std::span<const int16_t> raw, const BlockMeta& meta,
+                                                                    std::span<int16_t> audio_out)
+{
+    return run_stamped(raw, meta, audio_out);
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+template <typename Out>
+std::size_t DemodPipeline<Mode, DecimIq, DecimAudio>::run_stamped(std::span<const int16_t> raw, const BlockMeta& meta,
+                                                                  std::span<Out> audio_out)
+{
+    audio_meta_ = position_.begin(meta);
+    const std::size_t samples = run(raw, audio_out);
+    position_.end(meta.sample_index + raw.size() / 2,
+                  (samples + muted_samples_) / static_cast<std::size_t>(channels()));
+    return samples;
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+template <typename Out>
+std::size_t DemodPipeline<Mode, DecimIq, DecimAudio>::run(std::span<const int16_t> raw, std::span<Out> audio_out)
+{
+    const std::size_t pairs = raw.size() / 2;
+    if (audio_out.size() < max_audio_samples(pairs))
+        throw std::invalid_argument("process_block: audio span too small");
+    if (pairs > capacity_pairs_)
+        reserve(pairs);
+
+    StageTimer total(metrics_, Stage::Dsp);
+    muted_samples_ = 0;
+
+    if (fixed_point())
+        return run_fixed(raw, audio_out);
+
+    // Only the FM chain has a fused kernel; AM always runs staged
+    if constexpr (Mode == dsp::DemodulationMode::FM) {
+        if (dsp_.fused && !dsp_.stereo && dsp_.decimator != DecimatorType::Fir) {
+            StageTimer t(metrics_, Stage::Fused);
+            float power = 0.0f;
+            float* const measure = dsp_.squelch_dbfs ? &power : nullptr;
+
+            if (deemphasis_alpha_ == 0.0f) {
+                const std::size_t n = dsp::demodulate_fm_fused(raw, audio_out, decim_iq(), decim_audio(),
+                                                               chain_state_, audio_gain_,
+                                                               dsp_.discriminator, measure);
+                return gate_after(power) ? n : drop(n);
+            }
+
+            const auto audio = float_audio(audio_out);
+            const std::size_t n = dsp::demodulate_fm_fused(raw, audio, decim_iq(), decim_audio(),
+                                                           chain_state_, audio_gain_,
+                                                           dsp_.discriminator, measure);
+            if (!gate_after(power))
+                return drop(n);
+            dsp::deemphasis(audio.first(n), deemphasis_alpha_, deemphasis_);
+            return emit_audio(audio.first(n), audio_out);
+        }
+    }
+
+    const auto iq = decimate_iq(raw);
+    if (!gate(iq_power(iq)))
+        return mute(iq.size());
+
+    return decimate_audio(demodulate(iq), audio_out);
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+float DemodPipeline<Mode, DecimIq, DecimAudio>::channel_power(std::span<const int16_t> raw)
+{
+    if (raw.size() / 2 > capacity_pairs_)
+        reserve(raw.size() / 2);
+    return iq_power(decimate_iq(raw));
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+std::span<const std::complex<float>> DemodPipeline<Mode, DecimIq, DecimAudio>::decimate_iq(std::span<const int16_t> raw)
+{
+    StageTimer t(metrics_, Stage::DownsampleIq);
+    if (dsp_.decimator == DecimatorType::Fir)
+        return iq_buf_.first(iq_fir_.process(raw, iq_buf_));
+    return iq_buf_.first(dsp::downsample_iq(raw, iq_buf_, decim_iq(), chain_state_.iq));
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+float DemodPipeline<Mode, DecimIq, DecimAudio>::iq_power(std::span<const std::complex<float>> iq) const
+{
+    // Boxcar sums decim_iq() samples without normalising
+    const float scale = dsp_.decimator == DecimatorType::Fir ? 1.0f
+                                                             : static_cast<float>(decim_iq());
+    return dsp::mean_power(iq, kIqFullScale * scale);
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+template <typename Out>
+std::size_t DemodPipeline<Mode, DecimIq, DecimAudio>::run_fixed(std::span<const int16_t> raw, std::span<Out> audio_out)
+{
+    StageTimer t(metrics_, Stage::Fused);
+    std::span<int16_t> pcm;
+    if constexpr (std::is_same_v<Out, int16_t>)
+        pcm = audio_out;
+    else
+        pcm = pcm_buf_;
+
+    // Like the fused chain, squelched after the pass that measures the IQ
+    float power = 0.0f;
+    const std::size_t n = dsp::demodulate_fm_fixed(raw, pcm, decim_iq(), decim_audio(),
+                                                   fixed_state_, audio_gain_,
+                                                   dsp_.squelch_dbfs ? &power : nullptr);
+    if (!gate_after(power))
+        return drop(n);
+
+    if (deemphasis_alpha_q15_ > 0)
+        dsp::deemphasis_q15(pcm.first(n), deemphasis_alpha_q15_, deemphasis_q15_);
+
+    if constexpr (std::is_same_v<Out, float>) {
+        for (std::size_t i = 0; i < n; i++)
+            audio_out[i] = static_cast<float>(pcm[i]) * (1.0f / dsp::kS16FullScale);
+    }
+    return n;
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+template <typename Out>
+std::size_t DemodPipeline<Mode, DecimIq, DecimAudio>::decimate_audio(std::span<const float> demod, std::span<Out> audio_out)
+{
+    StageTimer t(metrics_, Stage::DownsampleAudio);
+    const bool fir = dsp_.decimator == DecimatorType::Fir;
+
+    // Flat mono boxcar audio converts to s16 inside the decimator
+    if (!fir && channels() == 1 && deemphasis_alpha_ == 0.0f)
+        return dsp::downsample_audio(demod, audio_out, decim_audio(), chain_state_.audio, audio_gain_);
+
+    const auto audio = float_audio(audio_out);
+    std::size_t n = 0;
+
+    if (channels() == 2) {
+        // De-emphasises each channel itself
+        n = stereo_.process(demod, audio, audio_gain_);
+    } else {
+        n = fir ? audio_fir_.process(demod, audio, audio_gain_)
+                : dsp::downsample_audio(demod, audio, decim_audio(), chain_state_.audio, audio_gain_);
+        if (deemphasis_alpha_ > 0.0f)
+            dsp::deemphasis(audio.first(n), deemphasis_alpha_, deemphasis_);
+    }
+    return emit_audio(audio.first(n), audio_out);
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+template <typename Out>
+std::span<float> DemodPipeline<Mode, DecimIq, DecimAudio>::float_audio(std::span<Out> audio_out) noexcept
+{
+    if constexpr (std::is_same_v<Out, float>)
+        return audio_out;
+    else
+        return audio_buf_;
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+template <typename Out>
+std::size_t DemodPipeline<Mode, DecimIq, DecimAudio>::emit_audio(std::span<float> audio, std::span<Out> audio_out)
+{
+    if constexpr (std::is_same_v<Out, float>)
+        return audio.size();
+    else
+        return dsp::float_to_s16(audio, audio_out);
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+std::span<const float> DemodPipeline<Mode, DecimIq, DecimAudio>::demodulate(std::span<const std::complex<float>> iq)
+{
+    StageTimer t(metrics_, Stage::Demodulate);
+    const auto out = demod_buf_.first(iq.size());
+
+    if constexpr (Mode == dsp::DemodulationMode::FM) {
+        dsp::demodulate_fm(iq, out, chain_state_.demod, dsp_.discriminator);
+    } else {
+        // Envelope level depends on the decimator gain; carrier removal
+        // normalises it away
+        dsp::demodulate_am(iq, out);
+        dsp::remove_carrier(out, chain_state_.carrier, carrier_alpha_);
+    }
+    return out;
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+bool DemodPipeline<Mode, DecimIq, DecimAudio>::gate(float power)
+{
+    if (!dsp_.squelch_dbfs)
+        return true;
+
+    level_dbfs_ = dsp::power_dbfs(power);
+
+    const bool was_open = squelch_.open;
+    const bool open = dsp::squelch(level_dbfs_, *dsp_.squelch_dbfs,
+                                   dsp_.squelch_hysteresis_db, squelch_);
+
+    if (was_open && !open) {
+        // The open audio window carries on as muted samples
+        muted_phase_ = audio_phase();
+    } else if (open && !was_open) {
+        // Demodulator history and audio windows predate the gap; only the
+        // window phases, which the muted blocks kept, carry over, so the
+        // frame count keeps following the input
+        const dsp::IqDecimState iq = chain_state_.iq;
+        chain_state_ = {};
+        chain_state_.iq = iq;
+        const dsp::IqDecimState fixed_iq = fixed_state_.iq;
+        fixed_state_ = {};
+        fixed_state_.iq = fixed_iq;
+        deemphasis_ = {};
+        deemphasis_q15_ = {};
+        resume_audio(muted_phase_);
+        muted_phase_ = 0;
+    }
+    return open;
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+std::size_t DemodPipeline<Mode, DecimIq, DecimAudio>::audio_phase() const noexcept
+{
+    if (fixed_point())
+        return static_cast<std::size_t>(fixed_state_.audio.counter);
+    if (channels() == 2)
+        return stereo_.phase();
+    if (dsp_.decimator == DecimatorType::Fir)
+        return audio_fir_.phase();
+    return static_cast<std::size_t>(chain_state_.audio.counter);
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+void DemodPipeline<Mode, DecimIq, DecimAudio>::resume_audio(std::size_t phase)
+{
+    if (fixed_point())
+        fixed_state_.audio.counter = static_cast<int>(phase);
+    else if (channels() == 2)
+        stereo_.reset(phase);
+    else if (dsp_.decimator == DecimatorType::Fir)
+        audio_fir_.reset(phase);
+    else
+        chain_state_.audio.counter = static_cast<int>(phase);
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+std::size_t DemodPipeline<Mode, DecimIq, DecimAudio>::mute(std::size_t iq_samples)
+{
+    const std::size_t total = muted_phase_ + iq_samples;
+    const auto decim = static_cast<std::size_t>(decim_audio());
+    muted_samples_ = total / decim * static_cast<std::size_t>(channels());
+    muted_phase_   = total % decim;
+    return 0;
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+bool DemodPipeline<Mode, DecimIq, DecimAudio>::gate_after(float power)
+{
+    if (!dsp_.squelch_dbfs)
+        return true;
+
+    level_dbfs_ = dsp::power_dbfs(power);
+
+    const bool was_open = squelch_.open;
+    const bool open = dsp::squelch(level_dbfs_, *dsp_.squelch_dbfs,
+                                   dsp_.squelch_hysteresis_db, squelch_);
+    if (open && !was_open) {
+        deemphasis_ = {};
+        deemphasis_q15_ = {};
+    }
+    return open;
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+std::size_t DemodPipeline<Mode, DecimIq, DecimAudio>::drop(std::size_t samples)
+{
+    muted_samples_ = samples;
+    return 0;
+}
+
+template <dsp::DemodulationMode Mode, int DecimIq, int DecimAudio>
+void DemodPipeline<Mode, DecimIq, DecimAudio>::reset()
+{
+    chain_state_ = {};
+    fixed_state_ = {};
+    deemphasis_q15_ = {};
+    iq_fir_.reset();
+    audio_fir_.reset();
+    stereo_.reset();
+    deemphasis_ = {};
+    squelch_ = {};
+    muted_phase_ = audio_phase();
+    position_.reset();
+}
+
+template class DemodPipeline<dsp::DemodulationMode::FM>;
+template class DemodPipeline<dsp::DemodulationMode::FM,  8, 5>;
+template class DemodPipeline<dsp::DemodulationMode::FM, 16, 5>;
+template class DemodPipeline<dsp::DemodulationMode::FM,
+                             dsp::kRuntimeDecimation, dsp::kRuntimeDecimation>;
+template class DemodPipeline<dsp::DemodulationMode::AM>;
+template class DemodPipeline<dsp::DemodulationMode::AM,  8, 5>;
+template class DemodPipeline<dsp::DemodulationMode::AM, 16, 5>;
+template class DemodPipeline<dsp::DemodulationMode::AM,
+                             dsp::kRuntimeDecimation, dsp::kRuntimeDecimation>;
+
+AnyPipeline make_pipeline(const DspOptions& dsp, float audio_gain, std::size_t block_size)
+{
+    return make_alternative(dsp, audio_gain, block_size);
+}
@@ -0,0 +1,470 @@
+#pragma once
+
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "arena.hpp"
+#include "block_meta.hpp"
+#include "dsp.hpp"
+#include "fir_decimator.hpp"
+#include "fixed_point.hpp"
+#include "metrics.hpp"
+#include "stereo.hpp"
+
+/**
+ * @file pipeline.hpp
+ * @brief Hardware-independent FM/AM DSP chains (raw IQ block -> audio block).
+ */
+
+/// Decimation filter used by the IQ and audio rate-reduction stages.
+enum class DecimatorType {
+    Boxcar, ///< Moving-sum decimation (cheapest, weak alias rejection)
+    Fir     ///< Polyphase FIR low-pass (dsp::FirDecimator)
+};
+
+/// Number format of the FM chain.
+enum class Arithmetic {
+    Float, ///< Float chain (every decimator and discriminator tier)
+    Fixed  ///< Q15 chain, dsp::demodulate_fm_fixed(): mono boxcar FM only
+};
+
+/**
+ * @brief Sample rates of the receive chain: the SDR rate and the two
+ *        integer decimations down to the IQ (demodulator) and audio rates.
+ */
+struct RatePlan {
+    long long input_rate_hz = 2'400'000; ///< SDR sample rate
+    int decim_iq = 10;                   ///< Input -> IQ rate
+    int decim_audio = 5;                 ///< IQ -> audio rate
+
+    [[nodiscard]] constexpr long long iq_rate_hz() const noexcept { return input_rate_hz / decim_iq; }
+    [[nodiscard]] constexpr long long audio_rate_hz() const noexcept { return iq_rate_hz() / decim_audio; }
+
+    friend constexpr bool operator==(const RatePlan&, const RatePlan&) = default;
+};
+
+/// The network PlutoSDR plan: 2.4 MS/s -> 240 kS/s -> 48 kS/s.
+inline constexpr RatePlan kDefaultRatePlan{};
+
+/**
+ * Plans whose decimations are compiled in as fixed-factor chains (see
+ * make_pipeline()). All keep the 240 kS/s IQ rate the stereo decoder needs
+ * and give 48 kS/s audio; the faster ones suit a USB-attached PlutoSDR.
+ */
+inline constexpr std::array<RatePlan, 3> kCompiledRatePlans{{
+    {2'400'000, 10, 5},
+    {1'920'000,  8, 5},
+    {3'840'000, 16, 5},
+}};
+
+/// Largest decimation factor a RatePlan may use in either stage.
+inline constexpr int kMaxDecimation = 256;
+
+/// @return The compiled plan for an SDR rate of @p input_rate_hz, if there is one.
+constexpr std::optional<RatePlan> compiled_rate_plan(long long input_rate_hz) noexcept
+{
+    for (const RatePlan& plan : kCompiledRatePlans)
+        if (plan.input_rate_hz == input_rate_hz)
+            return plan;
+    return std::nullopt;
+}
+
+/**
+ * @brief Check that @p plan describes a chain DemodPipeline can run.
+ *
+ * @throws std::invalid_argument unless the input rate is positive, both
+ *         factors lie in [1, kMaxDecimation] and together divide the input
+ *         rate exactly, so every stage runs at a whole rate
+ */
+void validate_rate_plan(const RatePlan& plan);
+
+/// DSP chain selection.
+struct DspOptions {
+    /// Input rate and decimations; picks the chain specialisation (see make_pipeline())
+    RatePlan rates;
+
+    /// Demodulator; picks the DemodPipeline specialisation (see make_pipeline())
+    dsp::DemodulationMode mode = dsp::DemodulationMode::FM;
+
+    /// FM discriminator accuracy tier (FM only)
+    dsp::FmDiscriminator discriminator = dsp::FmDiscriminator::Exact;
+
+    /// Decimation filter for both rate-reduction stages
+    DecimatorType decimator = DecimatorType::Boxcar;
+
+    /// Float or Q15 fixed-point chain (Fixed: FM, boxcar, mono; the
+    /// discriminator tier and fused flag do not apply)
+    Arithmetic arithmetic = Arithmetic::Float;
+
+    /// Run the boxcar chain as one fused cache-resident pass (FM only;
+    /// ignored with stereo, which needs the discriminator output)
+    bool fused = false;
+
+    /// Decode pilot-tone stereo into interleaved L/R audio (FM only)
+    bool stereo = false;
+
+    /// FM de-emphasis time constant in microseconds: 50 (Europe) or 75
+    /// (Americas); 0 leaves the discriminator response flat
+    float deemphasis_us = 0.0f;
+
+    /// Squelch threshold in dBFS of the channel IQ (nullopt = always open)
+    std::optional<float> squelch_dbfs;
+
+    /// Level drop below the threshold that closes an open squelch
+    float squelch_hysteresis_db = 3.0f;
+
+    /// Flush denormal floats to zero on every thread that runs this chain
+    /// (FTZ/DAZ, see enable_flush_to_zero()); the receive loops and pools
+    /// set it when their DSP threads start
+    bool flush_denormals = false;
+};
+
+/// Stream state of the staged AM chain.
+struct AmChainState {
+    dsp::IqDecimState iq;          ///< Partial IQ decimation window
+    dsp::AmCarrierState carrier;   ///< Tracked carrier level
+    dsp::AudioDecimState audio;    ///< Partial audio decimation window
+};
+
+/// Per-mode stream state of DemodPipeline.
+template <dsp::DemodulationMode Mode>
+using ChainState = std::conditional_t<Mode == dsp::DemodulationMode::FM,
+                                      dsp::FusedFmState, AmChainState>;
+
+/**
+ * @class DemodPipeline
+ * @brief Receiver DSP chain, from interleaved int16 IQ to audio.
+ *
+ * Owns all DSP state and scratch buffers, but no hardware, so it can be
+ * driven by any sample source, including benchmarks and tests.
+ *
+ * The demodulator is a template parameter: each mode is compiled as its own
+ * chain with only the state it needs, so process_block() never branches on
+ * or dispatches through the mode. FM runs the phase discriminator; AM an
+ * envelope detector followed by carrier removal (dsp::remove_carrier()).
+ * DspOptions::mode is not consulted here, only by make_pipeline().
+ *
+ * All scratch buffers come from one Arena sized for `block_size` at
+ * construction, and the span overloads of process_block() write into
+ * caller storage, so a steady stream of blocks no larger than that runs
+ * without a single heap allocation. A larger block grows the arena once.
+ *
+ * The decimation factors of DspOptions::rates are template parameters as
+ * well. The common plans (kCompiledRatePlans) get chains with both factors
+ * as constants, so the FIR decimators use their tuned FirDesign and every
+ * stage size is known to the compiler; any other plan runs the runtime
+ * chain, `DemodPipeline<Mode, dsp::kRuntimeDecimation,
+ * dsp::kRuntimeDecimation>`, which reads the factors from the options.
+ * The boxcar kernels have fixed-factor bodies for the factors of the
+ * compiled plans either way (see dsp_kernels.hpp).
+ *
+ * With DspOptions::arithmetic set to Fixed, the FM chain runs in Q15
+ * integer arithmetic end to end (dsp::demodulate_fm_fixed(), then
+ * dsp::deemphasis_q15()), for cores whose float units are the bottleneck.
+ * It produces PCM natively; float output is converted from it.
+ *
+ * FM audio is optionally de-emphasised (DspOptions::deemphasis_us). With
+ * DspOptions::stereo the discriminator output goes through a
+ * dsp::StereoDecoder instead of the audio decimator, and every block
+ * yields interleaved L/R samples (channels() == 2).
+ *
+ * With DspOptions::squelch_dbfs set, the power of each block is measured
+ * after IQ decimation. While the squelch is closed the demodulator and
+ * audio stages are skipped: the block yields no audio and muted_samples()
+ * tells how much audio it stands for. The fused and fixed-point chains
+ * only see their decimated IQ inside the single pass, so they demodulate
+ * every block and drop the audio of squelched ones.
+ *
+ * @tparam Mode        Demodulator
+ * @tparam DecimIq     Input -> IQ decimation, or dsp::kRuntimeDecimation
+ * @tparam DecimAudio  IQ -> audio decimation, or dsp::kRuntimeDecimation
+ */
+template <dsp::DemodulationMode Mode,
+          int DecimIq = kDefaultRatePlan.decim_iq,
+          int DecimAudio = kDefaultRatePlan.decim_audio>
+class DemodPipeline {
+    static_assert((DecimIq > 0 && DecimAudio > 0) ||
+                  (DecimIq == dsp::kRuntimeDecimation && DecimAudio == dsp::kRuntimeDecimation),
+                  "Decimations must both be fixed or both be runtime");
+
+public:
+    static constexpr dsp::DemodulationMode kMode = Mode;
+
+    static constexpr int kDecimIq    = DecimIq;    ///< dsp::kRuntimeDecimation if not compiled in
+    static constexpr int kDecimAudio = DecimAudio; ///< dsp::kRuntimeDecimation if not compiled in
+
+    /// true for the chain that reads its factors from DspOptions::rates.
+    static constexpr bool kRuntimeRates = DecimIq == dsp::kRuntimeDecimation;
+
+    /// @return true if this chain can run @p plan.
+    [[nodiscard]] static constexpr bool supports(const RatePlan& plan) noexcept
+    {
+        return kRuntimeRates || (plan.decim_iq == DecimIq && plan.decim_audio == DecimAudio);
+    }
+
+    /**
+     * @param dsp         DSP chain selection
+     * @param audio_gain  Audio gain applied after DSP
+     * @param block_size  Expected IQ pairs per block (sizes scratch buffers)
+     * @throws std::invalid_argument for a rate plan this chain cannot run,
+     *         or options the selected chain does not support
+     */
+    explicit DemodPipeline(const DspOptions& dsp = {},
+                           float audio_gain = 0.3f,
+                           std::size_t block_size = 120'000);
+
+    /**
+     * @brief Process a block of raw I/Q samples into caller storage.
+     *
+     * @param audio_out  At least max_audio_samples() of the block's pairs
+     *                   and channels()
+     * @return Audio samples written (0 while squelched)
+     * @throws std::invalid_argument if @p audio_out is too short
+     */
+    std::size_t process_block(std::span<const int16_t> raw, std::span<float> audio_out);
+
+    /**
+     * @brief Process a block straight to saturated 16-bit PCM.
+     *
+     * The flat boxcar chains convert inside their last stage (see
+     * dsp::float_to_s16()); the others convert their float audio output.
+     */
+    std::size_t process_block(std::span<const int16_t> raw, std::span<int16_t> audio_out);
+
+    /// process_block() into a vector resized to the audio produced.
+    void process_block(std::span<const int16_t> raw, std::vector<float>& audio_out);
+
+    /// PCM process_block() into a vector resized to the audio produced.
+    void process_block(std::span<const int16_t> raw, std::vector<int16_t>& audio_out);
+
+    /**
+     * @brief process_block() of a block stamped with @p meta.
+     *
+     * Afterwards audio_meta() describes the audio written (or muted): its
+     * capture time and the audio frame index of its first sample, kept by
+     * a StreamPosition over `decim_iq * decim_audio`.
+     */
+    std::size_t process_block(std::span<const int16_t> raw, const BlockMeta& meta,
+                              std::span<float> audio_out);
+
+    /// Stamped process_block() straight to 16-bit PCM.
+    std::size_t process_block(std::span<const int16_t> raw, const BlockMeta& meta,
+                              std::span<int16_t> audio_out);
+
+    /// @return Metadata of the audio of the last stamped block, at the audio rate.
+    [[nodiscard]] const BlockMeta& audio_meta() const noexcept { return audio_meta_; }
+
+    /// Size all scratch buffers for blocks of up to @p pairs (allocates).
+    void reserve(std::size_t pairs);
+
+    /// Clear all stream state (e.g. after a discontinuity in the input).
+    void reset();
+
+    /// @return Interleaved audio channels per frame: 2 for FM stereo, else 1.
+    [[nodiscard]] int channels() const noexcept
+    {
+        return Mode == dsp::DemodulationMode::FM && dsp_.stereo ? 2 : 1;
+    }
+
+    /// @return Audio samples the last block would have produced, if squelched; else 0.
+    [[nodiscard]] std::size_t muted_samples() const noexcept { return muted_samples_; }
+
+    /**
+     * @brief Mean power of @p raw inside the channel, relative to full scale.
+     *
+     * Runs only the IQ decimator of process_block(), so signals outside the
+     * channel are rejected as they are before the squelch. Advances the
+     * decimator state; reset() before going back to process_block() on a
+     * different stream.
+     */
+    float channel_power(std::span<const int16_t> raw);
+
+    /// @return Level of the last block in dBFS (only measured with a squelch).
+    [[nodiscard]] float level_dbfs() const noexcept { return level_dbfs_; }
+
+    /// @return Upper bound of audio samples (all channels) produced for a block of @p pairs.
+    [[nodiscard]] std::size_t max_audio_samples(std::size_t pairs) const noexcept
+    {
+        const auto decim = static_cast<std::size_t>(decim_iq() * decim_audio());
+        return (pairs / decim + 64) * static_cast<std::size_t>(channels());
+    }
+
+    /// @return Input -> IQ decimation (a constant unless kRuntimeRates).
+    [[nodiscard]] int decim_iq() const noexcept
+    {
+        if constexpr (kRuntimeRates) return dsp_.rates.decim_iq;
+        else                         return DecimIq;
+    }
+
+    /// @return IQ -> audio decimation (a constant unless kRuntimeRates).
+    [[nodiscard]] int decim_audio() const noexcept
+    {
+        if constexpr (kRuntimeRates) return dsp_.rates.decim_audio;
+        else                         return DecimAudio;
+    }
+
+    [[nodiscard]] const RatePlan& rates() const noexcept { return dsp_.rates; }
+
+    [[nodiscard]] const DspOptions& options() const noexcept { return dsp_; }
+
+    /**
+     * @brief Time every stage into @p metrics (nullptr to stop).
+     *
+     * The histograms are written by the thread calling process_block().
+     */
+    void set_metrics(PipelineMetrics* metrics) noexcept { metrics_ = metrics; }
+
+private:
+    DspOptions dsp_;
+    float audio_gain_;
+    PipelineMetrics* metrics_ = nullptr;
+
+    ChainState<Mode> chain_state_;
+    dsp::FirDecimator<std::complex<float>, DecimIq> iq_fir_;
+    dsp::FirDecimator<float, DecimAudio> audio_fir_;
+    dsp::StereoDecoder stereo_;
+    float deemphasis_alpha_ = 0.0f;   ///< 0 = off (always for AM)
+    float carrier_alpha_ = 0.0f;      ///< AM carrier tracker coefficient
+    dsp::DeemphasisState deemphasis_;
+
+    // Fixed-point chain (Arithmetic::Fixed)
+    dsp::FixedFmState fixed_state_;
+    int32_t deemphasis_alpha_q15_ = 0; ///< 0 = off
+    dsp::DeemphasisStateQ15 deemphasis_q15_;
+
+    // Scratch buffers, all in arena_, for blocks of up to capacity_pairs_
+    Arena arena_;
+    std::size_t capacity_pairs_ = 0;
+    std::span<std::complex<float>> iq_buf_;
+    std::span<float> demod_buf_; ///< Discriminator or AM envelope output
+    std::span<float> audio_buf_; ///< Float audio ahead of s16 conversion
+    std::span<int16_t> pcm_buf_; ///< Fixed-point PCM ahead of float conversion
+
+    // Squelch
+    dsp::SquelchState squelch_;
+    float level_dbfs_ = -200.0f;
+    std::size_t muted_samples_ = 0;
+    std::size_t muted_phase_ = 0; ///< Partial audio window while muted
+
+    // Stream position of stamped blocks
+    StreamPosition position_;
+    BlockMeta audio_meta_;
+
+    /// Both process_block() overloads; Out is float or int16_t.
+    template <typename Out>
+    std::size_t run(std::span<const int16_t> raw, std::span<Out> audio_out);
+
+    /// run() of a stamped block, keeping audio_meta() in step.
+    template <typename Out>
+    std::size_t run_stamped(std::span<const int16_t> raw, const BlockMeta& meta,
+                            std::span<Out> audio_out);
+
+    /// Fixed-point chain of run().
+    template <typename Out>
+    std::size_t run_fixed(std::span<const int16_t> raw, std::span<Out> audio_out);
+
+    /// @return true if the Q15 chain runs instead of the float one.
+    [[nodiscard]] bool fixed_point() const noexcept
+    {
+        return Mode == dsp::DemodulationMode::FM && dsp_.arithmetic == Arithmetic::Fixed;
+    }
+
+    /// IQ decimator in use (FIR or boxcar) into iq_buf_; @return its output.
+    std::span<const std::complex<float>> decimate_iq(std::span<const int16_t> raw);
+
+    /// @return Mean power of decimate_iq() output @p iq, relative to full scale.
+    [[nodiscard]] float iq_power(std::span<const std::complex<float>> iq) const;
+
+    /// Demodulator of this mode into demod_buf_; @return its output.
+    std::span<const float> demodulate(std::span<const std::complex<float>> iq);
+
+    /// Last stage: @p demod to audio (decimation or stereo, de-emphasis, s16).
+    template <typename Out>
+    std::size_t decimate_audio(std::span<const float> demod, std::span<Out> audio_out);
+
+    /// @return Where float audio for @p audio_out goes: itself, or audio_buf_ ahead of s16.
+    template <typename Out>
+    std::span<float> float_audio(std::span<Out> audio_out) noexcept;
+
+    /// Hand float @p audio from float_audio() over to @p audio_out; @return its size.
+    template <typename Out>
+    std::size_t emit_audio(std::span<float> audio, std::span<Out> audio_out);
+
+    /// @return true if a block of mean @p power may pass the squelch.
+    bool gate(float power);
+
+    /// @return Inputs taken toward the next frame by the audio decimator in use.
+    [[nodiscard]] std::size_t audio_phase() const noexcept;
+
+    /// Restart the audio decimator in use with @p phase inputs of its window taken.
+    void resume_audio(std::size_t phase);
+
+    /// Skip a squelched block that decimated to @p iq_samples; @return 0.
+    std::size_t mute(std::size_t iq_samples);
+
+    /**
+     * @brief gate() for a single-pass chain that already ran the block.
+     *
+     * Its state followed the input throughout, so only de-emphasis, which
+     * skips squelched audio, starts over on reopening.
+     */
+    bool gate_after(float power);
+
+    /// Drop the @p samples a single-pass chain made of a squelched block; @return 0.
+    std::size_t drop(std::size_t samples);
+};
+
+/// Chains of the default plan (kDefaultRatePlan).
+using FmPipeline = DemodPipeline<dsp::DemodulationMode::FM>;
+using AmPipeline = DemodPipeline<dsp::DemodulationMode::AM>;
+
+/// Chains for any plan, reading the decimations at runtime.
+using FmRuntimePipeline = DemodPipeline<dsp::DemodulationMode::FM,
+                                        dsp::kRuntimeDecimation, dsp::kRuntimeDecimation>;
+using AmRuntimePipeline = DemodPipeline<dsp::DemodulationMode::AM,
+                                        dsp::kRuntimeDecimation, dsp::kRuntimeDecimation>;
+
+extern template class DemodPipeline<dsp::DemodulationMode::FM>;
+extern template class DemodPipeline<dsp::DemodulationMode::FM,  8, 5>;
+extern template class DemodPipeline<dsp::DemodulationMode::FM, 16, 5>;
+extern template class DemodPipeline<dsp::DemodulationMode::FM,
+                                    dsp::kRuntimeDecimation, dsp::kRuntimeDecimation>;
+extern template class DemodPipeline<dsp::DemodulationMode::AM>;
+extern template class DemodPipeline<dsp::DemodulationMode::AM,  8, 5>;
+extern template class DemodPipeline<dsp::DemodulationMode::AM, 16, 5>;
+extern template class DemodPipeline<dsp::DemodulationMode::AM,
+                                    dsp::kRuntimeDecimation, dsp::kRuntimeDecimation>;
+
+/**
+ * @brief A pipeline of whichever mode and rate plan was selected at runtime.
+ *
+ * Per mode, one alternative for each of kCompiledRatePlans and the runtime
+ * chain last, which make_pipeline() falls back to.
+ */
+using AnyPipeline = std::variant<FmPipeline,
+                                 DemodPipeline<dsp::DemodulationMode::FM,  8, 5>,
+                                 DemodPipeline<dsp::DemodulationMode::FM, 16, 5>,
+                                 FmRuntimePipeline,
+                                 AmPipeline,
+                                 DemodPipeline<dsp::DemodulationMode::AM,  8, 5>,
+                                 DemodPipeline<dsp::DemodulationMode::AM, 16, 5>,
+                                 AmRuntimePipeline>;
+
+/**
+ * @brief Build the DemodPipeline specialisation for @p dsp.mode and @p dsp.rates.
+ *
+ * Picks the fixed-factor chain of the plan's decimations if one is
+ * compiled in, else the runtime chain of the mode. Callers branch once,
+ * through std::visit() around their whole receive loop, rather than per
+ * block.
+ *
+ * @throws std::invalid_argument as the DemodPipeline constructor
+ */
+AnyPipeline make_pipeline(const DspOptions& dsp, float audio_gain, std::size_t block_size);
@@ -1,7 +1,7 @@
 #include "plutosdr.hpp"
 #include <cstring>
 #include <stdexcept>
-#include <iostream>
+#include <string>
 
 void ContextDeleter::operator()(iio_context* ctx) const noexcept {
     if (ctx) iio_context_destroy(ctx);
@@ -29,39 +29,35 @@ inline void write_attr(iio_channel* ch, const char* name, const char* value) {
 
 PlutoSDR::PlutoSDR(long long frequency_hz,
                    double gain_db,
-                   std::optional<std::string> udp_ip,
-                   std::optional<int> udp_port,
-                   float audio_gain)
+                   const CaptureOptions& capture)
     : frequency_hz_{frequency_hz}
     , gain_db_{gain_db}
-    , audio_gain_{audio_gain}
-    , iq_buf_(PlutoConfig::kBufferSize / PlutoConfig::kDecimIq + 64)
-    , freq_buf_(PlutoConfig::kBufferSize / PlutoConfig::kDecimIq + 64)
+    , capture_{capture}
 {
-    if (udp_ip.has_value() && udp_port.has_value()) {
-        udp_.open(udp_ip.value(), udp_port.value());
-        use_udp_ = true;
-    }
+    if (capture_.buffer_size == 0)
+        throw std::invalid_argument("Buffer size must be non-zero");
+    if (capture_.sample_rate_hz <= 0)
+        throw std::invalid_argument("Sample rate must be positive");
 
     initialize_hardware();
 }
 
 void PlutoSDR::initialize_hardware()
 {
-    ctx_.reset(iio_create_context_from_uri(PlutoConfig::kPlutoUri));
+    ctx_.reset(iio_create_context_from_uri(capture_.uri.c_str()));
     if (!ctx_)
-        throw std::runtime_error("Failed to create IIO context");
+        throw std::runtime_error("Failed to create IIO context for " + capture_.uri);
 
     auto* phy   = iio_context_find_device(ctx_.get(), PlutoConfig::kDevicePhy);
     dev_rx_     = iio_context_find_device(ctx_.get(), PlutoConfig::kDeviceRx);
     if (!phy || !dev_rx_)
         throw std::runtime_error("PlutoSDR devices not found");
 
-    auto* lo = iio_device_find_channel(phy, PlutoConfig::kChannelLO, true);
+    lo_      = iio_device_find_channel(phy, PlutoConfig::kChannelLO, true);
     auto* rf = iio_device_find_channel(phy, PlutoConfig::kChannelRxI, false);
 
-    write_attr(lo, PlutoConfig::kAttrFrequency, frequency_hz_);
-    write_attr(rf, PlutoConfig::kAttrSampleRate, PlutoConfig::kInputRateHz);
+    write_attr(lo_, PlutoConfig::kAttrFrequency, frequency_hz_);
+    write_attr(rf, PlutoConfig::kAttrSampleRate, capture_.sample_rate_hz);
     write_attr(rf, PlutoConfig::kAttrGainMode,   PlutoConfig::kGainModeManual);
     write_attr(rf, PlutoConfig::kAttrGain,       static_cast<long long>(gain_db_));
 
@@ -73,51 +69,65 @@ void PlutoSDR::initialize_hardware()
     iio_channel_enable(rx_chan_i_);
     iio_channel_enable(rx_q);
 
+    // Must be set before the buffer is created
+    if (capture_.kernel_buffers > 0 &&
+        iio_device_set_kernel_buffers_count(dev_rx_, capture_.kernel_buffers) < 0)
+        throw std::runtime_error("Failed to set kernel buffer count");
+
+    create_buffer();
+}
+
+void PlutoSDR::create_buffer()
+{
     rx_buffer_.reset(iio_device_create_buffer(dev_rx_,
-                                              PlutoConfig::kBufferSize,
+                                              capture_.buffer_size,
                                               false));
     if (!rx_buffer_)
         throw std::runtime_error("Failed to create RX buffer");
 }
 
-void PlutoSDR::process_block(std::span<const int16_t> raw, std::vector<float>& audio_out)
+bool PlutoSDR::retune(long long frequency_hz)
 {
-    dsp::downsample_iq(raw, iq_buf_, PlutoConfig::kDecimIq);
-    dsp::demodulate_fm(iq_buf_, freq_buf_, demod_state_);
-    dsp::downsample_audio(freq_buf_, audio_out, PlutoConfig::kDecimAudio, audio_state_, audio_gain_);
+    write_attr(lo_, PlutoConfig::kAttrFrequency, frequency_hz);
+    frequency_hz_ = frequency_hz;
+
+    // Destroying the buffer stops streaming and frees the queued kernel
+    // blocks, which still hold samples from the old frequency
+    rx_buffer_.reset();
+    create_buffer();
+    return true;
 }
 
-void PlutoSDR::output_audio(const std::vector<float>& audio)
+bool PlutoSDR::set_block_size(std::size_t pairs)
 {
-    if (audio.empty()) return;
-
-    if (use_udp_ && udp_.is_open()) {
-        udp_.send(audio);
-    } else {
-        std::cout.write(reinterpret_cast<const char*>(audio.data()),
-                        audio.size() * sizeof(float));
+    if (pairs == 0)
+        return false;
+    if (pairs == capture_.buffer_size)
+        return true;
+
+    // A device has one buffer at a time, so the old one goes first; if the
+    // new size is refused, stream on at the old one
+    rx_buffer_.reset();
+    BufferPtr resized{iio_device_create_buffer(dev_rx_, pairs, false)};
+    if (!resized) {
+        create_buffer();
+        return false;
     }
+    rx_buffer_ = std::move(resized);
+    capture_.buffer_size = pairs;
+    return true;
 }
 
-void PlutoSDR::run()
+std::span<const int16_t> PlutoSDR::next_block()
 {
-    std::vector<float> audio_out;
-    audio_out.reserve(PlutoConfig::kBufferSize /
-                      (PlutoConfig::kDecimIq * PlutoConfig::kDecimAudio) + 64);
-
-    while (true) {
-        if (iio_buffer_refill(rx_buffer_.get()) < 0)
-            break;
+    if (iio_buffer_refill(rx_buffer_.get()) < 0)
+        return {};
 
-        auto* start = static_cast<int16_t*>(
-            iio_buffer_first(rx_buffer_.get(), rx_chan_i_));
+    auto* start = static_cast<int16_t*>(
+        iio_buffer_first(rx_buffer_.get(), rx_chan_i_));
 
-        auto* end = static_cast<int16_t*>(
-            iio_buffer_end(rx_buffer_.get()));
+    auto* end = static_cast<int16_t*>(
+        iio_buffer_end(rx_buffer_.get()));
 
-        std::span<const int16_t> raw{start, static_cast<size_t>(end - start)};
-
-        process_block(raw, audio_out);
-        output_audio(audio_out);
-    }
+    return {start, static_cast<size_t>(end - start)};
 }
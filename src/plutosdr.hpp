@@ -1,26 +1,23 @@
 #pragma once
 
-#include <complex>
 #include <cstdint>
 #include <memory>
-#include <optional>
 #include <span>
 #include <string>
-#include <vector>
 
 #include <iio.h>
 
-#include "dsp.hpp"
-#include "udp_sender.hpp"
+#include "pipeline.hpp"
+#include "sample_source.hpp"
 
 /**
  * @file plutosdr.hpp
- * @brief PlutoSDR FM receiver integrating libIIO and DSP pipeline
+ * @brief PlutoSDR IQ source built on libIIO
  */
 
-/// Constants used by ADALM-PLUTO SDR hardware and DSP configuration.
+/// Constants used by ADALM-PLUTO SDR hardware and its default configuration.
 struct PlutoConfig {
-    // Hardware URIs and device/channel names
+    // Default URI (network link) and device/channel names
     static constexpr const char* kPlutoUri        = "ip:pluto.local";
     static constexpr const char* kDevicePhy       = "ad9361-phy";
     static constexpr const char* kDeviceRx        = "cf-ad9361-lpc";
@@ -37,13 +34,25 @@ struct PlutoConfig {
     // Attribute values
     static constexpr const char* kGainModeManual  = "manual";
 
-    // Rates and buffer sizes
-    static constexpr long long   kInputRateHz     = 2'400'000; ///< 2.4 MSPS
+    // Default rate and buffer sizes
+    static constexpr long long   kInputRateHz     = kDefaultRatePlan.input_rate_hz;
     static constexpr std::size_t kBufferSize      = 120'000; ///< 50 ms
+    static constexpr unsigned    kKernelBuffers   = 4;       ///< libiio default
+};
+
+/// Runtime capture settings: device, sample rate and buffer geometry.
+struct CaptureOptions {
+    /// IQ samples per refill; any size, partial decimation windows carry over
+    std::size_t buffer_size = PlutoConfig::kBufferSize;
+
+    /// Number of kernel-side buffers queued by the IIO driver (0 = driver default)
+    unsigned kernel_buffers = PlutoConfig::kKernelBuffers;
+
+    /// libiio context URI, e.g. "ip:192.168.2.1" or "usb:" for a USB-attached PlutoSDR
+    std::string uri = PlutoConfig::kPlutoUri;
 
-    // DSP decimations
-    static constexpr int         kDecimIq         = 10;  ///< 2.4M -> 240k
-    static constexpr int         kDecimAudio      = 5;   ///< 240k -> 48k
+    /// Sample rate programmed into the AD9361 (must match DspOptions::rates)
+    long long sample_rate_hz = PlutoConfig::kInputRateHz;
 };
 
 /// RAII deleter for iio_context
@@ -61,55 +70,79 @@ using BufferPtr  = std::unique_ptr<iio_buffer,  BufferDeleter>;
 
 /**
  * @class PlutoSDR
- * @brief Handles PlutoSDR hardware, IQ acquisition, DSP chain, and audio output
+ * @brief Handles PlutoSDR hardware configuration and IQ acquisition.
+ *
+ * Each next_block() refills the IIO buffer and returns it in place, so the
+ * receiver runs DSP directly on the driver's memory. While a block is
+ * processed, the driver keeps filling the remaining kernel buffers, so with
+ * `kernel_buffers > 1` a slow DSP or output pass is absorbed by the kernel
+ * ring instead of overrunning the FIFO.
  */
-class PlutoSDR {
+class PlutoSDR final : public SampleSource {
 public:
     /**
-     * @brief Construct PlutoSDR receiver
+     * @brief Open and configure the PlutoSDR
      * @param frequency_hz Center RF frequency (Hz)
      * @param gain_db      RF gain (dB)
-     * @param udp_ip       Optional UDP destination IP
-     * @param udp_port     Optional UDP port
-     * @param audio_gain   Audio gain applied after DSP
+     * @param capture      Device URI, sample rate and capture buffers
      */
     PlutoSDR(long long frequency_hz,
              double gain_db,
-             std::optional<std::string> udp_ip = std::nullopt,
-             std::optional<int> udp_port       = std::nullopt,
-             float audio_gain                  = 0.3f);
+             const CaptureOptions& capture = {});
+
+    std::span<const int16_t> next_block() override;
+
+    [[nodiscard]] std::size_t block_size() const noexcept override { return capture_.buffer_size; }
+    [[nodiscard]] long long sample_rate() const noexcept override { return capture_.sample_rate_hz; }
+    [[nodiscard]] bool live() const noexcept override { return true; }
+
+    /// The kernel buffers queued by the IIO driver.
+    [[nodiscard]] std::size_t queued_blocks() const noexcept override
+    {
+        return capture_.kernel_buffers ? capture_.kernel_buffers : PlutoConfig::kKernelBuffers;
+    }
+
+    /**
+     * @brief Retune the LO in place, keeping the IIO context.
+     *
+     * Writes the LO frequency attribute and recreates the RX buffer, which
+     * discards the blocks still queued in the kernel buffers from the old
+     * frequency. Costs milliseconds instead of the seconds of a reconnect.
+     *
+     * @throws std::runtime_error if the attribute write or buffer creation fails
+     */
+    bool retune(long long frequency_hz) override;
+
+    /**
+     * @brief Recreate the RX buffer with @p pairs per refill.
+     *
+     * Like retune(), this drops the blocks queued in the kernel buffers, so
+     * the stream has a gap of up to `kernel_buffers` blocks, whether or not
+     * the new size is accepted.
+     *
+     * @return false, keeping the old size, if no buffer of @p pairs can be created
+     * @throws std::runtime_error if the buffer of the old size cannot be recreated either
+     */
+    bool set_block_size(std::size_t pairs) override;
 
-    /// Start continuous receive nad output loop
-    void run();
+    [[nodiscard]] long long frequency_hz() const noexcept { return frequency_hz_; }
 
 private:
     // User parameters
     long long frequency_hz_;
     double gain_db_;
-    float audio_gain_;
+    CaptureOptions capture_;
 
     // IIO device
     ContextPtr ctx_;
     iio_device*  dev_rx_ = nullptr;
     iio_channel* rx_chan_i_ = nullptr;
+    iio_channel* lo_ = nullptr;
     BufferPtr rx_buffer_;
 
-    // DSP buffers and state
-    dsp::DemodState demod_state_;
-    dsp::AudioDecimState audio_state_;
-    std::vector<std::complex<float>> iq_buf_;
-    std::vector<float> freq_buf_;
-
-    // Optional UDP output
-    UdpSender udp_;
-    bool use_udp_ = false;
-
     /// Configure PlutoSDR hardware (frequency, gain, sampling rate).
     void initialize_hardware();
 
-    /// Process a block of raw I/Q samples through DSP pipeline.
-    void process_block(std::span<const int16_t> raw, std::vector<float>& audio_out);
-
-    /// Output audio either to UDP or stdout.
-    void output_audio(const std::vector<float>& audio);
+    /// (Re)create the RX buffer; the previous one must be destroyed first.
+    void create_buffer();
 };
@@ -0,0 +1,424 @@
+#include "receiver.hpp"
+#include "channel_bank.hpp"
+#include "spectrum_tap.hpp"
+#include "spsc_ring.hpp"
+#include "thread_util.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <variant>
+
+namespace {
+
+/// Wall-clock throughput of one receive loop, reported on stderr.
+class RunStats {
+public:
+    explicit RunStats(long long sample_rate) : rate_{sample_rate} {}
+
+    void add(std::size_t raw_samples) noexcept { pairs_ += raw_samples / 2; }
+
+    ~RunStats()
+    {
+        const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start_;
+        const double secs = elapsed.count();
+        const double msps = secs > 0.0 ? static_cast<double>(pairs_) / secs / 1e6 : 0.0;
+
+        std::cerr << "Processed " << pairs_ << " IQ samples in " << secs << " s ("
+                  << msps << " MSPS, "
+                  << msps * 1e6 / static_cast<double>(rate_) << "x real time)\n";
+    }
+
+private:
+    long long rate_;
+    std::uint64_t pairs_ = 0;
+    std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+};
+
+/// Report what the stdout writer had to drop for a slow consumer.
+void report_stdout(const AudioOutput& output)
+{
+    const auto st = output.stdout_stats();
+    if (!st)
+        return;
+
+    std::cerr << "Stdout ring high-water:  " << st->high_water << '\n'
+              << "Dropped stdout frames:   " << st->frames_dropped << '\n';
+}
+
+/// @return Audio samples the pipeline produces at most for a block of @p pairs.
+std::size_t max_block_audio(const AnyPipeline& pipeline, std::size_t pairs)
+{
+    return std::visit([&](const auto& p) { return p.max_audio_samples(pairs); },
+                      pipeline);
+}
+
+/// @return Detector of the blocks a live @p source drops, whether or not stats are on.
+std::optional<OverrunDetector> overrun_detector(const SampleSource& source)
+{
+    // Beyond the queued buffers, a late refill means lost samples
+    if (!source.live())
+        return std::nullopt;
+    return OverrunDetector(source.sample_rate(), source.queued_blocks() + 1);
+}
+
+} // namespace
+
+Receiver::Receiver(SampleSource& source,
+                   std::optional<std::string> udp_ip,
+                   std::optional<int> udp_port,
+                   const DspOptions& dsp,
+                   float audio_gain,
+                   const OutputOptions& output)
+    : source_{source}
+    , pipeline_{make_pipeline(dsp, audio_gain, source.block_size())}
+    , output_{udp_ip && udp_port ? AudioOutput(*udp_ip, *udp_port, output)
+                                 : AudioOutput(output)}
+    , flush_denormals_{dsp.flush_denormals}
+    , overruns_{overrun_detector(source)}
+{
+}
+
+Receiver::Receiver(SampleSource& source,
+                   std::span<const UdpDestination> destinations,
+                   const DspOptions& dsp,
+                   float audio_gain,
+                   const OutputOptions& output)
+    : source_{source}
+    , pipeline_{make_pipeline(dsp, audio_gain, source.block_size())}
+    , output_{destinations, output}
+    , flush_denormals_{dsp.flush_denormals}
+    , overruns_{overrun_detector(source)}
+{
+}
+
+void Receiver::enable_stats(const StatsOptions& opts)
+{
+    const auto period = static_cast<std::uint64_t>(
+        static_cast<long long>(source_.block_size()) * 1'000'000'000LL / source_.sample_rate());
+
+    stats_opts_ = opts;
+    metrics_ = std::make_unique<PipelineMetrics>(period);
+    std::visit([&](auto& p) { p.set_metrics(metrics_.get()); }, pipeline_);
+}
+
+void Receiver::enable_low_latency(const LowLatencyOptions& opts)
+{
+    const auto granule = std::visit([](const auto& p) {
+        return static_cast<std::size_t>(p.decim_iq() * p.decim_audio());
+    }, pipeline_);
+
+    BlockSizer sizer(opts, source_.sample_rate(), granule);
+    if (!source_.set_block_size(sizer.block_size()))
+        throw std::invalid_argument("Source has a fixed block size");
+
+    std::visit([&](auto& p) { p.reserve(sizer.max_block()); }, pipeline_);
+    if (metrics_)
+        metrics_->set_block_period_ns(static_cast<std::uint64_t>(sizer.period(sizer.block_size()).count()));
+    sizer_ = sizer;
+}
+
+void Receiver::adapt_block_size(std::size_t pairs, BlockSizer::Clock::time_point ready)
+{
+    const std::size_t next = sizer_->on_block(pairs, ready, BlockSizer::Clock::now());
+    if (next == source_.block_size())
+        return;
+
+    const bool resized = source_.set_block_size(next);
+    if (source_.live()) {
+        // The samples queued at the old size are gone, as on a retune
+        restart_stream(ready);
+    }
+
+    if (!resized) {
+        std::cerr << "Warning: source refused " << next << " pairs per block; keeping "
+                  << source_.block_size() << " and a fixed size after " << sizer_->changes()
+                  << " changes\n";
+        sizer_.reset();
+        return;
+    }
+
+    const auto period = sizer_->period(next);
+    if (metrics_)
+        metrics_->set_block_period_ns(static_cast<std::uint64_t>(period.count()));
+    std::cerr << "Block size " << next << " pairs ("
+              << std::chrono::duration<double, std::milli>(period).count() << " ms)\n";
+}
+
+std::unique_ptr<StatsReporter> Receiver::start_stats() const
+{
+    if (!metrics_ || stats_opts_.interval_s <= 0.0)
+        return nullptr;
+    return std::make_unique<StatsReporter>(*metrics_, stats_opts_);
+}
+
+std::span<const int16_t> Receiver::capture(BlockMeta& meta)
+{
+    std::span<const int16_t> raw;
+    {
+        StageTimer t(metrics_.get(), Stage::Capture);
+        raw = source_.next_block();
+    }
+    if (raw.empty())
+        return raw;
+
+    const auto now = BlockMeta::Clock::now();
+    const std::size_t pairs = raw.size() / 2;
+    last_capture_ = now;
+
+    const std::uint64_t lost = overruns_ ? overruns_->on_block(pairs, now) : 0;
+    if (metrics_)
+        metrics_->add_block(lost);
+
+    // Lost blocks leave their gap in the index
+    next_index_ += lost * pairs;
+    meta = {next_index_, now};
+    next_index_ += pairs;
+
+    if (spectrum_)
+        spectrum_->feed(raw, meta);
+    return raw;
+}
+
+template <typename Pipeline>
+void Receiver::process(Pipeline& pipeline, std::span<const int16_t> raw, const BlockMeta& meta,
+                       AudioBlock& audio)
+{
+    audio.samples = output_.wants_pcm()
+        ? pipeline.process_block(raw, meta, std::span(audio.pcm))
+        : pipeline.process_block(raw, meta, std::span(audio.f32));
+
+    audio.muted = pipeline.muted_samples();
+    audio.meta = pipeline.audio_meta();
+}
+
+void Receiver::output_audio(const AudioBlock& audio)
+{
+    {
+        StageTimer t(metrics_.get(), Stage::Output);
+
+        output_.stamp(audio.meta);
+        if (audio.muted)
+            output_.write_silence(audio.muted);
+        else if (output_.wants_pcm())
+            output_.write(std::span<const int16_t>(audio.pcm).first(audio.samples));
+        else
+            output_.write(std::span<const float>(audio.f32).first(audio.samples));
+    }
+
+    if (metrics_)
+        metrics_->stage(Stage::Latency).record(static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                BlockMeta::Clock::now() - audio.meta.captured).count()));
+}
+
+void Receiver::run()
+{
+    const std::size_t max_pairs = sizer_ ? sizer_->max_block() : source_.block_size();
+    const std::size_t audio_samples = max_block_audio(pipeline_, max_pairs);
+
+    AudioBlock audio_out;
+    audio_out.allocate(audio_samples);
+
+    RunStats stats(source_.sample_rate());
+    const auto reporter = start_stats();
+    const ScopedFlushToZero ftz(flush_denormals_);
+
+    std::visit([&](auto& pipeline) {
+        BlockMeta meta;
+        while (true) {
+            const auto raw = capture(meta);
+            if (raw.empty())
+                break;
+            const auto ready = BlockSizer::Clock::now();
+
+            process(pipeline, raw, meta, audio_out);
+            output_audio(audio_out);
+            stats.add(raw.size());
+
+            if (sizer_)
+                adapt_block_size(raw.size() / 2, ready);
+        }
+    }, pipeline_);
+
+    if (sizer_)
+        std::cerr << "Block size changes:      " << sizer_->changes() << '\n';
+
+    report_stdout(output_);
+}
+
+void Receiver::run_pipelined(const PipelineOptions& opts)
+{
+    const std::size_t raw_samples   = source_.block_size() * 2;
+    const std::size_t audio_samples = max_block_audio(pipeline_, source_.block_size());
+    const bool live = source_.live();
+
+    SpscRing<RawBlock> raw_ring(opts.capture_ring_depth);
+    SpscRing<AudioBlock> audio_ring(opts.audio_ring_depth);
+
+    raw_ring.for_each_slot([&](auto& b) { b.iq.reserve(raw_samples); });
+    audio_ring.for_each_slot([&](auto& a) { a.allocate(audio_samples); });
+
+    std::atomic<std::uint64_t> dropped_blocks{0};
+    RunStats stats(source_.sample_rate());
+    const auto reporter = start_stats();
+
+    std::jthread output_thread([&] {
+        set_current_thread_name("fm-output");
+        if (!pin_current_thread(opts.output_cpu))
+            std::cerr << "Warning: failed to pin output thread\n";
+
+        while (auto* audio = audio_ring.wait_acquire_read()) {
+            output_audio(*audio);
+            audio_ring.commit_read();
+        }
+    });
+
+    std::jthread dsp_thread([&] {
+        set_current_thread_name("fm-dsp");
+        if (!pin_current_thread(opts.dsp_cpu))
+            std::cerr << "Warning: failed to pin DSP thread\n";
+        if (flush_denormals_)
+            enable_flush_to_zero();
+
+        std::visit([&](auto& pipeline) {
+            while (auto* raw = raw_ring.wait_acquire_read()) {
+                auto* audio = audio_ring.wait_acquire_write();
+
+                process(pipeline, raw->iq, raw->meta, *audio);
+                raw_ring.commit_read();
+                audio_ring.commit_write();
+            }
+        }, pipeline_);
+
+        audio_ring.close();
+    });
+
+    set_current_thread_name("fm-capture");
+    if (!pin_current_thread(opts.capture_cpu))
+        std::cerr << "Warning: failed to pin capture thread\n";
+
+    BlockMeta meta;
+    while (true) {
+        const auto block = capture(meta);
+        if (block.empty())
+            break;
+
+        auto* slot = live ? raw_ring.try_acquire_write() : raw_ring.wait_acquire_write();
+        if (!slot) {
+            dropped_blocks.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        slot->iq.assign(block.begin(), block.end());
+        slot->meta = meta;
+        raw_ring.commit_write();
+        stats.add(block.size());
+    }
+
+    raw_ring.close();
+    dsp_thread.join();
+    output_thread.join();
+
+    std::cerr << "Capture ring high-water: " << raw_ring.high_water_mark()
+              << '/' << raw_ring.capacity() << '\n'
+              << "Audio ring high-water:   " << audio_ring.high_water_mark()
+              << '/' << audio_ring.capacity() << '\n'
+              << "Dropped capture blocks:  " << dropped_blocks.load() << '\n';
+    report_stdout(output_);
+}
+
+void Receiver::run_channels(ChannelBank& bank)
+{
+    RunStats stats(source_.sample_rate());
+    const auto reporter = start_stats();
+
+    // The calling thread demodulates the first share of the channels
+    const ScopedFlushToZero ftz(bank.flush_denormals());
+
+    BlockMeta meta;
+    while (true) {
+        const auto raw = capture(meta);
+        if (raw.empty())
+            break;
+
+        bank.process(raw, meta);
+        stats.add(raw.size());
+    }
+}
+
+bool Receiver::retune(long long frequency_hz)
+{
+    if (!source_.retune(frequency_hz))
+        return false;
+
+    if (source_.live() && last_capture_ != BlockMeta::Clock::time_point{})
+        restart_stream(last_capture_);
+    else
+        std::visit([](auto& p) { p.reset(); }, pipeline_);
+    return true;
+}
+
+void Receiver::restart_stream(BlockMeta::Clock::time_point cut)
+{
+    // The chain starts over, and the index skips the time the stream was cut
+    const auto gap = BlockMeta::Clock::now() - cut;
+    next_index_ += static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(gap).count() *
+        source_.sample_rate() / 1'000'000'000LL);
+    std::visit([](auto& p) { p.reset(); }, pipeline_);
+
+    // Recreating the kernel buffers stalls the refills; that is no overrun
+    if (overruns_)
+        overruns_->restart();
+}
+
+void Receiver::run_scan(const ScanOptions& opts, std::ostream& out)
+{
+    if (opts.frequencies_hz.empty())
+        return;
+
+    const double block_ms = 1e3 * static_cast<double>(source_.block_size()) /
+                            static_cast<double>(source_.sample_rate());
+    const auto dwell_blocks = std::max<long long>(1, std::llround(opts.dwell_ms / block_ms));
+
+    if (!retune(opts.frequencies_hz.front()))
+        throw std::runtime_error("Source cannot be retuned");
+
+    RunStats stats(source_.sample_rate());
+    const auto reporter = start_stats();
+
+    for (unsigned pass = 0; opts.passes == 0 || pass < opts.passes; pass++) {
+        for (std::size_t i = 0; i < opts.frequencies_hz.size(); i++) {
+            const long long freq = opts.frequencies_hz[i];
+            if ((pass > 0 || i > 0) && !retune(freq))
+                throw std::runtime_error("Retune failed");
+
+            BlockMeta meta;
+            double energy = 0.0;
+            std::size_t pairs = 0;
+
+            for (long long b = 0; b < dwell_blocks; b++) {
+                const auto raw = capture(meta);
+                if (raw.empty())
+                    return;
+
+                // The channel around the LO, not the whole capture bandwidth
+                const float power = std::visit([&](auto& p) { return p.channel_power(raw); },
+                                               pipeline_);
+                energy += static_cast<double>(power) * static_cast<double>(raw.size() / 2);
+                pairs += raw.size() / 2;
+                stats.add(raw.size());
+            }
+
+            const auto power = static_cast<float>(energy / static_cast<double>(pairs));
+            out << freq << ',' << std::fixed << std::setprecision(1)
+                << dsp::power_dbfs(power) << std::endl;
+        }
+    }
+}
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <iosfwd>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "audio_output.hpp"
+#include "block_sizer.hpp"
+#include "metrics.hpp"
+#include "pipeline.hpp"
+#include "sample_source.hpp"
+
+/**
+ * @file receiver.hpp
+ * @brief Receive loops driving the FM/AM DSP chain from any sample source.
+ */
+
+/// Options for the threaded capture -> DSP -> output pipeline.
+struct PipelineOptions {
+    std::size_t capture_ring_depth = 8; ///< Raw IQ blocks between capture and DSP
+    std::size_t audio_ring_depth   = 8; ///< Audio blocks between DSP and output
+
+    // CPU cores for each stage (-1 leaves the thread unpinned)
+    int capture_cpu = -1;
+    int dsp_cpu     = -1;
+    int output_cpu  = -1;
+};
+
+/// Band survey: stations visited in turn by Receiver::run_scan().
+struct ScanOptions {
+    std::vector<long long> frequencies_hz; ///< Centre frequencies, in order
+    double dwell_ms = 100.0;               ///< Time measured per frequency
+    unsigned passes = 1;                   ///< Sweeps over the list (0 = until the source ends)
+};
+
+class ChannelBank;
+class SpectrumTap;
+
+/**
+ * @class Receiver
+ * @brief Pulls IQ blocks from a SampleSource, runs a DemodPipeline and sends
+ *        the audio to UDP or stdout through an AudioOutput.
+ *
+ * The pipeline is created for DspOptions::mode. Each loop resolves the mode
+ * once before it starts, so the per-block path calls the specialised chain
+ * directly.
+ *
+ * Every loop returns when the source reports end of stream, then prints the
+ * number of samples processed and the achieved rate relative to real time on
+ * stderr. Replaying a FileSource at Pacing::MaxSpeed therefore doubles as a
+ * throughput measurement of the whole receiver.
+ */
+class Receiver {
+public:
+    /**
+     * @param source      IQ block producer; must outlive the receiver
+     * @param udp_ip      Optional UDP destination IP
+     * @param udp_port    Optional UDP port (audio goes to stdout without both)
+     * @param dsp         DSP chain selection
+     * @param audio_gain  Audio gain applied after DSP
+     * @param output      Audio format and UDP framing
+     */
+    Receiver(SampleSource& source,
+             std::optional<std::string> udp_ip = std::nullopt,
+             std::optional<int> udp_port       = std::nullopt,
+             const DspOptions& dsp             = {},
+             float audio_gain                  = 0.3f,
+             const OutputOptions& output       = {});
+
+    /**
+     * @brief Receiver sending the same audio to every one of @p destinations.
+     * @throws std::runtime_error as AudioOutput
+     */
+    Receiver(SampleSource& source,
+             std::span<const UdpDestination> destinations,
+             const DspOptions& dsp       = {},
+             float audio_gain            = 0.3f,
+             const OutputOptions& output = {});
+
+    /**
+     * @brief Run the receive and output loop on the calling thread.
+     *
+     * DSP reads each block in place from the source (no copy). With
+     * enable_low_latency() the block size follows the measured load.
+     */
+    void run();
+
+    /**
+     * @brief Run the receive loop as a three-stage threaded pipeline.
+     *
+     * The calling thread becomes the capture stage and only fetches blocks
+     * and hands them off. DSP and output run on their own threads, linked by
+     * bounded lock-free SPSC rings. If the DSP stage falls behind a live
+     * source, whole capture blocks are dropped instead of stalling the
+     * refill; a recorded source waits for a free slot instead.
+     *
+     * Ring high-water marks and drop counts are reported on stderr when the
+     * loop ends.
+     *
+     * @param opts Ring depths and per-stage CPU pinning
+     */
+    void run_pipelined(const PipelineOptions& opts);
+
+    /**
+     * @brief Receive several stations from each capture block.
+     *
+     * Every block is demodulated in place by all channels of @p bank in
+     * parallel; the next block is fetched once they are done. The
+     * single-station DSP chain and output of this object are unused.
+     *
+     * @param bank Channels relative to the source's centre frequency
+     */
+    void run_channels(ChannelBank& bank);
+
+    /**
+     * @brief Retune the source and restart the DSP chain at the new station.
+     *
+     * Clears the demodulator and decimator state, so the first block after
+     * the hop does not carry a phase step or a partial window of the old
+     * station. On a live source the samples queued at the old frequency
+     * are dropped, so the stream index skips the time since the last
+     * block, and the overrun detector does not count the stall. Must not
+     * be called while run_pipelined() is running.
+     *
+     * @return false if the source cannot be tuned
+     */
+    bool retune(long long frequency_hz);
+
+    /**
+     * @brief Band survey: dwell on each frequency and report its power.
+     *
+     * For every frequency of @p opts, retunes the source, reads blocks for
+     * `dwell_ms` and writes one CSV line `frequency_hz,power_dbfs` to @p out:
+     * the mean power of the channel after IQ decimation, relative to int16
+     * full scale (see DemodPipeline::channel_power()). No audio is produced.
+     *
+     * @throws std::runtime_error if the source cannot be tuned
+     */
+    void run_scan(const ScanOptions& opts, std::ostream& out);
+
+    /**
+     * @brief Time capture, every DSP stage and output during the next loop.
+     *
+     * A StatsReporter prints per-stage percentiles and the real-time
+     * headroom every @p opts.interval_s seconds, including the blocks a live
+     * source lost to hardware overruns (see OverrunDetector).
+     */
+    void enable_stats(const StatsOptions& opts);
+
+    /**
+     * @brief Adapt the capture block size during run() (low-latency mode).
+     *
+     * The source starts at `opts.min_block` and a BlockSizer grows or
+     * shrinks it after every window from the measured refill jitter and
+     * DSP plus output time. Scratch buffers are sized for `opts.max_block`
+     * here, so resizing never allocates in the DSP chain. Each change is
+     * reported on stderr.
+     *
+     * @throws std::invalid_argument as BlockSizer, or if the source has a
+     *         fixed block size
+     */
+    void enable_low_latency(const LowLatencyOptions& opts);
+
+    /**
+     * @brief Hand every captured block to @p tap as well (null detaches).
+     *
+     * The tap copies what it needs on the capture thread and computes the
+     * spectrum on its own, so the receive loop never waits for it. Blocks
+     * dropped by a full ring in run_pipelined() still reach the tap.
+     *
+     * @param tap Must outlive the loops it is attached for
+     */
+    void attach_spectrum(SpectrumTap* tap) noexcept { spectrum_ = tap; }
+
+    /// @return Capture block sizer, or null unless enable_low_latency() was called.
+    [[nodiscard]] const BlockSizer* block_sizer() const noexcept
+    {
+        return sizer_ ? &*sizer_ : nullptr;
+    }
+
+private:
+    /// Audio of one block, in whichever sample type the output consumes
+    struct AudioBlock {
+        // Sized once for the largest block; only the first `samples` are valid
+        std::vector<float>   f32;
+        std::vector<int16_t> pcm;
+        std::size_t samples = 0;
+        std::size_t muted = 0; ///< Squelched samples in place of audio
+        BlockMeta meta;        ///< Audio-rate position and capture time
+
+        void allocate(std::size_t max_samples)
+        {
+            f32.resize(max_samples);
+            pcm.resize(max_samples);
+        }
+    };
+
+    /// Capture block copied for the DSP thread of run_pipelined()
+    struct RawBlock {
+        std::vector<int16_t> iq;
+        BlockMeta meta;
+    };
+
+    SampleSource& source_;
+
+    // DSP chain of the selected mode
+    AnyPipeline pipeline_;
+
+    // UDP or stdout sink
+    AudioOutput output_;
+
+    // DSP threads flush denormals (DspOptions::flush_denormals)
+    bool flush_denormals_;
+
+    // Statistics; null unless enable_stats() was called
+    StatsOptions stats_opts_;
+    std::unique_ptr<PipelineMetrics> metrics_;
+
+    // Lost blocks of a live source, counted into the stream index
+    std::optional<OverrunDetector> overruns_;
+
+    // Low-latency mode; empty unless enable_low_latency() was called
+    std::optional<BlockSizer> sizer_;
+
+    // Spectrum side channel; null unless attach_spectrum() was called
+    SpectrumTap* spectrum_ = nullptr;
+
+    // IQ pairs captured or lost so far: sample_index of the next block
+    std::uint64_t next_index_ = 0;
+
+    // When the last block arrived (epoch before the first)
+    BlockMeta::Clock::time_point last_capture_{};
+
+    /**
+     * @brief Fetch the next block from the source, timing it for the statistics.
+     *
+     * Stamps @p meta with the block's stream position, which skips the
+     * pairs of blocks the OverrunDetector presumes lost.
+     */
+    std::span<const int16_t> capture(BlockMeta& meta);
+
+    /// @return Reporter for the loop about to start, or null without stats.
+    std::unique_ptr<StatsReporter> start_stats() const;
+
+    /// Run @p pipeline on @p raw into the sample type of the output.
+    template <typename Pipeline>
+    void process(Pipeline& pipeline, std::span<const int16_t> raw, const BlockMeta& meta,
+                 AudioBlock& audio);
+
+    /// Output the block filled by process().
+    void output_audio(const AudioBlock& audio);
+
+    /**
+     * @brief Feed one block's timing to the sizer and resize the source if it says so.
+     *
+     * A live source loses its queued samples on a resize, so that is
+     * handled like a retune: the pipeline is reset and the stream index
+     * jumps by the time since @p ready. A refused size ends adaptation.
+     */
+    void adapt_block_size(std::size_t pairs, BlockSizer::Clock::time_point ready);
+
+    /**
+     * @brief Start over after a live source dropped its queued samples.
+     *
+     * Resets the pipeline and the overrun detector, and moves the stream
+     * index on by the time since @p cut, the arrival of the last block kept.
+     */
+    void restart_stream(BlockMeta::Clock::time_point cut);
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/**
+ * @file sample_source.hpp
+ * @brief Abstract producer of raw interleaved int16 IQ blocks.
+ */
+
+/**
+ * @class SampleSource
+ * @brief Anything that can feed FmPipeline::process_block(): an SDR, a
+ *        recorded capture or a pipe.
+ *
+ * Blocks are handed out by reference into the source's own storage (the IIO
+ * buffer, the mapped file, ...) so the receiver can run the DSP chain on
+ * them in place.
+ */
+class SampleSource {
+public:
+    virtual ~SampleSource() = default;
+
+    /**
+     * @brief Wait for and return the next block of interleaved I/Q.
+     *
+     * The span stays valid until the next call. The last block of a finite
+     * source may be shorter than block_size().
+     *
+     * @return Next block, or an empty span at end of stream (or on a
+     *         capture failure).
+     */
+    virtual std::span<const int16_t> next_block() = 0;
+
+    /// IQ pairs per block returned by next_block().
+    [[nodiscard]] virtual std::size_t block_size() const noexcept = 0;
+
+    /// Sample rate of the stream (IQ pairs per second).
+    [[nodiscard]] virtual long long sample_rate() const noexcept = 0;
+
+    /**
+     * @brief Whether the source produces samples in real time on its own.
+     *
+     * A live source cannot be paused, so a receiver that falls behind must
+     * drop blocks; a recording is instead throttled to the receiver's pace.
+     */
+    [[nodiscard]] virtual bool live() const noexcept = 0;
+
+    /**
+     * @brief Blocks a live source buffers before it must drop samples.
+     *
+     * A reader further behind real time than this loses data; the
+     * receivers size their OverrunDetector from it.
+     */
+    [[nodiscard]] virtual std::size_t queued_blocks() const noexcept { return 0; }
+
+    /**
+     * @brief Move the source to a new centre frequency.
+     *
+     * Blocks returned afterwards hold only samples taken at the new
+     * frequency; the span of the last block becomes invalid.
+     *
+     * @return false if the source cannot be tuned (e.g. a recording)
+     */
+    virtual bool retune([[maybe_unused]] long long frequency_hz) { return false; }
+
+    /**
+     * @brief Change the IQ pairs per block returned from the next call on.
+     *
+     * The span of the last block becomes invalid. A live source may drop
+     * the samples it had queued, even when it returns false.
+     *
+     * @return false if the source has a fixed block size
+     */
+    virtual bool set_block_size([[maybe_unused]] std::size_t pairs) { return false; }
+};
@@ -0,0 +1,214 @@
+#include "spectrum_tap.hpp"
+#include "thread_util.hpp"
+
+#include <arpa/inet.h>
+#include <endian.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <numbers>
+#include <stdexcept>
+
+namespace {
+
+/// Largest frame that fits a 1472-byte datagram as a power of two
+constexpr std::size_t kMaxBins = 1024;
+
+constexpr bool is_power_of_two(std::size_t n) noexcept { return n && (n & (n - 1)) == 0; }
+
+/// @return @p opts, once it has passed the checks of the SpectrumTap constructor.
+const SpectrumOptions& validated(const SpectrumOptions& opts, long long sample_rate)
+{
+    if (!is_power_of_two(opts.bins) || opts.bins < 16 || opts.bins > kMaxBins)
+        throw std::invalid_argument("Spectrum bins must be a power of two of 16 to 1024");
+    if (!is_power_of_two(opts.fft_size) || opts.fft_size < opts.bins)
+        throw std::invalid_argument("Spectrum FFT size must be a power of two of at least the bin count");
+    if (sample_rate <= 0 || !(opts.frame_rate > 0.0))
+        throw std::invalid_argument("Sample and frame rate must be positive");
+    if (opts.averages == 0 || opts.averages > UINT16_MAX || opts.queue_depth == 0)
+        throw std::invalid_argument("Invalid spectrum averages or queue depth");
+    if (opts.range_db <= 0 || opts.range_db > UINT16_MAX ||
+        opts.floor_db < INT16_MIN || opts.floor_db > INT16_MAX)
+        throw std::invalid_argument("Invalid spectrum level range");
+
+    const double stride = static_cast<double>(sample_rate) / opts.frame_rate;
+    if (static_cast<double>(opts.fft_size * opts.averages) > stride)
+        throw std::invalid_argument("Spectrum frame period is shorter than its FFTs");
+    return opts;
+}
+
+} // namespace
+
+SpectrumTap::SpectrumTap(const SpectrumOptions& opts, long long sample_rate)
+    : opts_{validated(opts, sample_rate)}
+    , rate_{sample_rate}
+    , frame_stride_{static_cast<std::uint64_t>(static_cast<double>(sample_rate) / opts.frame_rate)}
+    , ring_{opts.queue_depth}
+    , fft_{opts.fft_size}
+    , sender_{opts.udp_ip, opts.udp_port}
+{
+    const std::size_t n = opts_.fft_size;
+    ring_.for_each_slot([&](Segment& s) { s.iq.resize(n * 2); });
+
+    // 4-term Blackman-Harris: -92 dB sidelobes keep weak stations clear of strong ones
+    window_.resize(n);
+    double gain = 0.0;
+    for (std::size_t i = 0; i < n; i++) {
+        const double x = 2.0 * std::numbers::pi * static_cast<double>(i) / static_cast<double>(n);
+        const double w = 0.35875 - 0.48829 * std::cos(x) + 0.14128 * std::cos(2.0 * x) -
+                         0.01168 * std::cos(3.0 * x);
+        window_[i] = static_cast<float>(w);
+        gain += w;
+    }
+    norm_ = static_cast<float>(32'768.0 * gain * 32'768.0 * gain);
+
+    spectrum_.resize(n);
+    power_.assign(n, 0.0f);
+    packet_.resize(sizeof(SpectrumPacketHeader) + opts_.bins);
+
+    thread_ = std::jthread([this] { run(); });
+}
+
+SpectrumTap::~SpectrumTap()
+{
+    stop();
+}
+
+void SpectrumTap::stop()
+{
+    ring_.close();
+    if (thread_.joinable())
+        thread_.join();
+}
+
+void SpectrumTap::advance() noexcept
+{
+    if (++segment_ == opts_.averages) {
+        segment_ = 0;
+        frame_++;
+        frame_start_ += frame_stride_;
+    }
+    next_segment_ = frame_start_ + segment_ * frame_stride_ / opts_.averages;
+}
+
+void SpectrumTap::feed(std::span<const int16_t> raw, const BlockMeta& meta) noexcept
+{
+    const std::size_t pairs = raw.size() / 2;
+    const std::uint64_t first = meta.sample_index;
+    const std::uint64_t end = first + pairs;
+
+    // A gap breaks the FFT input being filled and restarts the frame grid
+    if (!started_ || first != next_input_) {
+        if (started_)
+            frame_++;
+        started_ = true;
+        fill_ = 0;
+        segment_ = 0;
+        frame_start_ = next_segment_ = first;
+    }
+    next_input_ = end;
+
+    const std::size_t n = opts_.fft_size;
+    while (true) {
+        std::size_t from = 0;
+        if (fill_ == 0) {
+            if (next_segment_ >= end)
+                break;
+            if (!slot_ && !(slot_ = ring_.try_acquire_write())) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                advance();
+                continue;
+            }
+            from = static_cast<std::size_t>(next_segment_ - first);
+            slot_->meta = {next_segment_, meta.captured};
+            slot_->frame = frame_;
+        }
+
+        const std::size_t take = std::min(n - fill_, pairs - from);
+        std::copy_n(raw.data() + from * 2, take * 2, slot_->iq.data() + fill_ * 2);
+        fill_ += take;
+        if (fill_ < n)
+            break;
+
+        ring_.commit_write();
+        slot_ = nullptr;
+        fill_ = 0;
+        advance();
+    }
+}
+
+void SpectrumTap::run()
+{
+    set_current_thread_name("fm-spectrum");
+    if (!lower_current_thread_priority())
+        std::cerr << "Warning: failed to lower spectrum thread priority\n";
+
+    while (const Segment* s = ring_.wait_acquire_read()) {
+        if (averaged_ && s->frame != frame_id_)
+            send_frame();
+        if (averaged_ == 0) {
+            frame_id_ = s->frame;
+            frame_meta_ = s->meta;
+        }
+
+        accumulate(*s);
+        ring_.commit_read();
+
+        if (averaged_ == opts_.averages)
+            send_frame();
+    }
+}
+
+void SpectrumTap::accumulate(const Segment& segment) noexcept
+{
+    const std::size_t n = opts_.fft_size;
+    for (std::size_t i = 0; i < n; i++)
+        spectrum_[i] = {static_cast<float>(segment.iq[2 * i]) * window_[i],
+                        static_cast<float>(segment.iq[2 * i + 1]) * window_[i]};
+
+    fft_.forward(spectrum_);
+    for (std::size_t i = 0; i < n; i++)
+        power_[i] += std::norm(spectrum_[i]);
+    averaged_++;
+}
+
+void SpectrumTap::send_frame()
+{
+    const std::size_t n = opts_.fft_size;
+    const std::size_t group = n / opts_.bins;
+    const float scale = 1.0f / (static_cast<float>(averaged_) * norm_);
+    const float steps = 255.0f / static_cast<float>(opts_.range_db);
+
+    // Bins from -rate/2 up, so DC lands on bins / 2
+    uint8_t* out = packet_.data() + sizeof(SpectrumPacketHeader);
+    for (std::size_t b = 0; b < opts_.bins; b++) {
+        float peak = 0.0f;
+        for (std::size_t j = 0; j < group; j++)
+            peak = std::max(peak, power_[(b * group + j + n / 2) & (n - 1)]);
+
+        const float db = 10.0f * std::log10(std::max(peak * scale, 1e-30f));
+        const float q = std::round((db - static_cast<float>(opts_.floor_db)) * steps);
+        out[b] = static_cast<uint8_t>(std::clamp(q, 0.0f, 255.0f));
+    }
+
+    SpectrumPacketHeader h{};
+    h.magic = htonl(kSpectrumPacketMagic);
+    h.sequence = htonl(sequence_++);
+    h.sample_index = htobe64(frame_meta_.sample_index);
+    h.capture_ns = htobe64(frame_meta_.captured_ns());
+    h.sample_rate_hz = htonl(static_cast<uint32_t>(rate_));
+    h.bins = htons(static_cast<uint16_t>(opts_.bins));
+    h.averages = htons(static_cast<uint16_t>(averaged_));
+    h.floor_db = static_cast<int16_t>(htons(static_cast<uint16_t>(opts_.floor_db)));
+    h.range_db = htons(static_cast<uint16_t>(opts_.range_db));
+    h.fft_size = htonl(static_cast<uint32_t>(n));
+    std::memcpy(packet_.data(), &h, sizeof(h));
+
+    sender_.send(std::span<const uint8_t>(packet_));
+    frames_.fetch_add(1, std::memory_order_relaxed);
+
+    std::fill(power_.begin(), power_.end(), 0.0f);
+    averaged_ = 0;
+}
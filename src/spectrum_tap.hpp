@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "block_meta.hpp"
+#include "fft.hpp"
+#include "spsc_ring.hpp"
+#include "udp_sender.hpp"
+
+/**
+ * @file spectrum_tap.hpp
+ * @brief Live spectrum of the captured band, sent as quantized UDP frames.
+ */
+
+/// Magic number opening every spectrum datagram ("FMS1").
+inline constexpr uint32_t kSpectrumPacketMagic = 0x464D5331;
+
+/**
+ * @brief Header of a spectrum datagram; all fields in network byte order.
+ *
+ * Followed by `bins` bytes, one per bin from -rate/2 to +rate/2 around the
+ * tuned frequency (bin `bins / 2` is DC). Byte `q` stands for
+ * `floor_db + q * range_db / 255` dBFS, where 0 dBFS is a full-scale tone.
+ */
+struct SpectrumPacketHeader {
+    uint32_t magic;          ///< kSpectrumPacketMagic
+    uint32_t sequence;       ///< Frame counter, wraps at 2^32
+    uint64_t sample_index;   ///< IQ pair index of the frame's first FFT
+    uint64_t capture_ns;     ///< CLOCK_MONOTONIC refill time of that block
+    uint32_t sample_rate_hz; ///< Width of the band the bins cover
+    uint16_t bins;           ///< Bytes after the header
+    uint16_t averages;       ///< FFTs averaged into this frame
+    int16_t  floor_db;       ///< Level of byte 0
+    uint16_t range_db;       ///< Level span of bytes 0..255
+    uint32_t fft_size;       ///< Transform size (resolution = rate / fft_size)
+};
+
+static_assert(sizeof(SpectrumPacketHeader) == 40, "SpectrumPacketHeader must stay packed");
+
+/// Destination and shape of the spectrum frames.
+struct SpectrumOptions {
+    std::string udp_ip;
+    int udp_port = 0;
+
+    std::size_t fft_size = 1024; ///< Power of two, at least `bins`
+    std::size_t bins = 1024;     ///< Bins per frame, a power of two of 16..1024
+    double frame_rate = 10.0;    ///< Frames per second of stream time
+    std::size_t averages = 8;    ///< FFTs per frame, spread over its period
+    int floor_db = -120;         ///< Level of byte 0, dBFS
+    int range_db = 120;          ///< Level span of bytes 0..255
+    std::size_t queue_depth = 32; ///< FFT inputs queued for the worker
+};
+
+/**
+ * @class SpectrumTap
+ * @brief Computes averaged, windowed FFT frames of the raw IQ on a
+ *        low-priority thread.
+ *
+ * The receive loop hands every capture block to feed(), which copies only
+ * the `averages` stretches of `fft_size` pairs each frame needs, evenly
+ * spaced over the frame period, into preallocated slots of an SPSC ring.
+ * It never waits: when the worker has fallen behind, the stretch is
+ * skipped and counted. The worker runs at SCHED_IDLE, applies a
+ * Blackman-Harris window, accumulates the bin powers and, once a frame is
+ * complete, sends it as one datagram of `bins` bytes. With `bins` below
+ * `fft_size` each byte holds the loudest of its FFT bins, so narrow
+ * carriers stay visible.
+ *
+ * A gap in the block sample indices (lost blocks, a retune) ends the
+ * current frame early; the partial average is sent with its `averages`.
+ */
+class SpectrumTap {
+public:
+    /**
+     * @param opts         Destination and frame shape
+     * @param sample_rate  IQ pairs per second of the source
+     * @throws std::invalid_argument for sizes that are not powers of two,
+     *         more bins than FFT points or than fit a datagram, a
+     *         non-positive rate or range, or frames too short for their FFTs
+     */
+    SpectrumTap(const SpectrumOptions& opts, long long sample_rate);
+
+    ~SpectrumTap();
+
+    SpectrumTap(const SpectrumTap&) = delete;
+    SpectrumTap& operator=(const SpectrumTap&) = delete;
+
+    /// Take what the next frames need from one capture block; never blocks.
+    void feed(std::span<const int16_t> raw, const BlockMeta& meta) noexcept;
+
+    /// Process what is queued and stop the worker; an unfinished frame is not sent.
+    void stop();
+
+    /// @return Frames sent so far; any thread.
+    [[nodiscard]] std::uint64_t frames() const noexcept { return frames_.load(std::memory_order_relaxed); }
+
+    /// @return FFT inputs skipped because the worker was behind; any thread.
+    [[nodiscard]] std::uint64_t dropped() const noexcept { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    /// Pairs of one FFT input, copied off the capture path
+    struct Segment {
+        std::vector<int16_t> iq;
+        BlockMeta meta;          ///< Position of the first pair
+        std::uint64_t frame = 0; ///< Frame it belongs to
+    };
+
+    SpectrumOptions opts_;
+    long long rate_;
+    std::uint64_t frame_stride_; ///< Pairs per frame period
+
+    SpscRing<Segment> ring_;
+
+    // Producer (feed) state
+    bool started_ = false;
+    std::uint64_t next_input_ = 0;    ///< Index of the pair after the last block
+    std::uint64_t frame_start_ = 0;   ///< Index of the current frame's first pair
+    std::uint64_t next_segment_ = 0;  ///< Index where the next FFT input starts
+    std::size_t segment_ = 0;         ///< FFT inputs of the current frame handed out
+    std::uint64_t frame_ = 0;
+    Segment* slot_ = nullptr;         ///< Acquired, partly filled slot
+    std::size_t fill_ = 0;            ///< Pairs in slot_
+
+    // Worker state
+    dsp::Fft fft_;
+    std::vector<float> window_;
+    std::vector<std::complex<float>> spectrum_;
+    std::vector<float> power_;        ///< Summed |X|^2 of the current frame
+    std::size_t averaged_ = 0;
+    std::uint64_t frame_id_ = 0;
+    BlockMeta frame_meta_;
+    float norm_;                      ///< |X|^2 of a full-scale tone
+    std::vector<uint8_t> packet_;
+    std::uint32_t sequence_ = 0;
+    UdpSender sender_;
+
+    std::atomic<std::uint64_t> frames_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::jthread thread_;
+
+    /// Move on to the next FFT input of the frame, or to the next frame.
+    void advance() noexcept;
+
+    void run();
+
+    /// Window, transform and accumulate one FFT input.
+    void accumulate(const Segment& segment) noexcept;
+
+    /// Quantize and send the accumulated frame, then clear it.
+    void send_frame();
+};
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @file spsc_ring.hpp
+ * @brief Bounded lock-free single-producer / single-consumer ring.
+ *
+ * Slots are allocated once at construction and reused in place: the producer
+ * acquires a slot, fills it and commits it; the consumer acquires the oldest
+ * committed slot, consumes it and releases it. No allocation or locking takes
+ * place on the hot path.
+ */
+
+/**
+ * @brief Fixed-capacity SPSC ring of preallocated slots.
+ *
+ * @tparam T Slot type. Slots are default-constructed once and then reused,
+ *           so containers keep their capacity between blocks.
+ *
+ * Exactly one thread may call the producer functions (`*_acquire_write`,
+ * `commit_write`, `wait_writable`) and exactly one other thread the consumer
+ * functions (`*_acquire_read`, `commit_read`, `wait_readable`).
+ */
+template <typename T>
+class SpscRing {
+public:
+    /**
+     * @param capacity Number of slots (rounded up to a power of two).
+     */
+    explicit SpscRing(std::size_t capacity)
+    {
+        if (capacity == 0)
+            throw std::invalid_argument("SpscRing capacity must be non-zero");
+
+        std::size_t n = 1;
+        while (n < capacity) n <<= 1;
+
+        slots_.resize(n);
+        mask_ = n - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /// Number of slots in the ring.
+    [[nodiscard]] std::size_t capacity() const noexcept { return slots_.size(); }
+
+    /// Number of committed slots not yet consumed.
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return head_.load(std::memory_order_acquire) -
+               tail_.load(std::memory_order_acquire);
+    }
+
+    /// Largest occupancy observed since construction.
+    [[nodiscard]] std::size_t high_water_mark() const noexcept
+    {
+        return high_water_.load(std::memory_order_relaxed);
+    }
+
+    /// Iterate over every slot, e.g. to preallocate per-slot storage.
+    template <typename F>
+    void for_each_slot(F&& fn)
+    {
+        for (auto& s : slots_) fn(s);
+    }
+
+    // ------------------------------------------------------------------
+    // Producer side
+    // ------------------------------------------------------------------
+
+    /// @return Slot to fill, or nullptr if the ring is full.
+    [[nodiscard]] T* try_acquire_write() noexcept
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) > mask_)
+            return nullptr;
+        return &slots_[head & mask_];
+    }
+
+    /// Publish the slot returned by the last successful try_acquire_write().
+    void commit_write() noexcept
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed) + 1;
+        head_.store(head, std::memory_order_release);
+
+        const std::size_t used = head - tail_.load(std::memory_order_acquire);
+        if (used > high_water_.load(std::memory_order_relaxed))
+            high_water_.store(used, std::memory_order_relaxed);
+
+        signal();
+    }
+
+    /**
+     * @brief Blocking variant of try_acquire_write().
+     * @return Slot to fill, or nullptr once the ring is closed.
+     */
+    [[nodiscard]] T* wait_acquire_write() noexcept
+    {
+        while (!closed()) {
+            if (T* slot = try_acquire_write()) return slot;
+            wait_writable();
+        }
+        return nullptr;
+    }
+
+    /// Block until a slot is free or the ring is closed.
+    void wait_writable() const noexcept
+    {
+        while (!closed()) {
+            const uint32_t seen = events_.load(std::memory_order_acquire);
+            if (head_.load(std::memory_order_relaxed) -
+                tail_.load(std::memory_order_acquire) <= mask_)
+                return;
+            events_.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // Consumer side
+    // ------------------------------------------------------------------
+
+    /// @return Oldest committed slot, or nullptr if the ring is empty.
+    [[nodiscard]] T* try_acquire_read() noexcept
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire))
+            return nullptr;
+        return &slots_[tail & mask_];
+    }
+
+    /// Release the slot returned by the last successful try_acquire_read().
+    void commit_read() noexcept
+    {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_release);
+        signal();
+    }
+
+    /**
+     * @brief Blocking variant of try_acquire_read().
+     *
+     * Slots committed before close() are still delivered.
+     *
+     * @return Oldest committed slot, or nullptr once the ring is closed
+     *         and drained.
+     */
+    [[nodiscard]] T* wait_acquire_read() noexcept
+    {
+        while (true) {
+            if (T* slot = try_acquire_read()) return slot;
+            if (closed()) return try_acquire_read();
+            wait_readable();
+        }
+    }
+
+    /// Block until data is available or the ring is closed.
+    void wait_readable() const noexcept
+    {
+        while (!closed()) {
+            const uint32_t seen = events_.load(std::memory_order_acquire);
+            if (tail_.load(std::memory_order_relaxed) !=
+                head_.load(std::memory_order_acquire))
+                return;
+            events_.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // Shutdown
+    // ------------------------------------------------------------------
+
+    /// Mark the ring closed and wake any waiting thread.
+    void close() noexcept
+    {
+        closed_.store(true, std::memory_order_release);
+        signal();
+    }
+
+    /// @return true once close() has been called.
+    [[nodiscard]] bool closed() const noexcept
+    {
+        return closed_.load(std::memory_order_acquire);
+    }
+
+private:
+    /// Keeps producer and consumer indices on separate cache lines
+    static constexpr std::size_t kCacheLine = 64;
+
+    std::vector<T> slots_;
+    std::size_t mask_ = 0;
+
+    alignas(kCacheLine) std::atomic<std::size_t> head_{0};
+    alignas(kCacheLine) std::atomic<std::size_t> tail_{0};
+    alignas(kCacheLine) std::atomic<std::size_t> high_water_{0};
+    mutable std::atomic<uint32_t> events_{0};
+    std::atomic<bool> closed_{false};
+
+    void signal() noexcept
+    {
+        events_.fetch_add(1, std::memory_order_release);
+        events_.notify_all();
+    }
+};
@@ -0,0 +1,173 @@
+#include "stereo.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+namespace dsp {
+
+namespace {
+
+constexpr double kTwoPi = 2.0 * std::numbers::pi;
+
+/// Nominal pilot in rad/sample
+constexpr double kPilotOmega = kTwoPi * StereoDecoder::kPilotHz / StereoDecoder::kMpxRateHz;
+
+/// Largest pilot offset the loop follows (the standard allows +-2 Hz)
+constexpr double kPullInOmega = kTwoPi * 100.0 / StereoDecoder::kMpxRateHz;
+
+// Second-order loop, updated once per chunk: natural frequency and
+// damping give the proportional and integral gains per update
+constexpr double kLoopHz = 10.0;
+constexpr double kDamping = 0.707;
+constexpr double kLoopTheta = kTwoPi * kLoopHz * static_cast<double>(StereoDecoder::kChunk) /
+                              StereoDecoder::kMpxRateHz;
+constexpr double kKp = 2.0 * kDamping * kLoopTheta;
+constexpr double kKi = kLoopTheta * kLoopTheta;
+
+/// Smoothing of the chunk correlation ahead of the phase detector (~120 Hz)
+constexpr float kCorrAlpha = 0.2f;
+
+/// Smoothing of the lock detector (~27 ms)
+constexpr float kLockAlpha = 0.01f;
+
+/// Lock detector hysteresis, on the mean cos of the phase error
+constexpr float kLockOn  = 0.9f;
+constexpr float kLockOff = 0.6f;
+
+/// Pilot amplitude below which there is no stereo, in MPX units
+/// (a standard pilot is about 0.18 rad/sample of discriminator output)
+constexpr float kMinPilot = 0.01f;
+
+/// Stereo blend change per chunk (full swing in about 9 ms)
+constexpr float kBlendStep = 1.0f / 32.0f;
+
+} // namespace
+
+StereoDecoder::StereoDecoder(float deemphasis_us)
+    : deemphasis_alpha_{deemphasis_us > 0.0f
+          ? deemphasis_alpha(deemphasis_us, static_cast<float>(kMpxRateHz / kDecimation))
+          : 0.0f}
+{
+    reset();
+}
+
+void StereoDecoder::reserve(std::size_t samples)
+{
+    sum_.resize(samples);
+    diff_.resize(samples);
+    left_buf_.resize(samples / kDecimation + 64);
+    right_buf_.resize(samples / kDecimation + 64);
+    sum_fir_.reserve(samples);
+    diff_fir_.reserve(samples);
+}
+
+std::size_t StereoDecoder::process(std::span<const float> mpx, std::span<float> out, float gain)
+{
+    const std::size_t n = mpx.size();
+    if (out.size() < output_size(n))
+        throw std::invalid_argument("StereoDecoder: output span too small");
+    if (n > sum_.size())
+        reserve(n);
+
+    const PilotMixFn mix = kernels().pilot_mix.fn;
+
+    for (std::size_t i = 0; i < n;) {
+        // Chunks run across block boundaries, so the loop does not depend
+        // on how the stream is cut
+        const std::size_t len = std::min(kChunk - chunk_fill_, n - i);
+        const double start = phase_ + freq_ * static_cast<double>(chunk_fill_);
+        const auto phase = std::polar(1.0f, static_cast<float>(start));
+        const auto step  = std::polar(1.0f, static_cast<float>(freq_));
+
+        // 4 Re(p) Im(p) = 2 sin(2 theta): the subcarrier, doubled to
+        // restore the level of L-R
+        chunk_corr_ += mix(mpx.data() + i, len, phase, step,
+                           blend_ * level_, 4.0f * blend_,
+                           sum_.data() + i, diff_.data() + i);
+        chunk_fill_ += len;
+        i += len;
+
+        if (chunk_fill_ == kChunk) {
+            update(chunk_corr_);
+            chunk_corr_ = {};
+            chunk_fill_ = 0;
+        }
+    }
+
+    const std::size_t frames = sum_fir_.process(std::span<const float>(sum_).first(n),
+                                                std::span(left_buf_), gain);
+    diff_fir_.process(std::span<const float>(diff_).first(n), std::span(right_buf_), gain);
+
+    for (std::size_t k = 0; k < frames; k++) {
+        const float s = left_buf_[k];
+        const float d = right_buf_[k];
+        left_buf_[k]  = s + d;
+        right_buf_[k] = s - d;
+    }
+
+    if (deemphasis_alpha_ > 0.0f) {
+        deemphasis(std::span(left_buf_).first(frames), deemphasis_alpha_, left_);
+        deemphasis(std::span(right_buf_).first(frames), deemphasis_alpha_, right_);
+    }
+
+    for (std::size_t k = 0; k < frames; k++) {
+        out[2 * k]     = left_buf_[k];
+        out[2 * k + 1] = right_buf_[k];
+    }
+    return 2 * frames;
+}
+
+void StereoDecoder::update(std::complex<float> corr)
+{
+    corr_ += kCorrAlpha * (corr / static_cast<float>(kChunk) - corr_);
+
+    // See PilotMixFn: the real part is the sine of the phase error, the
+    // imaginary part its cosine, both scaled by half the pilot amplitude
+    const float mag = std::abs(corr_);
+    const double err = std::atan2(corr_.real(), corr_.imag());
+
+    level_ = 2.0f * mag;
+    lock_ += kLockAlpha * (corr_.imag() / std::max(mag, FLT_MIN) - lock_);
+    locked_ = level_ > kMinPilot && lock_ > (locked_ ? kLockOff : kLockOn);
+
+    phase_ = std::remainder(phase_ + freq_ * static_cast<double>(kChunk) + kKp * err, kTwoPi);
+    freq_ = std::clamp(freq_ + kKi * err / static_cast<double>(kChunk),
+                       kPilotOmega - kPullInOmega, kPilotOmega + kPullInOmega);
+
+    blend_ = locked_ ? std::min(1.0f, blend_ + kBlendStep) : std::max(0.0f, blend_ - kBlendStep);
+}
+
+void StereoDecoder::reset()
+{
+    sum_fir_.reset();
+    diff_fir_.reset();
+    left_ = {};
+    right_ = {};
+
+    phase_ = 0.0;
+    freq_ = kPilotOmega;
+    chunk_corr_ = {};
+    chunk_fill_ = 0;
+    corr_ = {};
+    level_ = 0.0f;
+    lock_ = 0.0f;
+    locked_ = false;
+    blend_ = 0.0f;
+}
+
+void StereoDecoder::reset(std::size_t phase)
+{
+    reset();
+    sum_fir_.reset(phase);
+    diff_fir_.reset(phase);
+}
+
+double StereoDecoder::pilot_hz() const noexcept
+{
+    return freq_ * kMpxRateHz / kTwoPi;
+}
+
+} // namespace dsp
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "dsp.hpp"
+#include "fir_decimator.hpp"
+
+/**
+ * @file stereo.hpp
+ * @brief Pilot-locked FM stereo (MPX) decoder.
+ */
+
+namespace dsp {
+
+/**
+ * @class StereoDecoder
+ * @brief Streaming MPX decoder: discriminator output at 240 kS/s in,
+ *        interleaved L/R audio at 48 kS/s out.
+ *
+ * The broadcast multiplex carries L+R at baseband, a 19 kHz pilot and
+ * L-R as a suppressed-carrier DSB signal on twice the pilot frequency.
+ * Per chunk of kChunk samples (chunks run on across calls) the decoder
+ *
+ *  1. correlates the MPX with a reference phasor locked to the pilot by a
+ *     second-order PLL (updated once per chunk, so the per-sample work is
+ *     a handful of multiplies in the pilot_mix kernel),
+ *  2. subtracts the regenerated pilot from L+R, and
+ *  3. mixes the MPX with sin(2 theta) of the reference to bring L-R to
+ *     baseband.
+ *
+ * Both channels then pass a 128-tap FIR decimator whose stopband starts
+ * below the L-R sidebands at 23 kHz, are matrixed to L and R, and are
+ * optionally de-emphasised (dsp::deemphasis()).
+ *
+ * L-R fades in only while the pilot is present and the loop is locked;
+ * without a pilot the output is mono on both channels. For a mono
+ * programme each channel has the level of the mono chain.
+ *
+ * All state, including the PLL and the partial decimation windows, is
+ * kept across calls; reserve() sizes the scratch buffers so process()
+ * does not allocate.
+ */
+class StereoDecoder {
+public:
+    static constexpr double      kMpxRateHz  = 240'000.0; ///< Input (discriminator) rate
+    static constexpr int         kDecimation = 5;         ///< 240k -> 48k
+    static constexpr double      kPilotHz    = 19'000.0;
+    static constexpr std::size_t kChunk      = 64;        ///< MPX samples per PLL update
+
+    /// Both channel filters: -6 dB at 18 kHz, pilot and L-R sidebands in the stopband.
+    static constexpr int   kAudioTaps   = 128;
+    static constexpr float kAudioCutoff = 0.075f;
+
+    /**
+     * @param deemphasis_us  De-emphasis time constant (0 = off)
+     */
+    explicit StereoDecoder(float deemphasis_us = 0.0f);
+
+    /// Size the scratch buffers for blocks of up to @p samples (allocates).
+    void reserve(std::size_t samples);
+
+    /// @return Interleaved samples the next process() call produces for @p samples.
+    [[nodiscard]] std::size_t output_size(std::size_t samples) const noexcept
+    {
+        return 2 * sum_fir_.output_size(samples);
+    }
+
+    /**
+     * @brief Decode one block of MPX.
+     *
+     * @param mpx   Discriminator output at kMpxRateHz
+     * @param out   Interleaved L/R, at least output_size() samples
+     * @param gain  Gain applied to both channels
+     * @return Samples written (twice the frames)
+     * @throws std::invalid_argument if @p out is too short
+     */
+    std::size_t process(std::span<const float> mpx, std::span<float> out, float gain = 1.0f);
+
+    /// Drop the pilot lock and all filter history.
+    void reset();
+
+    /// reset(), resuming the decimation windows at @p phase (see FirDecimator::reset()).
+    void reset(std::size_t phase);
+
+    /// @return MPX samples taken toward the next output frame.
+    [[nodiscard]] std::size_t phase() const noexcept { return sum_fir_.phase(); }
+
+    /// @return true while the PLL is locked to a pilot.
+    [[nodiscard]] bool locked() const noexcept { return locked_; }
+
+    /// @return Tracked pilot frequency in Hz.
+    [[nodiscard]] double pilot_hz() const noexcept;
+
+    /// @return Estimated pilot amplitude, in MPX units.
+    [[nodiscard]] float pilot_level() const noexcept { return level_; }
+
+    /// @return Share of L-R in the output: 0 (mono) to 1 (full stereo).
+    [[nodiscard]] float blend() const noexcept { return blend_; }
+
+private:
+    using AudioFir = FirDecimator<float, kDecimation, kAudioTaps>;
+
+    AudioFir sum_fir_{kAudioCutoff};
+    AudioFir diff_fir_{kAudioCutoff};
+    float deemphasis_alpha_;
+    DeemphasisState left_;
+    DeemphasisState right_;
+
+    // PLL: reference phase (rad) and frequency (rad/sample)
+    double phase_ = 0.0;
+    double freq_ = 0.0;
+    std::complex<float> chunk_corr_; ///< Correlation of the open chunk
+    std::size_t chunk_fill_ = 0;     ///< Samples in the open chunk
+    std::complex<float> corr_;       ///< Smoothed mean pilot correlation
+    float level_ = 0.0f;
+    float lock_ = 0.0f;              ///< Smoothed cos of the phase error
+    bool locked_ = false;
+    float blend_ = 0.0f;
+
+    // Scratch: pilot-free L+R and demodulated L-R at the MPX rate, then
+    // L and R at the audio rate
+    std::vector<float> sum_;
+    std::vector<float> diff_;
+    std::vector<float> left_buf_;
+    std::vector<float> right_buf_;
+
+    /// Advance the loop past a chunk with pilot correlation @p corr.
+    void update(std::complex<float> corr);
+};
+
+} // namespace dsp
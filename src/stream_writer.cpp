@@ -0,0 +1,197 @@
+#include "stream_writer.hpp"
+#include "thread_util.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/uio.h>
+#include <utility>
+
+namespace {
+
+/// Frames handed to one writev() call
+constexpr std::size_t kMaxIov = 64;
+
+/// poll() interval while the consumer is not reading
+constexpr int kPollMs = 100;
+
+/// Consecutive idle polls after which shutdown gives up on the consumer (1 s)
+constexpr int kMaxIdlePolls = 10;
+
+} // namespace
+
+StreamWriter::StreamWriter(int fd, std::size_t capacity, OverflowPolicy policy)
+    : fd_{fd}
+    , policy_{policy}
+{
+    if (capacity == 0)
+        throw std::invalid_argument("StreamWriter capacity must be non-zero");
+
+    slots_.resize(capacity);
+
+    // Shared with whoever else holds the file description; restored on exit
+    saved_flags_ = ::fcntl(fd_, F_GETFL);
+    if (saved_flags_ >= 0)
+        ::fcntl(fd_, F_SETFL, saved_flags_ | O_NONBLOCK);
+
+    thread_ = std::jthread([this] { run(); });
+}
+
+StreamWriter::~StreamWriter()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    readable_.notify_all();
+    writable_.notify_all();
+    thread_.join();
+
+    if (saved_flags_ >= 0)
+        ::fcntl(fd_, F_SETFL, saved_flags_);
+}
+
+void StreamWriter::write(const void* data, std::size_t bytes)
+{
+    std::unique_lock lock(mutex_);
+
+    if (failed_ || stop_) {
+        stats_.frames_dropped++;
+        return;
+    }
+
+    if (count_ == slots_.size()) {
+        switch (policy_) {
+        case OverflowPolicy::Block:
+            writable_.wait(lock, [&] { return count_ < slots_.size() || failed_; });
+            if (failed_) {
+                stats_.frames_dropped++;
+                return;
+            }
+            break;
+
+        case OverflowPolicy::DropNewest:
+            stats_.frames_dropped++;
+            return;
+
+        case OverflowPolicy::DropOldest:
+            // Every queued frame is already being written
+            if (in_flight_ == count_) {
+                stats_.frames_dropped++;
+                return;
+            }
+
+            // Close the gap left by the oldest frame not in flight; the
+            // writer only touches in-flight slots without the lock
+            for (std::size_t i = in_flight_; i + 1 < count_; i++)
+                std::swap(slot(i), slot(i + 1));
+            count_--;
+            stats_.frames_dropped++;
+            break;
+        }
+    }
+
+    const auto* p = static_cast<const std::byte*>(data);
+    slot(count_).assign(p, p + bytes);
+    count_++;
+    stats_.high_water = std::max(stats_.high_water, count_);
+
+    lock.unlock();
+    readable_.notify_one();
+}
+
+StreamWriterStats StreamWriter::stats() const
+{
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+bool StreamWriter::stopping() const
+{
+    std::lock_guard lock(mutex_);
+    return stop_;
+}
+
+void StreamWriter::run()
+{
+    set_current_thread_name("fm-writer");
+
+    while (true) {
+        std::unique_lock lock(mutex_);
+        readable_.wait(lock, [&] { return count_ > 0 || stop_; });
+        if (count_ == 0)
+            break;
+
+        const std::size_t frames = std::min(count_, kMaxIov);
+        in_flight_ = frames;
+        lock.unlock();
+
+        std::uint64_t bytes = 0;
+        const bool ok = send(frames, bytes);
+
+        lock.lock();
+        head_ = (head_ + frames) % slots_.size();
+        count_ -= frames;
+        in_flight_ = 0;
+        stats_.bytes_written += bytes;
+
+        if (ok) {
+            stats_.frames_written += frames;
+        } else {
+            // The consumer is gone: stop queueing and discard the backlog
+            failed_ = true;
+            stats_.frames_dropped += frames + count_;
+            head_ = (head_ + count_) % slots_.size();
+            count_ = 0;
+        }
+
+        lock.unlock();
+        writable_.notify_all();
+    }
+}
+
+bool StreamWriter::send(std::size_t frames, std::uint64_t& bytes)
+{
+    iovec iov[kMaxIov];
+    for (std::size_t i = 0; i < frames; i++)
+        iov[i] = {slot(i).data(), slot(i).size()};
+
+    std::size_t first = 0;
+    int idle_polls = 0;
+
+    while (first < frames) {
+        const ssize_t r = ::writev(fd_, iov + first, static_cast<int>(frames - first));
+
+        if (r < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                return false;
+
+            pollfd pfd{fd_, POLLOUT, 0};
+            const int ready = ::poll(&pfd, 1, kPollMs);
+            if (ready > 0 && (pfd.revents & (POLLERR | POLLHUP)))
+                return false;
+            if (ready == 0 && stopping() && ++idle_polls >= kMaxIdlePolls)
+                return false;
+            continue;
+        }
+
+        idle_polls = 0;
+        bytes += static_cast<std::uint64_t>(r);
+
+        // Skip the fully written iovecs, trim a partially written one
+        auto left = static_cast<std::size_t>(r);
+        while (first < frames && left >= iov[first].iov_len)
+            left -= iov[first++].iov_len;
+        if (left > 0) {
+            iov[first].iov_base = static_cast<std::byte*>(iov[first].iov_base) + left;
+            iov[first].iov_len -= left;
+        }
+    }
+
+    return true;
+}
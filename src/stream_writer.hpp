@@ -0,0 +1,108 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @file stream_writer.hpp
+ * @brief Background writer decoupling the receive loop from a slow consumer.
+ */
+
+/// What StreamWriter::write() does when the ring is full.
+enum class OverflowPolicy {
+    DropOldest, ///< Discard the oldest queued frame (keeps latency bounded)
+    DropNewest, ///< Discard the frame being written (keeps the queue intact)
+    Block       ///< Wait for the consumer (lossless; for offline sources)
+};
+
+/// Counters of a StreamWriter.
+struct StreamWriterStats {
+    std::uint64_t frames_written = 0; ///< Frames fully handed to the fd
+    std::uint64_t frames_dropped = 0; ///< Frames discarded by the policy or after an fd error
+    std::uint64_t bytes_written  = 0;
+    std::size_t   high_water     = 0; ///< Largest number of queued frames
+};
+
+/**
+ * @class StreamWriter
+ * @brief Writes frames to a file descriptor from its own thread, behind a
+ *        bounded ring.
+ *
+ * write() copies a frame (one audio block) into a preallocated ring slot
+ * and returns; it never waits for the consumer unless the policy is Block.
+ * The writer thread sends every queued frame with a single writev() on the
+ * descriptor, which is switched to O_NONBLOCK so shutdown never hangs in
+ * a write; while the consumer is not reading the thread waits in poll().
+ *
+ * The destructor drains what is still queued (giving up if the consumer
+ * makes no progress for a second) and restores the descriptor flags.
+ */
+class StreamWriter {
+public:
+    /**
+     * @param fd        Descriptor to write to; not closed by this object
+     * @param capacity  Frames the ring holds
+     * @param policy    Behaviour of write() when the ring is full
+     *
+     * @throws std::invalid_argument if @p capacity is zero
+     */
+    StreamWriter(int fd, std::size_t capacity = 16,
+                 OverflowPolicy policy = OverflowPolicy::DropOldest);
+
+    ~StreamWriter();
+
+    StreamWriter(const StreamWriter&) = delete;
+    StreamWriter& operator=(const StreamWriter&) = delete;
+
+    /// Queue one frame of @p bytes bytes (copied).
+    void write(const void* data, std::size_t bytes);
+
+    /// Snapshot of the counters.
+    [[nodiscard]] StreamWriterStats stats() const;
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return slots_.size(); }
+    [[nodiscard]] OverflowPolicy policy() const noexcept { return policy_; }
+
+private:
+    int fd_;
+    int saved_flags_ = -1;
+    OverflowPolicy policy_;
+
+    // Ring of frames; slots keep their capacity between frames
+    std::vector<std::vector<std::byte>> slots_;
+    std::size_t head_ = 0;      ///< Oldest queued frame
+    std::size_t count_ = 0;     ///< Queued frames, including in-flight ones
+    std::size_t in_flight_ = 0; ///< Frames at head_ the writer is sending
+    bool stop_ = false;
+    bool failed_ = false;       ///< fd error: everything further is dropped
+
+    StreamWriterStats stats_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable readable_;
+    std::condition_variable writable_;
+    std::jthread thread_;
+
+    void run();
+
+    /// Queued frame @p i positions after head_.
+    std::vector<std::byte>& slot(std::size_t i) noexcept
+    {
+        return slots_[(head_ + i) % slots_.size()];
+    }
+
+    /**
+     * @brief Send the @p frames oldest (in-flight) frames, completing any
+     *        partial writes.
+     * @param bytes  Incremented by the bytes written
+     * @return false on an fd error, or if the consumer stalls at shutdown
+     */
+    bool send(std::size_t frames, std::uint64_t& bytes);
+
+    /// @return true once the destructor has asked the thread to finish.
+    bool stopping() const;
+};
@@ -0,0 +1,412 @@
+#include "supervisor.hpp"
+#include "spsc_ring.hpp"
+#include "thread_util.hpp"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <variant>
+
+namespace {
+
+template <typename T>
+bool parse_number(std::string_view sv, T& out)
+{
+    auto r = std::from_chars(sv.data(), sv.data() + sv.size(), out);
+    return r.ec == std::errc{} && r.ptr == sv.data() + sv.size();
+}
+
+/// Wait before reopen attempt number @p failures (1 = first retry).
+std::chrono::milliseconds backoff(const SupervisorOptions& opts, unsigned failures)
+{
+    const unsigned doublings = std::min(failures - 1, 20u);
+    return std::min<std::chrono::milliseconds>(opts.restart_delay * (1LL << doublings),
+                                               opts.max_restart_delay);
+}
+
+/// Sleep for @p d unless @p stop is requested first; @return false if stopped.
+bool sleep_for(std::chrono::milliseconds d, std::stop_token stop)
+{
+    std::mutex m;
+    std::condition_variable_any cv;
+    std::unique_lock lock(m);
+    cv.wait_for(lock, stop, d, [] { return false; });
+    return !stop.stop_requested();
+}
+
+} // namespace
+
+std::vector<DeviceConfig> parse_device_config(std::istream& in)
+{
+    std::vector<DeviceConfig> devices;
+    std::string line;
+
+    for (int number = 1; std::getline(in, line); number++) {
+        auto fail = [&](const std::string& what) {
+            throw std::runtime_error("Line " + std::to_string(number) + ": " + what);
+        };
+
+        line.erase(std::min(line.find('#'), line.size()));
+        std::istringstream fields(line);
+
+        DeviceConfig dev;
+        bool empty = true;
+        for (std::string field; fields >> field; empty = false) {
+            const auto eq = field.find('=');
+            if (eq == std::string::npos || eq == 0)
+                fail("expected key=value, got '" + field + "'");
+
+            const std::string key = field.substr(0, eq);
+            const std::string_view value = std::string_view(field).substr(eq + 1);
+
+            if (key == "name") {
+                dev.name = std::string(value);
+            } else if (key == "uri") {
+                dev.uri = std::string(value);
+            } else if (key == "file") {
+                dev.file = std::string(value);
+            } else if (key == "freq") {
+                double mhz{};
+                if (!parse_number(value, mhz) || !(mhz > 0.0))
+                    fail("invalid freq");
+                dev.frequency_hz = std::llround(mhz * 1e6);
+            } else if (key == "gain") {
+                if (!parse_number(value, dev.gain_db))
+                    fail("invalid gain");
+            } else if (key == "udp") {
+                if (!parse_udp_destination(value, dev.udp))
+                    fail("invalid udp, expected <ip>:<port>[,ttl=<hops>][,if=<name>][,loop]");
+            } else {
+                fail("unknown key '" + key + "'");
+            }
+        }
+        if (empty)
+            continue;
+
+        if (dev.uri.empty() == dev.file.empty())
+            fail("expected exactly one of uri= or file=");
+        if (!dev.uri.empty() && dev.frequency_hz == 0)
+            fail("uri= needs freq=");
+        if (dev.udp.ip.empty())
+            fail("missing udp=");
+        if (dev.name.empty())
+            dev.name = "dev" + std::to_string(devices.size());
+        if (std::ranges::any_of(devices, [&](const auto& d) { return d.name == dev.name; }))
+            fail("duplicate name '" + dev.name + "'");
+
+        devices.push_back(std::move(dev));
+    }
+
+    if (devices.empty())
+        throw std::runtime_error("No devices in config");
+    return devices;
+}
+
+std::vector<DeviceConfig> load_device_config(const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("Cannot open config " + path);
+    return parse_device_config(in);
+}
+
+/// Per-device DSP chain, output, queue and counters.
+struct Supervisor::Device {
+    /// Capture block copied out of the source
+    struct RawBlock {
+        std::vector<int16_t> iq;
+        BlockMeta meta;
+        bool restarted = false; ///< First block after a reopen: reset the DSP state
+    };
+
+    Device(DeviceConfig cfg, const DspOptions& dsp, const OutputOptions& out,
+           const SupervisorOptions& opts, float audio_gain)
+        : config{std::move(cfg)}
+        , pipeline{make_pipeline(dsp, audio_gain, opts.block_size)}
+        , output{std::span<const UdpDestination>(&config.udp, 1), out}
+        , ring{opts.ring_depth}
+    {
+        ring.for_each_slot([&](RawBlock& b) { b.iq.reserve(2 * opts.block_size); });
+    }
+
+    DeviceConfig config;
+    AnyPipeline pipeline;
+    AudioOutput output;
+    SpscRing<RawBlock> ring;
+
+    /// Blocks committed to the ring and not yet processed; the 0 -> 1
+    /// transition schedules drain(), so one task at a time owns the DSP
+    std::atomic<std::size_t> queued{0};
+
+    // Audio scratch of drain()
+    std::vector<float> f32;
+    std::vector<int16_t> pcm;
+
+    // Statistics; null unless enable_stats() was called
+    std::unique_ptr<PipelineMetrics> metrics;
+
+    std::atomic<DeviceState> state{DeviceState::Starting};
+    std::atomic<std::uint64_t> blocks{0};
+    std::atomic<std::uint64_t> pairs{0};
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<std::uint64_t> restarts{0};
+    bool opened = false; ///< Capture thread only
+};
+
+Supervisor::Supervisor(std::vector<DeviceConfig> devices,
+                       SourceFactory open,
+                       const DspOptions& dsp,
+                       const OutputOptions& output,
+                       const SupervisorOptions& opts,
+                       float audio_gain)
+    : open_{std::move(open)}
+    , opts_{opts}
+    , sample_rate_{dsp.rates.input_rate_hz}
+    , pool_{opts.pool_threads, dsp.flush_denormals}
+{
+    if (devices.empty())
+        throw std::invalid_argument("Supervisor needs at least one device");
+
+    devices_.reserve(devices.size());
+    for (std::size_t i = 0; i < devices.size(); i++) {
+        DeviceConfig& cfg = devices[i];
+        if (cfg.udp.ip.empty() || cfg.udp.port == 0)
+            throw std::invalid_argument("Device " + std::to_string(i) + " has no UDP destination");
+        if (cfg.name.empty())
+            cfg.name = "dev" + std::to_string(i);
+
+        devices_.push_back(std::make_unique<Device>(std::move(cfg), dsp, output, opts_, audio_gain));
+    }
+}
+
+Supervisor::~Supervisor() = default;
+
+void Supervisor::enable_stats(const StatsOptions& opts)
+{
+    const auto period = static_cast<std::uint64_t>(
+        static_cast<long long>(opts_.block_size) * 1'000'000'000LL / sample_rate_);
+
+    stats_opts_ = opts;
+    for (auto& dev : devices_) {
+        dev->metrics = std::make_unique<PipelineMetrics>(period);
+        std::visit([&](auto& p) { p.set_metrics(dev->metrics.get()); }, dev->pipeline);
+    }
+}
+
+void Supervisor::run()
+{
+    std::vector<std::unique_ptr<StatsReporter>> reporters;
+    if (stats_opts_ && stats_opts_->interval_s > 0.0) {
+        for (auto& dev : devices_) {
+            StatsOptions o = *stats_opts_;
+            o.label = dev->config.name;
+            reporters.push_back(std::make_unique<StatsReporter>(*dev->metrics, o));
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::jthread> threads;
+        for (std::size_t i = 0; i < devices_.size(); i++) {
+            threads.emplace_back([this, i, stop = stop_.get_token()] {
+                set_current_thread_name(("fm-cap-" + std::to_string(i)).c_str());
+                capture(*devices_[i], stop);
+            });
+        }
+    }
+    pool_.wait_idle();
+    reporters.clear();
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    for (std::size_t i = 0; i < devices_.size(); i++) {
+        const DeviceStats st = stats(i);
+        const double msps = elapsed.count() > 0.0
+            ? static_cast<double>(st.pairs) / elapsed.count() / 1e6 : 0.0;
+        std::cerr << '[' << name(i) << "] " << st.blocks << " blocks, " << st.pairs
+                  << " IQ samples (" << msps << " MSPS), " << st.dropped << " dropped, "
+                  << st.restarts << " restarts\n";
+    }
+}
+
+void Supervisor::stop() noexcept
+{
+    stop_.request_stop();
+}
+
+DeviceStats Supervisor::stats(std::size_t index) const
+{
+    const Device& dev = *devices_.at(index);
+    DeviceStats st;
+    st.state    = dev.state.load(std::memory_order_relaxed);
+    st.blocks   = dev.blocks.load(std::memory_order_relaxed);
+    st.pairs    = dev.pairs.load(std::memory_order_relaxed);
+    st.dropped  = dev.dropped.load(std::memory_order_relaxed);
+    st.restarts = dev.restarts.load(std::memory_order_relaxed);
+    return st;
+}
+
+const std::string& Supervisor::name(std::size_t index) const
+{
+    return devices_.at(index)->config.name;
+}
+
+std::unique_ptr<SampleSource> Supervisor::reopen(Device& dev, std::stop_token stop, unsigned& failures)
+{
+    const std::string& name = dev.config.name;
+
+    while (!stop.stop_requested()) {
+        if (failures > 0) {
+            if (opts_.max_retries && failures > opts_.max_retries) {
+                std::cerr << '[' << name << "] Giving up after " << failures << " failures\n";
+                return nullptr;
+            }
+            dev.state.store(DeviceState::Restarting, std::memory_order_relaxed);
+            if (!sleep_for(backoff(opts_, failures), stop))
+                return nullptr;
+        }
+
+        try {
+            auto source = open_(dev.config);
+            if (source->sample_rate() != sample_rate_)
+                throw std::runtime_error("sample rate is " + std::to_string(source->sample_rate()) +
+                                         " Hz, expected " + std::to_string(sample_rate_) + " Hz");
+            if (std::exchange(dev.opened, true))
+                dev.restarts.fetch_add(1, std::memory_order_relaxed);
+            return source;
+        } catch (const std::exception& e) {
+            std::cerr << '[' << name << "] Open failed: " << e.what() << '\n';
+            failures++;
+        }
+    }
+    return nullptr;
+}
+
+void Supervisor::capture(Device& dev, std::stop_token stop)
+{
+    unsigned failures = 0;
+    bool restarted = false;
+    std::uint64_t next_index = 0; ///< Pairs captured, lost or dropped, across reopens
+    BlockMeta::Clock::time_point failed_at{};
+
+    while (auto source = reopen(dev, stop, failures)) {
+        if (restarted) {
+            // The outage since the failed refill leaves its gap in the index
+            const auto outage = BlockMeta::Clock::now() - failed_at;
+            next_index += static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(outage).count() *
+                sample_rate_ / 1'000'000'000LL);
+        }
+
+        const bool live = source->live();
+        std::optional<OverrunDetector> overruns;
+        if (live)
+            overruns.emplace(source->sample_rate(), source->queued_blocks() + 1);
+
+        dev.state.store(DeviceState::Running, std::memory_order_relaxed);
+
+        bool failed = false;
+        while (!stop.stop_requested()) {
+            std::span<const int16_t> raw;
+            {
+                StageTimer t(dev.metrics.get(), Stage::Capture);
+                raw = source->next_block();
+            }
+
+            // Live sources never end: an empty block is a failed refill
+            if (raw.empty()) {
+                failed = live;
+                failed_at = BlockMeta::Clock::now();
+                break;
+            }
+            failures = 0;
+
+            const auto now = BlockMeta::Clock::now();
+            const std::size_t pairs = raw.size() / 2;
+            const std::uint64_t lost = overruns ? overruns->on_block(pairs, now) : 0;
+            if (dev.metrics)
+                dev.metrics->add_block(lost);
+
+            // Lost and dropped blocks leave their gap in the index
+            const BlockMeta meta{next_index + lost * pairs, now};
+            next_index = meta.sample_index + pairs;
+
+            // As run_pipelined(): drop live blocks rather than stall the refill
+            auto* slot = live ? dev.ring.try_acquire_write() : dev.ring.wait_acquire_write();
+            if (!slot) {
+                dev.dropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            slot->iq.assign(raw.begin(), raw.end());
+            slot->meta = meta;
+            slot->restarted = std::exchange(restarted, false);
+            dev.ring.commit_write();
+
+            if (dev.queued.fetch_add(1, std::memory_order_acq_rel) == 0)
+                pool_.submit([this, &dev] { drain(dev); });
+        }
+        if (!failed)
+            break;
+
+        std::cerr << '[' << dev.config.name << "] Capture failed, reopening\n";
+        source.reset();
+        restarted = true;
+        failures++;
+    }
+
+    dev.state.store(DeviceState::Stopped, std::memory_order_relaxed);
+}
+
+void Supervisor::drain(Device& dev)
+{
+    do {
+        // Counted blocks are committed, so the ring is never empty here
+        auto* block = dev.ring.try_acquire_read();
+        const std::size_t pairs = block->iq.size() / 2;
+
+        try {
+            std::visit([&](auto& p) {
+                if (block->restarted)
+                    p.reset();
+
+                const std::size_t max_samples = p.max_audio_samples(pairs);
+                if (dev.f32.size() < max_samples) {
+                    dev.f32.resize(max_samples);
+                    dev.pcm.resize(max_samples);
+                }
+
+                const std::size_t samples = dev.output.wants_pcm()
+                    ? p.process_block(block->iq, block->meta, std::span(dev.pcm))
+                    : p.process_block(block->iq, block->meta, std::span(dev.f32));
+
+                StageTimer t(dev.metrics.get(), Stage::Output);
+                dev.output.stamp(p.audio_meta());
+                if (const std::size_t muted = p.muted_samples())
+                    dev.output.write_silence(muted);
+                else if (dev.output.wants_pcm())
+                    dev.output.write(std::span<const int16_t>(dev.pcm).first(samples));
+                else
+                    dev.output.write(std::span<const float>(dev.f32).first(samples));
+            }, dev.pipeline);
+
+            if (dev.metrics)
+                dev.metrics->stage(Stage::Latency).record(static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        BlockMeta::Clock::now() - block->meta.captured).count()));
+
+            dev.blocks.fetch_add(1, std::memory_order_relaxed);
+            dev.pairs.fetch_add(pairs, std::memory_order_relaxed);
+        } catch (const std::exception& e) {
+            std::cerr << '[' << dev.config.name << "] DSP failed: " << e.what() << '\n';
+        }
+
+        dev.ring.commit_read();
+    } while (dev.queued.fetch_sub(1, std::memory_order_acq_rel) > 1);
+}
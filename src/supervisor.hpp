@@ -0,0 +1,188 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+#include "audio_output.hpp"
+#include "metrics.hpp"
+#include "pipeline.hpp"
+#include "sample_source.hpp"
+#include "work_pool.hpp"
+
+/**
+ * @file supervisor.hpp
+ * @brief Several SDRs in one process: a capture thread per device, the DSP
+ *        of all of them on one WorkPool.
+ */
+
+/// One receiver of a supervisor config file.
+struct DeviceConfig {
+    std::string name;          ///< Label of log lines and statistics
+    std::string uri;           ///< libiio context URI (a PlutoSDR)...
+    std::string file;          ///< ...or a recording to replay instead
+    long long frequency_hz = 0;
+    double gain_db = 0.0;
+    UdpDestination udp;        ///< Audio destination
+};
+
+/**
+ * @brief Parse a supervisor config: one device per line.
+ *
+ * Each line is a list of `key=value` fields separated by whitespace; `#`
+ * starts a comment and blank lines are ignored.
+ *
+ * @code
+ *   # Two Plutos and a recording
+ *   name=north uri=ip:192.168.2.1  freq=100.1 gain=40 udp=127.0.0.1:5000
+ *   name=south uri=usb:1.4.5       freq=94.5  gain=30 udp=127.0.0.1:5001
+ *   name=replay file=capture.iq                      udp=239.1.2.3:5002,ttl=4
+ * @endcode
+ *
+ * Every device needs exactly one of `uri` or `file`, and `udp` in the
+ * syntax of parse_udp_destination(). `freq` is
+ * required with `uri`; `gain` defaults to 0 dB and `name` to `dev<N>`
+ * (zero-based line of the device).
+ *
+ * @throws std::runtime_error naming the line of the first error, or if no
+ *         device is listed
+ */
+std::vector<DeviceConfig> parse_device_config(std::istream& in);
+
+/// parse_device_config() of a file; @throws std::runtime_error if it cannot be read.
+std::vector<DeviceConfig> load_device_config(const std::string& path);
+
+/// Supervisor scheduling and restart policy.
+struct SupervisorOptions {
+    unsigned pool_threads = 0;     ///< DSP workers (0 = one per hardware thread)
+    std::size_t ring_depth = 8;    ///< Capture blocks queued per device ahead of DSP
+    std::size_t block_size = 120'000; ///< Expected IQ pairs per capture block (sizes buffers)
+
+    /// Wait before the first reopen of a failed device; doubles per failed
+    /// attempt up to max_restart_delay, and resets after a good block
+    std::chrono::milliseconds restart_delay{500};
+    std::chrono::milliseconds max_restart_delay{10'000};
+
+    /// Consecutive failed opens or captures before a device is given up (0 = never)
+    unsigned max_retries = 0;
+};
+
+/// Lifecycle of one supervised device.
+enum class DeviceState {
+    Starting,   ///< Not opened yet
+    Running,    ///< Capturing
+    Restarting, ///< Waiting to reopen after a failure
+    Stopped,    ///< End of recording, stop() or out of retries
+};
+
+/// Counters of one device at one point in time.
+struct DeviceStats {
+    DeviceState state = DeviceState::Starting;
+    std::uint64_t blocks   = 0; ///< Capture blocks demodulated
+    std::uint64_t pairs    = 0; ///< IQ pairs demodulated
+    std::uint64_t dropped  = 0; ///< Live blocks dropped because DSP fell behind
+    std::uint64_t restarts = 0; ///< Times the device was reopened
+};
+
+/**
+ * @class Supervisor
+ * @brief Receives from several SampleSources at once, restarting any that fail.
+ *
+ * Every device has a capture thread that only fetches blocks and copies
+ * them into a per-device SPSC ring. The DSP chain and audio output of all
+ * devices run as tasks on one WorkPool sized to the machine, instead of a
+ * thread set per radio. A device's blocks are processed in order by one
+ * task at a time, so its DemodPipeline keeps its stream state without a
+ * lock, while different devices run on different workers.
+ *
+ * When a live source returns an empty block (iio_buffer_refill() failed:
+ * USB reset, network drop, device reboot), only that device is closed and
+ * reopened after SupervisorOptions::restart_delay, with exponential backoff;
+ * its DSP state is reset at the discontinuity, and the sample index skips
+ * the time the device was down. The other devices keep running. An empty
+ * block from a recording ends that device.
+ */
+class Supervisor {
+public:
+    /// Opens the source of a device; may throw to report a failed open.
+    using SourceFactory = std::function<std::unique_ptr<SampleSource>(const DeviceConfig&)>;
+
+    /**
+     * @param devices     Receivers to run; each needs a UDP destination
+     * @param open        Creates the source of a device, again on every restart
+     * @param dsp         DSP chain of every device; its rate must match the sources
+     * @param output      Audio format and UDP framing of every device
+     * @param opts        Pool size and restart policy
+     * @param audio_gain  Audio gain applied after DSP
+     * @throws std::invalid_argument for an empty device list or a device
+     *         without a UDP destination, or as DemodPipeline
+     */
+    Supervisor(std::vector<DeviceConfig> devices,
+               SourceFactory open,
+               const DspOptions& dsp,
+               const OutputOptions& output = {},
+               const SupervisorOptions& opts = {},
+               float audio_gain = 0.3f);
+
+    ~Supervisor();
+
+    Supervisor(const Supervisor&) = delete;
+    Supervisor& operator=(const Supervisor&) = delete;
+
+    /**
+     * @brief Time capture and DSP of every device during run().
+     *
+     * One StatsReporter per device, labelled with the device name (see
+     * StatsOptions::label).
+     */
+    void enable_stats(const StatsOptions& opts);
+
+    /**
+     * @brief Run every device until all have stopped.
+     *
+     * Prints one summary line per device on stderr when done.
+     */
+    void run();
+
+    /// Stop all devices; run() returns once the queued blocks are processed. Any thread.
+    void stop() noexcept;
+
+    /// @return Number of devices.
+    [[nodiscard]] std::size_t size() const noexcept { return devices_.size(); }
+
+    /// @return DSP worker threads.
+    [[nodiscard]] unsigned pool_threads() const noexcept { return pool_.threads(); }
+
+    /// @return Counters of device @p index; safe while run() is running.
+    [[nodiscard]] DeviceStats stats(std::size_t index) const;
+
+    /// @return Name of device @p index.
+    [[nodiscard]] const std::string& name(std::size_t index) const;
+
+private:
+    struct Device;
+
+    SourceFactory open_;
+    SupervisorOptions opts_;
+    long long sample_rate_;
+    std::optional<StatsOptions> stats_opts_;
+    std::vector<std::unique_ptr<Device>> devices_;
+    std::stop_source stop_;
+    WorkPool pool_;
+
+    /// Capture thread of @p dev: fetch, queue, restart on failure.
+    void capture(Device& dev, std::stop_token stop);
+
+    /// @return Opened source, or null once @p stop is requested or retries run out.
+    std::unique_ptr<SampleSource> reopen(Device& dev, std::stop_token stop, unsigned& failures);
+
+    /// DSP task: demodulate and output every block queued for @p dev, in order.
+    void drain(Device& dev);
+};
@@ -0,0 +1,120 @@
+#include "thread_util.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <xmmintrin.h>
+#define FP_CONTROL_X86 1
+#elif defined(__aarch64__)
+#define FP_CONTROL_A64 1
+#elif defined(__arm__) && defined(__ARM_FP)
+#define FP_CONTROL_A32 1
+#endif
+
+namespace {
+
+#if defined(FP_CONTROL_X86)
+constexpr unsigned long long kFlushBits = 0x8040;     // MXCSR FTZ (bit 15) and DAZ (bit 6)
+#else
+constexpr unsigned long long kFlushBits = 1ull << 24; // FPCR / FPSCR FZ
+#endif
+
+/// @return Floating-point control register of the calling thread (0 if none).
+unsigned long long read_fp_control() noexcept
+{
+#if defined(FP_CONTROL_X86)
+    return _mm_getcsr();
+#elif defined(FP_CONTROL_A64)
+    std::uint64_t fpcr;
+    __asm__ volatile("mrs %0, fpcr" : "=r"(fpcr));
+    return fpcr;
+#elif defined(FP_CONTROL_A32)
+    std::uint32_t fpscr;
+    __asm__ volatile("vmrs %0, fpscr" : "=r"(fpscr));
+    return fpscr;
+#else
+    return 0;
+#endif
+}
+
+void write_fp_control([[maybe_unused]] unsigned long long value) noexcept
+{
+#if defined(FP_CONTROL_X86)
+    _mm_setcsr(static_cast<unsigned>(value));
+#elif defined(FP_CONTROL_A64)
+    const std::uint64_t fpcr = value;
+    __asm__ volatile("msr fpcr, %0" : : "r"(fpcr));
+#elif defined(FP_CONTROL_A32)
+    const std::uint32_t fpscr = static_cast<std::uint32_t>(value);
+    __asm__ volatile("vmsr fpscr, %0" : : "r"(fpscr));
+#endif
+}
+
+} // namespace
+
+bool pin_current_thread(int cpu) noexcept
+{
+    if (cpu < 0)
+        return true;
+
+    if (cpu >= CPU_SETSIZE)
+        return false;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+void set_current_thread_name(const char* name) noexcept
+{
+    char buf[16] = {};
+    std::strncpy(buf, name, sizeof(buf) - 1);
+    pthread_setname_np(pthread_self(), buf);
+}
+
+bool lower_current_thread_priority() noexcept
+{
+    const sched_param param{};
+    return pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) == 0;
+}
+
+bool flush_to_zero_supported() noexcept
+{
+#if defined(FP_CONTROL_X86) || defined(FP_CONTROL_A64) || defined(FP_CONTROL_A32)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool enable_flush_to_zero() noexcept
+{
+    if (!flush_to_zero_supported())
+        return false;
+    write_fp_control(read_fp_control() | kFlushBits);
+    return true;
+}
+
+bool flush_to_zero_enabled() noexcept
+{
+    return flush_to_zero_supported() && (read_fp_control() & kFlushBits) == kFlushBits;
+}
+
+ScopedFlushToZero::ScopedFlushToZero(bool enable) noexcept
+{
+    if (!enable || !flush_to_zero_supported())
+        return;
+    saved_ = read_fp_control();
+    active_ = enable_flush_to_zero();
+}
+
+ScopedFlushToZero::~ScopedFlushToZero()
+{
+    if (active_)
+        write_fp_control(saved_);
+}
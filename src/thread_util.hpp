@@ -0,0 +1,72 @@
+#pragma once
+
+/**
+ * @file thread_util.hpp
+ * @brief Small helpers for configuring pipeline worker threads.
+ */
+
+/**
+ * @brief Pin the calling thread to a single CPU core.
+ *
+ * @param cpu Zero-based core index. Negative values leave the thread
+ *            unpinned and return true.
+ *
+ * @return true on success (or when no pinning was requested).
+ */
+bool pin_current_thread(int cpu) noexcept;
+
+/**
+ * @brief Set a short, human-readable name for the calling thread.
+ *
+ * Shown by top/htop/perf; names longer than 15 characters are truncated.
+ */
+void set_current_thread_name(const char* name) noexcept;
+
+/**
+ * @brief Move the calling thread to SCHED_IDLE.
+ *
+ * It then only runs on cycles no other thread of the machine wants, so
+ * background work never takes CPU from the receive loop.
+ *
+ * @return true on success.
+ */
+bool lower_current_thread_priority() noexcept;
+
+/// @return true if enable_flush_to_zero() can work on this target.
+bool flush_to_zero_supported() noexcept;
+
+/**
+ * @brief Flush denormal floats to zero on the calling thread.
+ *
+ * Sets FTZ and DAZ in the MXCSR on x86 and FZ in the FPCR (AArch64) or
+ * FPSCR (ARMv7) on ARM, so denormal results and operands are read as zero
+ * instead of taking the slow microcoded path. Affects SSE/AVX and NEON
+ * arithmetic of this thread only; x87 code is unchanged.
+ *
+ * @return false if the target has no such control.
+ */
+bool enable_flush_to_zero() noexcept;
+
+/// @return true if the calling thread flushes denormals to zero.
+bool flush_to_zero_enabled() noexcept;
+
+/**
+ * @class ScopedFlushToZero
+ * @brief Flushes denormals on the calling thread until it goes out of scope.
+ *
+ * Restores the previous floating-point control state on destruction, so a
+ * receive loop running on the caller's thread leaves it as it found it.
+ */
+class ScopedFlushToZero {
+public:
+    /// @param enable false makes this a no-op, for an optional mode
+    explicit ScopedFlushToZero(bool enable = true) noexcept;
+    ~ScopedFlushToZero();
+
+    ScopedFlushToZero(const ScopedFlushToZero&) = delete;
+    ScopedFlushToZero& operator=(const ScopedFlushToZero&) = delete;
+
+private:
+    bool active_ = false;
+    unsigned long long saved_ = 0;
+};
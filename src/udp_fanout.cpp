@@ -0,0 +1,479 @@
+#include "udp_fanout.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <endian.h>
+#include <linux/io_uring.h>
+#include <net/if.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+/// Submission queue depth; also the most messages of one io_uring_enter()
+constexpr unsigned kRingEntries = 1024;
+
+/// Socket options a destination needs; equal keys share a socket
+struct SocketKey {
+    AddressType type;
+    int ttl;
+    bool loopback;
+    std::string interface;
+
+    bool operator==(const SocketKey&) const = default;
+};
+
+void set_option(int fd, int level, int name, const void* value, socklen_t len, const char* what)
+{
+    if (::setsockopt(fd, level, name, value, len) != 0)
+        throw std::runtime_error(std::string("Failed to set ") + what + ": " + std::strerror(errno));
+}
+
+int open_socket(const SocketKey& key)
+{
+    const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0)
+        throw std::runtime_error("Failed to create UDP socket");
+
+    // Owns fd until the options are set
+    std::unique_ptr<int, SocketDeleter> guard(new int(fd));
+
+    switch (key.type) {
+    case AddressType::Multicast: {
+        const auto ttl = static_cast<unsigned char>(key.ttl ? key.ttl : 1);
+        set_option(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl), "multicast TTL");
+
+        const auto loop = static_cast<unsigned char>(key.loopback);
+        set_option(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop), "multicast loopback");
+
+        if (!key.interface.empty()) {
+            ip_mreqn req{};
+            req.imr_ifindex = static_cast<int>(::if_nametoindex(key.interface.c_str()));
+            if (req.imr_ifindex == 0)
+                throw std::runtime_error("Unknown interface " + key.interface);
+            set_option(fd, IPPROTO_IP, IP_MULTICAST_IF, &req, sizeof(req), "multicast interface");
+        }
+        break;
+    }
+    case AddressType::Broadcast: {
+        int yes = 1;
+        set_option(fd, SOL_SOCKET, SO_BROADCAST, &yes, sizeof(yes), "broadcast");
+        [[fallthrough]];
+    }
+    case AddressType::Unicast:
+        if (key.ttl)
+            set_option(fd, IPPROTO_IP, IP_TTL, &key.ttl, sizeof(key.ttl), "TTL");
+
+        // Unicast has no per-socket route override short of binding the device
+        if (!key.interface.empty())
+            set_option(fd, SOL_SOCKET, SO_BINDTODEVICE, key.interface.c_str(),
+                       static_cast<socklen_t>(key.interface.size()), "interface");
+        break;
+    }
+
+    return *guard.release();
+}
+
+template <typename T>
+bool parse_number(std::string_view sv, T& out)
+{
+    auto r = std::from_chars(sv.data(), sv.data() + sv.size(), out);
+    return r.ec == std::errc{} && r.ptr == sv.data() + sv.size();
+}
+
+int uring_setup(unsigned entries, io_uring_params& p)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+}
+
+int uring_enter(int fd, unsigned submit, unsigned wait)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, submit, wait,
+                                      IORING_ENTER_GETEVENTS, nullptr, 0));
+}
+
+/// @return true if the kernel implements @p op.
+bool uring_supports(int fd, unsigned op)
+{
+    constexpr unsigned kOps = 256;
+    std::vector<std::byte> buf(sizeof(io_uring_probe) + kOps * sizeof(io_uring_probe_op));
+    auto* probe = reinterpret_cast<io_uring_probe*>(buf.data());
+
+    if (::syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, kOps) < 0)
+        return false;
+    return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+}
+
+} // namespace
+
+bool parse_udp_destination(std::string_view spec, UdpDestination& out)
+{
+    UdpDestination d;
+
+    const auto comma = spec.find(',');
+    const std::string_view addr = spec.substr(0, comma);
+    const auto colon = addr.rfind(':');
+    if (colon == std::string_view::npos || colon == 0) return false;
+    if (!parse_number(addr.substr(colon + 1), d.port) || d.port < 1 || d.port > 65535)
+        return false;
+    d.ip = std::string(addr.substr(0, colon));
+
+    std::string_view rest = comma == std::string_view::npos ? std::string_view{}
+                                                            : spec.substr(comma + 1);
+    while (!rest.empty()) {
+        const auto next = rest.find(',');
+        const std::string_view opt = rest.substr(0, next);
+        rest = next == std::string_view::npos ? std::string_view{} : rest.substr(next + 1);
+
+        if (opt == "loop") {
+            d.loopback = true;
+        } else if (opt.starts_with("ttl=")) {
+            if (!parse_number(opt.substr(4), d.ttl) || d.ttl < 1 || d.ttl > 255) return false;
+        } else if (opt.starts_with("if=") && opt.size() > 3) {
+            d.interface = std::string(opt.substr(3));
+        } else {
+            return false;
+        }
+    }
+
+    out = std::move(d);
+    return true;
+}
+
+const char* backend_name(SendBackend backend) noexcept
+{
+    switch (backend) {
+    case SendBackend::Auto:     return "auto";
+    case SendBackend::Sendmmsg: return "sendmmsg";
+    case SendBackend::IoUring:  return "io_uring";
+    }
+    return "unknown";
+}
+
+/// Mapped submission and completion rings of one io_uring instance.
+struct UdpFanout::Uring {
+    int fd = -1;
+    bool zero_copy = false;
+
+    void* sq_ring = MAP_FAILED;
+    void* cq_ring = MAP_FAILED;
+    std::size_t sq_ring_bytes = 0;
+    std::size_t cq_ring_bytes = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    std::size_t sqes_bytes = 0;
+
+    unsigned entries = 0;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    ~Uring()
+    {
+        if (sqes != MAP_FAILED) ::munmap(sqes, sqes_bytes);
+        if (cq_ring != MAP_FAILED && cq_ring != sq_ring) ::munmap(cq_ring, cq_ring_bytes);
+        if (sq_ring != MAP_FAILED) ::munmap(sq_ring, sq_ring_bytes);
+        if (fd >= 0) ::close(fd);
+    }
+
+    /// @return Ring of kRingEntries, or null where io_uring is unavailable
+    ///         (old kernel, or blocked by seccomp in a container).
+    static std::unique_ptr<Uring, UringDeleter> open()
+    {
+        io_uring_params p{};
+        std::unique_ptr<Uring, UringDeleter> r(new Uring);
+        r->fd = uring_setup(kRingEntries, p);
+        if (r->fd < 0)
+            return nullptr;
+
+        r->sq_ring_bytes = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        r->cq_ring_bytes = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        if (p.features & IORING_FEAT_SINGLE_MMAP)
+            r->sq_ring_bytes = r->cq_ring_bytes = std::max(r->sq_ring_bytes, r->cq_ring_bytes);
+
+        r->sq_ring = ::mmap(nullptr, r->sq_ring_bytes, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+        if (r->sq_ring == MAP_FAILED)
+            return nullptr;
+
+        r->cq_ring = (p.features & IORING_FEAT_SINGLE_MMAP)
+            ? r->sq_ring
+            : ::mmap(nullptr, r->cq_ring_bytes, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+        if (r->cq_ring == MAP_FAILED)
+            return nullptr;
+
+        r->sqes_bytes = p.sq_entries * sizeof(io_uring_sqe);
+        r->sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, r->sqes_bytes, PROT_READ | PROT_WRITE,
+                                                    MAP_SHARED | MAP_POPULATE, r->fd,
+                                                    IORING_OFF_SQES));
+        if (r->sqes == MAP_FAILED)
+            return nullptr;
+
+        auto* sq = static_cast<std::byte*>(r->sq_ring);
+        auto* cq = static_cast<std::byte*>(r->cq_ring);
+        r->entries  = p.sq_entries;
+        r->sq_tail  = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        r->sq_mask  = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        r->sq_array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        r->cq_head  = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        r->cq_tail  = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        r->cq_mask  = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        r->cqes     = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+
+        r->zero_copy = uring_supports(r->fd, IORING_OP_SENDMSG_ZC);
+        return r;
+    }
+
+    /**
+     * @brief Send @p msgs, message i on socket fds[i], and wait for all of them.
+     * @return false if the ring failed and must not be used again
+     */
+    bool send(std::span<mmsghdr> msgs, std::span<const int> fds, bool zc, std::uint64_t& syscalls)
+    {
+        for (std::size_t done = 0; done < msgs.size();) {
+            const auto n = static_cast<unsigned>(std::min<std::size_t>(entries, msgs.size() - done));
+
+            // Single producer: only this thread writes the tail
+            unsigned tail = *sq_tail;
+            for (unsigned i = 0; i < n; i++, tail++) {
+                const unsigned idx = tail & *sq_mask;
+                io_uring_sqe& sqe = sqes[idx];
+                std::memset(&sqe, 0, sizeof(sqe));
+                sqe.opcode = zc ? IORING_OP_SENDMSG_ZC : IORING_OP_SENDMSG;
+                sqe.fd = fds[done + i];
+                sqe.addr = reinterpret_cast<std::uint64_t>(&msgs[done + i].msg_hdr);
+                sqe.len = 1;
+                sq_array[idx] = idx;
+            }
+            std::atomic_ref(*sq_tail).store(tail, std::memory_order_release);
+
+            // One completion per send, plus a buffer-release notification
+            // for every zero-copy send that reports IORING_CQE_F_MORE
+            unsigned to_submit = n;
+            unsigned outstanding = n;
+            while (outstanding) {
+                const int r = uring_enter(fd, to_submit, outstanding);
+                syscalls++;
+                if (r < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                to_submit -= std::min(to_submit, static_cast<unsigned>(r));
+
+                unsigned head = *cq_head;
+                const unsigned ready = std::atomic_ref(*cq_tail).load(std::memory_order_acquire);
+                for (; head != ready; head++) {
+                    const io_uring_cqe& cqe = cqes[head & *cq_mask];
+                    if (!(cqe.flags & IORING_CQE_F_MORE))
+                        outstanding--;
+                }
+                std::atomic_ref(*cq_head).store(head, std::memory_order_release);
+            }
+            done += n;
+        }
+        return true;
+    }
+};
+
+void UdpFanout::UringDeleter::operator()(Uring* ring) const noexcept
+{
+    delete ring;
+}
+
+UdpFanout::UdpFanout() = default;
+
+UdpFanout::UdpFanout(std::span<const UdpDestination> destinations, SendBackend backend)
+{
+    open(destinations, backend);
+}
+
+UdpFanout::~UdpFanout() = default;
+UdpFanout::UdpFanout(UdpFanout&&) noexcept = default;
+UdpFanout& UdpFanout::operator=(UdpFanout&&) noexcept = default;
+
+void UdpFanout::open(std::span<const UdpDestination> destinations, SendBackend backend)
+{
+    std::vector<std::unique_ptr<int, SocketDeleter>> sockets;
+    std::vector<SocketKey> keys;
+    std::vector<Target> targets;
+
+    for (const UdpDestination& d : destinations) {
+        Target t;
+        t.addr.sin_family = AF_INET;
+        t.addr.sin_port = htons(static_cast<uint16_t>(d.port));
+        if (inet_pton(AF_INET, d.ip.c_str(), &t.addr.sin_addr) != 1)
+            throw std::runtime_error("Invalid IPv4 address " + d.ip);
+
+        SocketKey key{detect_address_type(t.addr.sin_addr), d.ttl, d.loopback, d.interface};
+        const auto it = std::ranges::find(keys, key);
+        t.socket = static_cast<std::size_t>(it - keys.begin());
+        if (it == keys.end()) {
+            sockets.emplace_back(new int(open_socket(key)));
+            keys.push_back(std::move(key));
+        }
+        targets.push_back(t);
+    }
+
+    // Messages of one socket must be contiguous for sendmmsg()
+    std::ranges::stable_sort(targets, {}, &Target::socket);
+
+    // One socket already sends a whole block per sendmmsg()
+    std::unique_ptr<Uring, UringDeleter> uring;
+    if (backend == SendBackend::IoUring || (backend == SendBackend::Auto && sockets.size() > 1)) {
+        uring = Uring::open();
+        if (!uring && backend == SendBackend::IoUring)
+            throw std::runtime_error(std::string("io_uring unavailable: ") + std::strerror(errno));
+    }
+
+    sockets_ = std::move(sockets);
+    targets_ = std::move(targets);
+    uring_ = std::move(uring);
+}
+
+SendBackend UdpFanout::backend() const noexcept
+{
+    return uring_ ? SendBackend::IoUring : SendBackend::Sendmmsg;
+}
+
+bool UdpFanout::zero_copy() const noexcept
+{
+    return uring_ && uring_->zero_copy;
+}
+
+void UdpFanout::set_packetized(std::size_t max_datagram)
+{
+    validate_max_datagram(max_datagram);
+
+    max_datagram_ = max_datagram;
+    sequence_ = 0;
+    sample_index_ = 0;
+    capture_ns_ = 0;
+}
+
+AudioPacketHeader UdpFanout::next_header(std::size_t samples) noexcept
+{
+    const AudioPacketHeader h{htonl(kAudioPacketMagic), htonl(sequence_++),
+                              htobe64(sample_index_), htobe64(capture_ns_)};
+    sample_index_ += samples;
+    return h;
+}
+
+void UdpFanout::send_raw(const void* data, std::size_t bytes)
+{
+    iov_.assign(1, {const_cast<void*>(data), bytes});
+    transmit(1, 1, bytes);
+}
+
+void UdpFanout::send_packets(const void* data, std::size_t count, std::size_t elem_size)
+{
+    const auto* bytes = static_cast<const std::byte*>(data);
+
+    // Same split as UdpSender: samples never straddle datagrams
+    const std::size_t per_packet =
+        std::max<std::size_t>(1, (max_datagram_ - sizeof(AudioPacketHeader)) / elem_size);
+    const std::size_t packets = (count + per_packet - 1) / per_packet;
+
+    headers_.resize(packets);
+    iov_.resize(2 * packets);
+    for (std::size_t p = 0; p < packets; p++) {
+        const std::size_t first = p * per_packet;
+        const std::size_t n = std::min(per_packet, count - first);
+
+        headers_[p] = next_header(n);
+        iov_[2 * p]     = {&headers_[p], sizeof(AudioPacketHeader)};
+        iov_[2 * p + 1] = {const_cast<std::byte*>(bytes + first * elem_size), n * elem_size};
+    }
+    transmit(packets, 2, per_packet * elem_size);
+}
+
+void UdpFanout::send_frame(const void* data, std::size_t bytes, std::size_t samples)
+{
+    if (!is_open() || !data || bytes == 0)
+        return;
+
+    if (max_datagram_ == 0) {
+        send_raw(data, bytes);
+        return;
+    }
+
+    headers_.assign(1, next_header(samples));
+    iov_.assign({{headers_.data(), sizeof(AudioPacketHeader)}, {const_cast<void*>(data), bytes}});
+    transmit(1, 2, bytes);
+}
+
+void UdpFanout::send_gap(std::size_t samples)
+{
+    if (!is_open() || max_datagram_ == 0 || samples == 0)
+        return;
+
+    headers_.assign(1, next_header(samples));
+    iov_.assign(1, {headers_.data(), sizeof(AudioPacketHeader)});
+    transmit(1, 1, 0);
+}
+
+void UdpFanout::transmit(std::size_t datagrams, std::size_t iov_per, std::size_t payload_bytes)
+{
+    // Destination-major: each target's datagrams in stream order
+    msgs_.resize(datagrams * targets_.size());
+    for (std::size_t t = 0; t < targets_.size(); t++) {
+        for (std::size_t p = 0; p < datagrams; p++) {
+            msghdr& h = msgs_[t * datagrams + p].msg_hdr;
+            h = {};
+            h.msg_name    = &targets_[t].addr;
+            h.msg_namelen = sizeof(sockaddr_in);
+            h.msg_iov     = &iov_[p * iov_per];
+            h.msg_iovlen  = iov_per;
+        }
+    }
+
+    if (uring_) {
+        fds_.resize(msgs_.size());
+        for (std::size_t t = 0; t < targets_.size(); t++)
+            std::fill_n(fds_.begin() + static_cast<std::ptrdiff_t>(t * datagrams), datagrams,
+                        *sockets_[targets_[t].socket]);
+
+        const bool zc = uring_->zero_copy && payload_bytes >= kZeroCopyMinBytes;
+        if (uring_->send(msgs_, fds_, zc, syscalls_))
+            return;
+
+        // A failed ring may hold unsubmitted entries; drop it for good and
+        // lose this block, as a failed sendmmsg() would
+        uring_.reset();
+        return;
+    }
+
+    // One run of sendmmsg() per socket
+    for (std::size_t first = 0; first < targets_.size();) {
+        std::size_t last = first;
+        while (last < targets_.size() && targets_[last].socket == targets_[first].socket)
+            last++;
+
+        const int fd = *sockets_[targets_[first].socket];
+        const std::size_t begin = first * datagrams;
+        const std::size_t end = last * datagrams;
+
+        for (std::size_t sent = begin; sent < end;) {
+            const auto batch = static_cast<unsigned>(std::min(kMaxBatch, end - sent));
+            const int r = ::sendmmsg(fd, &msgs_[sent], batch, 0);
+            syscalls_++;
+
+            if (r < 0 && errno == EINTR)
+                continue;
+
+            // sendmmsg() stops at the first failed message (e.g. an
+            // unreachable host): skip it so the others still get the block
+            sent += r > 0 ? static_cast<std::size_t>(r) : 1;
+        }
+        first = last;
+    }
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "udp_sender.hpp"
+
+/**
+ * @file udp_fanout.hpp
+ * @brief One audio stream to many UDP destinations in batched syscalls.
+ */
+
+/// One receiver of a UdpFanout.
+struct UdpDestination {
+    std::string ip;         ///< IPv4 unicast, multicast or broadcast address
+    int port = 0;
+    int ttl = 0;            ///< Hop limit (0 = 1 for multicast, the system default otherwise)
+    bool loopback = false;  ///< Deliver multicast to listeners on this host too
+    std::string interface;  ///< Outgoing interface name ("" = as routed)
+};
+
+/**
+ * @brief Parse `<ip>:<port>[,ttl=<hops>][,if=<name>][,loop]`.
+ *
+ * For example `239.1.2.3:5000,ttl=8,if=eth1` or `10.0.0.7:5004`.
+ */
+bool parse_udp_destination(std::string_view spec, UdpDestination& out);
+
+/// How UdpFanout hands datagrams to the kernel.
+enum class SendBackend {
+    Auto,     ///< io_uring for several sockets where the kernel allows it, else sendmmsg()
+    Sendmmsg, ///< One sendmmsg() per socket
+    IoUring,  ///< One io_uring_enter() for every socket
+};
+
+/// @return "auto", "sendmmsg" or "io_uring".
+const char* backend_name(SendBackend backend) noexcept;
+
+/**
+ * @class UdpFanout
+ * @brief UdpSender with a list of destinations.
+ *
+ * Every datagram is built once and sent to all destinations: packetized
+ * headers, sequence numbers and sample indices are shared, so each
+ * listener sees exactly the stream a single UdpSender would send it.
+ *
+ * Destinations with the same TTL, loopback and interface share one
+ * unconnected socket, and each message carries its own address. With
+ * sendmmsg() a block then costs one syscall per socket (per 1024
+ * datagrams) instead of one sendto() per destination and datagram. With
+ * io_uring the messages of all sockets go out in one io_uring_enter(). The
+ * call waits for their completions, so the caller's buffer can be reused
+ * as soon as it returns.
+ *
+ * Datagrams of at least kZeroCopyMinBytes use IORING_OP_SENDMSG_ZC when
+ * the kernel supports it. Below that, pinning pages and waiting for the
+ * extra notification costs more than the copy does, so 1472-byte packetized
+ * audio is always copied.
+ */
+class UdpFanout {
+public:
+    /// Payload size from which io_uring sends are zero-copy.
+    static constexpr std::size_t kZeroCopyMinBytes = 10 * 1024;
+
+    UdpFanout();
+
+    /**
+     * @throws std::runtime_error if a socket cannot be opened or configured,
+     *         an address or interface is invalid, or SendBackend::IoUring
+     *         is requested and unavailable
+     */
+    explicit UdpFanout(std::span<const UdpDestination> destinations,
+                       SendBackend backend = SendBackend::Auto);
+
+    ~UdpFanout();
+    UdpFanout(UdpFanout&&) noexcept;
+    UdpFanout& operator=(UdpFanout&&) noexcept;
+
+    /// (Re)open the sockets for @p destinations; throws as the constructor.
+    void open(std::span<const UdpDestination> destinations,
+              SendBackend backend = SendBackend::Auto);
+
+    /// @return true once open() succeeded.
+    [[nodiscard]] bool is_open() const noexcept { return !targets_.empty(); }
+
+    /// @return Number of destinations.
+    [[nodiscard]] std::size_t size() const noexcept { return targets_.size(); }
+
+    /// @return Number of sockets the destinations are grouped into.
+    [[nodiscard]] std::size_t sockets() const noexcept { return sockets_.size(); }
+
+    /// @return Backend in use: SendBackend::Sendmmsg or SendBackend::IoUring.
+    [[nodiscard]] SendBackend backend() const noexcept;
+
+    /// @return true if large datagrams go out zero-copy.
+    [[nodiscard]] bool zero_copy() const noexcept;
+
+    /// @return Send syscalls (sendmmsg or io_uring_enter) made so far.
+    [[nodiscard]] std::uint64_t syscalls() const noexcept { return syscalls_; }
+
+    /// As UdpSender::set_packetized().
+    void set_packetized(std::size_t max_datagram = kDefaultMaxDatagram);
+
+    /// @return Packetized datagram limit, or 0 in raw mode.
+    [[nodiscard]] std::size_t max_datagram() const noexcept { return max_datagram_; }
+
+    /// @return Sequence number of the next packetized datagram.
+    [[nodiscard]] uint32_t sequence() const noexcept { return sequence_; }
+
+    /// As UdpSender::stamp().
+    void stamp(uint64_t sample_index, uint64_t capture_ns) noexcept
+    {
+        sample_index_ = sample_index;
+        capture_ns_ = capture_ns;
+    }
+
+    /// As UdpSender::send(), to every destination.
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void send(std::span<const T> samples)
+    {
+        if (!is_open() || samples.empty())
+            return;
+
+        if (max_datagram_ > 0)
+            send_packets(samples.data(), samples.size(), sizeof(T));
+        else
+            send_raw(samples.data(), samples.size_bytes());
+    }
+
+    /// send() of a whole vector.
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void send(const std::vector<T>& vec)
+    {
+        send(std::span<const T>(vec));
+    }
+
+    /// As UdpSender::send_frame(), to every destination.
+    void send_frame(const void* data, std::size_t bytes, std::size_t samples);
+
+    /// As UdpSender::send_gap(), to every destination.
+    void send_gap(std::size_t samples);
+
+private:
+    /// Messages per sendmmsg() call: the kernel's UIO_MAXIOV
+    static constexpr std::size_t kMaxBatch = 1024;
+
+    struct Uring;
+    struct UringDeleter {
+        void operator()(Uring* ring) const noexcept;
+    };
+
+    /// One destination and the socket that sends to it
+    struct Target {
+        sockaddr_in addr{};
+        std::size_t socket = 0;
+    };
+
+    std::vector<std::unique_ptr<int, SocketDeleter>> sockets_;
+    std::vector<Target> targets_; ///< Grouped by socket
+    std::unique_ptr<Uring, UringDeleter> uring_;
+    std::uint64_t syscalls_ = 0;
+
+    // Packetized mode
+    std::size_t max_datagram_ = 0;
+    uint32_t sequence_ = 0;
+    uint64_t sample_index_ = 0;
+    uint64_t capture_ns_ = 0;
+
+    // Scratch reused between sends: `iov_per` iovecs per datagram, then one
+    // message per datagram and destination
+    std::vector<AudioPacketHeader> headers_;
+    std::vector<iovec> iov_;
+    std::vector<mmsghdr> msgs_;
+    std::vector<int> fds_;        ///< Socket of each message, for io_uring
+
+    void send_raw(const void* data, std::size_t bytes);
+    void send_packets(const void* data, std::size_t count, std::size_t elem_size);
+
+    /// @return Header of the next packetized datagram covering @p samples.
+    AudioPacketHeader next_header(std::size_t samples) noexcept;
+
+    /// Send the @p datagrams described by iov_ to every destination.
+    void transmit(std::size_t datagrams, std::size_t iov_per, std::size_t payload_bytes);
+};
@@ -1,19 +1,16 @@
 #include "udp_sender.hpp"
 
+#include <algorithm>
 #include <arpa/inet.h>
+#include <cerrno>
 #include <cstring>
+#include <endian.h>
 #include <stdexcept>
 #include <sys/socket.h>
 #include <unistd.h>
 
 
-enum class AddressType {
-    Unicast,
-    Multicast,
-    Broadcast
-};
-
-static AddressType detect_address_type(const in_addr& addr)
+AddressType detect_address_type(const in_addr& addr) noexcept
 {
     uint32_t ip = ntohl(addr.s_addr);
 
@@ -97,3 +94,107 @@ void UdpSender::send_bytes_internal(const void* data, std::size_t len) const {
            reinterpret_cast<const sockaddr*>(&addr_),
            sizeof(addr_));
 }
+
+void validate_max_datagram(std::size_t max_datagram) {
+    constexpr std::size_t kMaxUdpPayload = 65507;
+
+    if (max_datagram > 0 &&
+        (max_datagram <= sizeof(AudioPacketHeader) || max_datagram > kMaxUdpPayload)) {
+        throw std::invalid_argument("Datagram size must be between " +
+                                    std::to_string(sizeof(AudioPacketHeader) + 1) +
+                                    " and " + std::to_string(kMaxUdpPayload) + " bytes");
+    }
+}
+
+void UdpSender::set_packetized(std::size_t max_datagram) {
+    validate_max_datagram(max_datagram);
+
+    max_datagram_ = max_datagram;
+    sequence_ = 0;
+    sample_index_ = 0;
+    capture_ns_ = 0;
+}
+
+AudioPacketHeader UdpSender::next_header(std::size_t samples) noexcept {
+    const AudioPacketHeader h{htonl(kAudioPacketMagic), htonl(sequence_++),
+                              htobe64(sample_index_), htobe64(capture_ns_)};
+    sample_index_ += samples;
+    return h;
+}
+
+void UdpSender::send_packets_internal(const void* data, std::size_t count,
+                                      std::size_t elem_size) {
+    const auto* bytes = static_cast<const std::byte*>(data);
+
+    // Samples never straddle datagrams
+    const std::size_t per_packet =
+        std::max<std::size_t>(1, (max_datagram_ - sizeof(AudioPacketHeader)) / elem_size);
+    const std::size_t packets = (count + per_packet - 1) / per_packet;
+
+    headers_.resize(packets);
+    iov_.resize(2 * packets);
+    msgs_.resize(packets);
+
+    for (std::size_t p = 0; p < packets; p++) {
+        const std::size_t first = p * per_packet;
+        const std::size_t n = std::min(per_packet, count - first);
+
+        headers_[p] = next_header(n);
+
+        // Header from scratch, payload straight from the caller's buffer
+        iov_[2 * p]     = {&headers_[p], sizeof(AudioPacketHeader)};
+        iov_[2 * p + 1] = {const_cast<std::byte*>(bytes + first * elem_size), n * elem_size};
+
+        msgs_[p] = {};
+        msgs_[p].msg_hdr.msg_name    = &addr_;
+        msgs_[p].msg_hdr.msg_namelen = sizeof(addr_);
+        msgs_[p].msg_hdr.msg_iov     = &iov_[2 * p];
+        msgs_[p].msg_hdr.msg_iovlen  = 2;
+    }
+
+    for (std::size_t sent = 0; sent < packets;) {
+        const auto batch = static_cast<unsigned>(std::min(kMaxBatch, packets - sent));
+        const int r = ::sendmmsg(*sock_fd_, &msgs_[sent], batch, 0);
+
+        if (r < 0 && errno == EINTR)
+            continue;
+
+        // Like a failed sendto(), the rest of the block is lost; the
+        // sequence numbers already consumed let the receiver notice
+        if (r <= 0)
+            break;
+
+        sent += static_cast<std::size_t>(r);
+    }
+}
+
+void UdpSender::send_gap(std::size_t samples) {
+    if (!is_open() || max_datagram_ == 0 || samples == 0) {
+        return;
+    }
+
+    const AudioPacketHeader header = next_header(samples);
+    send_bytes_internal(&header, sizeof(header));
+}
+
+void UdpSender::send_frame(const void* data, std::size_t bytes, std::size_t samples) {
+    if (!is_open() || !data || bytes == 0) {
+        return;
+    }
+
+    if (max_datagram_ == 0) {
+        send_bytes_internal(data, bytes);
+        return;
+    }
+
+    AudioPacketHeader header = next_header(samples);
+    iovec iov[2] = {{&header, sizeof(header)}, {const_cast<void*>(data), bytes}};
+
+    msghdr msg{};
+    msg.msg_name    = &addr_;
+    msg.msg_namelen = sizeof(addr_);
+    msg.msg_iov     = iov;
+    msg.msg_iovlen  = 2;
+
+    ::sendmsg(*sock_fd_, &msg, 0);
+}
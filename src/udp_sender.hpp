@@ -1,7 +1,11 @@
 #pragma once
 
 #include <netinet/in.h>
+#include <sys/socket.h>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <span>
 #include <vector>
 #include <memory>
 #include <type_traits>
@@ -14,6 +18,45 @@
  * It never exposes raw file descriptors and never requires a custom destructor.
  */
 
+/// Magic number opening every packetized datagram ("FMA2", the 24-byte header).
+inline constexpr uint32_t kAudioPacketMagic = 0x464D4132;
+
+/// Largest UDP payload that fits a 1500-byte Ethernet MTU without IP fragmentation.
+inline constexpr std::size_t kDefaultMaxDatagram = 1472;
+
+/**
+ * @brief Header of a packetized datagram; all fields in network byte order.
+ *
+ * The payload after the header holds whole samples in host byte order
+ * (F32LE on every supported target), so a receiver derives the sample count
+ * from the datagram length. `sequence` exposes loss and reordering,
+ * `sample_index` places the payload in the stream even across gaps, and
+ * `capture_ns` aligns streams captured on the same host.
+ */
+struct AudioPacketHeader {
+    uint32_t magic;        ///< kAudioPacketMagic
+    uint32_t sequence;     ///< Datagram counter, wraps at 2^32
+    uint64_t sample_index; ///< Stream position of the first payload sample
+    uint64_t capture_ns;   ///< CLOCK_MONOTONIC refill time of its IQ block (0 = unknown)
+};
+
+static_assert(sizeof(AudioPacketHeader) == 24, "AudioPacketHeader must stay packed");
+
+/// Kind of IPv4 destination, which decides the socket options it needs.
+enum class AddressType {
+    Unicast,
+    Multicast,
+    Broadcast
+};
+
+/// @return Multicast for 224.0.0.0/4, Broadcast for x.x.x.255 and
+///         255.255.255.255, else Unicast.
+AddressType detect_address_type(const in_addr& addr) noexcept;
+
+/// @throws std::invalid_argument unless @p max_datagram is 0 (raw mode) or
+///         leaves room for a header and a sample within a UDP payload.
+void validate_max_datagram(std::size_t max_datagram);
+
 /// Custom deleter for UDP socket wrapped in unique_ptr.
 /// Automatically closes socket on destruction.
 struct SocketDeleter {
@@ -49,27 +92,112 @@ public:
     [[nodiscard]] bool is_open() const noexcept;
 
     /**
-     * @brief Send a vector of values over UDP.
+     * @brief Split every send() into datagrams of at most @p max_datagram
+     *        bytes, each led by an AudioPacketHeader.
+     *
+     * The datagrams of one send() leave in batches through sendmmsg(), so a
+     * 50 ms audio block costs one syscall instead of one fragmented
+     * datagram. Sequence numbers and sample indices restart from zero.
+     *
+     * @param max_datagram UDP payload limit including the header
+     *                     (0 restores one raw datagram per send())
+     *
+     * @throws std::invalid_argument if the limit leaves no room for samples
+     */
+    void set_packetized(std::size_t max_datagram = kDefaultMaxDatagram);
+
+    /// @return Packetized datagram limit, or 0 in raw mode.
+    [[nodiscard]] std::size_t max_datagram() const noexcept { return max_datagram_; }
+
+    /// @return Sequence number of the next packetized datagram.
+    [[nodiscard]] uint32_t sequence() const noexcept { return sequence_; }
+
+    /**
+     * @brief Position the packetized stream at a block's metadata.
+     *
+     * The next datagram carries @p sample_index, later ones count on from
+     * it, and all carry @p capture_ns until the next stamp. Without stamps
+     * the index counts from 0 and `capture_ns` stays 0.
+     */
+    void stamp(uint64_t sample_index, uint64_t capture_ns) noexcept
+    {
+        sample_index_ = sample_index;
+        capture_ns_ = capture_ns;
+    }
+
+    /**
+     * @brief Send a block of values over UDP.
+     *
+     * In raw mode the whole block is one datagram; in packetized mode it is
+     * split on sample boundaries (see set_packetized()).
      *
-     * @tparam T  Element type
-     * @param vec Vector containing data to transmit
+     * @tparam T       Element type
+     * @param samples  Values to transmit
      */
     template <typename T>
         requires std::is_trivially_copyable_v<T>
-    void send(const std::vector<T>& vec) const
+    void send(std::span<const T> samples)
     {
-        if (!is_open() || vec.empty())
+        if (!is_open() || samples.empty())
             return;
 
-        const void* data = static_cast<const void*>(vec.data());
-        const std::size_t bytes = vec.size() * sizeof(T);
+        const void* data = static_cast<const void*>(samples.data());
+        const std::size_t bytes = samples.size_bytes();
 
-        send_bytes_internal(data, bytes);
+        if (max_datagram_ > 0)
+            send_packets_internal(data, samples.size(), sizeof(T));
+        else
+            send_bytes_internal(data, bytes);
     }
 
+    /// send() of a whole vector.
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void send(const std::vector<T>& vec)
+    {
+        send(std::span<const T>(vec));
+    }
+
+    /**
+     * @brief Send one indivisible frame (e.g. an encoded audio packet) as a
+     *        single datagram.
+     *
+     * In packetized mode the datagram gets an AudioPacketHeader and
+     * `sample_index` advances by @p samples, the audio the frame decodes
+     * to. The frame is never split, even if it exceeds max_datagram().
+     */
+    void send_frame(const void* data, std::size_t bytes, std::size_t samples);
+
+    /**
+     * @brief Mark @p samples of silence (e.g. a squelched block).
+     *
+     * In packetized mode this sends a header-only datagram, so receivers
+     * see the stream is alive and that silence runs from its
+     * `sample_index` to the next datagram's. Raw mode sends nothing.
+     */
+    void send_gap(std::size_t samples);
+
 private:
+    /// Datagrams handed to one sendmmsg() call
+    static constexpr std::size_t kMaxBatch = 64;
+
     std::unique_ptr<int, SocketDeleter> sock_fd_{};
     sockaddr_in addr_{};
 
+    // Packetized mode
+    std::size_t max_datagram_ = 0;
+    uint32_t sequence_ = 0;
+    uint64_t sample_index_ = 0;
+    uint64_t capture_ns_ = 0;
+
+    // sendmmsg() scratch, reused between sends
+    std::vector<AudioPacketHeader> headers_;
+    std::vector<iovec> iov_;
+    std::vector<mmsghdr> msgs_;
+
     void send_bytes_internal(const void* data, std::size_t len) const;
+    void send_packets_internal(const void* data, std::size_t count, std::size_t elem_size);
+
+    /// @return Header of the next packetized datagram covering @p samples.
+    AudioPacketHeader next_header(std::size_t samples) noexcept;
 };
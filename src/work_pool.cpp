@@ -0,0 +1,112 @@
+#include "work_pool.hpp"
+#include "thread_util.hpp"
+#include <algorithm>
+#include <string>
+
+namespace {
+
+// Pool and deque of the calling thread, if it is a worker
+thread_local const WorkPool* tl_pool = nullptr;
+thread_local std::size_t tl_index = 0;
+
+} // namespace
+
+WorkPool::WorkPool(unsigned threads, bool flush_denormals)
+    : flush_denormals_{flush_denormals}
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    workers_.reserve(threads);
+    for (unsigned i = 0; i < threads; i++)
+        workers_.push_back(std::make_unique<Worker>());
+
+    threads_.reserve(threads);
+    for (std::size_t i = 0; i < threads; i++)
+        threads_.emplace_back([this, i] { work(i); });
+}
+
+WorkPool::~WorkPool()
+{
+    wait_idle();
+    stop_.store(true, std::memory_order_release);
+    signal(true);
+}
+
+void WorkPool::submit(Task task)
+{
+    const std::size_t index = tl_pool == this
+        ? tl_index
+        : next_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard lock(workers_[index]->mutex);
+        workers_[index]->tasks.push_back(std::move(task));
+    }
+    signal(false);
+}
+
+void WorkPool::wait_idle() const noexcept
+{
+    for (std::size_t n; (n = pending_.load(std::memory_order_acquire)) != 0;)
+        pending_.wait(n, std::memory_order_acquire);
+}
+
+WorkPool::Task WorkPool::take(std::size_t index)
+{
+    {
+        Worker& own = *workers_[index];
+        std::lock_guard lock(own.mutex);
+        if (!own.tasks.empty()) {
+            Task task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return task;
+        }
+    }
+
+    for (std::size_t k = 1; k < workers_.size(); k++) {
+        Worker& victim = *workers_[(index + k) % workers_.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            Task task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+    return {};
+}
+
+void WorkPool::work(std::size_t index)
+{
+    set_current_thread_name(("fm-pool-" + std::to_string(index)).c_str());
+    if (flush_denormals_)
+        enable_flush_to_zero();
+    tl_pool = this;
+    tl_index = index;
+
+    while (true) {
+        // Read the counter first: a submit after the failed take() changes it
+        const std::uint32_t seen = events_.load(std::memory_order_acquire);
+
+        if (Task task = take(index)) {
+            task();
+            if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                pending_.notify_all();
+            continue;
+        }
+        if (stop_.load(std::memory_order_acquire))
+            break;
+        events_.wait(seen, std::memory_order_acquire);
+    }
+}
+
+void WorkPool::signal(bool all) noexcept
+{
+    events_.fetch_add(1, std::memory_order_release);
+    if (all)
+        events_.notify_all();
+    else
+        events_.notify_one();
+}
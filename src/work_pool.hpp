@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @file work_pool.hpp
+ * @brief Work-stealing thread pool shared by the DSP of several receivers.
+ */
+
+/**
+ * @class WorkPool
+ * @brief Fixed set of worker threads, each with its own task deque.
+ *
+ * A task submitted from a worker goes onto that worker's deque and is taken
+ * back LIFO, while its data is still in cache; tasks from other threads are
+ * dealt round-robin. An idle worker steals the oldest task of another
+ * worker before it goes to sleep, so one busy producer never leaves the
+ * other cores idle.
+ *
+ * Each deque has its own mutex: tasks here are whole capture blocks of DSP,
+ * milliseconds apiece, so a lock per task is noise and keeps stealing
+ * simple. Sleeping workers wait on an event counter, like SpscRing.
+ */
+class WorkPool {
+public:
+    /// Unit of work; must not throw.
+    using Task = std::function<void()>;
+
+    /**
+     * @param threads          Worker count (0 = one per hardware thread)
+     * @param flush_denormals  Workers flush denormal floats to zero (see
+     *                         enable_flush_to_zero())
+     */
+    explicit WorkPool(unsigned threads = 0, bool flush_denormals = false);
+
+    /// Runs every task still queued, then joins the workers.
+    ~WorkPool();
+
+    WorkPool(const WorkPool&) = delete;
+    WorkPool& operator=(const WorkPool&) = delete;
+
+    /// Queue @p task; safe from any thread, including a running task.
+    void submit(Task task);
+
+    /// Block until every submitted task, and any task it submitted, has run.
+    void wait_idle() const noexcept;
+
+    /// @return Number of worker threads.
+    [[nodiscard]] unsigned threads() const noexcept { return static_cast<unsigned>(workers_.size()); }
+
+    /// @return Tasks a worker took from another worker's deque so far.
+    [[nodiscard]] std::uint64_t steals() const noexcept { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<std::size_t> next_{0};
+    std::atomic<std::size_t> pending_{0};   ///< Submitted and not yet finished
+    std::atomic<std::uint64_t> steals_{0};
+    std::atomic<std::uint32_t> events_{0};
+    std::atomic<bool> stop_{false};
+    bool flush_denormals_;
+    std::vector<std::jthread> threads_;
+
+    /// Worker loop of thread @p index.
+    void work(std::size_t index);
+
+    /// @return Next task for worker @p index: its own newest, else the oldest of another.
+    Task take(std::size_t index);
+
+    void signal(bool all) noexcept;
+};
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+#include "receiver.hpp"
+#include "test_signals.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Global allocator hook: counts every heap allocation made by any thread
+// while g_counting is set. Replacing operator new applies to the whole test
+// binary; outside the counted windows it is a plain malloc.
+
+namespace {
+
+std::atomic<bool> g_counting{false};
+std::atomic<std::size_t> g_allocations{0};
+
+void* counted_alloc(std::size_t bytes, std::size_t align)
+{
+    if (g_counting.load(std::memory_order_relaxed))
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    bytes = std::max<std::size_t>(bytes, 1);
+    void* p = align <= alignof(std::max_align_t)
+        ? std::malloc(bytes)
+        : std::aligned_alloc(align, (bytes + align - 1) / align * align);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+} // namespace
+
+void* operator new(std::size_t bytes) { return counted_alloc(bytes, 0); }
+void* operator new(std::size_t bytes, std::align_val_t a) { return counted_alloc(bytes, static_cast<std::size_t>(a)); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace {
+
+constexpr std::size_t kBlockPairs = 24'000;  // 10 ms
+constexpr int kWarmupBlocks = 8;              // more than the ring depths below
+constexpr int kBlocks = 40;
+
+/// Replays tone (and, with gaps, near-silent) blocks and opens the counting
+/// window after the warm-up blocks; closes it at end of stream.
+class CountingSource final : public SampleSource {
+public:
+    explicit CountingSource(bool gaps)
+        : tone_{fm_tone(kBlockPairs)}
+        , quiet_(2 * kBlockPairs, 1)
+        , gaps_{gaps}
+    {
+    }
+
+    std::span<const int16_t> next_block() override
+    {
+        if (served_ == kBlocks) {
+            g_counting = false;
+            return {};
+        }
+        if (served_++ == kWarmupBlocks)
+            g_counting = true;
+
+        // Odd and even block sizes exercise the carried decimation windows
+        const std::span<const int16_t> block = gaps_ && (served_ / 3) % 2 ? quiet_ : tone_;
+        return block.first(served_ % 2 ? block.size() : block.size() - 6);
+    }
+
+    [[nodiscard]] std::size_t block_size() const noexcept override { return kBlockPairs; }
+    [[nodiscard]] long long sample_rate() const noexcept override { return kDefaultRatePlan.input_rate_hz; }
+    [[nodiscard]] bool live() const noexcept override { return false; }
+
+private:
+    std::vector<int16_t> tone_;
+    std::vector<int16_t> quiet_;
+    bool gaps_;
+    int served_ = 0;
+};
+
+struct Case {
+    const char* name;
+    DspOptions dsp;
+    OutputOptions output;
+    bool threaded = false;
+};
+
+std::vector<Case> cases()
+{
+    std::vector<Case> v;
+    const auto add = [&](const char* name, auto&& tweak) {
+        Case c{name, {}, {}};
+        tweak(c);
+        v.push_back(c);
+    };
+
+    add("boxcar_f32", [](Case&) {});
+    add("fast_s16", [](Case& c) {
+        c.dsp.discriminator = dsp::FmDiscriminator::Fast;
+        c.output.format = AudioFormat::S16;
+    });
+    add("fused_s16", [](Case& c) {
+        c.dsp.fused = true;
+        c.output.format = AudioFormat::S16;
+    });
+    add("fir_f32", [](Case& c) { c.dsp.decimator = DecimatorType::Fir; });
+    add("fir_s16", [](Case& c) {
+        c.dsp.decimator = DecimatorType::Fir;
+        c.output.format = AudioFormat::S16;
+    });
+    add("am_f32", [](Case& c) { c.dsp.mode = dsp::DemodulationMode::AM; });
+    add("deemphasis_fused_s16", [](Case& c) {
+        c.dsp.deemphasis_us = 50.0f;
+        c.dsp.fused = true;
+        c.output.format = AudioFormat::S16;
+    });
+    add("stereo_fir_s16", [](Case& c) {
+        c.dsp.stereo = true;
+        c.dsp.deemphasis_us = 50.0f;
+        c.dsp.decimator = DecimatorType::Fir;
+        c.output.format = AudioFormat::S16;
+        c.output.channels = 2;
+    });
+    add("squelch_fused", [](Case& c) {
+        c.dsp.squelch_dbfs = -50.0f;
+        c.dsp.fused = true;
+    });
+    add("squelch_fir_s16", [](Case& c) {
+        c.dsp.squelch_dbfs = -50.0f;
+        c.dsp.decimator = DecimatorType::Fir;
+        c.output.format = AudioFormat::S16;
+    });
+    add("threaded_boxcar", [](Case& c) { c.threaded = true; });
+    add("threaded_fir_s16", [](Case& c) {
+        c.threaded = true;
+        c.dsp.decimator = DecimatorType::Fir;
+        c.output.format = AudioFormat::S16;
+    });
+    return v;
+}
+
+class SteadyStateAllocationTest : public ::testing::TestWithParam<Case> {};
+
+} // namespace
+
+TEST(AllocationTest, HookSeesAllocations)
+{
+    g_allocations = 0;
+    g_counting = true;
+    auto v = std::make_unique<std::vector<int>>(100);
+    g_counting = false;
+
+    EXPECT_EQ(g_allocations.load(), 2u);   // the vector object and its storage
+}
+
+TEST_P(SteadyStateAllocationTest, ReceiveLoopDoesNotAllocate)
+{
+    const Case& c = GetParam();
+    CountingSource source(c.dsp.squelch_dbfs.has_value());
+
+    OutputOptions output = c.output;
+    output.max_datagram = 1472;   // packetized loopback UDP
+    Receiver receiver(source, "127.0.0.1", 9, c.dsp, 0.3f, output);
+
+    g_allocations = 0;
+    if (c.threaded) {
+        PipelineOptions opts;
+        opts.capture_ring_depth = 2;
+        opts.audio_ring_depth = 2;
+        receiver.run_pipelined(opts);
+    } else {
+        receiver.run();
+    }
+
+    EXPECT_FALSE(g_counting.load());
+    EXPECT_EQ(g_allocations.load(), 0u);
+}
+
+INSTANTIATE_TEST_SUITE_P(Chains, SteadyStateAllocationTest, ::testing::ValuesIn(cases()),
+                         [](const auto& info) { return std::string(info.param.name); });
+
+TEST(AllocationTest, SpanPipelineDoesNotAllocate)
+{
+    const auto raw = fm_tone(kBlockPairs);
+    FmPipeline pipeline({}, 0.3f, kBlockPairs);
+    std::vector<float> audio(pipeline.max_audio_samples(kBlockPairs));
+
+    g_allocations = 0;
+    g_counting = true;
+    std::size_t produced = 0;
+    for (int i = 0; i < 10; i++)
+        produced += pipeline.process_block(raw, std::span(audio));
+    g_counting = false;
+
+    EXPECT_EQ(g_allocations.load(), 0u);
+    EXPECT_NEAR(static_cast<double>(produced), 10.0 * kBlockPairs / 50.0, 2.0);
+    EXPECT_THROW(pipeline.process_block(raw, std::span(audio).first(10)), std::invalid_argument);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "audio_output.hpp"
+#include "datagram_receiver.hpp"
+#include "dsp.hpp"
+#include <cstring>
+#include <endian.h>
+#include <unistd.h>
+
+namespace {
+
+std::vector<float> ramp_audio(size_t n)
+{
+    std::vector<float> v(n);
+    for (size_t i = 0; i < n; i++) v[i] = static_cast<float>(i) / static_cast<float>(n) - 0.5f;
+    return v;
+}
+
+} // namespace
+
+TEST(AudioOutputTest, S16HalvesTheBytes) {
+    DatagramReceiver rx;
+    const auto audio = ramp_audio(2400);
+
+    AudioOutput f32("127.0.0.1", rx.port(), {AudioFormat::F32});
+    f32.write(audio);
+
+    AudioOutput s16("127.0.0.1", rx.port(), {AudioFormat::S16});
+    EXPECT_TRUE(s16.wants_pcm());
+    s16.write(audio);
+
+    const auto got = rx.drain();
+    ASSERT_EQ(got.size(), 2u);
+    EXPECT_EQ(got[0].size(), audio.size() * sizeof(float));
+    ASSERT_EQ(got[1].size(), audio.size() * sizeof(int16_t));
+
+    std::vector<int16_t> want;
+    dsp::float_to_s16(audio, want);
+    EXPECT_EQ(std::memcmp(got[1].data(), want.data(), got[1].size()), 0);
+}
+
+TEST(AudioOutputTest, PcmBlocksPassThroughAndKeepPacketFraming) {
+    DatagramReceiver rx;
+    AudioOutput out("127.0.0.1", rx.port(), {AudioFormat::S16, kDefaultMaxDatagram});
+
+    std::vector<int16_t> pcm(2400);
+    for (size_t i = 0; i < pcm.size(); i++) pcm[i] = static_cast<int16_t>(i);
+    out.write(pcm);
+
+    // (1472 - 24) / 2 = 724 samples per datagram
+    const auto got = rx.drain();
+    ASSERT_EQ(got.size(), 4u);
+    EXPECT_EQ(got[0].size(), sizeof(AudioPacketHeader) + 724 * sizeof(int16_t));
+
+    int16_t first{};
+    std::memcpy(&first, got[1].data() + sizeof(AudioPacketHeader), sizeof(first));
+    EXPECT_EQ(first, 724);
+}
+
+TEST(AudioOutputTest, StampCountsInterleavedSamples) {
+    DatagramReceiver rx;
+    OutputOptions opts{AudioFormat::F32, kDefaultMaxDatagram};
+    opts.channels = 2;
+    AudioOutput out("127.0.0.1", rx.port(), opts);
+
+    const auto captured = BlockMeta::Clock::time_point(std::chrono::nanoseconds(5'000'000'000));
+    out.stamp({4'800, captured});
+    out.write(ramp_audio(200));
+
+    const auto got = rx.drain();
+    ASSERT_EQ(got.size(), 1u);
+    AudioPacketHeader h{};
+    std::memcpy(&h, got[0].data(), sizeof(h));
+    EXPECT_EQ(be64toh(h.sample_index), 9'600u);   // frame 4800 of a stereo stream
+    EXPECT_EQ(be64toh(h.capture_ns), 5'000'000'000u);
+}
+
+TEST(AudioOutputTest, OpusRequiresSupport) {
+    if (opus_supported()) {
+        DatagramReceiver rx;
+        AudioOutput out("127.0.0.1", rx.port(), {AudioFormat::Opus});
+
+        // 25 ms of audio: two 10 ms frames, the rest waits for the next block
+        out.write(ramp_audio(1200));
+        const auto got = rx.drain();
+        ASSERT_EQ(got.size(), 2u);
+        EXPECT_LT(got[0].size(), 1200 * sizeof(int16_t) / 2);
+    } else {
+        EXPECT_THROW(AudioOutput({AudioFormat::Opus}), std::runtime_error);
+    }
+}
+
+TEST(AudioOutputTest, OpusSilenceClosesTheOpenFrame) {
+    if (!opus_supported())
+        GTEST_SKIP() << "built without Opus";
+
+    DatagramReceiver rx;
+    AudioOutput out("127.0.0.1", rx.port(), {AudioFormat::Opus, kDefaultMaxDatagram});
+
+    // 1.5 frames, then squelched: the open half frame is padded with the
+    // first muted samples and the gap starts after it
+    out.stamp({0, {}});
+    out.write(ramp_audio(720));
+    out.stamp({720, {}});
+    out.write_silence(1000);
+    out.stamp({1720, {}});
+    out.write(ramp_audio(480));
+
+    const auto got = rx.drain();
+    ASSERT_EQ(got.size(), 4u);
+    std::uint64_t index[4];
+    for (size_t d = 0; d < got.size(); d++) {
+        AudioPacketHeader h{};
+        std::memcpy(&h, got[d].data(), sizeof(h));
+        index[d] = be64toh(h.sample_index);
+    }
+    EXPECT_EQ(index[0], 0u);
+    EXPECT_EQ(index[1], 480u);
+    EXPECT_EQ(index[2], 960u);
+    EXPECT_EQ(got[2].size(), sizeof(AudioPacketHeader));
+    EXPECT_EQ(index[3], 1720u);
+}
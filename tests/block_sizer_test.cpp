@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "block_sizer.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr long long kRate = 2'400'000;
+constexpr std::size_t kGranule = 50;
+
+/// Feeds a sizer blocks of its current size that arrive @p interval apart and take @p work each.
+struct Driver {
+    BlockSizer sizer;
+    BlockSizer::Clock::time_point now{};
+
+    explicit Driver(const LowLatencyOptions& opts = {}) : sizer(opts, kRate, kGranule) {}
+
+    std::size_t feed(std::chrono::nanoseconds work, std::chrono::nanoseconds jitter = 0ns)
+    {
+        const std::size_t pairs = sizer.block_size();
+        now += sizer.period(pairs) + jitter;
+        return sizer.on_block(pairs, now, now + work);
+    }
+
+    /// Run blocks for @p seconds of stream time.
+    std::size_t run(std::chrono::milliseconds span, double load, std::chrono::nanoseconds jitter = 0ns)
+    {
+        const auto end = now + span;
+        while (now < end) {
+            const auto work = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                sizer.period(sizer.block_size()) * load);
+            feed(work, jitter);
+        }
+        return sizer.block_size();
+    }
+};
+
+} // namespace
+
+TEST(BlockSizerTest, BoundsAreWholeGranules)
+{
+    Driver d;
+    EXPECT_EQ(d.sizer.min_block(), 9'600u);     // 4 ms
+    EXPECT_EQ(d.sizer.max_block(), 120'000u);   // 50 ms
+    EXPECT_EQ(d.sizer.block_size(), d.sizer.min_block());
+    EXPECT_EQ(d.sizer.min_block() % kGranule, 0u);
+
+    LowLatencyOptions bad;
+    bad.min_block = 60ms;
+    EXPECT_THROW(BlockSizer(bad, kRate, kGranule), std::invalid_argument);
+    EXPECT_THROW(BlockSizer({}, kRate, 0), std::invalid_argument);
+
+    bad = {};
+    bad.shrink_margin = 1.5;
+    EXPECT_THROW(BlockSizer(bad, kRate, kGranule), std::invalid_argument);
+}
+
+TEST(BlockSizerTest, StaysSmallWhileLightlyLoaded)
+{
+    Driver d;
+    EXPECT_EQ(d.run(5s, 0.1), d.sizer.min_block());
+    EXPECT_EQ(d.sizer.changes(), 0u);
+}
+
+TEST(BlockSizerTest, GrowsUnderLoadUntilItFits)
+{
+    // A fixed per-block cost of 3 ms: a 4 ms block is 75 % busy, an 8 ms block 37.5 %
+    Driver d;
+    std::size_t size = 0;
+    for (auto end = d.now + 5s; d.now < end;)
+        size = d.feed(3ms);
+    EXPECT_EQ(size, 19'200u);
+    EXPECT_EQ(d.sizer.changes(), 1u);
+}
+
+TEST(BlockSizerTest, GrowsAtOnceWhenFallingBehind)
+{
+    Driver d;
+    EXPECT_EQ(d.feed(5ms), 2 * d.sizer.min_block());
+}
+
+TEST(BlockSizerTest, GrowsOnRefillJitter)
+{
+    Driver d;
+    // Refills 3 ms late on a 4 ms period
+    EXPECT_GT(d.run(1s, 0.05, 3ms), d.sizer.min_block());
+}
+
+TEST(BlockSizerTest, ShrinksBackWhenLoadDrops)
+{
+    Driver d;
+    d.run(10s, 0.9);
+    EXPECT_EQ(d.sizer.block_size(), d.sizer.max_block());
+
+    d.run(10s, 0.05);
+    EXPECT_EQ(d.sizer.block_size(), d.sizer.min_block());
+}
+
+TEST(BlockSizerTest, ShrinkMarginHoldsANearTargetLoad)
+{
+    // Twice 0.2 is under the 0.5 target, but not under 3/4 of it
+    Driver d;
+    d.run(10s, 0.9);
+    d.run(10s, 0.2);
+    EXPECT_EQ(d.sizer.block_size(), d.sizer.max_block());
+
+    LowLatencyOptions opts;
+    opts.shrink_margin = 1.0;
+    Driver loose(opts);
+    loose.run(10s, 0.9);
+    loose.run(10s, 0.2);
+    EXPECT_EQ(loose.sizer.block_size(), loose.sizer.min_block());
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include "channel_bank.hpp"
+#include "datagram_receiver.hpp"
+#include "test_signals.hpp"
+#include <endian.h>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+namespace {
+
+constexpr double kRate = kDefaultRatePlan.input_rate_hz;
+
+/// Two FM stations: 1 kHz tone at +400 kHz, 3 kHz tone at -400 kHz.
+std::vector<int16_t> make_two_stations(std::size_t pairs, std::size_t start)
+{
+    std::vector<int16_t> raw(2 * pairs);
+    const double w = 2.0 * std::numbers::pi;
+    const double dev = 50e3;
+
+    for (std::size_t i = 0; i < pairs; i++) {
+        const double t = static_cast<double>(start + i) / kRate;
+        // Phase of an FM carrier: 2 pi fc t + (dev / fm) sin(2 pi fm t)
+        const double a = w * 400e3 * t + dev / 1e3 * std::sin(w * 1e3 * t);
+        const double b = -w * 400e3 * t + dev / 3e3 * std::sin(w * 3e3 * t);
+        const auto v = std::polar(4000.0, a) + std::polar(4000.0, b);
+        raw[2 * i]     = static_cast<int16_t>(std::lround(v.real()));
+        raw[2 * i + 1] = static_cast<int16_t>(std::lround(v.imag()));
+    }
+    return raw;
+}
+
+/// Power of @p audio at @p hz (48 kHz audio rate).
+double tone_power(const std::vector<float>& audio, double hz)
+{
+    std::complex<double> acc{};
+    for (std::size_t n = 0; n < audio.size(); n++)
+        acc += std::polar(static_cast<double>(audio[n]),
+                          -2.0 * std::numbers::pi * hz * n / 48e3);
+    return std::norm(acc) / static_cast<double>(audio.size());
+}
+
+/// sample_index of a packetized datagram.
+std::uint64_t sample_index(const std::vector<char>& datagram)
+{
+    AudioPacketHeader h{};
+    std::memcpy(&h, datagram.data(), sizeof(h));
+    return be64toh(h.sample_index);
+}
+
+} // namespace
+
+TEST(ChannelBankTest, RejectsOffsetOutsideCapture) {
+    EXPECT_THROW(ChannelBank({{1'300'000, 5000}}, "127.0.0.1"), std::invalid_argument);
+    EXPECT_THROW(ChannelBank({}, "127.0.0.1"), std::invalid_argument);
+}
+
+TEST(ChannelBankTest, RejectsOtherRatePlans) {
+    DspOptions dsp;
+    dsp.rates = {1'920'000, 8, 5};
+    EXPECT_THROW(ChannelBank({{0, 5000}}, "127.0.0.1", dsp), std::invalid_argument);
+}
+
+TEST(ChannelBankTest, RejectsFixedPoint) {
+    DspOptions dsp;
+    dsp.arithmetic = Arithmetic::Fixed;
+    EXPECT_THROW(ChannelBank({{0, 5000}}, "127.0.0.1", dsp), std::invalid_argument);
+}
+
+TEST(ChannelBankTest, SeparatesStationsIntoTheirPorts) {
+    DatagramReceiver rx_a(std::chrono::seconds(1)), rx_b(std::chrono::seconds(1));
+
+    for (unsigned threads : {1u, 2u}) {
+        DspOptions dsp;
+        dsp.discriminator = dsp::FmDiscriminator::Fast;
+        ChannelBank bank({{400'000, rx_a.port()}, {-400'000, rx_b.port()}},
+                         "127.0.0.1", dsp, 1.0f, threads);
+        ASSERT_EQ(bank.threads(), threads);
+
+        const std::size_t block = 24'000;
+        const int blocks = 10;
+        for (int b = 0; b < blocks; b++)
+            bank.process(make_two_stations(block, b * block));
+
+        auto a = rx_a.receive_floats(blocks);
+        auto b = rx_b.receive_floats(blocks);
+        ASSERT_GT(a.size(), 4000u);
+        ASSERT_GT(b.size(), 4000u);
+
+        // Skip the filter start-up transient
+        a.erase(a.begin(), a.begin() + 200);
+        b.erase(b.begin(), b.begin() + 200);
+
+        EXPECT_GT(tone_power(a, 1e3), 100.0 * tone_power(a, 3e3)) << "threads " << threads;
+        EXPECT_GT(tone_power(b, 3e3), 100.0 * tone_power(b, 1e3)) << "threads " << threads;
+    }
+}
+
+TEST(ChannelBankTest, SquelchCyclesKeepTheStreamIndex) {
+    const std::size_t pairs = 12'345;   // leaves every decimation window partly open
+    const auto tone = fm_tone(pairs);
+    const std::vector<int16_t> quiet(2 * pairs, 2);
+
+    for (DecimatorType decimator : {DecimatorType::Boxcar, DecimatorType::Fir}) {
+        DatagramReceiver rx_ungated, rx_gated;
+        OutputOptions output;
+        output.max_datagram = kDefaultMaxDatagram;   // one datagram or gap per block
+
+        DspOptions dsp;
+        dsp.decimator = decimator;
+        ChannelBank ungated({{0, rx_ungated.port()}}, "127.0.0.1", dsp, 1.0f, 1, output);
+        dsp.squelch_dbfs = -40.0f;   // above the filter tail reaching into the quiet blocks
+        ChannelBank gated({{0, rx_gated.port()}}, "127.0.0.1", dsp, 1.0f, 1, output);
+
+        std::uint64_t index = 0;
+        for (int b = 0; b < 30; b++) {
+            const auto& block = b % 3 == 2 ? quiet : tone;
+            ungated.process(block, {index, {}});
+            gated.process(block, {index, {}});
+            index += pairs;
+
+            const auto want = rx_ungated.receive(1);
+            const auto got = rx_gated.receive(1);
+            ASSERT_EQ(want.size(), 1u);
+            ASSERT_EQ(got.size(), 1u);
+            ASSERT_EQ(sample_index(got[0]), sample_index(want[0]))
+                << "fir " << (decimator == DecimatorType::Fir) << " block " << b;
+        }
+    }
+}
+
+TEST(ChannelBankTest, DeemphasisCutsTheTreble) {
+    // 10 kHz tone at 20 kHz deviation on the centre frequency
+    const std::size_t pairs = 240'000;
+    std::vector<int16_t> raw(2 * pairs);
+    for (std::size_t i = 0; i < pairs; i++) {
+        const double t = static_cast<double>(i) / kRate;
+        const double phase = 2.0 * std::sin(2.0 * std::numbers::pi * 10e3 * t);
+        raw[2 * i]     = static_cast<int16_t>(std::lround(4000.0 * std::cos(phase)));
+        raw[2 * i + 1] = static_cast<int16_t>(std::lround(4000.0 * std::sin(phase)));
+    }
+
+    double power[2];
+    for (int emph = 0; emph < 2; emph++) {
+        DatagramReceiver rx;
+        DspOptions dsp;
+        dsp.deemphasis_us = emph ? 50.0f : 0.0f;
+        ChannelBank bank({{0, rx.port()}}, "127.0.0.1", dsp, 1.0f, 1);
+        bank.process(raw);
+
+        auto audio = rx.receive_floats(1);
+        ASSERT_GT(audio.size(), 4000u);
+        audio.erase(audio.begin(), audio.begin() + 200);
+        power[emph] = tone_power(audio, 10e3);
+    }
+
+    const double db = 10.0 * std::log10(power[1] / power[0]);
+    EXPECT_NEAR(db, -9.7, 1.0);
+}
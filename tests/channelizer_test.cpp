@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "channelizer.hpp"
+#include <cmath>
+#include <numbers>
+
+using namespace dsp;
+
+namespace {
+
+std::vector<std::complex<float>> tone(size_t n, double cycles_per_sample) {
+    std::vector<std::complex<float>> v(n);
+    for (size_t i = 0; i < n; i++)
+        v[i] = std::polar(1.0f, static_cast<float>(2.0 * std::numbers::pi *
+                                                   std::fmod(cycles_per_sample * i, 1.0)));
+    return v;
+}
+
+/// RMS of channel @p k over frames, skipping the filter start-up.
+template <size_t M>
+double channel_rms(const std::vector<std::complex<float>>& frames, size_t k, size_t skip) {
+    double acc = 0.0;
+    size_t count = 0;
+    for (size_t t = skip; t < frames.size() / M; t++, count++)
+        acc += std::norm(frames[t * M + k]);
+    return std::sqrt(acc / count);
+}
+
+} // namespace
+
+TEST(PfbChannelizerTest, ConstexprPrototypeHasUnityDcGain) {
+    constexpr auto& h = PfbChannelizer<16, 8>::kPrototype;
+    double sum = 0.0;
+    for (size_t i = 0; i < h.size(); i += 2) sum += h[i];
+    EXPECT_NEAR(sum, 1.0, 1e-5);
+}
+
+TEST(PfbChannelizerTest, ChannelFrequencies) {
+    using Pfb = PfbChannelizer<8>;
+    EXPECT_DOUBLE_EQ(Pfb::channel_frequency(0), 0.0);
+    EXPECT_DOUBLE_EQ(Pfb::channel_frequency(1), 0.125);
+    EXPECT_DOUBLE_EQ(Pfb::channel_frequency(4), -0.5);
+    EXPECT_DOUBLE_EQ(Pfb::channel_frequency(7), -0.125);
+}
+
+TEST(PfbChannelizerTest, ToneLandsInItsChannel) {
+    constexpr size_t M = 16;
+    PfbChannelizer<M> pfb;
+
+    for (size_t k : {size_t{0}, size_t{3}, size_t{13}}) {
+        pfb.reset();
+        std::vector<std::complex<float>> out;
+        pfb.process(tone(M * 400, PfbChannelizer<M>::channel_frequency(k)), out);
+        ASSERT_EQ(out.size(), M * 400);
+
+        EXPECT_NEAR(channel_rms<M>(out, k, 16), 1.0, 1e-3) << "channel " << k;
+
+        for (size_t j = 0; j < M; j++) {
+            const size_t dist = std::min((j + M - k) % M, (k + M - j) % M);
+            if (dist < 2) continue;
+            EXPECT_LT(20.0 * std::log10(channel_rms<M>(out, j, 16)), -70.0)
+                << "tone in " << k << " leaks into " << j;
+        }
+    }
+}
+
+TEST(PfbChannelizerTest, StreamingSplitMatchesWhole) {
+    constexpr size_t M = 32;
+    const auto in = tone(M * 50 + 7, 0.23);
+
+    PfbChannelizer<M> whole, split;
+    std::vector<std::complex<float>> want, got, part;
+    whole.process(in, want);
+
+    std::span<const std::complex<float>> all(in);
+    for (size_t off = 0, len = 5; off < all.size(); off += len, len = len * 2 + 1) {
+        split.process(all.subspan(off, std::min(len, all.size() - off)), part);
+        got.insert(got.end(), part.begin(), part.end());
+    }
+
+    ASSERT_EQ(got.size(), want.size());
+    for (size_t i = 0; i < want.size(); i++)
+        EXPECT_LT(std::abs(got[i] - want[i]), 1e-5f) << "index " << i;
+}
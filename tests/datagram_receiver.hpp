@@ -0,0 +1,77 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * @file datagram_receiver.hpp
+ * @brief Loopback UDP endpoint shared by the tests of the network outputs.
+ */
+
+/// Bound loopback UDP socket returning whole datagrams.
+class DatagramReceiver {
+public:
+    /// @param timeout  How long a receive waits for the next datagram
+    explicit DatagramReceiver(std::chrono::microseconds timeout = std::chrono::milliseconds(200))
+    {
+        fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+
+        socklen_t len = sizeof(addr);
+        ::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+
+        timeval tv{static_cast<time_t>(timeout.count() / 1'000'000),
+                   static_cast<suseconds_t>(timeout.count() % 1'000'000)};
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+
+    ~DatagramReceiver() { ::close(fd_); }
+
+    DatagramReceiver(const DatagramReceiver&) = delete;
+    DatagramReceiver& operator=(const DatagramReceiver&) = delete;
+
+    int port() const { return port_; }
+
+    /// Up to @p count datagrams in arrival order, fewer if the timeout passes first.
+    std::vector<std::vector<char>> receive(std::size_t count)
+    {
+        std::vector<std::vector<char>> out;
+        std::vector<char> buf(65536);
+        while (out.size() < count) {
+            const ssize_t n = ::recv(fd_, buf.data(), buf.size(), 0);
+            if (n < 0) break;
+            out.emplace_back(buf.begin(), buf.begin() + n);
+        }
+        return out;
+    }
+
+    /// All datagrams queued so far, in arrival order.
+    std::vector<std::vector<char>> drain() { return receive(SIZE_MAX); }
+
+    /// Payloads of up to @p count datagrams, concatenated as float samples.
+    std::vector<float> receive_floats(std::size_t count)
+    {
+        std::vector<float> audio;
+        for (const auto& d : receive(count)) {
+            const std::size_t base = audio.size();
+            audio.resize(base + d.size() / sizeof(float));
+            std::memcpy(audio.data() + base, d.data(), (audio.size() - base) * sizeof(float));
+        }
+        return audio;
+    }
+
+private:
+    int fd_ = -1;
+    int port_ = 0;
+};
@@ -1,8 +1,19 @@
 #include <benchmark/benchmark.h>
+#include <chrono>
+#include <cmath>
+#include <numbers>
 #include <random>
+#include <string>
 #include <vector>
 #include <complex>
 #include "dsp.hpp"
+#include "channelizer.hpp"
+#include "fir_decimator.hpp"
+#include "fixed_point.hpp"
+#include "pipeline.hpp"
+#include "stereo.hpp"
+#include "thread_util.hpp"
+#include "udp_sender.hpp"
 
 
 static std::vector<int16_t> make_iq_int16(size_t samples) {
@@ -30,6 +41,12 @@ static std::vector<float> make_audio(size_t samples) {
 }
 
 
+// Seconds per sample (shown with an SI prefix, e.g. 4.1n) over @p samples
+static benchmark::Counter per_sample(int64_t samples) {
+    return benchmark::Counter(static_cast<double>(samples),
+                              benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
 static void BM_downsample_iq(benchmark::State& state) {
     const int decim = state.range(0);
     const size_t input_samples = 1 << 16;   // 65536 samples
@@ -50,6 +67,24 @@ static void BM_downsample_iq(benchmark::State& state) {
 }
 BENCHMARK(BM_downsample_iq)->Arg(2)->Arg(4)->Arg(8)->Arg(10)->Arg(16)->Unit(benchmark::kMicrosecond);
 
+static void BM_downsample_iq_q15(benchmark::State& state) {
+    const int decim = state.range(0);
+    const size_t input_samples = 1 << 16;
+
+    auto in = make_iq_int16(input_samples);
+    std::vector<int16_t> out(2 * (input_samples / 2 / decim + 1));
+    dsp::IqDecimState st;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(in);
+        dsp::downsample_iq_q15(in, std::span(out), decim, st);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(int64_t(state.iterations()) * input_samples);
+}
+BENCHMARK(BM_downsample_iq_q15)->Arg(8)->Arg(10)->Arg(16)->Unit(benchmark::kMicrosecond);
+
 static void BM_demodulate_fm(benchmark::State& state) {
     const size_t N = state.range(0);
     auto in = make_iq_f32(N);
@@ -68,9 +103,70 @@ static void BM_demodulate_fm(benchmark::State& state) {
     }
 
     state.SetItemsProcessed(state.iterations() * N);
+    state.counters["time/sample"] = per_sample(state.iterations() * N);
 }
 BENCHMARK(BM_demodulate_fm)->Arg(4096)->Arg(16384)->Arg(65536)->Unit(benchmark::kMicrosecond);
 
+static void BM_demodulate_fm_fast(benchmark::State& state) {
+    const size_t N = state.range(0);
+    auto in = make_iq_f32(N);
+    std::vector<float> out;
+    out.resize(N);
+
+    dsp::DemodState st{};
+    st.prev_iq = {1.0f, 0.0f};
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(in);
+        benchmark::DoNotOptimize(out);
+
+        dsp::demodulate_fm(in, out, st, dsp::FmDiscriminator::Fast);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * N);
+}
+BENCHMARK(BM_demodulate_fm_fast)->Arg(4096)->Arg(16384)->Arg(65536)->Unit(benchmark::kMicrosecond);
+
+// Scalar table-driven tier: compare with BM_demodulate_fm, the std::atan2 path
+static void BM_demodulate_fm_lut(benchmark::State& state) {
+    const size_t N = state.range(0);
+    auto in = make_iq_f32(N);
+    std::vector<float> out;
+    out.resize(N);
+
+    dsp::DemodState st{};
+    st.prev_iq = {1.0f, 0.0f};
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(in);
+        benchmark::DoNotOptimize(out);
+
+        dsp::demodulate_fm(in, out, st, dsp::FmDiscriminator::Lut);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * N);
+    state.counters["time/sample"] = per_sample(state.iterations() * N);
+}
+BENCHMARK(BM_demodulate_fm_lut)->Arg(4096)->Arg(16384)->Arg(65536)->Unit(benchmark::kMicrosecond);
+
+static void BM_demodulate_fm_q15(benchmark::State& state) {
+    const size_t N = state.range(0);
+    auto in = make_iq_int16(2 * N);
+    std::vector<int16_t> out(N);
+    dsp::DemodStateQ15 st;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(in);
+        dsp::demodulate_fm_q15(in, std::span(out), st);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * N);
+}
+BENCHMARK(BM_demodulate_fm_q15)->Arg(4096)->Arg(16384)->Arg(65536)->Unit(benchmark::kMicrosecond);
+
 static void BM_demodulate_am(benchmark::State& state) {
     const size_t N = state.range(0);
     auto in = make_iq_f32(N);
@@ -113,6 +209,486 @@ static void BM_downsample_audio(benchmark::State& state) {
 
     state.SetItemsProcessed(state.iterations() * N);
 }
-BENCHMARK(BM_downsample_audio)->Arg(2)->Arg(4)->Arg(8)->Arg(16)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_downsample_audio)->Arg(2)->Arg(4)->Arg(5)->Arg(8)->Arg(16)->Unit(benchmark::kMicrosecond);
+
+// Same decimation straight to saturated 16-bit PCM
+static void BM_downsample_audio_s16(benchmark::State& state) {
+    const int decim = state.range(0);
+    const size_t N = 1 << 16;
+
+    auto in = make_audio(N);
+    std::vector<int16_t> out;
+    out.reserve(N / decim + 1);
+
+    dsp::AudioDecimState st{};
+
+    for (auto _ : state) {
+        st = {};
+        dsp::downsample_audio(in, out, decim, st, 1.0f);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * N);
+}
+BENCHMARK(BM_downsample_audio_s16)->Arg(2)->Arg(4)->Arg(8)->Arg(16)->Unit(benchmark::kMicrosecond);
+
+// Per-channel NCO shift of the full-rate capture (items = IQ pairs)
+static void BM_mix_iq(benchmark::State& state) {
+    const size_t pairs = 1 << 16;
+    auto in = make_iq_int16(pairs * 2);
+
+    std::vector<std::complex<float>> out;
+    dsp::NcoState nco;
+
+    for (auto _ : state) {
+        dsp::mix_iq(in, out, -400e3 / 2.4e6, nco);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(int64_t(state.iterations()) * pairs);
+}
+BENCHMARK(BM_mix_iq)->Unit(benchmark::kMicrosecond);
+
+// One channel of the NCO + FIR channel bank; multiply by the channel count
+// to compare with the filter bank below (items = input IQ pairs)
+static void BM_nco_fir_channel(benchmark::State& state) {
+    const size_t pairs = 1 << 16;
+    auto in = make_iq_int16(pairs * 2);
+
+    std::vector<std::complex<float>> mixed, out;
+    dsp::NcoState nco;
+    dsp::FirDecimator<std::complex<float>, 10> fir;
+
+    for (auto _ : state) {
+        dsp::mix_iq(in, mixed, -400e3 / 2.4e6, nco);
+        fir.process(mixed, out);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(int64_t(state.iterations()) * pairs);
+}
+BENCHMARK(BM_nco_fir_channel)->Unit(benchmark::kMicrosecond);
+
+// All M subbands at once; per-sample cost grows with log2(M), not M
+template <size_t M>
+static void BM_pfb_channelizer(benchmark::State& state) {
+    const size_t n = 1 << 16;
+    auto in = make_iq_f32(n);
+
+    std::vector<std::complex<float>> out;
+    dsp::PfbChannelizer<M> pfb;
+
+    for (auto _ : state) {
+        pfb.process(in, out);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+    state.counters["channels"] = M;
+}
+BENCHMARK_TEMPLATE(BM_pfb_channelizer, 8)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_pfb_channelizer, 32)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_pfb_channelizer, 128)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_pfb_channelizer, 512)->Unit(benchmark::kMicrosecond);
+
+// Full boxcar FM chain on one capture block: three passes with block-sized
+// intermediates vs the fused strip-mined pass (items = IQ pairs)
+static void BM_fm_chain_staged(benchmark::State& state) {
+    const size_t pairs = state.range(0);
+    auto in = make_iq_int16(pairs * 2);
+
+    std::vector<std::complex<float>> iq;
+    std::vector<float> freq, audio;
+    dsp::DemodState demod;
+    dsp::AudioDecimState decim;
+
+    for (auto _ : state) {
+        dsp::downsample_iq(in, iq, 10);
+        dsp::demodulate_fm(iq, freq, demod, dsp::FmDiscriminator::Fast);
+        dsp::downsample_audio(freq, audio, 5, decim, 0.3f);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(int64_t(state.iterations()) * pairs);
+}
+BENCHMARK(BM_fm_chain_staged)->Arg(12'000)->Arg(120'000)->Arg(1'200'000)->Unit(benchmark::kMicrosecond);
+
+static void BM_fm_chain_fused(benchmark::State& state) {
+    const size_t pairs = state.range(0);
+    auto in = make_iq_int16(pairs * 2);
+
+    std::vector<float> audio;
+    dsp::FusedFmState st;
+
+    for (auto _ : state) {
+        dsp::demodulate_fm_fused(in, audio, 10, 5, st, 0.3f, dsp::FmDiscriminator::Fast);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(int64_t(state.iterations()) * pairs);
+}
+BENCHMARK(BM_fm_chain_fused)->Arg(12'000)->Arg(120'000)->Arg(1'200'000)->Unit(benchmark::kMicrosecond);
+
+static void BM_fm_chain_fixed(benchmark::State& state) {
+    const size_t pairs = state.range(0);
+    auto in = make_iq_int16(pairs * 2);
+
+    std::vector<int16_t> pcm;
+    dsp::FixedFmState st;
+
+    for (auto _ : state) {
+        dsp::demodulate_fm_fixed(in, pcm, 10, 5, st, 0.3f);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(int64_t(state.iterations()) * pairs);
+}
+BENCHMARK(BM_fm_chain_fixed)->Arg(12'000)->Arg(120'000)->Arg(1'200'000)->Unit(benchmark::kMicrosecond);
+
+// Polyphase FIR decimators at the receiver's rates, next to the boxcar
+// kernels above (items = input samples, so the rate reads as MSPS)
+static void BM_fir_decimate_iq(benchmark::State& state) {
+    const size_t input_samples = 1 << 16;
+
+    auto in = make_iq_int16(input_samples);
+    std::vector<std::complex<float>> out;
+    out.reserve(input_samples / 10 + 1);
+
+    dsp::FirDecimator<std::complex<float>, 10> fir;
+
+    for (auto _ : state) {
+        fir.process(in, out);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(int64_t(state.iterations()) * input_samples / 2);
+}
+BENCHMARK(BM_fir_decimate_iq)->Unit(benchmark::kMicrosecond);
+
+static void BM_fir_decimate_audio(benchmark::State& state) {
+    const size_t N = 1 << 16;
+
+    auto in = make_audio(N);
+    std::vector<float> out;
+    out.reserve(N / 5 + 1);
+
+    dsp::FirDecimator<float, 5> fir;
+
+    for (auto _ : state) {
+        fir.process(in, out);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(int64_t(state.iterations()) * N);
+}
+BENCHMARK(BM_fir_decimate_audio)->Unit(benchmark::kMicrosecond);
+
+// Stereo multiplex at 240 kS/s: 1 kHz on L, 400 Hz on R, 19 kHz pilot
+static std::vector<float> make_mpx(size_t n) {
+    std::vector<float> v(n);
+    const double w = 2.0 * std::numbers::pi / dsp::StereoDecoder::kMpxRateHz;
+    for (size_t i = 0; i < n; i++) {
+        const double l = std::sin(w * 1e3 * i);
+        const double r = std::sin(w * 400.0 * i);
+        const double a = w * dsp::StereoDecoder::kPilotHz * i;
+        v[i] = static_cast<float>(0.45 * (l + r) + 0.45 * (l - r) * std::sin(2.0 * a) +
+                                  0.1 * std::sin(a));
+    }
+    return v;
+}
+
+// Stereo decoder on its own (pilot PLL, 38 kHz demodulation, both channel
+// filters; arg 1 adds 50 us de-emphasis), locked before timing. rt_factor is
+// MPX seconds decoded per second: the stage's share of a core at 240 kS/s
+// is 1 / rt_factor (items = MPX samples)
+static void BM_stereo_decode(benchmark::State& state) {
+    const size_t n = 24'000;   // 100 ms
+    const auto mpx = make_mpx(n);
+
+    dsp::StereoDecoder dec(state.range(0) ? 50.0f : 0.0f);
+    dec.reserve(n);
+    std::vector<float> out(dec.output_size(n) + 64);
+    for (int i = 0; i < 3; i++)
+        dec.process(mpx, out);
+
+    for (auto _ : state) {
+        dec.process(mpx, out);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+    state.counters["rt_factor"] = benchmark::Counter(
+        double(n) / dsp::StereoDecoder::kMpxRateHz, benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["locked"] = dec.locked();
+    state.SetLabel(state.range(0) ? "deemphasis" : "flat");
+}
+BENCHMARK(BM_stereo_decode)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// De-emphasis IIR on one channel at the 48 kS/s audio rate
+static void BM_deemphasis(benchmark::State& state) {
+    const size_t n = 4'800;    // 100 ms
+    auto audio = make_audio(n);
+    const float alpha = dsp::deemphasis_alpha(50.0f, 48'000.0f);
+    dsp::DeemphasisState st;
+
+    for (auto _ : state) {
+        dsp::deemphasis(audio, alpha, st);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(int64_t(state.iterations()) * n);
+    state.counters["rt_factor"] = benchmark::Counter(
+        double(n) / 48'000.0, benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_deemphasis)->Unit(benchmark::kMicrosecond);
+
+// ---------------------------------------------------------------------------
+// Pipeline-level benchmarks: DemodPipeline::process_block on a synthetic FM
+// signal, reported against the real-time input rate.
+// ---------------------------------------------------------------------------
+
+// 1 kHz tone at 75 kHz deviation, 12-bit amplitude, continuous across blocks
+static std::vector<int16_t> make_fm_block(size_t pairs,
+                                          double fs = kDefaultRatePlan.input_rate_hz) {
+    std::vector<int16_t> raw(2 * pairs);
+    for (size_t i = 0; i < pairs; i++) {
+        const double phase = 75.0 * std::sin(2.0 * std::numbers::pi * 1e3 * i / fs);
+        raw[2 * i]     = static_cast<int16_t>(1500.0 * std::cos(phase));
+        raw[2 * i + 1] = static_cast<int16_t>(1500.0 * std::sin(phase));
+    }
+    return raw;
+}
+
+static DspOptions pipeline_config(int64_t id, const char*& label) {
+    DspOptions o;
+    switch (id) {
+    case 0: label = "boxcar/exact"; break;
+    case 1: label = "boxcar/fast";  o.discriminator = dsp::FmDiscriminator::Fast; break;
+    case 2: label = "fused/fast";   o.discriminator = dsp::FmDiscriminator::Fast; o.fused = true; break;
+    case 3: label = "fir/fast";     o.discriminator = dsp::FmDiscriminator::Fast;
+             o.decimator = DecimatorType::Fir; break;
+    default: label = "fixed";       o.arithmetic = Arithmetic::Fixed; break;
+    }
+    return o;
+}
+
+// Run the pipeline on one block per iteration and report throughput as plain
+// MSPS, ns/sample and real-time factor (input seconds processed per second)
+template <typename Pipeline>
+static void run_pipeline(benchmark::State& state, Pipeline& pipeline, size_t pairs) {
+    const long long rate = pipeline.rates().input_rate_hz;
+    const auto raw = make_fm_block(pairs, static_cast<double>(rate));
+    std::vector<float> audio;
+    audio.reserve(pipeline.max_audio_samples(pairs));
+
+    const auto t0 = std::chrono::steady_clock::now();
+    for (auto _ : state) {
+        pipeline.process_block(raw, audio);
+        benchmark::DoNotOptimize(audio.data());
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - t0;
+
+    const double samples = double(state.iterations()) * double(pairs);
+    const double sps = samples / elapsed.count();
+    state.counters["MSPS"]      = sps / 1e6;
+    state.counters["ns/sample"] = 1e9 / sps;
+    state.counters["rt_factor"] = sps / double(rate);
+}
+
+static void BM_pipeline_process_block(benchmark::State& state) {
+    const size_t pairs = state.range(0);
+    const char* label = "";
+    FmPipeline pipeline(pipeline_config(state.range(1), label), 0.3f, pairs);
+
+    run_pipeline(state, pipeline, pairs);
+    state.SetLabel(label);
+}
+BENCHMARK(BM_pipeline_process_block)
+    ->ArgsProduct({{120'000, 24'000, 4'800}, {0, 1, 2, 3, 4}})
+    ->ArgNames({"block", "config"})
+    ->Unit(benchmark::kMicrosecond);
+
+// SNR of the 1 kHz test tone in @p audio at 48 kS/s, in dB: least-squares
+// fit of a sine, cosine and offset, against the residual
+static double tone_snr_db(const std::vector<float>& audio, size_t skip) {
+    const double w = 2.0 * std::numbers::pi * 1e3 / 48e3;
+    double ss = 0, sc = 0, cc = 0, s1 = 0, c1 = 0, n = 0, ys = 0, yc = 0, y1 = 0;
+    for (size_t i = skip; i < audio.size(); i++) {
+        const double s = std::sin(w * i), c = std::cos(w * i), y = audio[i];
+        ss += s * s; sc += s * c; cc += c * c; s1 += s; c1 += c; n += 1;
+        ys += y * s; yc += y * c; y1 += y;
+    }
+
+    // 3x3 normal equations by Cramer's rule
+    const auto det = [](double a, double b, double c, double d, double e, double f,
+                        double g, double h, double k) {
+        return a * (e * k - f * h) - b * (d * k - f * g) + c * (d * h - e * g);
+    };
+    const double d0 = det(ss, sc, s1, sc, cc, c1, s1, c1, n);
+    const double a  = det(ys, sc, s1, yc, cc, c1, y1, c1, n) / d0;
+    const double b  = det(ss, ys, s1, sc, yc, c1, s1, y1, n) / d0;
+    const double k  = det(ss, sc, ys, sc, cc, yc, s1, c1, y1) / d0;
+
+    double signal = 0.0, noise = 0.0;
+    for (size_t i = skip; i < audio.size(); i++) {
+        const double fit = a * std::sin(w * i) + b * std::cos(w * i);
+        signal += fit * fit;
+        noise  += (audio[i] - fit - k) * (audio[i] - fit - k);
+    }
+    return 10.0 * std::log10(signal / noise);
+}
+
+// Float and fixed-point chains side by side (arg 0 = float with the fast
+// discriminator, 1 = Q15): throughput, plus the SNR of the recovered tone
+static void BM_pipeline_arithmetic(benchmark::State& state) {
+    const size_t pairs = 120'000;
+    DspOptions o;
+    o.discriminator = dsp::FmDiscriminator::Fast;
+    if (state.range(0) == 1) o.arithmetic = Arithmetic::Fixed;
+    FmPipeline pipeline(o, 0.3f, pairs);
+
+    run_pipeline(state, pipeline, pairs);
+
+    FmPipeline probe(o, 0.3f, pairs);
+    std::vector<float> audio;
+    probe.process_block(make_fm_block(pairs), audio);
+    state.counters["snr_db"] = tone_snr_db(audio, 100);
+    state.SetLabel(state.range(0) == 1 ? "fixed" : "float");
+}
+BENCHMARK(BM_pipeline_arithmetic)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// AM chain (envelope + carrier removal); arg 0 = boxcar, 1 = FIR. The input
+// is the FM test block, whose constant envelope costs the same as real AM
+static void BM_pipeline_am(benchmark::State& state) {
+    const size_t pairs = 120'000;
+    DspOptions o;
+    o.mode = dsp::DemodulationMode::AM;
+    if (state.range(0))
+        o.decimator = DecimatorType::Fir;
+    AmPipeline pipeline(o, 0.3f, pairs);
+
+    run_pipeline(state, pipeline, pairs);
+    state.SetLabel(state.range(0) ? "fir" : "boxcar");
+}
+BENCHMARK(BM_pipeline_am)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// FM stereo chain with 50 us de-emphasis; arg 0 = boxcar IQ, 1 = FIR IQ.
+// The mono test block carries no pilot, so this times the decoder searching
+// for one, which costs the same as a locked decode
+static void BM_pipeline_stereo(benchmark::State& state) {
+    const size_t pairs = 120'000;
+    DspOptions o;
+    o.stereo = true;
+    o.deemphasis_us = 50.0f;
+    o.discriminator = dsp::FmDiscriminator::Fast;
+    if (state.range(0))
+        o.decimator = DecimatorType::Fir;
+    FmPipeline pipeline(o, 0.3f, pairs);
+
+    run_pipeline(state, pipeline, pairs);
+    state.SetLabel(state.range(0) ? "fir" : "boxcar");
+}
+BENCHMARK(BM_pipeline_stereo)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// Rate plans: arg 0 indexes kCompiledRatePlans, arg 1 = 0 runs its
+// fixed-factor chain and 1 the runtime chain on the same plan, arg 2 = 0
+// boxcar, 1 FIR decimation. 50 ms blocks at each plan's input rate
+static void BM_pipeline_rate_plan(benchmark::State& state) {
+    const RatePlan plan = kCompiledRatePlans[static_cast<size_t>(state.range(0))];
+    const size_t pairs = static_cast<size_t>(plan.input_rate_hz / 20);
+    DspOptions o;
+    o.rates = plan;
+    o.discriminator = dsp::FmDiscriminator::Fast;
+    if (state.range(2))
+        o.decimator = DecimatorType::Fir;
+
+    if (state.range(1)) {
+        FmRuntimePipeline pipeline(o, 0.3f, pairs);
+        run_pipeline(state, pipeline, pairs);
+    } else {
+        AnyPipeline pipeline = make_pipeline(o, 0.3f, pairs);
+        std::visit([&](auto& p) { run_pipeline(state, p, pairs); }, pipeline);
+    }
+    state.SetLabel(std::to_string(plan.input_rate_hz / 1000) + "k/" +
+                   std::to_string(plan.decim_iq) + "/" + std::to_string(plan.decim_audio) +
+                   (state.range(1) ? " runtime" : " fixed"));
+}
+BENCHMARK(BM_pipeline_rate_plan)
+    ->ArgsProduct({{0, 1, 2}, {0, 1}, {0, 1}})
+    ->ArgNames({"plan", "runtime", "fir"})
+    ->Unit(benchmark::kMicrosecond);
+
+// Latency of one block through the chain: wall time per block is the DSP
+// share of end-to-end latency, on top of the block duration itself
+static void BM_pipeline_block_latency(benchmark::State& state) {
+    const size_t pairs = state.range(0);
+    DspOptions o;
+    o.discriminator = dsp::FmDiscriminator::Fast;
+    FmPipeline pipeline(o, 0.3f, pairs);
+
+    run_pipeline(state, pipeline, pairs);
+    state.counters["block_ms"] = 1e3 * double(pairs) / double(kDefaultRatePlan.input_rate_hz);
+}
+BENCHMARK(BM_pipeline_block_latency)->Arg(120'000)->Arg(12'000)->Arg(2'400)
+    ->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+// Cost of --stats: the same chain with stage timers off (0) and on (1), on
+// small blocks where the per-block timer overhead matters most
+static void BM_pipeline_instrumented(benchmark::State& state) {
+    const size_t pairs = 4'800;
+    PipelineMetrics metrics(pairs * 1'000'000'000ull / kDefaultRatePlan.input_rate_hz);
+    FmPipeline pipeline({}, 0.3f, pairs);
+    if (state.range(0))
+        pipeline.set_metrics(&metrics);
+
+    run_pipeline(state, pipeline, pairs);
+}
+BENCHMARK(BM_pipeline_instrumented)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// Audio-rate float stages on near-silent input, as a discriminator gives on
+// a dead channel: values around 1e-39 are denormal, and so becomes the
+// state decaying from them. Arg 0 runs with the default FP environment,
+// 1 with flush-to-zero (--flush-denormals)
+static void BM_near_silence(benchmark::State& state) {
+    const size_t N = 1 << 16;
+    std::vector<float> in(N);
+    std::mt19937 r(123);
+    std::uniform_real_distribution<float> d(-1e-39f, 1e-39f);
+    for (auto& x : in) x = d(r);
+
+    const ScopedFlushToZero ftz(state.range(0) != 0);
+    std::vector<float> audio(N / 5 + 1), filtered(N / 25 + 1);
+    dsp::AudioDecimState decim;
+    dsp::DeemphasisState deemph;
+    const float alpha = dsp::deemphasis_alpha(50.0f, 48'000.0f);
+    dsp::FirDecimator<float, 5> fir;
+
+    for (auto _ : state) {
+        const size_t n = dsp::downsample_audio(in, std::span(audio), 5, decim);
+        dsp::deemphasis(std::span(audio).first(n), alpha, deemph);
+        fir.process(std::span<const float>(audio).first(n), std::span(filtered));
+        benchmark::DoNotOptimize(filtered.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(int64_t(state.iterations()) * N);
+    state.SetLabel(state.range(0) ? "ftz" : "ieee");
+}
+BENCHMARK(BM_near_silence)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// One 50 ms audio block to loopback: arg 0 = single fragmented datagram,
+// otherwise packetized into datagrams of that many bytes via sendmmsg
+static void BM_udp_send_block(benchmark::State& state) {
+    const auto audio = make_audio(2400);
+
+    UdpSender udp("127.0.0.1", 9);
+    udp.set_packetized(static_cast<size_t>(state.range(0)));
+
+    for (auto _ : state)
+        udp.send(audio);
+
+    state.SetBytesProcessed(int64_t(state.iterations()) * audio.size() * sizeof(float));
+}
+BENCHMARK(BM_udp_send_block)->Arg(0)->Arg(1472)->Arg(8972)->Unit(benchmark::kMicrosecond);
 
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -0,0 +1,507 @@
+#include <gtest/gtest.h>
+#include "dsp_kernels.hpp"
+#include "thread_util.hpp"
+#include <cmath>
+#include <cstring>
+#include <random>
+
+using namespace dsp;
+
+namespace {
+
+constexpr Isa kAllIsas[] = {Isa::Neon, Isa::Sse41, Isa::Avx2, Isa::Avx512};
+
+std::vector<int16_t> random_iq(size_t pairs) {
+    std::vector<int16_t> v(pairs * 2);
+    std::mt19937 r(7);
+    std::uniform_int_distribution<int> d(-32768, 32767);
+    for (auto& x : v) x = static_cast<int16_t>(d(r));
+    return v;
+}
+
+std::vector<std::complex<float>> random_cf32(size_t n) {
+    std::vector<std::complex<float>> v(n);
+    std::mt19937 r(11);
+    std::uniform_real_distribution<float> d(-1000.0f, 1000.0f);
+    for (auto& x : v) x = {d(r), d(r)};
+    return v;
+}
+
+std::vector<float> random_f32(size_t n) {
+    std::vector<float> v(n);
+    std::mt19937 r(13);
+    std::uniform_real_distribution<float> d(-3.0f, 3.0f);
+    for (auto& x : v) x = d(r);
+    return v;
+}
+
+/// Values a flushing FPU reads as zero, between zeros and normal samples
+std::vector<float> near_silence(size_t n) {
+    std::vector<float> v(n);
+    std::mt19937 r(17);
+    std::uniform_real_distribution<float> d(-1.0f, 1.0f);
+    for (size_t i = 0; i < n; i++)
+        v[i] = i % 7 == 0 ? 0.0f : d(r) * (i % 5 == 0 ? 1e-3f : 1e-39f);
+    return v;
+}
+
+/// @return true if @p x is a subnormal float, judged from its bits (an
+///         FP compare would read it as zero under DAZ).
+bool is_subnormal(float x) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    return (bits & 0x7F800000u) == 0 && (bits & 0x007FFFFFu) != 0;
+}
+
+class KernelVariantTest : public ::testing::TestWithParam<Isa> {
+protected:
+    void SetUp() override {
+        if (!isa_supported(GetParam()))
+            GTEST_SKIP() << isa_name(GetParam()) << " not supported on this CPU";
+        table_ = kernels_for(GetParam());
+    }
+
+    KernelTable table_;
+    const KernelTable ref_ = kernels_for(Isa::Scalar);
+};
+
+std::string isa_param_name(const ::testing::TestParamInfo<Isa>& info) {
+    switch (info.param) {
+    case Isa::Neon:   return "Neon";
+    case Isa::Sse41:  return "Sse41";
+    case Isa::Avx2:   return "Avx2";
+    case Isa::Avx512: return "Avx512";
+    default:          return "Scalar";
+    }
+}
+
+} // namespace
+
+TEST_P(KernelVariantTest, DownsampleIqMatchesScalar) {
+    if (!table_.downsample_iq) GTEST_SKIP();
+    EXPECT_EQ(table_.downsample_iq.isa, GetParam());
+
+    for (int decim : {1, 3, 4, 5, 8, 10, 16, 17}) {
+        const size_t pairs = 1003;
+        auto in = random_iq(pairs);
+        std::vector<std::complex<float>> got(pairs), want(pairs);
+
+        const size_t n_got  = table_.downsample_iq.fn(in.data(), pairs, decim, got.data());
+        const size_t n_want = ref_.downsample_iq.fn(in.data(), pairs, decim, want.data());
+
+        ASSERT_EQ(n_got, n_want) << "decim " << decim;
+        for (size_t i = 0; i < n_want; i++)
+            EXPECT_EQ(got[i], want[i]) << "decim " << decim << " index " << i;
+    }
+}
+
+TEST_P(KernelVariantTest, DemodulateFmMatchesScalar) {
+    if (!table_.demodulate_fm) GTEST_SKIP();
+
+    for (size_t n : {size_t{1}, size_t{7}, size_t{33}, size_t{100}}) {
+        auto in = random_cf32(n);
+        std::vector<float> got(n), want(n);
+        const std::complex<float> prev{0.5f, -0.25f};
+
+        table_.demodulate_fm.fn(in.data(), n, prev, got.data());
+        ref_.demodulate_fm.fn(in.data(), n, prev, want.data());
+
+        for (size_t i = 0; i < n; i++) {
+            // The same polynomial, so only rounding differs (FMA, reciprocal)
+            float err = std::abs(got[i] - want[i]);
+            err = std::min(err, std::abs(err - 2.0f * detail::kPi));
+            EXPECT_LT(err, 1e-5f) << "n " << n << " index " << i;
+        }
+    }
+}
+
+TEST_P(KernelVariantTest, DemodulateAmMatchesScalar) {
+    if (!table_.demodulate_am) GTEST_SKIP();
+
+    const size_t n = 101;
+    auto in = random_cf32(n);
+    std::vector<float> got(n), want(n);
+
+    table_.demodulate_am.fn(in.data(), n, got.data());
+    ref_.demodulate_am.fn(in.data(), n, want.data());
+
+    for (size_t i = 0; i < n; i++)
+        EXPECT_NEAR(got[i], want[i], want[i] * 1e-5f) << "index " << i;
+}
+
+TEST_P(KernelVariantTest, DownsampleAudioMatchesScalar) {
+    if (!table_.downsample_audio) GTEST_SKIP();
+
+    for (int decim : {1, 2, 5, 8}) {
+        auto in = random_f32(997);
+        std::vector<float> got(in.size() + 1), want(in.size() + 1);
+        AudioDecimState s_got{0.75f, 1};
+        AudioDecimState s_want{0.75f, 1};
+        if (decim == 1) s_got = s_want = {};
+
+        // Two calls so block-boundary state is exercised
+        std::span<const float> all(in);
+        size_t n_got = 0, n_want = 0;
+        for (auto part : {all.first(301), all.subspan(301)}) {
+            n_got  += table_.downsample_audio.fn(part.data(), part.size(), decim, 0.5f,
+                                                 s_got, got.data() + n_got);
+            n_want += ref_.downsample_audio.fn(part.data(), part.size(), decim, 0.5f,
+                                               s_want, want.data() + n_want);
+        }
+
+        ASSERT_EQ(n_got, n_want) << "decim " << decim;
+        for (size_t i = 0; i < n_want; i++)
+            EXPECT_FLOAT_EQ(got[i], want[i]) << "decim " << decim << " index " << i;
+        EXPECT_EQ(s_got.counter, s_want.counter);
+        EXPECT_FLOAT_EQ(s_got.accumulator, s_want.accumulator);
+    }
+}
+
+TEST_P(KernelVariantTest, FirDecimateMatchesScalar) {
+    if (!table_.fir_decimate) GTEST_SKIP();
+
+    for (size_t ntaps : {size_t{8}, size_t{48}, size_t{96}}) {
+        for (size_t step : {size_t{1}, size_t{5}, size_t{10}}) {
+            const size_t n_out = 37;
+            auto x    = random_f32(n_out * step + ntaps);
+            auto taps = random_f32(ntaps);
+            std::vector<float> got(n_out), want(n_out);
+
+            table_.fir_decimate.fn(x.data(), n_out, step, taps.data(), ntaps, got.data());
+            ref_.fir_decimate.fn(x.data(), n_out, step, taps.data(), ntaps, want.data());
+
+            // Summation order differs, so allow accumulated rounding
+            for (size_t i = 0; i < n_out; i++)
+                EXPECT_NEAR(got[i], want[i], 1e-4f * ntaps)
+                    << "taps " << ntaps << " step " << step << " index " << i;
+        }
+    }
+}
+
+TEST_P(KernelVariantTest, FirDecimateCfMatchesScalar) {
+    if (!table_.fir_decimate_cf) GTEST_SKIP();
+
+    for (size_t ntaps : {size_t{8}, size_t{16}, size_t{96}}) {
+        for (size_t step : {size_t{1}, size_t{5}, size_t{10}}) {
+            const size_t n_out = 37;
+            auto x    = random_cf32(n_out * step + ntaps);
+            auto taps = random_f32(ntaps);
+            std::vector<float> taps2(2 * ntaps);
+            for (size_t j = 0; j < ntaps; j++)
+                taps2[2 * j] = taps2[2 * j + 1] = taps[j];
+
+            std::vector<std::complex<float>> got(n_out), want(n_out);
+            table_.fir_decimate_cf.fn(x.data(), n_out, step, taps2.data(), ntaps, got.data());
+            ref_.fir_decimate_cf.fn(x.data(), n_out, step, taps2.data(), ntaps, want.data());
+
+            for (size_t i = 0; i < n_out; i++) {
+                EXPECT_NEAR(got[i].real(), want[i].real(), 0.05f * ntaps)
+                    << "taps " << ntaps << " step " << step << " index " << i;
+                EXPECT_NEAR(got[i].imag(), want[i].imag(), 0.05f * ntaps)
+                    << "taps " << ntaps << " step " << step << " index " << i;
+            }
+        }
+    }
+}
+
+TEST_P(KernelVariantTest, MixIqMatchesScalar) {
+    if (!table_.mix_iq) GTEST_SKIP();
+
+    for (size_t pairs : {size_t{1}, size_t{7}, size_t{64}, size_t{1023}}) {
+        auto in = random_iq(pairs);
+        const auto phase = std::polar(1.0f, 0.7f);
+        const auto step  = std::polar(1.0f, -0.3f);
+        std::vector<std::complex<float>> got(pairs), want(pairs);
+
+        table_.mix_iq.fn(in.data(), pairs, phase, step, got.data());
+        ref_.mix_iq.fn(in.data(), pairs, phase, step, want.data());
+
+        // Lane phasors are built by different multiply chains, so rounding
+        // drifts apart slowly over a run
+        for (size_t i = 0; i < pairs; i++)
+            EXPECT_LE(std::abs(got[i] - want[i]), std::abs(want[i]) * 1e-4f)
+                << "pairs " << pairs << " index " << i;
+    }
+}
+
+TEST_P(KernelVariantTest, FftPassMatchesScalar) {
+    if (!table_.fft_pass) GTEST_SKIP();
+
+    const size_t n = 64;
+    for (size_t half = 1; half < n; half <<= 1) {
+        auto data = random_cf32(n);
+        auto tw   = random_cf32(half);
+        auto ref  = data;
+        if (half == 1) tw[0] = 1.0f;  // the first stage's only twiddle
+
+        table_.fft_pass.fn(data.data(), n, half, tw.data());
+        ref_.fft_pass.fn(ref.data(), n, half, tw.data());
+
+        for (size_t i = 0; i < n; i++)
+            EXPECT_LT(std::abs(data[i] - ref[i]), 1e-4f * std::abs(ref[i]) + 1e-3f)
+                << "half " << half << " index " << i;
+    }
+}
+
+TEST_P(KernelVariantTest, FloatToS16MatchesScalar) {
+    if (!table_.float_to_s16) GTEST_SKIP();
+
+    // +-3 at scale 16384 drives about a third of the samples into saturation
+    auto in = random_f32(1003);
+    in[0] = 0.5f / 16384.0f;   // ties round to even
+    in[1] = 1.5f / 16384.0f;
+    in[2] = 1e30f;
+    in[3] = -1e30f;
+
+    for (size_t n : {0, 1, 7, 8, 15, 16, 17, 1003}) {
+        std::vector<int16_t> got(n), want(n);
+        table_.float_to_s16.fn(in.data(), n, 16384.0f, got.data());
+        ref_.float_to_s16.fn(in.data(), n, 16384.0f, want.data());
+
+        // ARMv7 rounds exact ties away from zero
+        for (size_t i = 0; i < n; i++)
+            EXPECT_LE(std::abs(got[i] - want[i]), GetParam() == Isa::Neon ? 1 : 0)
+                << "n " << n << " index " << i;
+    }
+}
+
+TEST_P(KernelVariantTest, PowerCfMatchesScalar) {
+    if (!table_.power_cf) GTEST_SKIP();
+
+    const auto in = random_cf32(1003);
+    for (size_t n : {0, 1, 3, 4, 7, 8, 9, 1003}) {
+        const float got  = table_.power_cf.fn(in.data(), n);
+        const float want = ref_.power_cf.fn(in.data(), n);
+        EXPECT_NEAR(got, want, 1e-5f * want + 1e-6f) << "n " << n;
+    }
+}
+
+TEST_P(KernelVariantTest, PilotMixMatchesScalar) {
+    if (!table_.pilot_mix) GTEST_SKIP();
+
+    const auto mpx = random_f32(1003);
+    const auto phase = std::polar(1.0f, 0.7f);
+    const auto step  = std::polar(1.0f, 0.497f);
+
+    for (size_t n : {size_t{1}, size_t{7}, size_t{8}, size_t{64}, size_t{67}}) {
+        std::vector<float> sum(n), diff(n), want_sum(n), want_diff(n);
+        const auto got  = table_.pilot_mix.fn(mpx.data(), n, phase, step, 0.1f, 4.0f,
+                                              sum.data(), diff.data());
+        const auto want = ref_.pilot_mix.fn(mpx.data(), n, phase, step, 0.1f, 4.0f,
+                                            want_sum.data(), want_diff.data());
+
+        EXPECT_LT(std::abs(got - want), 1e-4f * static_cast<float>(n)) << "n " << n;
+        for (size_t i = 0; i < n; i++) {
+            EXPECT_NEAR(sum[i], want_sum[i], 1e-4f) << "n " << n << " index " << i;
+            EXPECT_NEAR(diff[i], want_diff[i], 1e-3f) << "n " << n << " index " << i;
+        }
+    }
+}
+
+TEST_P(KernelVariantTest, DeemphasisMatchesScalar) {
+    if (!table_.deemphasis) GTEST_SKIP();
+
+    const auto in = random_f32(1003);
+    for (size_t n : {0, 1, 3, 4, 5, 8, 1003}) {
+        auto got = in, want = in;
+        const float y_got  = table_.deemphasis.fn(got.data(), n, 0.34f, 0.5f);
+        const float y_want = ref_.deemphasis.fn(want.data(), n, 0.34f, 0.5f);
+
+        EXPECT_NEAR(y_got, y_want, 1e-5f) << "n " << n;
+        for (size_t i = 0; i < n; i++)
+            EXPECT_NEAR(got[i], want[i], 1e-5f) << "n " << n << " index " << i;
+    }
+}
+
+TEST_P(KernelVariantTest, DownsampleIqQ15MatchesScalar) {
+    if (!table_.downsample_iq_q15) GTEST_SKIP();
+
+    for (int decim : {1, 3, 4, 5, 8, 10, 16, 17}) {
+        const size_t pairs = 1003;
+        auto in = random_iq(pairs);
+        std::vector<int16_t> got(2 * pairs), want(2 * pairs);
+        const int shift = iq_q15_shift(decim);
+
+        const size_t n_got  = table_.downsample_iq_q15.fn(in.data(), pairs, decim, shift, got.data());
+        const size_t n_want = ref_.downsample_iq_q15.fn(in.data(), pairs, decim, shift, want.data());
+
+        ASSERT_EQ(n_got, n_want) << "decim " << decim;
+        for (size_t i = 0; i < 2 * n_want; i++)
+            EXPECT_EQ(got[i], want[i]) << "decim " << decim << " index " << i;
+    }
+}
+
+TEST_P(KernelVariantTest, DemodulateFmQ15MatchesScalar) {
+    if (!table_.demodulate_fm_q15) GTEST_SKIP();
+
+    // Full-scale random IQ within +-kQ15Max, as the IQ stage delivers it
+    auto in = random_iq(1001);
+    for (auto& x : in) x = std::max<int16_t>(x, -kQ15Max);
+
+    for (size_t n : {0, 1, 7, 8, 9, 16, 1001}) {
+        std::vector<int16_t> got(n), want(n);
+        table_.demodulate_fm_q15.fn(in.data(), n, 1234, -4321, got.data());
+        ref_.demodulate_fm_q15.fn(in.data(), n, 1234, -4321, want.data());
+
+        for (size_t i = 0; i < n; i++)
+            EXPECT_EQ(got[i], want[i]) << "n " << n << " index " << i;
+    }
+
+    // A few LSBs and runs of zeros: the largest normalisation shifts and
+    // the zero-vector case of every lane
+    std::vector<int16_t> weak(in.size());
+    for (size_t i = 0; i < in.size(); i++)
+        weak[i] = (i / 16) % 3 == 0 ? 0 : static_cast<int16_t>(in[i] % 5);
+
+    std::vector<int16_t> got(1001), want(1001);
+    table_.demodulate_fm_q15.fn(weak.data(), 1001, 0, 0, got.data());
+    ref_.demodulate_fm_q15.fn(weak.data(), 1001, 0, 0, want.data());
+    for (size_t i = 0; i < got.size(); i++)
+        EXPECT_EQ(got[i], want[i]) << "weak index " << i;
+}
+
+TEST_P(KernelVariantTest, DownsampleAudioQ15MatchesScalar) {
+    if (!table_.downsample_audio_q15) GTEST_SKIP();
+
+    const auto raw = random_iq(500);
+    for (int decim : {1, 2, 5, 8}) {
+        for (float scale : {0.2f, -1.7f}) {
+            const FixedGain g = fixed_gain(scale, decim);
+            std::vector<int16_t> got(raw.size() + 1), want(raw.size() + 1);
+            AudioDecimStateQ15 s_got{-700, 1}, s_want{-700, 1};
+            if (decim == 1) s_got = s_want = {};
+
+            std::span<const int16_t> all(raw);
+            size_t n_got = 0, n_want = 0;
+            for (auto part : {all.first(301), all.subspan(301)}) {
+                n_got  += table_.downsample_audio_q15.fn(part.data(), part.size(), decim, g,
+                                                         s_got, got.data() + n_got);
+                n_want += ref_.downsample_audio_q15.fn(part.data(), part.size(), decim, g,
+                                                       s_want, want.data() + n_want);
+            }
+
+            ASSERT_EQ(n_got, n_want) << "decim " << decim;
+            for (size_t i = 0; i < n_want; i++)
+                EXPECT_EQ(got[i], want[i]) << "decim " << decim << " index " << i;
+            EXPECT_EQ(s_got.counter, s_want.counter);
+            EXPECT_EQ(s_got.accumulator, s_want.accumulator);
+        }
+    }
+}
+
+TEST_P(KernelVariantTest, FloatKernelsAgreeWhenFlushingDenormals) {
+    if (!flush_to_zero_supported()) GTEST_SKIP() << "No flush-to-zero control on this target";
+    const ScopedFlushToZero ftz;
+
+    const auto in = near_silence(1003);
+    const auto check = [](const std::vector<float>& got, const std::vector<float>& want,
+                          size_t n, const char* kernel) {
+        for (size_t i = 0; i < n; i++) {
+            ASSERT_TRUE(std::isfinite(got[i])) << kernel << " index " << i;
+            EXPECT_FALSE(is_subnormal(got[i])) << kernel << " index " << i;
+            EXPECT_NEAR(got[i], want[i], 1e-6f) << kernel << " index " << i;
+        }
+    };
+
+    if (table_.downsample_audio) {
+        std::vector<float> got(in.size()), want(in.size());
+        AudioDecimState s_got{1e-39f, 1}, s_want{1e-39f, 1};
+        const size_t n = table_.downsample_audio.fn(in.data(), in.size(), 5, 0.5f, s_got, got.data());
+        ref_.downsample_audio.fn(in.data(), in.size(), 5, 0.5f, s_want, want.data());
+        check(got, want, n, "downsample_audio");
+        EXPECT_FALSE(is_subnormal(s_got.accumulator));
+    }
+    if (table_.deemphasis) {
+        auto got = in, want = in;
+        const float y = table_.deemphasis.fn(got.data(), got.size(), 0.34f, 1e-39f);
+        ref_.deemphasis.fn(want.data(), want.size(), 0.34f, 1e-39f);
+        check(got, want, got.size(), "deemphasis");
+        EXPECT_FALSE(is_subnormal(y));
+    }
+    if (table_.fir_decimate) {
+        const auto taps = random_f32(48);
+        std::vector<float> got(190), want(190);
+        table_.fir_decimate.fn(in.data(), got.size(), 5, taps.data(), taps.size(), got.data());
+        ref_.fir_decimate.fn(in.data(), want.size(), 5, taps.data(), taps.size(), want.data());
+        check(got, want, got.size(), "fir_decimate");
+    }
+    if (table_.demodulate_fm) {
+        // Denormal IQ reads as zero: the angles of 0 / 0 must stay finite
+        std::vector<std::complex<float>> iq(in.size() / 2);
+        for (size_t i = 0; i < iq.size(); i++)
+            iq[i] = {in[2 * i], in[2 * i + 1]};
+        std::vector<float> got(iq.size()), want(iq.size());
+        table_.demodulate_fm.fn(iq.data(), iq.size(), {1e-39f, 0.0f}, got.data());
+        ref_.demodulate_fm.fn(iq.data(), iq.size(), {1e-39f, 0.0f}, want.data());
+        for (size_t i = 0; i < got.size(); i++) {
+            ASSERT_TRUE(std::isfinite(got[i])) << "demodulate_fm index " << i;
+            float err = std::abs(got[i] - want[i]);
+            err = std::min(err, std::abs(err - 2.0f * detail::kPi));
+            EXPECT_LT(err, 1e-5f) << "demodulate_fm index " << i;
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(AllIsas, KernelVariantTest,
+                         ::testing::ValuesIn(kAllIsas), isa_param_name);
+
+TEST(KernelRegistryTest, EveryEntryBound) {
+    const KernelTable& k = kernels();
+
+    EXPECT_TRUE(k.downsample_iq);
+    EXPECT_TRUE(k.demodulate_fm);
+    EXPECT_TRUE(k.demodulate_am);
+    EXPECT_TRUE(k.downsample_audio);
+    EXPECT_TRUE(k.fir_decimate);
+    EXPECT_TRUE(k.fir_decimate_cf);
+    EXPECT_TRUE(k.mix_iq);
+    EXPECT_TRUE(k.fft_pass);
+    EXPECT_TRUE(k.float_to_s16);
+    EXPECT_TRUE(k.power_cf);
+    EXPECT_TRUE(k.pilot_mix);
+    EXPECT_TRUE(k.deemphasis);
+    EXPECT_TRUE(k.downsample_iq_q15);
+    EXPECT_TRUE(k.demodulate_fm_q15);
+    EXPECT_TRUE(k.downsample_audio_q15);
+}
+
+TEST(KernelRegistryTest, BoundKernelsAreSupported) {
+    const KernelTable& k = kernels();
+
+    EXPECT_TRUE(isa_supported(k.downsample_iq.isa));
+    EXPECT_TRUE(isa_supported(k.demodulate_fm.isa));
+    EXPECT_TRUE(isa_supported(k.demodulate_am.isa));
+    EXPECT_TRUE(isa_supported(k.downsample_audio.isa));
+    EXPECT_TRUE(isa_supported(k.fir_decimate.isa));
+    EXPECT_TRUE(isa_supported(k.fir_decimate_cf.isa));
+    EXPECT_TRUE(isa_supported(k.mix_iq.isa));
+    EXPECT_TRUE(isa_supported(k.fft_pass.isa));
+    EXPECT_TRUE(isa_supported(k.float_to_s16.isa));
+    EXPECT_TRUE(isa_supported(k.power_cf.isa));
+    EXPECT_TRUE(isa_supported(k.pilot_mix.isa));
+    EXPECT_TRUE(isa_supported(k.deemphasis.isa));
+}
+
+TEST(KernelRegistryTest, ScalarAlwaysSupported) {
+    EXPECT_TRUE(isa_supported(Isa::Scalar));
+    EXPECT_STREQ(isa_name(Isa::Scalar), "scalar");
+}
+
+TEST(FlushToZeroTest, ScopeFlushesAndRestores) {
+    if (!flush_to_zero_supported()) GTEST_SKIP() << "No flush-to-zero control on this target";
+    ASSERT_FALSE(flush_to_zero_enabled());
+
+    volatile float tiny = 1e-39f;
+    {
+        const ScopedFlushToZero ftz;
+        EXPECT_TRUE(flush_to_zero_enabled());
+        const float doubled = tiny * 2.0f;
+        EXPECT_FALSE(is_subnormal(doubled));
+    }
+    EXPECT_FALSE(flush_to_zero_enabled());
+    const float doubled = tiny * 2.0f;
+    EXPECT_TRUE(is_subnormal(doubled));
+
+    const ScopedFlushToZero off(false);
+    EXPECT_FALSE(flush_to_zero_enabled());
+}
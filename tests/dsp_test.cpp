@@ -463,6 +463,51 @@ TEST(DownsampleIQTest, ClearsOutput) {
     EXPECT_TRUE(approx_equal(out[0], std::complex<float>(4, 6)));
 }
 
+TEST(DownsampleIQTest, StatefulCarriesPartialWindow) {
+    // 3 pairs then 3 pairs with decim=4: one output spanning both blocks
+    std::vector<int16_t> a = {1, 10, 2, 20, 3, 30};
+    std::vector<int16_t> b = {4, 40, 5, 50, 6, 60};
+    std::vector<std::complex<float>> out;
+    IqDecimState state{};
+
+    downsample_iq(a, out, 4, state);
+    EXPECT_TRUE(out.empty());
+    EXPECT_EQ(state.count, 3);
+
+    downsample_iq(b, out, 4, state);
+    ASSERT_EQ(out.size(), 1);
+    EXPECT_TRUE(approx_equal(out[0], std::complex<float>(10, 100)));
+    EXPECT_EQ(state.count, 2);
+    EXPECT_EQ(state.sum_i, 11);
+    EXPECT_EQ(state.sum_q, 110);
+}
+
+TEST(DownsampleIQTest, StatefulSplitMatchesWhole) {
+    std::vector<int16_t> in(2 * 1009);
+    for (size_t i = 0; i < in.size(); i++)
+        in[i] = static_cast<int16_t>((i * 7919) % 2001) - 1000;
+
+    for (int decim : {3, 10, 17}) {
+        std::vector<std::complex<float>> whole, got, part;
+        IqDecimState s_whole{}, s_split{};
+        downsample_iq(in, whole, decim, s_whole);
+
+        // Block lengths that never line up with the decimation
+        std::span<const int16_t> all(in);
+        for (size_t off = 0, len = 2; off < all.size(); off += len, len += 6) {
+            len = std::min(len, all.size() - off);
+            downsample_iq(all.subspan(off, len), part, decim, s_split);
+            got.insert(got.end(), part.begin(), part.end());
+        }
+
+        ASSERT_EQ(got.size(), whole.size()) << "decim " << decim;
+        ASSERT_EQ(got.size(), in.size() / 2 / decim);
+        for (size_t i = 0; i < whole.size(); i++)
+            EXPECT_EQ(got[i], whole[i]) << "decim " << decim << " index " << i;
+        EXPECT_EQ(s_split.count, s_whole.count);
+    }
+}
+
 TEST(DemodulateFMTest, EmptyInput) {
     std::vector<std::complex<float>> in;
     std::vector<float> out;
@@ -523,6 +568,128 @@ TEST(DemodulateFMTest, ConsecutiveCalls) {
     EXPECT_TRUE(approx_equal(out2[0], std::numbers::pi_v<float> / 2.0f, 1e-4f));
 }
 
+TEST(FastAtan2Test, ErrorBound) {
+    float max_err = 0.0f;
+    for (int k = 0; k < 100000; k++) {
+        const double t = -std::numbers::pi + 2.0 * std::numbers::pi * k / 100000.0;
+        for (float radius : {1e-3f, 1.0f, 3e4f}) {
+            const float x = radius * static_cast<float>(std::cos(t));
+            const float y = radius * static_cast<float>(std::sin(t));
+            float err = std::abs(fast_atan2(y, x) - std::atan2(y, x));
+            // +pi and -pi are the same angle
+            err = std::min(err, std::abs(err - 2.0f * std::numbers::pi_v<float>));
+            max_err = std::max(max_err, err);
+        }
+    }
+    EXPECT_LT(max_err, kFastAtan2MaxError);
+}
+
+TEST(FastAtan2Test, Quadrants) {
+    EXPECT_TRUE(approx_equal(fast_atan2(0.0f, 1.0f), 0.0f));
+    EXPECT_TRUE(approx_equal(fast_atan2(1.0f, 0.0f), std::numbers::pi_v<float> / 2, 1e-4f));
+    EXPECT_TRUE(approx_equal(fast_atan2(-1.0f, 0.0f), -std::numbers::pi_v<float> / 2, 1e-4f));
+    EXPECT_TRUE(approx_equal(fast_atan2(1.0f, -1.0f), 3 * std::numbers::pi_v<float> / 4, 1e-4f));
+    EXPECT_TRUE(approx_equal(fast_atan2(-1.0f, -1.0f), -3 * std::numbers::pi_v<float> / 4, 1e-4f));
+    EXPECT_TRUE(approx_equal(fast_atan2(0.0f, 0.0f), 0.0f));
+}
+
+TEST(LutAtan2Test, ErrorBound) {
+    float max_err = 0.0f;
+    for (int k = 0; k < 100000; k++) {
+        const double t = -std::numbers::pi + 2.0 * std::numbers::pi * k / 100000.0;
+        for (float radius : {1e-30f, 1e-3f, 1.0f, 3e4f, 1e30f}) {
+            const float x = radius * static_cast<float>(std::cos(t));
+            const float y = radius * static_cast<float>(std::sin(t));
+            float err = std::abs(lut_atan2(y, x) - std::atan2(y, x));
+            err = std::min(err, std::abs(err - 2.0f * std::numbers::pi_v<float>));
+            max_err = std::max(max_err, err);
+        }
+    }
+    EXPECT_LT(max_err, kLutAtan2MaxError);
+}
+
+TEST(LutAtan2Test, QuadrantsAndLimits) {
+    EXPECT_EQ(lut_atan2(0.0f, 1.0f), 0.0f);
+    EXPECT_TRUE(approx_equal(lut_atan2(1.0f, 0.0f), std::numbers::pi_v<float> / 2, kLutAtan2MaxError));
+    EXPECT_TRUE(approx_equal(lut_atan2(-1.0f, 0.0f), -std::numbers::pi_v<float> / 2, kLutAtan2MaxError));
+    EXPECT_TRUE(approx_equal(lut_atan2(1.0f, -1.0f), 3 * std::numbers::pi_v<float> / 4, kLutAtan2MaxError));
+    EXPECT_TRUE(approx_equal(lut_atan2(-1.0f, -1.0f), -3 * std::numbers::pi_v<float> / 4, kLutAtan2MaxError));
+    EXPECT_EQ(lut_atan2(0.0f, 0.0f), 0.0f);
+    EXPECT_EQ(lut_atan2(1e-40f, 1e-40f), 0.0f);   // denormal
+}
+
+static std::vector<std::complex<float>> make_fm_iq(size_t n) {
+    std::vector<std::complex<float>> iq(n);
+    float phase = 0.3f;
+    for (size_t i = 0; i < n; i++) {
+        phase += 0.8f * std::sin(0.05f * static_cast<float>(i));
+        const float amp = 100.0f + 50.0f * std::cos(0.11f * static_cast<float>(i));
+        iq[i] = std::polar(amp, phase);
+    }
+    return iq;
+}
+
+TEST(DemodulateFMTest, FastMatchesExact) {
+    // 37 samples: exercises vector body and scalar tail for every SIMD width
+    auto in = make_fm_iq(37);
+    std::vector<float> exact, fast;
+    DemodState s_exact{std::complex<float>(0.0f, 1.0f)};
+    DemodState s_fast{std::complex<float>(0.0f, 1.0f)};
+
+    demodulate_fm(in, exact, s_exact, FmDiscriminator::Exact);
+    demodulate_fm(in, fast, s_fast, FmDiscriminator::Fast);
+
+    ASSERT_EQ(fast.size(), exact.size());
+    for (size_t i = 0; i < exact.size(); i++) {
+        EXPECT_TRUE(approx_equal(fast[i], exact[i], kFastAtan2MaxError))
+            << "Index " << i << ": exact " << exact[i] << ", fast " << fast[i];
+    }
+    EXPECT_TRUE(approx_equal(s_fast.prev_iq, s_exact.prev_iq));
+}
+
+TEST(DemodulateFMTest, LutMatchesExact) {
+    auto in = make_fm_iq(1000);
+    std::vector<float> exact, lut;
+    DemodState s_exact{}, s_lut{};
+
+    demodulate_fm(in, exact, s_exact, FmDiscriminator::Exact);
+    demodulate_fm(in, lut, s_lut, FmDiscriminator::Lut);
+
+    ASSERT_EQ(lut.size(), exact.size());
+    for (size_t i = 0; i < exact.size(); i++)
+        EXPECT_NEAR(lut[i], exact[i], kLutAtan2MaxError) << "Index " << i;
+    EXPECT_EQ(s_lut.prev_iq, s_exact.prev_iq);
+}
+
+TEST(DemodulateFMTest, FastPhaseContinuityAcrossBlocks) {
+    auto in = make_fm_iq(100);
+    std::vector<float> whole, part1, part2;
+
+    DemodState s_whole{};
+    demodulate_fm(in, whole, s_whole, FmDiscriminator::Fast);
+
+    DemodState s_split{};
+    std::span<const std::complex<float>> all(in);
+    demodulate_fm(all.first(13), part1, s_split, FmDiscriminator::Fast);
+    demodulate_fm(all.subspan(13), part2, s_split, FmDiscriminator::Fast);
+
+    part1.insert(part1.end(), part2.begin(), part2.end());
+    ASSERT_EQ(part1.size(), whole.size());
+    for (size_t i = 0; i < whole.size(); i++)
+        EXPECT_TRUE(approx_equal(part1[i], whole[i])) << "Index " << i;
+}
+
+TEST(DemodulateFMTest, FastEmptyInputKeepsState) {
+    std::vector<std::complex<float>> in;
+    std::vector<float> out = {1.0f};
+    DemodState state{std::complex<float>(0.0f, 1.0f)};
+
+    demodulate_fm(in, out, state, FmDiscriminator::Fast);
+
+    EXPECT_TRUE(out.empty());
+    EXPECT_TRUE(approx_equal(state.prev_iq, std::complex<float>(0.0f, 1.0f)));
+}
+
 TEST(DemodulateAMTest, EmptyInput) {
     std::vector<std::complex<float>> in;
     std::vector<float> out;
@@ -595,6 +762,74 @@ TEST(DemodulateAMTest, ClearsOutput) {
     EXPECT_TRUE(approx_equal(out[0], 1.0f));
 }
 
+TEST(RemoveCarrierTest, ConstantEnvelopeIsSilent) {
+    std::vector<float> env(100, 7.5f);
+    AmCarrierState state;
+
+    remove_carrier(env, state, 1e-3f);
+
+    for (float x : env) EXPECT_NEAR(x, 0.0f, 1e-6f);
+    EXPECT_NEAR(state.carrier, 7.5f, 1e-5f);
+}
+
+TEST(RemoveCarrierTest, IndependentOfLevelAndBlocking) {
+    std::vector<float> env(1000);
+    for (size_t i = 0; i < env.size(); i++) env[i] = 2.0f + std::sin(0.05f * static_cast<float>(i));
+
+    std::vector<float> whole = env;
+    std::vector<float> scaled = env;
+    for (float& x : scaled) x *= 30.0f;
+    AmCarrierState s1, s2, s3;
+    remove_carrier(whole, s1, 1e-3f);
+    remove_carrier(scaled, s2, 1e-3f);
+
+    std::vector<float> split = env;
+    remove_carrier(std::span(split).first(333), s3, 1e-3f);
+    remove_carrier(std::span(split).subspan(333), s3, 1e-3f);
+
+    for (size_t i = 0; i < env.size(); i++) {
+        EXPECT_NEAR(scaled[i], whole[i], 1e-5f) << "Index " << i;
+        EXPECT_FLOAT_EQ(split[i], whole[i]) << "Index " << i;
+    }
+}
+
+TEST(DeemphasisTest, UnityAtDcAndMinus3dBAtCorner) {
+    const float alpha = deemphasis_alpha(50.0f, 48'000.0f);
+    EXPECT_NEAR(alpha, 1.0f - std::exp(-1.0f / (50e-6f * 48'000.0f)), 1e-6f);
+
+    std::vector<float> dc(200, 0.25f);
+    DeemphasisState state;
+    deemphasis(dc, alpha, state);
+    EXPECT_NEAR(dc.back(), 0.25f, 1e-6f);
+
+    // 1 / (2 pi 50 us) = 3183 Hz
+    std::vector<float> tone(4800);
+    const float w = 2.0f * std::numbers::pi_v<float> * 3183.0f / 48'000.0f;
+    for (size_t i = 0; i < tone.size(); i++) tone[i] = std::sin(w * static_cast<float>(i));
+    DeemphasisState s2;
+    deemphasis(tone, alpha, s2);
+
+    float peak = 0.0f;
+    for (size_t i = 480; i < tone.size(); i++) peak = std::max(peak, std::abs(tone[i]));
+    EXPECT_NEAR(20.0f * std::log10(peak), -3.0f, 0.2f);
+}
+
+TEST(DeemphasisTest, StateCarriesAcrossBlocks) {
+    std::vector<float> in(1001);
+    for (size_t i = 0; i < in.size(); i++) in[i] = std::sin(0.3f * static_cast<float>(i));
+    const float alpha = deemphasis_alpha(75.0f, 48'000.0f);
+
+    std::vector<float> whole = in, split = in;
+    DeemphasisState s1, s2;
+    deemphasis(whole, alpha, s1);
+    deemphasis(std::span(split).first(333), alpha, s2);
+    deemphasis(std::span(split).subspan(333), alpha, s2);
+
+    for (size_t i = 0; i < in.size(); i++)
+        EXPECT_NEAR(split[i], whole[i], 1e-6f) << "Index " << i;
+    EXPECT_NEAR(s2.y, whole.back(), 1e-6f);
+}
+
 TEST(DownsampleAudioTest, EmptyInput) {
     std::vector<float> in;
     std::vector<float> out;
@@ -734,3 +969,198 @@ TEST(IntegrationTest, IQToAMPipeline) {
     downsample_audio(am_out, audio_out, 2, audio_state, 1.0f);
     EXPECT_FALSE(audio_out.empty());
 }
+
+// ============================================================================
+// NCO Mixer Tests
+// ============================================================================
+
+TEST(MixIqTest, ShiftsToneToDc) {
+    // Tone at +0.1 cycles/sample, shifted by -0.1 across uneven blocks
+    const size_t pairs = 5000;
+    std::vector<int16_t> in(2 * pairs);
+    for (size_t n = 0; n < pairs; n++) {
+        const auto v = std::polar(1000.0, 2.0 * std::numbers::pi * 0.1 * n);
+        in[2 * n]     = static_cast<int16_t>(std::lround(v.real()));
+        in[2 * n + 1] = static_cast<int16_t>(std::lround(v.imag()));
+    }
+
+    NcoState nco;
+    std::vector<std::complex<float>> out;
+    std::span<const int16_t> all(in);
+
+    for (size_t off = 0, len = 2 * 777; off < all.size(); off += len) {
+        len = std::min(len, all.size() - off);
+        mix_iq(all.subspan(off, len), out, -0.1, nco);
+        ASSERT_EQ(out.size(), len / 2);
+
+        for (const auto& v : out)
+            EXPECT_TRUE(approx_equal(v, std::complex<float>(1000.0f, 0.0f), 2.0f))
+                << "offset " << off << ": " << v;
+    }
+
+    // 5000 * 0.1 whole cycles: back at phase 0 (modulo wrap)
+    EXPECT_NEAR(std::min(nco.phase, 1.0 - nco.phase), 0.0, 1e-9);
+}
+
+// ============================================================================
+// Fused Chain Tests
+// ============================================================================
+
+static std::vector<int16_t> make_fm_raw(size_t pairs) {
+    auto iq = make_fm_iq(pairs);
+    std::vector<int16_t> raw(pairs * 2);
+    for (size_t i = 0; i < pairs; i++) {
+        raw[2 * i]     = static_cast<int16_t>(std::lround(iq[i].real() * 50.0f));
+        raw[2 * i + 1] = static_cast<int16_t>(std::lround(iq[i].imag() * 50.0f));
+    }
+    return raw;
+}
+
+TEST(FusedChainTest, MatchesStagedAcrossBlocks) {
+    for (auto accuracy : {FmDiscriminator::Exact, FmDiscriminator::Fast, FmDiscriminator::Lut}) {
+        // Blocks larger and smaller than the fused chunk, with ragged tails
+        auto raw = make_fm_raw(40'007);
+        std::span<const int16_t> all(raw);
+
+        FusedFmState fused_state;
+        IqDecimState iq_state;
+        DemodState demod_state;
+        AudioDecimState audio_state;
+        std::vector<float> fused, staged, part;
+        std::vector<std::complex<float>> iq;
+        std::vector<float> freq;
+
+        for (size_t off = 0, len = 6; off < all.size(); off += len, len *= 3) {
+            len = std::min(len, all.size() - off);
+            auto block = all.subspan(off, len);
+
+            demodulate_fm_fused(block, part, 10, 5, fused_state, 0.3f, accuracy);
+            fused.insert(fused.end(), part.begin(), part.end());
+
+            downsample_iq(block, iq, 10, iq_state);
+            demodulate_fm(iq, freq, demod_state, accuracy);
+            downsample_audio(freq, part, 5, audio_state, 0.3f);
+            staged.insert(staged.end(), part.begin(), part.end());
+        }
+
+        ASSERT_EQ(fused.size(), staged.size());
+        for (size_t i = 0; i < staged.size(); i++)
+            EXPECT_FLOAT_EQ(fused[i], staged[i]) << "Index " << i;
+        EXPECT_EQ(fused_state.iq.count, iq_state.count);
+        EXPECT_EQ(fused_state.demod.prev_iq, demod_state.prev_iq);
+        EXPECT_EQ(fused_state.audio.counter, audio_state.counter);
+    }
+}
+
+TEST(FusedChainTest, EmptyInputKeepsState) {
+    FusedFmState state{{}, {std::complex<float>(0.0f, 1.0f)}, {0.5f, 2}};
+    std::vector<float> out(3, 1.0f);
+
+    demodulate_fm_fused({}, out, 10, 5, state);
+
+    EXPECT_TRUE(out.empty());
+    EXPECT_EQ(state.demod.prev_iq, std::complex<float>(0.0f, 1.0f));
+    EXPECT_EQ(state.audio.counter, 2);
+}
+
+// ============================================================================
+// PCM Output Tests
+// ============================================================================
+
+TEST(FloatToS16Test, RoundsAndSaturates) {
+    const std::vector<float> in = {0.0f, 1.0f, -1.0f, 0.5f, 2.0f, -2.0f,
+                                   1.5f / kS16FullScale, 2.5f / kS16FullScale};
+    std::vector<int16_t> out;
+
+    float_to_s16(in, out);
+
+    const std::vector<int16_t> want = {0, 32767, -32767, 16384, 32767, -32768, 2, 2};
+    EXPECT_EQ(out, want);
+}
+
+TEST(FloatToS16Test, AppliesGain) {
+    std::vector<int16_t> out;
+    float_to_s16(std::vector<float>{0.25f, -0.25f}, out, 2.0f);
+    EXPECT_EQ(out, (std::vector<int16_t>{16384, -16384}));
+}
+
+TEST(DownsampleAudioS16Test, MatchesFloatPathAcrossBlocks) {
+    // Long enough to span several internal chunks, with ragged block edges
+    std::vector<float> in(20'011);
+    for (size_t i = 0; i < in.size(); i++)
+        in[i] = 1.2f * std::sin(0.001f * static_cast<float>(i));
+
+    AudioDecimState s16_state, f32_state;
+    std::vector<int16_t> pcm, part;
+    std::vector<float> ref, ref_part;
+
+    for (size_t off = 0, len = 3; off < in.size(); off += len, len *= 4) {
+        len = std::min(len, in.size() - off);
+        std::span<const float> block(in.data() + off, len);
+
+        downsample_audio(block, part, 5, s16_state, 0.5f);
+        pcm.insert(pcm.end(), part.begin(), part.end());
+
+        downsample_audio(block, ref_part, 5, f32_state, 0.5f);
+        ref.insert(ref.end(), ref_part.begin(), ref_part.end());
+    }
+
+    std::vector<int16_t> want;
+    float_to_s16(ref, want);
+
+    ASSERT_EQ(pcm.size(), want.size());
+    for (size_t i = 0; i < want.size(); i++)
+        EXPECT_LE(std::abs(pcm[i] - want[i]), 1) << "Index " << i;
+    EXPECT_EQ(s16_state.counter, f32_state.counter);
+}
+
+TEST(FusedChainTest, PcmOutputMatchesFloat) {
+    auto raw = make_fm_raw(40'007);
+
+    FusedFmState f32_state, s16_state;
+    std::vector<float> audio;
+    std::vector<int16_t> pcm, want;
+
+    demodulate_fm_fused(raw, audio, 10, 5, f32_state, 0.3f);
+    demodulate_fm_fused(raw, pcm, 10, 5, s16_state, 0.3f);
+    float_to_s16(audio, want);
+
+    ASSERT_EQ(pcm.size(), want.size());
+    ASSERT_FALSE(pcm.empty());
+    for (size_t i = 0; i < want.size(); i++)
+        EXPECT_LE(std::abs(pcm[i] - want[i]), 1) << "Index " << i;
+    EXPECT_EQ(s16_state.audio.counter, f32_state.audio.counter);
+}
+
+TEST(MeanPowerTest, FullScaleToneIsZeroDbfs) {
+    // Complex tone at full scale: I^2 + Q^2 = 32768^2 for every pair
+    const std::vector<int16_t> tone = {-32768, 0, 0, -32768, -32768, 0, 0, -32768};
+    EXPECT_FLOAT_EQ(dsp::mean_power(tone), 1.0f);
+    EXPECT_NEAR(dsp::power_dbfs(dsp::mean_power(tone)), 0.0f, 1e-5f);
+
+    // Half the amplitude is a quarter of the power
+    const std::vector<int16_t> half = {16384, 0, 0, 16384, -16384, 0, 0, -16384};
+    EXPECT_NEAR(dsp::power_dbfs(dsp::mean_power(half)), -6.0206f, 1e-3f);
+}
+
+TEST(MeanPowerTest, SilenceHitsFloor) {
+    EXPECT_EQ(dsp::mean_power(std::vector<int16_t>{}), 0.0f);
+    EXPECT_EQ(dsp::mean_power(std::vector<int16_t>(64, 0)), 0.0f);
+    EXPECT_FLOAT_EQ(dsp::power_dbfs(0.0f), -200.0f);
+}
+
+TEST(SquelchTest, OpensAtThresholdClosesBelowHysteresis) {
+    dsp::SquelchState s;
+    EXPECT_FALSE(dsp::squelch(-45.0f, -40.0f, 5.0f, s));
+    EXPECT_TRUE(dsp::squelch(-40.0f, -40.0f, 5.0f, s));
+    EXPECT_TRUE(dsp::squelch(-44.9f, -40.0f, 5.0f, s));
+    EXPECT_FALSE(dsp::squelch(-45.1f, -40.0f, 5.0f, s));
+    EXPECT_FALSE(dsp::squelch(-41.0f, -40.0f, 5.0f, s));
+}
+
+TEST(MeanPowerTest, ComplexBlockRelativeToFullScale) {
+    const std::vector<std::complex<float>> iq(37, {300.0f, -400.0f});   // |z| = 500
+    EXPECT_NEAR(dsp::mean_power(iq, 1000.0f), 0.25f, 1e-6f);
+    EXPECT_NEAR(dsp::power_dbfs(dsp::mean_power(iq, 1000.0f)), -6.0206f, 1e-3f);
+    EXPECT_EQ(dsp::mean_power(std::span<const std::complex<float>>{}, 1.0f), 0.0f);
+}
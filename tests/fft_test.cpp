@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include "fft.hpp"
+#include <cmath>
+#include <numbers>
+#include <random>
+
+using namespace dsp;
+
+namespace {
+
+std::vector<std::complex<float>> random_signal(size_t n) {
+    std::vector<std::complex<float>> v(n);
+    std::mt19937 r(17);
+    std::uniform_real_distribution<float> d(-1.0f, 1.0f);
+    for (auto& x : v) x = {d(r), d(r)};
+    return v;
+}
+
+std::vector<std::complex<double>> naive_dft(const std::vector<std::complex<float>>& x) {
+    const size_t n = x.size();
+    std::vector<std::complex<double>> X(n);
+    for (size_t k = 0; k < n; k++)
+        for (size_t i = 0; i < n; i++)
+            X[k] += std::complex<double>(x[i]) *
+                    std::polar(1.0, -2.0 * std::numbers::pi * double(k * i % n) / double(n));
+    return X;
+}
+
+} // namespace
+
+TEST(FftTest, RejectsNonPowerOfTwo) {
+    EXPECT_THROW(Fft(0), std::invalid_argument);
+    EXPECT_THROW(Fft(1), std::invalid_argument);
+    EXPECT_THROW(Fft(12), std::invalid_argument);
+}
+
+TEST(FftTest, ForwardMatchesNaiveDft) {
+    for (size_t n : {2, 4, 8, 16, 64, 256}) {
+        auto x = random_signal(n);
+        const auto want = naive_dft(x);
+
+        Fft fft(n);
+        fft.forward(x);
+
+        for (size_t k = 0; k < n; k++)
+            EXPECT_LT(std::abs(std::complex<double>(x[k]) - want[k]), 1e-4 * n)
+                << "n " << n << " bin " << k;
+    }
+}
+
+TEST(FftTest, InverseUndoesForward) {
+    const size_t n = 1024;
+    const auto orig = random_signal(n);
+    auto x = orig;
+
+    Fft fft(n);
+    fft.forward(x);
+    fft.inverse(x);
+
+    for (size_t i = 0; i < n; i++)
+        EXPECT_LT(std::abs(x[i] / float(n) - orig[i]), 1e-5f) << "index " << i;
+}
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include "file_source.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+/// Temporary file removed at scope exit.
+struct TempPath {
+    std::filesystem::path path;
+
+    explicit TempPath(const std::string& name)
+        : path(std::filesystem::temp_directory_path() /
+               ("fm_radio_" + std::to_string(::getpid()) + "_" + name)) {}
+    ~TempPath() { std::filesystem::remove(path); }
+
+    std::string str() const { return path.string(); }
+};
+
+/// `pairs` IQ pairs counting up from 0, so every sample identifies its index.
+std::vector<int16_t> ramp(size_t pairs) {
+    std::vector<int16_t> v(2 * pairs);
+    for (size_t i = 0; i < v.size(); i++) v[i] = static_cast<int16_t>(i);
+    return v;
+}
+
+void write_file(const std::string& path, const std::vector<int16_t>& data, size_t extra_bytes = 0) {
+    std::ofstream f(path, std::ios::binary);
+    f.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(int16_t));
+    for (size_t i = 0; i < extra_bytes; i++) f.put('\x7f');
+}
+
+} // namespace
+
+TEST(FileSourceTest, BlocksAreContiguousViewsOfTheFile) {
+    TempPath file("raw.iq");
+    const auto data = ramp(1000);
+    write_file(file.str(), data, 3);  // trailing partial pair is ignored
+
+    FileSource src(file.str(), 300);
+    EXPECT_EQ(src.total_pairs(), 1000u);
+    EXPECT_EQ(src.sample_rate(), kDefaultRecordingRateHz);
+    EXPECT_FALSE(src.live());
+
+    std::vector<int16_t> seen;
+    const int16_t* base = nullptr;
+    std::vector<size_t> sizes;
+
+    for (auto block = src.next_block(); !block.empty(); block = src.next_block()) {
+        if (!base) base = block.data();
+        // Zero copy: each block points straight after the previous one
+        EXPECT_EQ(block.data(), base + seen.size());
+        seen.insert(seen.end(), block.begin(), block.end());
+        sizes.push_back(block.size() / 2);
+    }
+
+    EXPECT_EQ(sizes, (std::vector<size_t>{300, 300, 300, 100}));
+    EXPECT_EQ(seen, data);
+    EXPECT_TRUE(src.next_block().empty());
+
+    src.rewind();
+    EXPECT_EQ(src.next_block().data(), base);
+}
+
+TEST(FileSourceTest, EmptyFileEndsImmediately) {
+    TempPath file("empty.iq");
+    write_file(file.str(), {});
+
+    FileSource src(file.str(), 100);
+    EXPECT_EQ(src.total_pairs(), 0u);
+    EXPECT_TRUE(src.next_block().empty());
+}
+
+TEST(FileSourceTest, RejectsBadArguments) {
+    EXPECT_THROW(FileSource("/nonexistent/capture.iq", 100), std::runtime_error);
+
+    TempPath file("raw.iq");
+    write_file(file.str(), ramp(10));
+    EXPECT_THROW(FileSource(file.str(), 0), std::invalid_argument);
+}
+
+TEST(FileSourceTest, ReadsSigmfRecording) {
+    TempPath data("rec.sigmf-data");
+    TempPath meta("rec.sigmf-meta");
+    write_file(data.str(), ramp(64));
+    std::ofstream(meta.str()) <<
+        "{\n"
+        "  \"global\": {\n"
+        "    \"core:datatype\": \"ci16_le\",\n"
+        "    \"core:sample_rate\": 2.4e6,\n"
+        "    \"core:version\": \"1.0.0\"\n"
+        "  },\n"
+        "  \"captures\": [{\"core:sample_start\": 0, \"core:frequency\": 100e6}]\n"
+        "}\n";
+
+    // Either file of the pair opens the recording
+    for (const auto& path : {data.str(), meta.str()}) {
+        FileSource src(path, 1000, Pacing::MaxSpeed, 1);
+        EXPECT_EQ(src.sample_rate(), 2'400'000);
+        EXPECT_EQ(src.next_block().size(), 128u);
+    }
+}
+
+TEST(FileSourceTest, RejectsUnsupportedSigmf) {
+    TempPath data("bad.sigmf-data");
+    TempPath meta("bad.sigmf-meta");
+    write_file(data.str(), ramp(64));
+
+    std::ofstream(meta.str()) <<
+        R"({"global": {"core:datatype": "cf32_le", "core:sample_rate": 2400000}})";
+    EXPECT_THROW(FileSource(data.str(), 100), std::runtime_error);
+
+    std::ofstream(meta.str()) << R"({"global": {"core:datatype": "ci16_le"}})";
+    EXPECT_THROW(FileSource(data.str(), 100), std::runtime_error);
+}
+
+TEST(FileSourceTest, RealtimePacingFollowsSampleRate) {
+    TempPath file("paced.iq");
+    write_file(file.str(), ramp(2400));
+
+    // 2400 pairs at 24 kS/s: 100 ms of signal
+    FileSource src(file.str(), 600, Pacing::Realtime, 24'000);
+
+    const auto start = std::chrono::steady_clock::now();
+    size_t blocks = 0;
+    while (!src.next_block().empty()) blocks++;
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(blocks, 4u);
+    EXPECT_GE(elapsed, std::chrono::milliseconds(100));
+}
+
+TEST(StreamSourceTest, ReassemblesShortReads) {
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+
+    const auto data = ramp(1000);
+    std::thread writer([&] {
+        // Odd-sized writes split I/Q pairs across reads
+        const auto* bytes = reinterpret_cast<const char*>(data.data());
+        const size_t total = data.size() * sizeof(int16_t);
+        for (size_t off = 0; off < total; off += 777)
+            ASSERT_GT(::write(fds[1], bytes + off, std::min<size_t>(777, total - off)), 0);
+        ::close(fds[1]);
+    });
+
+    StreamSource src(fds[0], 300);
+    std::vector<int16_t> seen;
+    std::vector<size_t> sizes;
+    for (auto block = src.next_block(); !block.empty(); block = src.next_block()) {
+        seen.insert(seen.end(), block.begin(), block.end());
+        sizes.push_back(block.size() / 2);
+    }
+
+    writer.join();
+    ::close(fds[0]);
+
+    EXPECT_EQ(sizes, (std::vector<size_t>{300, 300, 300, 100}));
+    EXPECT_EQ(seen, data);
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include "fir_decimator.hpp"
+#include <cmath>
+#include <numbers>
+#include <random>
+
+using namespace dsp;
+
+namespace {
+
+std::vector<float> tone(size_t n, float cycles_per_sample) {
+    std::vector<float> v(n);
+    for (size_t i = 0; i < n; i++)
+        v[i] = std::cos(2.0f * std::numbers::pi_v<float> * cycles_per_sample * i);
+    return v;
+}
+
+float rms(std::span<const float> v) {
+    double acc = 0.0;
+    for (float x : v) acc += double(x) * x;
+    return static_cast<float>(std::sqrt(acc / v.size()));
+}
+
+} // namespace
+
+TEST(DesignLowpassTest, UnityDcGainAndSymmetry) {
+    std::vector<float> h(48);
+    design_lowpass(h, 0.08f);
+
+    float sum = 0.0f;
+    for (float c : h) sum += c;
+    EXPECT_NEAR(sum, 1.0f, 1e-5f);
+
+    for (size_t i = 0; i < h.size() / 2; i++)
+        EXPECT_FLOAT_EQ(h[i], h[h.size() - 1 - i]);
+}
+
+TEST(FirDecimatorTest, OutputCountMatchesDecimation) {
+    FirDecimator<float, 5> fir;
+    std::vector<float> in(1000, 0.0f), out;
+
+    size_t total = 0;
+    for (int block = 0; block < 7; block++) {
+        fir.process(in, out);
+        total += out.size();
+    }
+
+    // History starts zeroed, so every 5 inputs yield exactly one output
+    EXPECT_EQ(total, size_t{7 * 1000 / 5});
+}
+
+TEST(FirDecimatorTest, PhaseCountsTowardTheNextOutput) {
+    FirDecimator<float, 5> fir;
+    EXPECT_EQ(fir.phase(), 4u);   // reset() emits on the first input
+
+    std::vector<float> out;
+    fir.process(std::vector<float>(7, 0.0f), out);
+    EXPECT_EQ(out.size(), 2u);
+    EXPECT_EQ(fir.phase(), 1u);
+
+    // Resumed at phase 3, the next output needs two inputs
+    fir.reset(3);
+    EXPECT_EQ(fir.phase(), 3u);
+    fir.process(std::vector<float>(1, 0.0f), out);
+    EXPECT_TRUE(out.empty());
+    fir.process(std::vector<float>(1, 0.0f), out);
+    EXPECT_EQ(out.size(), 1u);
+    EXPECT_EQ(fir.phase(), 0u);
+}
+
+TEST(FirDecimatorTest, DcGainIsUnity) {
+    FirDecimator<float, 5> fir;
+    std::vector<float> in(2000, 0.25f), out;
+
+    fir.process(in, out, 2.0f);
+    ASSERT_FALSE(out.empty());
+    EXPECT_NEAR(out.back(), 0.5f, 1e-4f);
+}
+
+TEST(FirDecimatorTest, RejectsAliasingTone) {
+    FirDecimator<float, 5> fir;
+    std::vector<float> out;
+
+    // 0.01 cycles/sample passes; 0.17 would alias to 0.15 after decimation
+    fir.process(tone(20000, 0.01f), out);
+    const float pass = rms(std::span<const float>(out).subspan(100));
+
+    fir.reset();
+    fir.process(tone(20000, 0.17f), out);
+    const float stop = rms(std::span<const float>(out).subspan(100));
+
+    EXPECT_NEAR(pass, std::sqrt(0.5f), 0.01f);
+    EXPECT_LT(20.0f * std::log10(stop / pass), -60.0f);
+}
+
+TEST(FirDecimatorTest, StreamingSplitMatchesWhole) {
+    std::mt19937 r(3);
+    std::uniform_real_distribution<float> d(-1.0f, 1.0f);
+    std::vector<std::complex<float>> in(4001);
+    for (auto& x : in) x = {d(r), d(r)};
+
+    FirDecimator<std::complex<float>, 10> whole, split;
+    std::vector<std::complex<float>> want, got, part;
+
+    whole.process(in, want);
+
+    std::span<const std::complex<float>> all(in);
+    for (size_t off = 0, len = 1; off < all.size(); off += len, len = len * 3 + 1) {
+        split.process(all.subspan(off, std::min(len, all.size() - off)), part);
+        got.insert(got.end(), part.begin(), part.end());
+    }
+
+    ASSERT_EQ(got.size(), want.size());
+    for (size_t i = 0; i < want.size(); i++) {
+        EXPECT_NEAR(got[i].real(), want[i].real(), 1e-5f) << "index " << i;
+        EXPECT_NEAR(got[i].imag(), want[i].imag(), 1e-5f) << "index " << i;
+    }
+}
+
+TEST(FirDecimatorTest, Int16InputMatchesFloat) {
+    std::mt19937 r(5);
+    std::uniform_int_distribution<int> d(-2048, 2047);
+    std::vector<int16_t> raw(2 * 1200);
+    for (auto& x : raw) x = static_cast<int16_t>(d(r));
+
+    std::vector<std::complex<float>> cf(raw.size() / 2);
+    for (size_t i = 0; i < cf.size(); i++)
+        cf[i] = {float(raw[2 * i]), float(raw[2 * i + 1])};
+
+    FirDecimator<std::complex<float>, 10> a, b;
+    std::vector<std::complex<float>> from_int, from_float;
+    a.process(std::span<const int16_t>(raw), from_int);
+    b.process(cf, from_float);
+
+    ASSERT_EQ(from_int.size(), from_float.size());
+    for (size_t i = 0; i < from_int.size(); i++)
+        EXPECT_EQ(from_int[i], from_float[i]);
+}
+
+TEST(FirDecimatorTest, RuntimeFactorMatchesFixed) {
+    // The runtime filter takes the generic FirDesign of its factor
+    FirDecimator<float, 3> fixed;
+    FirDecimator<float, kRuntimeDecimation> runtime(3);
+    FirDecimator<std::complex<float>, 7> fixed_cf;
+    FirDecimator<std::complex<float>, kRuntimeDecimation> runtime_cf(7);
+    EXPECT_EQ(runtime.decimation(), 3);
+    EXPECT_EQ(runtime.padded_taps(), fixed.padded_taps());
+
+    const auto in = tone(1001, 0.01f);
+    std::vector<std::complex<float>> in_cf(in.size());
+    for (size_t i = 0; i < in.size(); i++) in_cf[i] = {in[i], -in[i]};
+
+    std::vector<float> want, got;
+    std::vector<std::complex<float>> want_cf, got_cf;
+    for (int block = 0; block < 3; block++) {
+        fixed.process(in, want, 0.5f);
+        runtime.process(in, got, 0.5f);
+        EXPECT_EQ(got, want);
+
+        fixed_cf.process(in_cf, want_cf);
+        runtime_cf.process(in_cf, got_cf);
+        EXPECT_EQ(got_cf, want_cf);
+    }
+
+    EXPECT_THROW((FirDecimator<float, kRuntimeDecimation>(0)), std::invalid_argument);
+}
@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+#include "fixed_point.hpp"
+#include "test_signals.hpp"
+#include <cmath>
+#include <numbers>
+#include <random>
+
+using namespace dsp;
+
+namespace {
+
+/// Q15 phase of @p rad, wrapped to int16.
+int q15_phase(double rad) {
+    return static_cast<int16_t>(static_cast<int32_t>(std::lround(rad / std::numbers::pi * 32768.0)));
+}
+
+/// Distance between two Q15 phases, modulo a full turn.
+int phase_distance(int a, int b) {
+    return std::abs(static_cast<int16_t>(a - b));
+}
+
+} // namespace
+
+TEST(CordicTest, ErrorBound) {
+    std::mt19937 r(3);
+    std::uniform_int_distribution<int32_t> d(-(1 << 30), 1 << 30);
+
+    int worst = 0;
+    for (int k = 0; k < 200'000; k++) {
+        const int32_t y = d(r) >> (k % 20);
+        const int32_t x = d(r) >> (k % 20);
+        if (x == 0 && y == 0) continue;
+        worst = std::max(worst, phase_distance(cordic_atan2_q15(y, x), q15_phase(std::atan2(y, x))));
+    }
+    EXPECT_LE(worst, kCordicMaxErrorQ15);
+}
+
+TEST(CordicTest, AxesAndExtremes) {
+    EXPECT_EQ(cordic_atan2_q15(0, 0), 0);
+    EXPECT_LE(std::abs(cordic_atan2_q15(0, 1000)), kCordicMaxErrorQ15);
+    EXPECT_LE(phase_distance(cordic_atan2_q15(1000, 0), 16384), kCordicMaxErrorQ15);
+    EXPECT_LE(phase_distance(cordic_atan2_q15(-1000, 0), -16384), kCordicMaxErrorQ15);
+    EXPECT_LE(phase_distance(cordic_atan2_q15(0, -1000), -32768), kCordicMaxErrorQ15);
+
+    // The full int32 range of the conjugate product does not overflow
+    constexpr int32_t kMax = 2 * kQ15Max * kQ15Max;
+    EXPECT_LE(phase_distance(cordic_atan2_q15(kMax, kMax), 8192), kCordicMaxErrorQ15);
+    EXPECT_LE(phase_distance(cordic_atan2_q15(-kMax, -kMax), -24576), kCordicMaxErrorQ15);
+}
+
+TEST(FixedGainTest, QuantisesScale) {
+    for (float scale : {1.0f, 0.1f, -0.37f, 3.0e-4f, 100.0f}) {
+        for (int decim : {1, 5, 10}) {
+            const FixedGain g = fixed_gain(scale, decim);
+            const double got = std::ldexp(static_cast<double>(g.mul), -g.pre_shift - g.shift);
+            EXPECT_NEAR(got, scale, std::abs(scale) * 1e-4) << scale << " / " << decim;
+            EXPECT_LE(std::abs(g.mul), 32768);
+        }
+    }
+    EXPECT_EQ(fixed_gain(0.0f, 5).mul, 0);
+}
+
+TEST(FixedGainTest, RejectsOutOfRange) {
+    EXPECT_THROW(fixed_gain(1.0f, 0), std::invalid_argument);
+    EXPECT_THROW(fixed_gain(1e6f, 5), std::invalid_argument);
+}
+
+TEST(DownsampleIqQ15Test, ShiftsAndSaturates) {
+    // Ten pairs at -32768 sum to -327680; >> 4 is -20480. Sixteen would
+    // reach -32768 itself, which saturates to -kQ15Max
+    const std::vector<int16_t> in(32, -32768);
+    IqDecimState state;
+    std::vector<int16_t> out;
+
+    downsample_iq_q15(std::span(in).first(20), out, 10, state);
+    EXPECT_EQ(out, (std::vector<int16_t>{-20480, -20480}));
+
+    state = {};
+    downsample_iq_q15(in, out, 16, state);
+    EXPECT_EQ(out, (std::vector<int16_t>{-kQ15Max, -kQ15Max}));
+}
+
+TEST(DownsampleIqQ15Test, BlockSizeDoesNotMatter) {
+    const auto raw = fm_tone(10'007);
+    std::span<const int16_t> all(raw);
+
+    for (int decim : {1, 3, 10, 16}) {
+        IqDecimState whole_state, split_state;
+        std::vector<int16_t> whole, split, part;
+        downsample_iq_q15(all, whole, decim, whole_state);
+
+        for (size_t off = 0, len = 2; off < all.size(); off += len, len *= 3) {
+            len = std::min(len, all.size() - off);
+            downsample_iq_q15(all.subspan(off, len), part, decim, split_state);
+            split.insert(split.end(), part.begin(), part.end());
+        }
+        EXPECT_EQ(whole, split) << "decim " << decim;
+        EXPECT_EQ(whole_state.count, split_state.count);
+    }
+}
+
+TEST(DemodulateFmQ15Test, TracksFloatDiscriminator) {
+    const auto raw = fm_tone(4801, kDefaultRatePlan.input_rate_hz, 20'000.0);
+    DemodStateQ15 q15_state{raw[0], raw[1]};
+    std::vector<int16_t> got;
+    demodulate_fm_q15(std::span(raw).subspan(2), got, q15_state);
+
+    ASSERT_EQ(got.size(), 4800u);
+    for (size_t n = 0; n < got.size(); n++) {
+        const std::complex<double> cur(raw[2 * n + 2], raw[2 * n + 3]);
+        const std::complex<double> prev(raw[2 * n], raw[2 * n + 1]);
+        EXPECT_LE(phase_distance(got[n], q15_phase(std::arg(cur * std::conj(prev)))),
+                  kCordicMaxErrorQ15) << "index " << n;
+    }
+    EXPECT_EQ(q15_state.prev_i, raw[raw.size() - 2]);
+    EXPECT_EQ(q15_state.prev_q, raw.back());
+}
+
+TEST(DownsampleAudioQ15Test, AveragesWithGainAcrossBlocks) {
+    std::vector<int16_t> in(2003);
+    for (size_t i = 0; i < in.size(); i++)
+        in[i] = static_cast<int16_t>(std::lround(20'000.0 * std::sin(0.01 * i)));
+
+    AudioDecimStateQ15 state;
+    std::vector<int16_t> out, part;
+    std::span<const int16_t> all(in);
+    for (auto block : {all.first(7), all.subspan(7, 996), all.subspan(1003)}) {
+        downsample_audio_q15(block, part, 5, state, 0.7f);
+        out.insert(out.end(), part.begin(), part.end());
+    }
+
+    ASSERT_EQ(out.size(), in.size() / 5);
+    EXPECT_EQ(state.counter, 3);
+    // The pre-shift drops the low iq_q15_shift(5) bits of each sum
+    for (size_t k = 0; k < out.size(); k++) {
+        double sum = 0.0;
+        for (size_t j = 0; j < 5; j++) sum += in[5 * k + j];
+        EXPECT_LE(std::abs(out[k] - std::lround(sum * 0.7 / 5.0)), 2) << "index " << k;
+    }
+}
+
+TEST(DownsampleAudioQ15Test, Saturates) {
+    const std::vector<int16_t> in(10, 30'000);
+    AudioDecimStateQ15 state;
+    std::vector<int16_t> out;
+    downsample_audio_q15(in, out, 5, state, -2.0f);
+    EXPECT_EQ(out, (std::vector<int16_t>{-32768, -32768}));
+}
+
+TEST(DeemphasisQ15Test, MatchesFloatFilter) {
+    std::vector<float> ref(4000);
+    std::vector<int16_t> pcm(ref.size());
+    std::mt19937 r(5);
+    std::uniform_int_distribution<int> d(-30'000, 30'000);
+    for (size_t i = 0; i < ref.size(); i++) {
+        pcm[i] = static_cast<int16_t>(d(r));
+        ref[i] = pcm[i];
+    }
+
+    const float alpha = deemphasis_alpha(50.0f, 48e3f);
+    DeemphasisState f32_state;
+    DeemphasisStateQ15 q15_state;
+    deemphasis(std::span(ref).first(1000), alpha, f32_state);
+    deemphasis(std::span(ref).subspan(1000), alpha, f32_state);
+    deemphasis_q15(std::span(pcm).first(1000), deemphasis_alpha_q15(50.0f, 48e3f), q15_state);
+    deemphasis_q15(std::span(pcm).subspan(1000), deemphasis_alpha_q15(50.0f, 48e3f), q15_state);
+
+    // The alpha quantisation is the only difference: one part in 2^15
+    for (size_t i = 0; i < ref.size(); i++)
+        EXPECT_NEAR(pcm[i], ref[i], 2.0f) << "index " << i;
+}
+
+TEST(FixedChainTest, MatchesFloatPcm) {
+    const auto raw = fm_tone(48'000);
+
+    FusedFmState f32_state;
+    FixedFmState q15_state;
+    std::vector<int16_t> want, got;
+    demodulate_fm_fused(raw, want, 10, 5, f32_state, 0.3f);
+    demodulate_fm_fixed(raw, got, 10, 5, q15_state, 0.3f);
+
+    ASSERT_EQ(got.size(), want.size());
+    ASSERT_EQ(got.size(), 960u);
+
+    // Signal-to-error ratio against the float chain, after the first
+    // (zero-history) sample
+    double signal = 0.0, error = 0.0;
+    for (size_t i = 1; i < got.size(); i++) {
+        signal += double(want[i]) * want[i];
+        error  += double(got[i] - want[i]) * (got[i] - want[i]);
+    }
+    EXPECT_GT(10.0 * std::log10(signal / error), 70.0);
+    EXPECT_EQ(q15_state.audio.counter, f32_state.audio.counter);
+    EXPECT_EQ(q15_state.iq.count, f32_state.iq.count);
+}
+
+TEST(FixedChainTest, MatchesStagedAcrossBlocks) {
+    const auto raw = fm_tone(40'007);
+    std::span<const int16_t> all(raw);
+
+    FixedFmState fixed_state;
+    IqDecimState iq_state;
+    DemodStateQ15 demod_state;
+    AudioDecimStateQ15 audio_state;
+    std::vector<int16_t> fixed, staged, part, iq, freq;
+
+    for (size_t off = 0, len = 6; off < all.size(); off += len, len *= 3) {
+        len = std::min(len, all.size() - off);
+        auto block = all.subspan(off, len);
+
+        demodulate_fm_fixed(block, part, 10, 5, fixed_state, 0.3f);
+        fixed.insert(fixed.end(), part.begin(), part.end());
+
+        downsample_iq_q15(block, iq, 10, iq_state);
+        demodulate_fm_q15(iq, freq, demod_state);
+        downsample_audio_q15(freq, part, 5, audio_state,
+                             0.3f * kQ15PhaseRad * kS16FullScale);
+        staged.insert(staged.end(), part.begin(), part.end());
+    }
+
+    EXPECT_EQ(fixed, staged);
+    EXPECT_EQ(fixed_state.audio.counter, audio_state.counter);
+    EXPECT_EQ(fixed_state.demod.prev_i, demod_state.prev_i);
+}
+
+TEST(FixedChainTest, RejectsShortOutput) {
+    const auto raw = fm_tone(1000);
+    FixedFmState state;
+    std::vector<int16_t> out(10);
+    EXPECT_THROW(demodulate_fm_fixed(raw, std::span(out), 10, 5, state), std::invalid_argument);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "latency_probe.hpp"
+#include "receiver.hpp"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+ToneBurstOptions short_run()
+{
+    ToneBurstOptions o;
+    o.period = 100ms;
+    o.burst = 10ms;
+    o.duration = 1'050ms;
+    return o;
+}
+
+/// @return p50 glass-to-glass latency of a receiver over a ToneBurstSource, in ms.
+double measure(std::size_t block_size, bool low_latency, std::uint64_t* bursts = nullptr)
+{
+    ToneBurstSource source(short_run(), block_size);
+    LatencyProbe probe(source, 50);   // default 10:5 plan
+
+    OutputOptions out;
+    out.max_datagram = kDefaultMaxDatagram;
+    Receiver receiver(source, "127.0.0.1", probe.port(), {}, 0.3f, out);
+    if (low_latency)
+        receiver.enable_low_latency({});
+    receiver.run();
+    probe.stop();
+
+    const auto lat = probe.latency();
+    if (bursts)
+        *bursts = lat.count;
+    return static_cast<double>(lat.percentile(0.5)) / 1e6;
+}
+
+} // namespace
+
+TEST(ToneBurstSourceTest, ReleasesBlocksInRealTime)
+{
+    ToneBurstOptions o = short_run();
+    o.duration = 100ms;
+    ToneBurstSource source(o, 24'000);   // 10 ms blocks
+    EXPECT_TRUE(source.live());
+    EXPECT_EQ(source.period_pairs(), 240'000u);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t blocks = 0;
+    while (!source.next_block().empty())
+        blocks++;
+    EXPECT_EQ(blocks, 10u);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 95ms);
+
+    EXPECT_TRUE(source.set_block_size(4'800));
+    EXPECT_EQ(source.block_size(), 4'800u);
+}
+
+TEST(ToneBurstSourceTest, SilentBetweenBursts)
+{
+    ToneBurstSource source(short_run(), 240'000);
+    const auto iq = source.next_block();
+    ASSERT_EQ(iq.size(), 480'000u);
+
+    // Constant carrier phase after the burst, moving phase inside it
+    EXPECT_EQ(iq[2 * 50'000], iq[2 * 200'000]);
+    EXPECT_EQ(iq[2 * 50'000 + 1], iq[2 * 200'000 + 1]);
+    EXPECT_NE(iq[2 * 1'000], iq[2 * 1'200]);
+}
+
+TEST(LatencyProbeTest, SmallBlocksCutGlassToGlassLatency)
+{
+    std::uint64_t bursts = 0;
+    const double fixed = measure(120'000, false, &bursts);
+    EXPECT_GE(bursts, 9u);
+    // A burst at a block boundary waits for the whole 50 ms block
+    EXPECT_GE(fixed, 45.0);
+
+    const double adaptive = measure(120'000, true, &bursts);
+    EXPECT_GE(bursts, 9u);
+    EXPECT_LT(adaptive, fixed / 2.0);
+}
+
+TEST(LatencyProbeTest, RejectsCompressedFormats)
+{
+    ToneBurstSource source(short_run(), 24'000);
+    EXPECT_THROW(LatencyProbe(source, 50, AudioFormat::Opus), std::invalid_argument);
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "metrics.hpp"
+
+using namespace std::chrono_literals;
+
+TEST(MetricsTest, BucketsCoverEveryDuration)
+{
+    std::size_t prev = 0;
+    for (std::uint64_t ns : {0ull, 1ull, 7ull, 8ull, 9ull, 15ull, 16ull, 1000ull,
+                             123'456ull, 50'000'000ull, ~0ull}) {
+        const std::size_t b = HistogramSnapshot::bucket_of(ns);
+        ASSERT_LT(b, HistogramSnapshot::kBuckets);
+        EXPECT_GE(b, prev);
+        EXPECT_GE(HistogramSnapshot::bucket_upper(b), ns);
+        if (b > 0) {
+            EXPECT_LT(HistogramSnapshot::bucket_upper(b - 1), ns);
+        }
+        prev = b;
+    }
+}
+
+TEST(MetricsTest, PercentilesWithinBucketResolution)
+{
+    LatencyHistogram h;
+    for (std::uint64_t i = 1; i <= 1000; i++)
+        h.record(i * 1000);   // 1 us .. 1 ms
+
+    const HistogramSnapshot s = h.snapshot();
+    EXPECT_EQ(s.count, 1000u);
+    EXPECT_NEAR(s.mean_ns(), 500'500.0, 1e-6);
+
+    for (const double q : {0.5, 0.99}) {
+        const double exact = q * 1e6;
+        const auto p = static_cast<double>(s.percentile(q));
+        EXPECT_GE(p, exact);
+        EXPECT_LE(p, exact * 1.125);
+    }
+    EXPECT_GE(s.percentile(1.0), 1'000'000u);
+}
+
+TEST(MetricsTest, SnapshotDifferenceCoversInterval)
+{
+    PipelineMetrics m(50'000'000);
+    m.stage(Stage::Dsp).record(1000);
+    m.add_block();
+    const MetricsSnapshot before = m.snapshot();
+
+    m.stage(Stage::Dsp).record(2'000'000);
+    m.add_block(3);
+    const MetricsSnapshot d = m.snapshot().since(before);
+
+    EXPECT_EQ(d.blocks, 1u);
+    EXPECT_EQ(d.overruns, 3u);
+    EXPECT_EQ(d[Stage::Dsp].count, 1u);
+    EXPECT_GE(d[Stage::Dsp].percentile(0.5), 2'000'000u);
+    EXPECT_EQ(d[Stage::Output].count, 0u);
+}
+
+TEST(MetricsTest, StageTimerRecordsOnlyWithMetrics)
+{
+    PipelineMetrics m(1);
+    { StageTimer t(&m, Stage::Output); }
+    { StageTimer t(nullptr, Stage::Output); }
+
+    EXPECT_EQ(m.snapshot()[Stage::Output].count, 1u);
+}
+
+TEST(MetricsTest, OverrunDetectorIgnoresJitter)
+{
+    // 120000-pair blocks at 2.4 MSPS: 50 ms each
+    OverrunDetector d(2'400'000, 5);
+    auto t = OverrunDetector::Clock::time_point{};
+
+    EXPECT_EQ(d.on_block(120'000, t), 0u);
+    for (int i = 0; i < 100; i++) {
+        t += (i % 2) ? 30ms : 70ms;
+        EXPECT_EQ(d.on_block(120'000, t), 0u);
+    }
+
+    // Catching up on queued buffers is not an overrun either
+    t += 250ms;
+    EXPECT_EQ(d.on_block(120'000, t), 0u);
+    for (int i = 0; i < 4; i++)
+        EXPECT_EQ(d.on_block(120'000, t), 0u);
+}
+
+TEST(MetricsTest, OverrunDetectorCountsLostBlocks)
+{
+    OverrunDetector d(2'400'000, 5);
+    auto t = OverrunDetector::Clock::time_point{};
+    EXPECT_EQ(d.on_block(120'000, t), 0u);
+
+    // A 500 ms stall: 10 blocks behind, 5 of them queued by the driver
+    t += 550ms;
+    EXPECT_EQ(d.on_block(120'000, t), 5u);
+
+    // Resynchronised: normal pacing reports nothing further
+    for (int i = 0; i < 10; i++) {
+        t += 50ms;
+        EXPECT_EQ(d.on_block(120'000, t), 0u);
+    }
+}
+
+TEST(MetricsTest, PrometheusTextListsStages)
+{
+    PipelineMetrics m(50'000'000);
+    m.stage(Stage::Dsp).record(1'000'000);
+    m.stage(Stage::Output).record(1'000'000);
+    m.add_block(2);
+
+    const std::string text = format_prometheus(m.snapshot(), m.block_period_ns());
+    EXPECT_NE(text.find("fm_radio_stage_seconds_count{stage=\"dsp\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("fm_radio_stage_seconds{stage=\"output\",quantile=\"0.99\"}"), std::string::npos);
+    EXPECT_NE(text.find("fm_radio_overruns_total 2\n"), std::string::npos);
+    EXPECT_EQ(text.find("stage=\"capture\""), std::string::npos);
+
+    const std::string line = format_stats_line(m.snapshot(), m.block_period_ns());
+    EXPECT_NE(line.find("1 blocks, 2 overruns"), std::string::npos);
+    EXPECT_NE(line.find("headroom"), std::string::npos);
+}
+
+TEST(MetricsTest, PrometheusDeviceLabel)
+{
+    PipelineMetrics m(50'000'000);
+    m.stage(Stage::Dsp).record(1'000'000);
+    m.add_block();
+
+    const std::string text = format_prometheus(m.snapshot(), m.block_period_ns(), "north");
+    EXPECT_NE(text.find("fm_radio_stage_seconds_count{device=\"north\",stage=\"dsp\"} 1\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("fm_radio_blocks_total{device=\"north\"} 1\n"), std::string::npos);
+    EXPECT_EQ(text.find("{stage="), std::string::npos);
+}
@@ -0,0 +1,616 @@
+#include <gtest/gtest.h>
+#include "pipeline.hpp"
+#include "test_signals.hpp"
+#include <cmath>
+#include <numbers>
+
+namespace {
+
+/// 1 kHz tone at 50 % AM depth on a carrier of amplitude 4000.
+std::vector<int16_t> am_tone(size_t pairs, double fs = kDefaultRatePlan.input_rate_hz) {
+    std::vector<int16_t> raw(2 * pairs);
+    for (size_t i = 0; i < pairs; i++) {
+        const double env = 4000.0 * (1.0 + 0.5 * std::sin(2.0 * std::numbers::pi * 1e3 * i / fs));
+        raw[2 * i]     = static_cast<int16_t>(std::lround(env * std::cos(0.3)));
+        raw[2 * i + 1] = static_cast<int16_t>(std::lround(env * std::sin(0.3)));
+    }
+    return raw;
+}
+
+/// FM IQ at 75 kHz deviation of a multiplex mpx(t) in [-1, 1].
+template <typename Mpx>
+std::vector<int16_t> fm_modulate(size_t pairs, Mpx mpx, double fs = kDefaultRatePlan.input_rate_hz) {
+    std::vector<int16_t> raw(2 * pairs);
+    double phase = 0.0;
+    for (size_t i = 0; i < pairs; i++) {
+        phase += 2.0 * std::numbers::pi * 75e3 * mpx(i / fs) / fs;
+        raw[2 * i]     = static_cast<int16_t>(std::lround(1500.0 * std::cos(phase)));
+        raw[2 * i + 1] = static_cast<int16_t>(std::lround(1500.0 * std::sin(phase)));
+    }
+    return raw;
+}
+
+/// Stereo broadcast with a 1 kHz tone on the left channel only.
+std::vector<int16_t> fm_stereo_left(size_t pairs, double fs = kDefaultRatePlan.input_rate_hz) {
+    return fm_modulate(pairs, [](double t) {
+        const double a = 2.0 * std::numbers::pi * 19e3 * t;
+        const double l = std::sin(2.0 * std::numbers::pi * 1e3 * t);
+        return 0.45 * l + 0.45 * l * std::sin(2.0 * a) + 0.1 * std::sin(a);
+    }, fs);
+}
+
+/// RMS of every @p stride-th sample from @p first, skipping the first @p skip.
+float rms(const std::vector<float>& v, size_t first = 0, size_t stride = 1, size_t skip = 0) {
+    double acc = 0.0;
+    size_t n = 0;
+    for (size_t i = first + skip * stride; i < v.size(); i += stride, n++)
+        acc += double(v[i]) * v[i];
+    return static_cast<float>(std::sqrt(acc / static_cast<double>(n)));
+}
+
+} // namespace
+
+TEST(FmPipelineTest, RecoversToneWithoutHardware) {
+    for (DecimatorType decim : {DecimatorType::Boxcar, DecimatorType::Fir}) {
+        DspOptions opts;
+        opts.decimator = decim;
+        FmPipeline pipeline(opts, 1.0f);
+
+        const auto raw = fm_tone(240'000);  // 100 ms
+        std::vector<float> audio;
+        pipeline.process_block(raw, audio);
+
+        ASSERT_NEAR(static_cast<double>(audio.size()), 4800.0, 20.0);
+
+        // Peak deviation 75 kHz at 240 kS/s -> 2 pi * 75k / 240k rad/sample
+        const float expected_peak = 2.0f * std::numbers::pi_v<float> * 75e3f / 240e3f;
+        float peak = 0.0f;
+        for (size_t i = 100; i < audio.size(); i++) peak = std::max(peak, std::abs(audio[i]));
+        EXPECT_NEAR(peak, expected_peak, 0.1f * expected_peak);
+    }
+}
+
+TEST(FmPipelineTest, FusedMatchesStaged) {
+    DspOptions fused;
+    fused.fused = true;
+    FmPipeline a(fused), b;
+
+    const auto raw = fm_tone(24'003);
+    std::vector<float> out_a, out_b;
+    for (int block = 0; block < 3; block++) {
+        a.process_block(raw, out_a);
+        b.process_block(raw, out_b);
+
+        ASSERT_EQ(out_a.size(), out_b.size());
+        for (size_t i = 0; i < out_a.size(); i++)
+            EXPECT_FLOAT_EQ(out_a[i], out_b[i]);
+    }
+}
+
+TEST(FmPipelineTest, ResetRestartsStream) {
+    FmPipeline pipeline;
+    const auto raw = fm_tone(12'345);
+    std::vector<float> first, again;
+
+    pipeline.process_block(raw, first);
+    pipeline.reset();
+    pipeline.process_block(raw, again);
+
+    EXPECT_EQ(first, again);
+}
+
+TEST(FmPipelineTest, AudioMetaFollowsTheInputIndex) {
+    FmPipeline pipeline;
+    const auto raw = fm_tone(12'345);   // not a multiple of the 50:1 decimation
+    std::vector<float> audio(pipeline.max_audio_samples(12'345));
+    const auto t0 = BlockMeta::Clock::now();
+
+    // Contiguous blocks: the index counts the audio produced, carries included
+    std::uint64_t index = 0;
+    std::uint64_t frames = 0;
+    for (int b = 0; b < 4; b++) {
+        const auto captured = t0 + std::chrono::milliseconds(b);
+        frames += pipeline.process_block(raw, {index, captured}, std::span(audio));
+        index += 12'345;
+        EXPECT_EQ(pipeline.audio_meta().captured, captured);
+    }
+    EXPECT_EQ(frames, 4u * 12'345u / 50u);
+
+    pipeline.process_block(raw, {index, t0}, std::span(audio));
+    EXPECT_EQ(pipeline.audio_meta().sample_index, frames);
+
+    // Two lost blocks move the index by their audio
+    pipeline.process_block(raw, {index + 3 * 12'345, t0}, std::span(audio));
+    EXPECT_EQ(pipeline.audio_meta().sample_index, (index + 3 * 12'345) / 50);
+
+    // After a reset it follows the input again
+    pipeline.reset();
+    pipeline.process_block(raw, {1'000'000, t0}, std::span(audio));
+    EXPECT_EQ(pipeline.audio_meta().sample_index, 20'000u);
+}
+
+TEST(FmPipelineTest, PcmOutputMatchesFloat) {
+    const auto raw = fm_tone(48'000);
+
+    for (DecimatorType decim : {DecimatorType::Boxcar, DecimatorType::Fir}) {
+        for (bool fused : {false, true}) {
+            DspOptions opts;
+            opts.decimator = decim;
+            opts.fused = fused;
+
+            FmPipeline f32_chain(opts), s16_chain(opts);
+            std::vector<float> audio;
+            std::vector<int16_t> pcm, want;
+
+            f32_chain.process_block(raw, audio);
+            s16_chain.process_block(raw, pcm);
+            dsp::float_to_s16(audio, want);
+
+            ASSERT_EQ(pcm.size(), want.size());
+            for (size_t i = 0; i < want.size(); i++)
+                EXPECT_LE(std::abs(pcm[i] - want[i]), 1) << "Index " << i;
+        }
+    }
+}
+
+TEST(FmPipelineTest, SquelchMutesSilentBlocks) {
+    const size_t pairs = 24'000;
+    const auto tone = fm_tone(pairs);             // about -27 dBFS
+    const std::vector<int16_t> quiet(2 * pairs, 2); // about -78 dBFS
+
+    for (int config = 0; config < 3; config++) {
+        DspOptions opts;
+        opts.decimator = config == 2 ? DecimatorType::Fir : DecimatorType::Boxcar;
+        opts.fused = config == 1;
+        opts.squelch_dbfs = -50.0f;
+        FmPipeline pipeline(opts, 1.0f, pairs);
+
+        size_t total = 0;
+        std::vector<float> audio;
+        for (const auto* block : {&quiet, &tone, &tone, &quiet}) {
+            pipeline.process_block(*block, audio);
+
+            if (block == &quiet) {
+                EXPECT_TRUE(audio.empty()) << "config " << config;
+                EXPECT_GT(pipeline.muted_samples(), 0u);
+                // The FIR history still rings with the tone for a few samples
+                EXPECT_LT(pipeline.level_dbfs(), -50.0f) << "config " << config;
+            } else {
+                EXPECT_FALSE(audio.empty()) << "config " << config;
+                EXPECT_EQ(pipeline.muted_samples(), 0u);
+                EXPECT_GT(pipeline.level_dbfs(), -35.0f);
+            }
+            total += audio.size() + pipeline.muted_samples();
+        }
+
+        // Muted blocks still account for the stream time they cover
+        EXPECT_NEAR(static_cast<double>(total), 4.0 * pairs / 50.0, 8.0) << "config " << config;
+    }
+}
+
+TEST(FmPipelineTest, SquelchHysteresisHoldsOpen) {
+    const size_t pairs = 24'000;
+    const auto tone = fm_tone(pairs);
+
+    // Same tone 6 dB down: below the open threshold, above the close one
+    std::vector<int16_t> weaker(tone.size());
+    for (size_t i = 0; i < tone.size(); i++) weaker[i] = static_cast<int16_t>(tone[i] / 2);
+
+    DspOptions opts;
+    opts.squelch_dbfs = -30.0f;
+    opts.squelch_hysteresis_db = 8.0f;
+    FmPipeline pipeline(opts, 1.0f, pairs);
+
+    std::vector<float> audio;
+    pipeline.process_block(weaker, audio);
+    EXPECT_TRUE(audio.empty());    // never opened
+
+    pipeline.process_block(tone, audio);
+    EXPECT_FALSE(audio.empty());
+
+    pipeline.process_block(weaker, audio);
+    EXPECT_FALSE(audio.empty());   // held open by the hysteresis
+}
+
+TEST(FmPipelineTest, SquelchCyclesKeepTheStreamIndex) {
+    const size_t pairs = 12'345;   // leaves every decimation window partly open
+    const auto tone = fm_tone(pairs);
+    const std::vector<int16_t> quiet(2 * pairs, 2);
+
+    for (int config = 0; config < 5; config++) {
+        DspOptions opts;
+        opts.decimator = config == 2 ? DecimatorType::Fir : DecimatorType::Boxcar;
+        opts.fused = config == 1;
+        opts.stereo = config == 3;
+        opts.arithmetic = config == 4 ? Arithmetic::Fixed : Arithmetic::Float;
+        FmPipeline ungated(opts, 1.0f, pairs);
+        opts.squelch_dbfs = -50.0f;
+        FmPipeline gated(opts, 1.0f, pairs);
+
+        // Muted blocks count the frames the chain would have produced, and
+        // reopening resumes the audio window where they left it
+        std::vector<float> audio(gated.max_audio_samples(pairs));
+        std::uint64_t index = 0;
+        size_t frames = 0, want = 0;
+        for (int b = 0; b < 30; b++) {
+            const auto& block = b % 3 == 2 ? quiet : tone;
+            frames += gated.process_block(block, {index, {}}, std::span(audio)) + gated.muted_samples();
+            want += ungated.process_block(block, {index, {}}, std::span(audio));
+            index += pairs;
+
+            ASSERT_EQ(gated.audio_meta().sample_index, ungated.audio_meta().sample_index)
+                << "config " << config << " block " << b;
+        }
+        EXPECT_EQ(frames, want) << "config " << config;
+    }
+}
+
+TEST(FmPipelineTest, SquelchMeasuresTheChannelInEveryChain) {
+    const size_t pairs = 24'000;
+    const auto tone = fm_tone(pairs);   // about -27 dBFS
+
+    // A strong carrier 480 kHz off: two whole turns per boxcar window, so
+    // nothing of it reaches the channel IQ
+    std::vector<int16_t> adjacent(2 * pairs);
+    for (size_t i = 0; i < pairs; i++) {
+        const double a = 2.0 * std::numbers::pi * 0.2 * static_cast<double>(i);
+        adjacent[2 * i]     = static_cast<int16_t>(std::lround(8000.0 * std::cos(a)));
+        adjacent[2 * i + 1] = static_cast<int16_t>(std::lround(8000.0 * std::sin(a)));
+    }
+
+    float staged_dbfs = 0.0f;
+    for (int config = 0; config < 3; config++) {
+        DspOptions opts;
+        opts.fused = config == 1;
+        opts.arithmetic = config == 2 ? Arithmetic::Fixed : Arithmetic::Float;
+        opts.squelch_dbfs = -50.0f;
+        FmPipeline pipeline(opts, 1.0f, pairs);
+
+        std::vector<float> audio;
+        pipeline.process_block(adjacent, audio);
+        EXPECT_TRUE(audio.empty()) << "config " << config;
+        EXPECT_LT(pipeline.level_dbfs(), -50.0f) << "config " << config;
+
+        // Same scale as the staged chain's decimated IQ
+        pipeline.process_block(tone, audio);
+        EXPECT_FALSE(audio.empty()) << "config " << config;
+        if (config == 0)
+            staged_dbfs = pipeline.level_dbfs();
+        EXPECT_NEAR(pipeline.level_dbfs(), staged_dbfs, 0.05f) << "config " << config;
+    }
+}
+
+TEST(FmPipelineTest, OpenSquelchMatchesUngated) {
+    DspOptions gated;
+    gated.squelch_dbfs = -100.0f;
+    FmPipeline a(gated), b;
+
+    const auto raw = fm_tone(24'003);
+    std::vector<int16_t> out_a, out_b;
+    for (int block = 0; block < 3; block++) {
+        a.process_block(raw, out_a);
+        b.process_block(raw, out_b);
+        EXPECT_EQ(out_a, out_b);
+    }
+}
+
+TEST(FmPipelineTest, StereoSeparatesChannels) {
+    const auto raw = fm_stereo_left(1'200'000);   // 500 ms
+
+    for (DecimatorType decim : {DecimatorType::Boxcar, DecimatorType::Fir}) {
+        DspOptions opts;
+        opts.decimator = decim;
+        opts.stereo = true;
+        opts.fused = true;   // needs the discriminator output: runs staged
+        FmPipeline pipeline(opts, 1.0f, 120'000);
+        ASSERT_EQ(pipeline.channels(), 2);
+
+        std::vector<float> audio, all;
+        for (size_t i = 0; i < raw.size(); i += 240'000) {
+            pipeline.process_block(std::span(raw).subspan(i, 240'000), audio);
+            all.insert(all.end(), audio.begin(), audio.end());
+        }
+        ASSERT_NEAR(static_cast<double>(all.size()), 2 * 24'000.0, 100.0);
+
+        // Left carries 0.9 of full deviation (2 pi * 75k / 240k rad/sample),
+        // after the pilot lock during the first 100 ms
+        const float full = 2.0f * std::numbers::pi_v<float> * 75e3f / 240e3f;
+        const float left  = rms(all, 0, 2, 4800);
+        const float right = rms(all, 1, 2, 4800);
+        EXPECT_NEAR(left, 0.9f * full / std::numbers::sqrt2_v<float>, 0.05f * full);
+        EXPECT_GT(20.0f * std::log10(left / right), 25.0f) << "decimator " << static_cast<int>(decim);
+    }
+}
+
+TEST(FmPipelineTest, DeemphasisAttenuatesTreble) {
+    const auto raw = fm_modulate(240'000, [](double t) {
+        return std::sin(2.0 * std::numbers::pi * 10e3 * t);
+    });
+
+    for (DecimatorType decim : {DecimatorType::Boxcar, DecimatorType::Fir}) {
+        for (bool fused : {false, true}) {
+            DspOptions opts;
+            opts.decimator = decim;
+            opts.fused = fused;
+            FmPipeline flat(opts);
+            opts.deemphasis_us = 50.0f;
+            FmPipeline emph(opts);
+
+            std::vector<float> a, b;
+            flat.process_block(raw, a);
+            emph.process_block(raw, b);
+            ASSERT_EQ(a.size(), b.size());
+
+            // One-pole 50 us response at 10 kHz and 48 kS/s: -9.7 dB
+            const float db = 20.0f * std::log10(rms(b, 0, 1, 100) / rms(a, 0, 1, 100));
+            EXPECT_NEAR(db, -9.7f, 0.5f) << "decimator " << static_cast<int>(decim)
+                                         << " fused " << fused;
+        }
+    }
+}
+
+TEST(FmPipelineTest, StereoPcmMatchesFloat) {
+    const auto raw = fm_stereo_left(240'000);
+    DspOptions opts;
+    opts.stereo = true;
+    opts.deemphasis_us = 75.0f;
+    FmPipeline f32_chain(opts), s16_chain(opts);
+
+    std::vector<float> audio;
+    std::vector<int16_t> pcm, want;
+    f32_chain.process_block(raw, audio);
+    s16_chain.process_block(raw, pcm);
+    dsp::float_to_s16(audio, want);
+
+    ASSERT_EQ(pcm.size(), want.size());
+    for (size_t i = 0; i < want.size(); i++)
+        EXPECT_LE(std::abs(pcm[i] - want[i]), 1) << "Index " << i;
+}
+
+TEST(FixedPointPipelineTest, MatchesFloatChain) {
+    const auto raw = fm_tone(24'003);
+    DspOptions opts;
+    FmPipeline f32_chain(opts, 0.3f);
+    opts.arithmetic = Arithmetic::Fixed;
+    FmPipeline q15_chain(opts, 0.3f);
+    FmRuntimePipeline q15_runtime(opts, 0.3f);
+
+    std::vector<float> audio, got;
+    std::vector<int16_t> want, pcm;
+    for (int block = 0; block < 3; block++) {
+        f32_chain.process_block(raw, audio);
+        dsp::float_to_s16(audio, want);
+
+        q15_chain.process_block(raw, pcm);
+        ASSERT_EQ(pcm.size(), want.size());
+        for (size_t i = block == 0 ? 1 : 0; i < want.size(); i++)
+            EXPECT_LE(std::abs(pcm[i] - want[i]), 8) << "block " << block << " index " << i;
+
+        q15_runtime.process_block(raw, got);
+        ASSERT_EQ(got.size(), pcm.size());
+        for (size_t i = 0; i < pcm.size(); i++)
+            EXPECT_FLOAT_EQ(got[i] * dsp::kS16FullScale, pcm[i]);
+    }
+}
+
+TEST(FixedPointPipelineTest, SquelchAndDeemphasis) {
+    const size_t pairs = 24'000;
+    const auto tone = fm_tone(pairs);
+    const std::vector<int16_t> quiet(2 * pairs, 2);
+
+    DspOptions opts;
+    opts.arithmetic = Arithmetic::Fixed;
+    opts.squelch_dbfs = -50.0f;
+    FmPipeline gated(opts, 0.3f, pairs);
+
+    size_t total = 0;
+    std::vector<int16_t> pcm;
+    for (const auto* block : {&quiet, &tone, &tone, &quiet}) {
+        gated.process_block(*block, pcm);
+        EXPECT_EQ(pcm.empty(), block == &quiet);
+        total += pcm.size() + gated.muted_samples();
+    }
+    EXPECT_NEAR(static_cast<double>(total), 4.0 * pairs / 50.0, 8.0);
+
+    const auto treble = fm_modulate(240'000, [](double t) {
+        return 0.2 * std::sin(2.0 * std::numbers::pi * 10e3 * t);
+    });
+    opts.squelch_dbfs.reset();
+    FmPipeline flat(opts);
+    opts.deemphasis_us = 50.0f;
+    FmPipeline emph(opts);
+
+    std::vector<float> a, b;
+    flat.process_block(treble, a);
+    emph.process_block(treble, b);
+    const float db = 20.0f * std::log10(rms(b, 0, 1, 100) / rms(a, 0, 1, 100));
+    EXPECT_NEAR(db, -9.7f, 0.5f);
+}
+
+TEST(FixedPointPipelineTest, RejectsUnsupportedChains) {
+    DspOptions opts;
+    opts.arithmetic = Arithmetic::Fixed;
+    EXPECT_NO_THROW(FmPipeline{opts});
+
+    opts.decimator = DecimatorType::Fir;
+    EXPECT_THROW(FmPipeline{opts}, std::invalid_argument);
+
+    opts.decimator = DecimatorType::Boxcar;
+    opts.stereo = true;
+    EXPECT_THROW(FmPipeline{opts}, std::invalid_argument);
+
+    opts.stereo = false;
+    opts.mode = dsp::DemodulationMode::AM;
+    EXPECT_THROW(AmPipeline{opts}, std::invalid_argument);
+}
+
+TEST(AmPipelineTest, RecoversModulationDepth) {
+    for (DecimatorType decim : {DecimatorType::Boxcar, DecimatorType::Fir}) {
+        DspOptions opts;
+        opts.decimator = decim;
+        opts.fused = true;   // no fused AM chain: must fall back to staged
+        AmPipeline pipeline(opts, 1.0f);
+
+        // 100 ms per block; the carrier tracker settles during the first
+        const auto raw = am_tone(240'000);
+        std::vector<float> audio;
+        pipeline.process_block(raw, audio);
+        pipeline.process_block(raw, audio);
+
+        ASSERT_NEAR(static_cast<double>(audio.size()), 4800.0, 20.0);
+
+        // Modulation relative to the carrier, independent of decimator gain
+        float peak = 0.0f;
+        for (size_t i = 0; i < audio.size(); i++) peak = std::max(peak, std::abs(audio[i]));
+        EXPECT_NEAR(peak, 0.5f, 0.05f) << "decimator " << static_cast<int>(decim);
+    }
+}
+
+TEST(AmPipelineTest, MakePipelineFollowsMode) {
+    DspOptions opts;
+    EXPECT_TRUE(std::holds_alternative<FmPipeline>(make_pipeline(opts, 0.3f, 1200)));
+
+    opts.mode = dsp::DemodulationMode::AM;
+    const AnyPipeline p = make_pipeline(opts, 0.3f, 1200);
+    ASSERT_TRUE(std::holds_alternative<AmPipeline>(p));
+    EXPECT_EQ(std::get<AmPipeline>(p).options().mode, dsp::DemodulationMode::AM);
+
+    // Stereo and de-emphasis are FM only
+    opts.stereo = true;
+    EXPECT_EQ(std::get<AmPipeline>(make_pipeline(opts, 0.3f, 1200)).channels(), 1);
+}
+
+TEST(RatePlanTest, MakePipelinePicksCompiledChain) {
+    DspOptions opts;
+    opts.rates = {1'920'000, 8, 5};
+    EXPECT_TRUE((std::holds_alternative<DemodPipeline<dsp::DemodulationMode::FM, 8, 5>>(
+        make_pipeline(opts, 0.3f, 1200))));
+
+    // The factors pick the chain, whatever the input rate
+    opts.rates = {4'000'000, 16, 5};
+    EXPECT_TRUE((std::holds_alternative<DemodPipeline<dsp::DemodulationMode::FM, 16, 5>>(
+        make_pipeline(opts, 0.3f, 1200))));
+
+    opts.rates = {1'200'000, 6, 4};
+    const AnyPipeline fm = make_pipeline(opts, 0.3f, 1200);
+    ASSERT_TRUE(std::holds_alternative<FmRuntimePipeline>(fm));
+    EXPECT_EQ(std::get<FmRuntimePipeline>(fm).decim_iq(), 6);
+    EXPECT_EQ(std::get<FmRuntimePipeline>(fm).decim_audio(), 4);
+
+    opts.mode = dsp::DemodulationMode::AM;
+    EXPECT_TRUE(std::holds_alternative<AmRuntimePipeline>(make_pipeline(opts, 0.3f, 1200)));
+    opts.rates = {3'840'000, 16, 5};
+    EXPECT_TRUE((std::holds_alternative<DemodPipeline<dsp::DemodulationMode::AM, 16, 5>>(
+        make_pipeline(opts, 0.3f, 1200))));
+}
+
+TEST(RatePlanTest, RuntimeChainMatchesCompiledChain) {
+    // Boxcar chains share the kernels, so the factor source must not matter
+    const auto fm_raw = fm_tone(24'003);
+    const auto am_raw = am_tone(24'003);
+
+    for (bool fused : {false, true}) {
+        DspOptions opts;
+        opts.fused = fused;
+        FmPipeline fixed(opts);
+        FmRuntimePipeline runtime(opts);
+        opts.mode = dsp::DemodulationMode::AM;
+        AmPipeline am_fixed(opts);
+        AmRuntimePipeline am_runtime(opts);
+
+        std::vector<float> want, got;
+        for (int block = 0; block < 3; block++) {
+            fixed.process_block(fm_raw, want);
+            runtime.process_block(fm_raw, got);
+            ASSERT_EQ(got, want) << "fused " << fused;
+
+            am_fixed.process_block(am_raw, want);
+            am_runtime.process_block(am_raw, got);
+            ASSERT_EQ(got, want) << "fused " << fused;
+        }
+    }
+}
+
+TEST(RatePlanTest, RecoversToneAtEveryPlan) {
+    const RatePlan plans[] = {
+        {1'920'000, 8, 5},
+        {3'840'000, 16, 5},
+        {1'200'000, 6, 4},   // runtime chain, 50 kS/s audio
+    };
+
+    for (const RatePlan& plan : plans) {
+        for (DecimatorType decim : {DecimatorType::Boxcar, DecimatorType::Fir}) {
+            DspOptions opts;
+            opts.rates = plan;
+            opts.decimator = decim;
+            AnyPipeline pipeline = make_pipeline(opts, 1.0f, 1200);
+
+            // 100 ms
+            const auto raw = fm_tone(static_cast<size_t>(plan.input_rate_hz / 10),
+                                     static_cast<double>(plan.input_rate_hz));
+            std::vector<float> audio;
+            std::visit([&](auto& p) { p.process_block(raw, audio); }, pipeline);
+
+            const double expected_size = static_cast<double>(plan.audio_rate_hz()) / 10.0;
+            EXPECT_NEAR(static_cast<double>(audio.size()), expected_size, 40.0);
+
+            const float expected_peak = 2.0f * std::numbers::pi_v<float> * 75e3f /
+                                        static_cast<float>(plan.iq_rate_hz());
+            float peak = 0.0f;
+            for (size_t i = 100; i < audio.size(); i++) peak = std::max(peak, std::abs(audio[i]));
+            EXPECT_NEAR(peak, expected_peak, 0.1f * expected_peak)
+                << plan.input_rate_hz << " Hz, decimator " << static_cast<int>(decim);
+        }
+    }
+}
+
+TEST(RatePlanTest, StereoAtCompiledPlan) {
+    DspOptions opts;
+    opts.rates = {1'920'000, 8, 5};
+    opts.stereo = true;
+    opts.decimator = DecimatorType::Fir;
+    DemodPipeline<dsp::DemodulationMode::FM, 8, 5> pipeline(opts, 1.0f, 192'000);
+
+    const auto raw = fm_stereo_left(960'000, 1.92e6);   // 500 ms
+    std::vector<float> audio, all;
+    for (size_t i = 0; i < raw.size(); i += 2 * 192'000) {
+        pipeline.process_block(std::span(raw).subspan(i, 2 * 192'000), audio);
+        all.insert(all.end(), audio.begin(), audio.end());
+    }
+
+    const float left  = rms(all, 0, 2, 4800);
+    const float right = rms(all, 1, 2, 4800);
+    EXPECT_GT(20.0f * std::log10(left / right), 25.0f);
+}
+
+TEST(RatePlanTest, RejectsUnsupportedPlans) {
+    EXPECT_THROW(validate_rate_plan({0, 10, 5}), std::invalid_argument);
+    EXPECT_THROW(validate_rate_plan({2'400'000, 0, 5}), std::invalid_argument);
+    EXPECT_THROW(validate_rate_plan({2'400'000, 10, kMaxDecimation + 1}), std::invalid_argument);
+    EXPECT_THROW(validate_rate_plan({2'400'000, 7, 5}), std::invalid_argument);   // 68571.4 Hz
+    EXPECT_NO_THROW(validate_rate_plan({2'000'000, 8, 5}));
+
+    DspOptions opts;
+    opts.rates = {1'920'000, 8, 5};
+    EXPECT_THROW(FmPipeline{opts}, std::invalid_argument);   // compiled for 10:5
+    EXPECT_NO_THROW(FmRuntimePipeline{opts});
+
+    // The stereo decoder runs at 240 kS/s into 48 kS/s only
+    opts.rates = {1'200'000, 6, 4};
+    opts.stereo = true;
+    EXPECT_THROW(make_pipeline(opts, 0.3f, 1200), std::invalid_argument);
+    opts.mode = dsp::DemodulationMode::AM;
+    EXPECT_NO_THROW(make_pipeline(opts, 0.3f, 1200));
+}
+
+TEST(RatePlanTest, CompiledPlanLookup) {
+    ASSERT_TRUE(compiled_rate_plan(1'920'000));
+    EXPECT_EQ(*compiled_rate_plan(1'920'000), (RatePlan{1'920'000, 8, 5}));
+    EXPECT_EQ(*compiled_rate_plan(kDefaultRatePlan.input_rate_hz), kDefaultRatePlan);
+    EXPECT_FALSE(compiled_rate_plan(2'000'000));
+
+    for (const RatePlan& plan : kCompiledRatePlans) {
+        EXPECT_NO_THROW(validate_rate_plan(plan));
+        EXPECT_EQ(plan.audio_rate_hz(), 48'000);
+    }
+}
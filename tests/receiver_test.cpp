@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+#include "receiver.hpp"
+#include "datagram_receiver.hpp"
+#include <endian.h>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+/// Tunable source whose IQ amplitude encodes the tuned frequency.
+class FakeTuner final : public SampleSource {
+public:
+    explicit FakeTuner(std::size_t block_size, bool tunable = true)
+        : block_(2 * block_size), tunable_{tunable} {}
+
+    std::span<const int16_t> next_block() override
+    {
+        if (blocks_left_ == 0)
+            return {};
+        if (blocks_left_ == stall_at_)
+            std::this_thread::sleep_for(stall_);
+        blocks_left_--;
+
+        // 100 MHz -> amplitude 1000, i.e. 20 * log10(1000 / 32768) dBFS
+        const auto a = static_cast<int16_t>(freq_hz_ / 100'000);
+        for (std::size_t i = 0; i < block_.size(); i += 2) {
+            block_[i] = a;
+            block_[i + 1] = 0;
+        }
+        reads_since_tune_++;
+        return block_;
+    }
+
+    [[nodiscard]] std::size_t block_size() const noexcept override { return block_.size() / 2; }
+    [[nodiscard]] long long sample_rate() const noexcept override { return kDefaultRatePlan.input_rate_hz; }
+    [[nodiscard]] bool live() const noexcept override { return true; }
+
+    bool retune(long long frequency_hz) override
+    {
+        if (!tunable_)
+            return false;
+        freq_hz_ = frequency_hz;
+        retunes_++;
+        reads_since_tune_ = 0;
+        return true;
+    }
+
+    std::size_t blocks_left_ = 1000;
+    std::size_t stall_at_ = 0;             ///< Refill delayed by stall_, counted down like blocks_left_
+    std::chrono::milliseconds stall_{0};
+    int retunes_ = 0;
+    int reads_since_tune_ = 0;
+
+private:
+    std::vector<int16_t> block_;
+    bool tunable_;
+    long long freq_hz_ = 0;
+};
+
+/// Band with one unmodulated carrier of amplitude 8000, seen from the tuned LO.
+class FakeBand final : public SampleSource {
+public:
+    FakeBand(std::size_t block_size, long long station_hz)
+        : block_(2 * block_size), station_hz_{station_hz} {}
+
+    std::span<const int16_t> next_block() override
+    {
+        if (blocks_left_ == 0)
+            return {};
+        blocks_left_--;
+
+        const double step = 2.0 * M_PI * static_cast<double>(station_hz_ - lo_hz_) /
+                            static_cast<double>(sample_rate());
+        for (std::size_t i = 0; i < block_.size(); i += 2) {
+            block_[i]     = static_cast<int16_t>(std::lround(8000.0 * std::cos(phase_)));
+            block_[i + 1] = static_cast<int16_t>(std::lround(8000.0 * std::sin(phase_)));
+            phase_ = std::remainder(phase_ + step, 2.0 * M_PI);
+        }
+        return block_;
+    }
+
+    [[nodiscard]] std::size_t block_size() const noexcept override { return block_.size() / 2; }
+    [[nodiscard]] long long sample_rate() const noexcept override { return kDefaultRatePlan.input_rate_hz; }
+    [[nodiscard]] bool live() const noexcept override { return true; }
+
+    bool retune(long long frequency_hz) override
+    {
+        lo_hz_ = frequency_hz;
+        return true;
+    }
+
+    std::size_t blocks_left_ = 1000;
+
+private:
+    std::vector<int16_t> block_;
+    long long station_hz_;
+    long long lo_hz_ = 0;
+    double phase_ = 0.0;
+};
+
+/// Rows of `frequency_hz,power_dbfs`.
+std::vector<std::pair<long long, double>> parse_csv(const std::string& text)
+{
+    std::vector<std::pair<long long, double>> rows;
+    std::istringstream in(text);
+    long long f;
+    char comma;
+    double db;
+    while (in >> f >> comma >> db)
+        rows.emplace_back(f, db);
+    return rows;
+}
+
+double expected_dbfs(long long freq_hz)
+{
+    return 20.0 * std::log10(static_cast<double>(freq_hz / 100'000) / 32768.0);
+}
+
+} // namespace
+
+TEST(ReceiverScanTest, ReportsPowerPerFrequency)
+{
+    FakeTuner source(24'000);   // 10 ms blocks
+    Receiver receiver(source);
+
+    ScanOptions scan;
+    scan.frequencies_hz = {88'000'000, 100'000'000, 108'000'000};
+    scan.dwell_ms = 50.0;
+
+    std::ostringstream out;
+    receiver.run_scan(scan, out);
+
+    const auto rows = parse_csv(out.str());
+    ASSERT_EQ(rows.size(), 3u);
+    for (std::size_t i = 0; i < rows.size(); i++) {
+        EXPECT_EQ(rows[i].first, scan.frequencies_hz[i]);
+        EXPECT_NEAR(rows[i].second, expected_dbfs(scan.frequencies_hz[i]), 0.05);
+    }
+
+    EXPECT_EQ(source.retunes_, 3);
+    EXPECT_EQ(source.reads_since_tune_, 5);   // dwell / block period
+    EXPECT_EQ(source.blocks_left_, 1000u - 15u);
+}
+
+TEST(ReceiverScanTest, MeasuresOnlyTheTunedChannel)
+{
+    FakeBand source(24'000, 100'000'000);
+    Receiver receiver(source);
+
+    ScanOptions scan;
+    scan.frequencies_hz = {99'800'000, 100'000'000, 100'200'000};
+    scan.dwell_ms = 20.0;
+
+    std::ostringstream out;
+    receiver.run_scan(scan, out);
+
+    // The whole capture holds the carrier at every step; the channel only at its own
+    const auto rows = parse_csv(out.str());
+    ASSERT_EQ(rows.size(), 3u);
+    EXPECT_NEAR(rows[1].second, 20.0 * std::log10(8000.0 / 32768.0), 0.1);
+    EXPECT_GT(rows[1].second, rows[0].second + 10.0);
+    EXPECT_GT(rows[1].second, rows[2].second + 10.0);
+}
+
+TEST(ReceiverScanTest, RepeatsPassesUntilSourceEnds)
+{
+    FakeTuner source(24'000);
+    source.blocks_left_ = 25;
+    Receiver receiver(source);
+
+    ScanOptions scan;
+    scan.frequencies_hz = {90'000'000, 95'000'000};
+    scan.dwell_ms = 10.0;
+    scan.passes = 0;
+
+    std::ostringstream out;
+    receiver.run_scan(scan, out);
+
+    // One block per dwell; the 26th read ends the scan mid-sweep
+    EXPECT_EQ(parse_csv(out.str()).size(), 25u);
+    EXPECT_EQ(source.retunes_, 26);
+}
+
+TEST(ReceiverScanTest, RejectsUntunableSource)
+{
+    FakeTuner source(24'000, false);
+    Receiver receiver(source);
+
+    ScanOptions scan;
+    scan.frequencies_hz = {100'000'000};
+
+    std::ostringstream out;
+    EXPECT_THROW(receiver.run_scan(scan, out), std::runtime_error);
+    EXPECT_FALSE(receiver.retune(100'000'000));
+    EXPECT_TRUE(out.str().empty());
+}
+
+TEST(ReceiverScanTest, RetuneLeavesAGapInTheIndex)
+{
+    DatagramReceiver rx;
+    FakeTuner source(24'000);   // 480 audio frames per block
+    source.blocks_left_ = 2;
+
+    OutputOptions output;
+    output.max_datagram = kDefaultMaxDatagram;
+    Receiver receiver(source, "127.0.0.1", rx.port(), {}, 0.3f, output);
+    receiver.run();
+    ASSERT_FALSE(rx.drain().empty());
+
+    // The buffers queued at the old frequency are dropped with the time spent
+    ASSERT_TRUE(receiver.retune(100'000'000));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    source.blocks_left_ = 1;
+    receiver.run();
+
+    const auto got = rx.receive(1);
+    ASSERT_EQ(got.size(), 1u);
+    AudioPacketHeader h{};
+    std::memcpy(&h, got[0].data(), sizeof(h));
+    EXPECT_GE(be64toh(h.sample_index), 2u * 480u + 50u * 48u);
+}
+
+TEST(ReceiverTest, OverrunLeavesAGapWithoutStats)
+{
+    DatagramReceiver rx;
+    FakeTuner source(24'000);   // 10 ms blocks, 480 audio frames each
+    source.blocks_left_ = 4;
+    source.stall_at_ = 2;       // third refill 50 ms late: the hardware dropped blocks
+    source.stall_ = std::chrono::milliseconds(50);
+
+    OutputOptions output;
+    output.format = AudioFormat::S16;   // one datagram per block
+    output.max_datagram = kDefaultMaxDatagram;
+    Receiver receiver(source, "127.0.0.1", rx.port(), {}, 0.3f, output);
+    receiver.run();
+
+    const auto got = rx.receive(4);
+    ASSERT_EQ(got.size(), 4u);
+    std::uint64_t index[4];
+    for (std::size_t d = 0; d < got.size(); d++) {
+        AudioPacketHeader h{};
+        std::memcpy(&h, got[d].data(), sizeof(h));
+        index[d] = be64toh(h.sample_index);
+    }
+    EXPECT_EQ(index[1], 480u);
+    EXPECT_GE(index[2], 2u * 480u + 3u * 480u);
+    EXPECT_EQ(index[3], index[2] + 480u);
+}
@@ -0,0 +1,396 @@
+// Soak benchmark: the whole DSP chain on minutes of synthetic FM, with the
+// per-block processing time held against the capture deadline.
+//
+//   make soak SOAK_ARGS="--seconds 600 --config fir/fast --json soak.json"
+//
+// The micro-benchmarks in dsp_benchmark.cpp repeat one short block, so they
+// never see slow state drift, denormals building up in decaying filter
+// state, or a board throttling once it is warm. This runner feeds a
+// deterministic multi-tone FM station through make_pipeline() block after
+// block and writes a JSON report: sustained throughput, the distribution of
+// block times, the worst block against its period, and one summary per
+// window to expose trends over the run.
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numbers>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "metrics.hpp"
+#include "pipeline.hpp"
+
+// Vectors only pass between functions of this file, so the ABI note for
+// 32-byte vectors without AVX does not apply
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Eight lanes of GCC vector extensions: SSE/AVX on x86 and NEON on ARM,
+// from one source and without a runtime dispatch of its own
+constexpr std::size_t kLanes = 8;
+using v8f = float __attribute__((vector_size(kLanes * sizeof(float))));
+using v8u = std::uint32_t __attribute__((vector_size(kLanes * sizeof(std::uint32_t))));
+using v8i = std::int32_t __attribute__((vector_size(kLanes * sizeof(std::int32_t))));
+
+/// @return Nearest integer of every lane (|x| < 2^22), ties to even.
+inline v8f round_lanes(v8f x) noexcept
+{
+    const v8f magic = v8f{} + 12'582'912.0f; // 1.5 * 2^23
+    return (x + magic) - magic;
+}
+
+/// @return sin(pi * y) for y in [-1, 1].
+inline v8f sin_pi(v8f y) noexcept
+{
+    // Fold onto [-1/2, 1/2]: sin(pi - a) = sin(a)
+    const v8f one = v8f{} + 1.0f;
+    y = y > 0.5f ? one - y : (y < -0.5f ? -one - y : y);
+
+    // Taylor series to x^11: below 6e-8 on [-pi/2, pi/2]
+    const v8f x = y * std::numbers::pi_v<float>;
+    const v8f x2 = x * x;
+    v8f r = x2 * (-1.0f / 39'916'800.0f) + 1.0f / 362'880.0f;
+    r = r * x2 - 1.0f / 5'040.0f;
+    r = r * x2 + 1.0f / 120.0f;
+    r = r * x2 - 1.0f / 6.0f;
+    r = r * x2;
+    return x + x * r;
+}
+
+/// @return sin(pi * y) taking a 32-bit phase (2^32 = one turn).
+inline v8f sin_turns(v8u phase) noexcept
+{
+    const v8f y = __builtin_convertvector(reinterpret_cast<v8i>(phase), v8f) * (1.0f / 2'147'483'648.0f);
+    return sin_pi(y);
+}
+
+/**
+ * @brief Deterministic FM station with a three-tone message.
+ *
+ * Every pair is a closed-form function of its index: each tone phase is its
+ * index times a 32-bit increment, wrapping exactly, so minutes of signal
+ * carry no accumulated rounding and any block can be regenerated alone.
+ * The carrier phase is the tones' sum weighted by their modulation indices
+ * (FM by a tone of deviation D at f is a phase of (D / f) sin(2 pi f t)).
+ *
+ * Every `quiet_every` pairs the modulation stops for `quiet_for` pairs:
+ * an unmodulated, noise-free carrier demodulates to exact zeros, so the
+ * de-emphasis and decimator state decays towards the denormal range as it
+ * would on a silent station. The rest carries a low dither of noise,
+ * hashed from the pair index as well.
+ */
+class SyntheticFm {
+public:
+    explicit SyntheticFm(long long rate) : rate_{static_cast<double>(rate)}
+    {
+        for (std::size_t k = 0; k < kTones; k++) {
+            inc_[k] = static_cast<std::uint32_t>(std::llround(kToneHz[k] / rate_ * 4'294'967'296.0));
+            beta_[k] = static_cast<float>(kDeviationHz[k] / kToneHz[k] / std::numbers::pi);
+        }
+        quiet_every_ = static_cast<std::uint64_t>(10.0 * rate_);
+        quiet_for_ = static_cast<std::uint64_t>(2.0 * rate_);
+    }
+
+    /// Write pairs @p first .. first + iq.size() / 2 as interleaved int16.
+    void generate(std::uint64_t first, std::span<int16_t> iq) noexcept
+    {
+        const std::size_t pairs = iq.size() / 2;
+        alignas(32) std::int32_t i_out[kLanes];
+        alignas(32) std::int32_t q_out[kLanes];
+
+        for (std::size_t n = 0; n < pairs; n += kLanes) {
+            const std::uint64_t index = first + n;
+            const bool quiet = index % quiet_every_ >= quiet_every_ - quiet_for_;
+
+            v8u lane{};
+            for (std::size_t l = 0; l < kLanes; l++)
+                lane[l] = static_cast<std::uint32_t>(index + l);
+
+            // Carrier phase in half turns
+            v8f phase{};
+            if (!quiet)
+                for (std::size_t k = 0; k < kTones; k++)
+                    phase += beta_[k] * sin_turns(lane * inc_[k]);
+            phase -= 2.0f * round_lanes(phase * 0.5f);
+
+            v8f i = kAmplitude * sin_pi(fold(phase + 0.5f));
+            v8f q = kAmplitude * sin_pi(phase);
+            if (!quiet) {
+                i += noise(lane);
+                q += noise(lane ^ 0x5BD1E995u);
+            }
+
+            const v8i ii = __builtin_convertvector(round_lanes(i), v8i);
+            const v8i qi = __builtin_convertvector(round_lanes(q), v8i);
+            std::memcpy(i_out, &ii, sizeof(ii));
+            std::memcpy(q_out, &qi, sizeof(qi));
+
+            const std::size_t m = std::min(kLanes, pairs - n);
+            for (std::size_t l = 0; l < m; l++) {
+                iq[2 * (n + l)]     = static_cast<int16_t>(i_out[l]);
+                iq[2 * (n + l) + 1] = static_cast<int16_t>(q_out[l]);
+            }
+        }
+    }
+
+private:
+    static constexpr std::size_t kTones = 3;
+    static constexpr double kToneHz[kTones]      = {400.0, 1'000.0, 3'300.0};
+    static constexpr double kDeviationHz[kTones] = {20'000.0, 15'000.0, 10'000.0};
+    static constexpr float kAmplitude = 8'192.0f;
+    static constexpr float kNoise = 48.0f;
+
+    double rate_;
+    std::uint32_t inc_[kTones];
+    float beta_[kTones];
+    std::uint64_t quiet_every_;
+    std::uint64_t quiet_for_;
+
+    /// @return @p y moved into [-1, 1) by whole turns.
+    static v8f fold(v8f y) noexcept { return y - 2.0f * round_lanes(y * 0.5f); }
+
+    /// @return Uniform noise of +-kNoise per lane, a 32-bit integer hash of @p key.
+    static v8f noise(v8u key) noexcept
+    {
+        v8u x = key * 0x9E3779B1u;
+        x ^= x >> 16;
+        x *= 0x7FEB352Du;
+        x ^= x >> 15;
+        x *= 0x846CA68Bu;
+        x ^= x >> 16;
+        return __builtin_convertvector(reinterpret_cast<v8i>(x), v8f) * (kNoise / 2'147'483'648.0f);
+    }
+};
+
+struct SoakOptions {
+    double seconds = 120.0;        ///< Wall-clock run time
+    std::size_t block = 120'000;   ///< Pairs per block (50 ms at 2.4 MS/s)
+    double window_s = 10.0;        ///< Wall time per trend window
+    bool realtime = false;         ///< Release blocks at the capture rate
+    std::string config = "boxcar/exact";
+    std::string json;              ///< Report file (empty = stdout)
+};
+
+/// @return DSP options of a named chain, or false for an unknown name.
+bool parse_config(std::string_view name, DspOptions& o)
+{
+    o = {};
+    o.deemphasis_us = 50.0f;
+    if (name == "boxcar/exact") return true;
+    o.discriminator = dsp::FmDiscriminator::Fast;
+    if (name == "boxcar/fast") return true;
+    if (name == "fused/fast") { o.fused = true; return true; }
+    if (name == "fir/fast") { o.decimator = DecimatorType::Fir; return true; }
+    if (name == "stereo") { o.stereo = true; return true; }
+    if (name == "fixed") {
+        o.discriminator = dsp::FmDiscriminator::Exact;
+        o.arithmetic = Arithmetic::Fixed;
+        return true;
+    }
+    return false;
+}
+
+bool parse_number(std::string_view sv, double& out)
+{
+    const auto r = std::from_chars(sv.data(), sv.data() + sv.size(), out);
+    return r.ec == std::errc{} && r.ptr == sv.data() + sv.size();
+}
+
+/// Block times of one trend window
+struct Window {
+    double start_s = 0.0;
+    std::uint64_t blocks = 0;
+    double busy_s = 0.0;
+    std::uint64_t max_ns = 0;
+    double audio_energy = 0.0;
+    std::uint64_t audio_samples = 0;
+};
+
+double ms(std::uint64_t ns) { return static_cast<double>(ns) / 1e6; }
+
+int run(const SoakOptions& opts)
+{
+    DspOptions dsp;
+    if (!parse_config(opts.config, dsp)) {
+        std::cerr << "Unknown config '" << opts.config
+                  << "', expected boxcar/exact, boxcar/fast, fused/fast, fir/fast, stereo or fixed\n";
+        return 1;
+    }
+
+    AnyPipeline pipeline = make_pipeline(dsp, 0.3f, opts.block);
+    const long long rate = dsp.rates.input_rate_hz;
+    const auto deadline = std::chrono::nanoseconds(
+        static_cast<long long>(opts.block) * 1'000'000'000LL / rate);
+
+    SyntheticFm station(rate);
+    std::vector<int16_t> raw(opts.block * 2);
+    std::vector<float> audio(std::visit([&](const auto& p) { return p.max_audio_samples(opts.block); },
+                                        pipeline));
+
+    LatencyHistogram block_times;
+    std::uint64_t max_ns = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t blocks = 0;
+    double busy_s = 0.0;
+    std::vector<Window> windows;
+    Window window;
+
+    const auto start = Clock::now();
+    const auto stop = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(opts.seconds));
+    auto window_end = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(opts.window_s));
+
+    std::visit([&](auto& p) {
+        for (auto now = start; now < stop; blocks++) {
+            station.generate(blocks * opts.block, raw);
+            if (opts.realtime)
+                std::this_thread::sleep_until(start + deadline * (blocks + 1));
+
+            const auto t0 = Clock::now();
+            const std::size_t n = p.process_block(raw, std::span(audio));
+            now = Clock::now();
+
+            const auto ns = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - t0).count());
+            block_times.record(ns);
+            max_ns = std::max(max_ns, ns);
+            misses += ns > static_cast<std::uint64_t>(deadline.count());
+            busy_s += static_cast<double>(ns) / 1e9;
+
+            window.blocks++;
+            window.busy_s += static_cast<double>(ns) / 1e9;
+            window.max_ns = std::max(window.max_ns, ns);
+            for (std::size_t i = 0; i < n; i++)
+                window.audio_energy += static_cast<double>(audio[i]) * audio[i];
+            window.audio_samples += n;
+
+            if (now >= window_end) {
+                windows.push_back(window);
+                window = {};
+                window.start_s = std::chrono::duration<double>(now - start).count();
+                window_end += std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(opts.window_s));
+            }
+        }
+    }, pipeline);
+    if (window.blocks)
+        windows.push_back(window);
+
+    const double wall_s = std::chrono::duration<double>(Clock::now() - start).count();
+    const double pairs = static_cast<double>(blocks * opts.block);
+    const double msps = pairs / busy_s / 1e6;
+    const auto t = block_times.snapshot();
+    const auto pct = [&](double q) { return ms(std::min(t.percentile(q), max_ns)); };
+
+    std::ostringstream js;
+    js << std::fixed << std::setprecision(4)
+       << "{\n"
+       << "  \"config\": \"" << opts.config << "\",\n"
+       << "  \"sample_rate_hz\": " << rate << ",\n"
+       << "  \"block_pairs\": " << opts.block << ",\n"
+       << "  \"realtime\": " << (opts.realtime ? "true" : "false") << ",\n"
+       << "  \"wall_seconds\": " << wall_s << ",\n"
+       << "  \"stream_seconds\": " << pairs / static_cast<double>(rate) << ",\n"
+       << "  \"blocks\": " << blocks << ",\n"
+       << "  \"msps\": " << msps << ",\n"
+       << "  \"rt_factor\": " << msps * 1e6 / static_cast<double>(rate) << ",\n"
+       << "  \"deadline_ms\": " << ms(static_cast<std::uint64_t>(deadline.count())) << ",\n"
+       << "  \"block_ms\": {\"mean\": " << t.mean_ns() / 1e6 << ", \"p50\": " << pct(0.5)
+       << ", \"p90\": " << pct(0.9) << ", \"p99\": " << pct(0.99) << ", \"p999\": " << pct(0.999)
+       << ", \"max\": " << ms(max_ns) << "},\n"
+       << "  \"worst_margin\": " << (max_ns ? static_cast<double>(deadline.count()) / static_cast<double>(max_ns) : 0.0)
+       << ",\n"
+       << "  \"deadline_misses\": " << misses << ",\n"
+       << "  \"windows\": [";
+    for (std::size_t w = 0; w < windows.size(); w++) {
+        const Window& win = windows[w];
+        const double rms = win.audio_samples
+            ? std::sqrt(win.audio_energy / static_cast<double>(win.audio_samples)) : 0.0;
+        js << (w ? ",\n" : "\n")
+           << "    {\"start_s\": " << win.start_s << ", \"blocks\": " << win.blocks
+           << ", \"mean_ms\": " << win.busy_s * 1e3 / static_cast<double>(win.blocks)
+           << ", \"max_ms\": " << ms(win.max_ns)
+           << ", \"msps\": " << static_cast<double>(win.blocks * opts.block) / win.busy_s / 1e6
+           << ", \"audio_rms\": " << std::setprecision(6) << rms << std::setprecision(4) << '}';
+    }
+    js << "\n  ]\n}\n";
+
+    if (opts.json.empty()) {
+        std::cout << js.str();
+    } else {
+        std::ofstream out(opts.json);
+        out << js.str();
+        if (!out) {
+            std::cerr << "Failed to write " << opts.json << '\n';
+            return 1;
+        }
+    }
+
+    std::cerr << "Soak " << opts.config << ": " << blocks << " blocks in " << wall_s << " s, "
+              << msps << " MSPS, worst block " << ms(max_ns) << " ms of "
+              << ms(static_cast<std::uint64_t>(deadline.count())) << " ms, "
+              << misses << " deadline misses\n";
+    return misses ? 2 : 0;
+}
+
+void print_usage(std::string_view prog)
+{
+    std::cerr << "Usage: " << prog << " [--seconds <s>] [--block <pairs>] [--window <s>]\n"
+                 "       [--config boxcar/exact|boxcar/fast|fused/fast|fir/fast|stereo|fixed]\n"
+                 "       [--realtime] [--json <file>]\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    SoakOptions opts;
+    for (int i = 1; i < argc; i++) {
+        const std::string_view arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        double v = 0.0;
+
+        if (arg == "--realtime") {
+            opts.realtime = true;
+        } else if (has_value && arg == "--config") {
+            opts.config = argv[++i];
+        } else if (has_value && arg == "--json") {
+            opts.json = argv[++i];
+        } else if (has_value && arg == "--seconds" && parse_number(argv[++i], v) && v > 0.0) {
+            opts.seconds = v;
+        } else if (has_value && arg == "--window" && parse_number(argv[++i], v) && v > 0.0) {
+            opts.window_s = v;
+        } else if (has_value && arg == "--block" && parse_number(argv[++i], v) && v >= 1.0) {
+            opts.block = static_cast<std::size_t>(v);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    try {
+        return run(opts);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include "spectrum_tap.hpp"
+#include "datagram_receiver.hpp"
+#include <arpa/inet.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <endian.h>
+#include <numbers>
+
+namespace {
+
+constexpr long long kRate = 2'400'000;
+
+/// @return @p pairs of a complex tone at @p hz, a quarter of full scale (-12 dBFS).
+std::vector<int16_t> tone(std::size_t pairs, double hz, std::uint64_t first = 0)
+{
+    std::vector<int16_t> iq(pairs * 2);
+    for (std::size_t n = 0; n < pairs; n++) {
+        const double ph = 2.0 * std::numbers::pi * hz * static_cast<double>(first + n) / kRate;
+        iq[2 * n]     = static_cast<int16_t>(std::lround(8'192.0 * std::cos(ph)));
+        iq[2 * n + 1] = static_cast<int16_t>(std::lround(8'192.0 * std::sin(ph)));
+    }
+    return iq;
+}
+
+SpectrumPacketHeader decode_header(const std::vector<char>& d)
+{
+    SpectrumPacketHeader h{};
+    std::memcpy(&h, d.data(), sizeof(h));
+    h.magic = ntohl(h.magic);
+    h.sequence = ntohl(h.sequence);
+    h.sample_index = be64toh(h.sample_index);
+    h.capture_ns = be64toh(h.capture_ns);
+    h.sample_rate_hz = ntohl(h.sample_rate_hz);
+    h.bins = ntohs(h.bins);
+    h.averages = ntohs(h.averages);
+    h.floor_db = static_cast<int16_t>(ntohs(static_cast<uint16_t>(h.floor_db)));
+    h.range_db = ntohs(h.range_db);
+    h.fft_size = ntohl(h.fft_size);
+    return h;
+}
+
+SpectrumOptions to(const DatagramReceiver& rx)
+{
+    SpectrumOptions opts;
+    opts.udp_ip = "127.0.0.1";
+    opts.udp_port = rx.port();
+    opts.queue_depth = 128;   // the idle-priority worker may not run until stop()
+    return opts;
+}
+
+} // namespace
+
+TEST(SpectrumTapTest, RejectsInvalidShapes) {
+    DatagramReceiver rx;
+    auto opts = to(rx);
+
+    opts.bins = 1000;
+    EXPECT_THROW(SpectrumTap(opts, kRate), std::invalid_argument);
+    opts.bins = 2048;
+    opts.fft_size = 2048;
+    EXPECT_THROW(SpectrumTap(opts, kRate), std::invalid_argument);
+    opts.bins = 1024;
+    opts.fft_size = 512;
+    EXPECT_THROW(SpectrumTap(opts, kRate), std::invalid_argument);
+
+    // 8 FFTs of 65536 pairs do not fit a 100 ms frame
+    opts.fft_size = 65'536;
+    EXPECT_THROW(SpectrumTap(opts, kRate), std::invalid_argument);
+    opts.fft_size = 1024;
+    opts.range_db = 0;
+    EXPECT_THROW(SpectrumTap(opts, kRate), std::invalid_argument);
+}
+
+TEST(SpectrumTapTest, FramesShowAToneInItsBin) {
+    DatagramReceiver rx;
+    SpectrumTap tap(to(rx), kRate);
+
+    // One second in 50 ms blocks: ten 100 ms frames of eight FFTs each
+    const auto t0 = BlockMeta::Clock::now();
+    constexpr std::size_t kBlock = 120'000;
+    for (std::uint64_t b = 0; b < 20; b++) {
+        const auto iq = tone(kBlock, 600'000.0, b * kBlock);
+        tap.feed(iq, {b * kBlock, t0 + std::chrono::milliseconds(50 * b)});
+    }
+    tap.stop();
+
+    const auto got = rx.drain();
+    ASSERT_EQ(got.size(), 10u);
+    EXPECT_EQ(tap.frames(), 10u);
+    EXPECT_EQ(tap.dropped(), 0u);
+
+    for (std::size_t f = 0; f < got.size(); f++) {
+        ASSERT_EQ(got[f].size(), sizeof(SpectrumPacketHeader) + 1024);
+        const auto h = decode_header(got[f]);
+        EXPECT_EQ(h.magic, kSpectrumPacketMagic);
+        EXPECT_EQ(h.sequence, f);
+        EXPECT_EQ(h.sample_index, f * 240'000);
+        const BlockMeta first{f * 240'000, t0 + std::chrono::milliseconds(100 * f)};
+        EXPECT_EQ(h.capture_ns, first.captured_ns());
+        EXPECT_EQ(h.sample_rate_hz, kRate);
+        EXPECT_EQ(h.bins, 1024);
+        EXPECT_EQ(h.averages, 8);
+        EXPECT_EQ(h.floor_db, -120);
+        EXPECT_EQ(h.range_db, 120);
+        EXPECT_EQ(h.fft_size, 1024u);
+
+        // +600 kHz is a quarter of the band above DC (bin 512)
+        const auto* bins = reinterpret_cast<const uint8_t*>(got[f].data() + sizeof(SpectrumPacketHeader));
+        const auto peak = std::max_element(bins, bins + 1024);
+        EXPECT_EQ(peak - bins, 768);
+
+        // -12 dBFS on a -120..0 dB scale, and quiet away from the tone
+        const double db = -120.0 + *peak * 120.0 / 255.0;
+        EXPECT_NEAR(db, -12.0, 1.0);
+        EXPECT_LT(bins[256], 40);
+    }
+}
+
+TEST(SpectrumTapTest, PoolingKeepsTheLoudestBin) {
+    DatagramReceiver rx;
+    auto opts = to(rx);
+    opts.fft_size = 4096;
+    opts.bins = 256;
+    opts.averages = 2;
+    SpectrumTap tap(opts, kRate);
+
+    const auto iq = tone(240'000, -300'000.0);
+    tap.feed(iq, {0, {}});
+    tap.stop();
+
+    const auto got = rx.drain();
+    ASSERT_EQ(got.size(), 1u);
+    const auto* bins = reinterpret_cast<const uint8_t*>(got[0].data() + sizeof(SpectrumPacketHeader));
+    EXPECT_EQ(std::max_element(bins, bins + 256) - bins, 96);   // 128 - 256 / 8
+    EXPECT_NEAR(-120.0 + bins[96] * 120.0 / 255.0, -12.0, 1.0);
+}
+
+TEST(SpectrumTapTest, GapEndsThePartialFrame) {
+    DatagramReceiver rx;
+    SpectrumTap tap(to(rx), kRate);
+
+    // Half a frame, then the stream resumes after lost blocks
+    const auto iq = tone(120'000, 100'000.0);
+    tap.feed(iq, {0, {}});
+    tap.feed(iq, {1'000'000, {}});
+    tap.feed(iq, {1'120'000, {}});
+    tap.stop();
+
+    const auto got = rx.drain();
+    ASSERT_EQ(got.size(), 2u);
+    EXPECT_EQ(decode_header(got[0]).sample_index, 0u);
+    EXPECT_EQ(decode_header(got[0]).averages, 4);
+    EXPECT_EQ(decode_header(got[1]).sample_index, 1'000'000u);
+    EXPECT_EQ(decode_header(got[1]).averages, 8);
+}
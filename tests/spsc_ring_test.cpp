@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "spsc_ring.hpp"
+#include <thread>
+
+TEST(SpscRingTest, CapacityRoundsUpToPowerOfTwo) {
+    SpscRing<int> ring(5);
+
+    EXPECT_EQ(ring.capacity(), 8);
+    EXPECT_EQ(ring.size(), 0);
+}
+
+TEST(SpscRingTest, ZeroCapacityThrows) {
+    EXPECT_THROW(SpscRing<int>(0), std::invalid_argument);
+}
+
+TEST(SpscRingTest, FullRingRejectsWrites) {
+    SpscRing<int> ring(2);
+
+    for (int i = 0; i < 2; i++) {
+        int* slot = ring.try_acquire_write();
+        ASSERT_NE(slot, nullptr);
+        *slot = i;
+        ring.commit_write();
+    }
+
+    EXPECT_EQ(ring.try_acquire_write(), nullptr);
+    EXPECT_EQ(ring.size(), 2);
+}
+
+TEST(SpscRingTest, FifoOrder) {
+    SpscRing<int> ring(4);
+
+    for (int i = 0; i < 3; i++) {
+        *ring.try_acquire_write() = i;
+        ring.commit_write();
+    }
+
+    for (int i = 0; i < 3; i++) {
+        int* slot = ring.try_acquire_read();
+        ASSERT_NE(slot, nullptr);
+        EXPECT_EQ(*slot, i);
+        ring.commit_read();
+    }
+
+    EXPECT_EQ(ring.try_acquire_read(), nullptr);
+}
+
+TEST(SpscRingTest, HighWaterMark) {
+    SpscRing<int> ring(8);
+
+    for (int i = 0; i < 3; i++) {
+        (void)ring.try_acquire_write();
+        ring.commit_write();
+    }
+    for (int i = 0; i < 3; i++) {
+        (void)ring.try_acquire_read();
+        ring.commit_read();
+    }
+    (void)ring.try_acquire_write();
+    ring.commit_write();
+
+    EXPECT_EQ(ring.high_water_mark(), 3);
+    EXPECT_EQ(ring.size(), 1);
+}
+
+TEST(SpscRingTest, SlotsKeepCapacity) {
+    SpscRing<std::vector<int>> ring(2);
+    ring.for_each_slot([](auto& v) { v.reserve(128); });
+
+    auto* slot = ring.try_acquire_write();
+    const int* storage = slot->data();
+    slot->assign(100, 7);
+
+    EXPECT_EQ(slot->data(), storage);
+}
+
+TEST(SpscRingTest, CloseWakesConsumer) {
+    SpscRing<int> ring(4);
+    int sentinel = 0;
+
+    int* result = &sentinel;
+    std::thread consumer([&] { result = ring.wait_acquire_read(); });
+    ring.close();
+    consumer.join();
+
+    EXPECT_TRUE(ring.closed());
+    EXPECT_EQ(result, nullptr);
+}
+
+TEST(SpscRingTest, ThreadedTransfer) {
+    constexpr int kCount = 100'000;
+    SpscRing<int> ring(16);
+    long long sum = 0;
+
+    std::thread consumer([&] {
+        while (int* v = ring.wait_acquire_read()) {
+            sum += *v;
+            ring.commit_read();
+        }
+    });
+
+    for (int i = 0; i < kCount; i++) {
+        int* slot = ring.wait_acquire_write();
+        ASSERT_NE(slot, nullptr);
+        *slot = i;
+        ring.commit_write();
+    }
+    ring.close();
+    consumer.join();
+
+    EXPECT_EQ(sum, static_cast<long long>(kCount) * (kCount - 1) / 2);
+    EXPECT_LE(ring.high_water_mark(), ring.capacity());
+}
+
+TEST(SpscRingTest, CloseDeliversPendingSlots) {
+    SpscRing<int> ring(4);
+    *ring.try_acquire_write() = 42;
+    ring.commit_write();
+    ring.close();
+
+    int* slot = ring.wait_acquire_read();
+    ASSERT_NE(slot, nullptr);
+    EXPECT_EQ(*slot, 42);
+    ring.commit_read();
+
+    EXPECT_EQ(ring.wait_acquire_read(), nullptr);
+    EXPECT_EQ(ring.wait_acquire_write(), nullptr);
+}
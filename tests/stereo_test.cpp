@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "stereo.hpp"
+#include <cmath>
+#include <numbers>
+
+using namespace dsp;
+
+namespace {
+
+constexpr double kRate = StereoDecoder::kMpxRateHz;
+constexpr std::size_t kBlock = 2400;     // 10 ms of MPX
+
+/// Broadcast multiplex: 0.45 (L+R) + 0.45 (L-R) sin(2a) + 0.1 sin(a),
+/// with sine tones on L and R (0 Hz = silent channel).
+std::vector<float> mpx(std::size_t n, double left_hz, double right_hz,
+                       bool pilot = true, double pilot_hz = StereoDecoder::kPilotHz)
+{
+    const double w = 2.0 * std::numbers::pi / kRate;
+    std::vector<float> v(n);
+    for (std::size_t i = 0; i < n; i++) {
+        const double t = static_cast<double>(i);
+        const double l = left_hz > 0.0 ? std::sin(w * left_hz * t) : 0.0;
+        const double r = right_hz > 0.0 ? std::sin(w * right_hz * t) : 0.0;
+        const double a = w * pilot_hz * t;
+        v[i] = static_cast<float>(0.45 * (l + r) + 0.45 * (l - r) * std::sin(2.0 * a) +
+                                  (pilot ? 0.1 * std::sin(a) : 0.0));
+    }
+    return v;
+}
+
+/// Decode @p in block by block; @return interleaved output.
+std::vector<float> decode(StereoDecoder& dec, const std::vector<float>& in,
+                          std::size_t block = kBlock)
+{
+    std::vector<float> out;
+    std::vector<float> buf(block / StereoDecoder::kDecimation * 2 + 128);
+    for (std::size_t i = 0; i < in.size(); i += block) {
+        const auto chunk = std::span(in).subspan(i, std::min(block, in.size() - i));
+        const std::size_t n = dec.process(chunk, buf);
+        out.insert(out.end(), buf.begin(), buf.begin() + static_cast<std::ptrdiff_t>(n));
+    }
+    return out;
+}
+
+/// RMS of one channel (0 = L, 1 = R) over the last @p frames.
+float channel_rms(const std::vector<float>& out, int channel, std::size_t frames)
+{
+    double acc = 0.0;
+    for (std::size_t k = out.size() / 2 - frames; k < out.size() / 2; k++)
+        acc += double(out[2 * k + channel]) * out[2 * k + channel];
+    return static_cast<float>(std::sqrt(acc / static_cast<double>(frames)));
+}
+
+} // namespace
+
+TEST(StereoDecoderTest, LocksToOffsetPilot) {
+    StereoDecoder dec;
+    decode(dec, mpx(static_cast<std::size_t>(kRate / 2), 1000.0, 0.0, true, 19'002.0));
+
+    EXPECT_TRUE(dec.locked());
+    EXPECT_NEAR(dec.pilot_hz(), 19'002.0, 0.5);
+    EXPECT_NEAR(dec.pilot_level(), 0.1f, 0.01f);
+    EXPECT_FLOAT_EQ(dec.blend(), 1.0f);
+}
+
+TEST(StereoDecoderTest, SeparatesChannels) {
+    for (const bool left : {true, false}) {
+        StereoDecoder dec;
+        const auto out = decode(dec, mpx(static_cast<std::size_t>(kRate / 2),
+                                         left ? 1000.0 : 0.0, left ? 0.0 : 1000.0));
+
+        // 0.45 (L+R) + 0.45 (L-R) gives each channel 0.9 of its tone
+        const float on  = channel_rms(out, left ? 0 : 1, 4800);
+        const float off = channel_rms(out, left ? 1 : 0, 4800);
+        EXPECT_NEAR(on, 0.9f / std::numbers::sqrt2_v<float>, 0.02f);
+        EXPECT_GT(20.0f * std::log10(on / off), 30.0f) << (left ? "left" : "right");
+    }
+}
+
+TEST(StereoDecoderTest, MonoWithoutPilot) {
+    StereoDecoder dec;
+    const auto out = decode(dec, mpx(static_cast<std::size_t>(kRate / 4), 1000.0, 1000.0, false));
+
+    EXPECT_FALSE(dec.locked());
+    EXPECT_EQ(dec.blend(), 0.0f);
+    for (std::size_t k = 0; k < out.size() / 2; k++)
+        ASSERT_EQ(out[2 * k], out[2 * k + 1]) << "frame " << k;
+    EXPECT_NEAR(channel_rms(out, 0, 4800), 0.9f / std::numbers::sqrt2_v<float>, 0.02f);
+}
+
+TEST(StereoDecoderTest, PilotDoesNotReachAudio) {
+    // Silent programme: only the pilot, which locked decoding cancels
+    StereoDecoder dec;
+    const auto out = decode(dec, mpx(static_cast<std::size_t>(kRate / 2), 0.0, 0.0));
+
+    ASSERT_TRUE(dec.locked());
+    EXPECT_LT(channel_rms(out, 0, 4800), 1e-3f);
+    EXPECT_LT(channel_rms(out, 1, 4800), 1e-3f);
+}
+
+TEST(StereoDecoderTest, BlockSizeDoesNotMatter) {
+    const auto in = mpx(static_cast<std::size_t>(kRate / 2), 1000.0, 400.0);
+    StereoDecoder a, b;
+    const auto whole = decode(a, in, 24'000);
+    const auto split = decode(b, in, 777);
+
+    // Only the float phasor seeding differs
+    ASSERT_EQ(whole.size(), split.size());
+    for (std::size_t i = 0; i < whole.size(); i++)
+        ASSERT_NEAR(whole[i], split[i], 1e-4f) << "sample " << i;
+}
+
+TEST(StereoDecoderTest, DeemphasisAttenuatesTreble) {
+    StereoDecoder flat, emph(50.0f);
+    const auto in = mpx(static_cast<std::size_t>(kRate / 2), 10'000.0, 10'000.0);
+    const auto a = decode(flat, in);
+    const auto b = decode(emph, in);
+
+    // 50 us: 10 kHz is about 10 dB down
+    const float db = 20.0f * std::log10(channel_rms(b, 0, 4800) / channel_rms(a, 0, 4800));
+    EXPECT_NEAR(db, -10.4f, 1.0f);
+}
+
+TEST(StereoDecoderTest, RejectsShortOutput) {
+    StereoDecoder dec;
+    const std::vector<float> in(kBlock, 0.0f);
+    std::vector<float> out(10);
+    EXPECT_THROW(dec.process(in, out), std::invalid_argument);
+}
+
+TEST(StereoDecoderTest, ResetDropsLock) {
+    StereoDecoder dec;
+    decode(dec, mpx(static_cast<std::size_t>(kRate / 2), 1000.0, 0.0));
+    ASSERT_TRUE(dec.locked());
+
+    dec.reset();
+    EXPECT_FALSE(dec.locked());
+    EXPECT_EQ(dec.blend(), 0.0f);
+    EXPECT_DOUBLE_EQ(dec.pilot_hz(), StereoDecoder::kPilotHz);
+}
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include "stream_writer.hpp"
+#include <fcntl.h>
+#include <optional>
+#include <poll.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+/// Frames larger than the pipe buffer, so an unread pipe stalls the writer.
+constexpr std::size_t kFrameBytes = 8192;
+
+/// Pipe with a one-page buffer.
+struct Pipe {
+    int rd = -1;
+    int wr = -1;
+
+    Pipe()
+    {
+        int fds[2];
+        EXPECT_EQ(::pipe(fds), 0);
+        rd = fds[0];
+        wr = fds[1];
+        ::fcntl(wr, F_SETPIPE_SZ, 4096);
+    }
+
+    ~Pipe()
+    {
+        if (rd >= 0) ::close(rd);
+        if (wr >= 0) ::close(wr);
+    }
+
+    void close_write()
+    {
+        ::close(wr);
+        wr = -1;
+    }
+
+    /// Block until the writer has put data into the pipe.
+    void wait_readable() const
+    {
+        pollfd pfd{rd, POLLIN, 0};
+        ASSERT_EQ(::poll(&pfd, 1, 2000), 1);
+    }
+};
+
+/// Reads the pipe until EOF on a background thread.
+class PipeReader {
+public:
+    explicit PipeReader(int fd)
+        : thread_([this, fd] {
+            char buf[65536];
+            ssize_t n;
+            while ((n = ::read(fd, buf, sizeof(buf))) > 0)
+                data_.insert(data_.end(), buf, buf + n);
+        })
+    {
+    }
+
+    /// Wait for EOF and return everything read.
+    std::vector<char> finish()
+    {
+        thread_.join();
+        return data_;
+    }
+
+private:
+    std::vector<char> data_;
+    std::thread thread_;
+};
+
+void write_frame(StreamWriter& w, int value)
+{
+    const std::vector<char> frame(kFrameBytes, static_cast<char>(value));
+    w.write(frame.data(), frame.size());
+}
+
+/// Values of the frames in @p data, one per kFrameBytes.
+std::vector<int> frame_values(const std::vector<char>& data)
+{
+    EXPECT_EQ(data.size() % kFrameBytes, 0u);
+
+    std::vector<int> out;
+    for (std::size_t off = 0; off + kFrameBytes <= data.size(); off += kFrameBytes) {
+        for (std::size_t i = 1; i < kFrameBytes; i++)
+            EXPECT_EQ(data[off + i], data[off]) << "frame " << out.size() << " torn";
+        out.push_back(data[off]);
+    }
+    return out;
+}
+
+/// Fill a writer whose consumer is stalled on frame 0, then drain it.
+std::pair<std::vector<int>, StreamWriterStats> overflow_run(OverflowPolicy policy)
+{
+    Pipe pipe;
+    StreamWriterStats stats;
+    std::optional<PipeReader> reader;
+    {
+        StreamWriter w(pipe.wr, 2, policy);
+
+        write_frame(w, 0);
+        pipe.wait_readable();   // frame 0 is in flight, the pipe is full
+
+        for (int i = 1; i < 10; i++)
+            write_frame(w, i);
+        stats = w.stats();
+
+        reader.emplace(pipe.rd);
+    }
+    pipe.close_write();
+
+    return {frame_values(reader->finish()), stats};
+}
+
+} // namespace
+
+TEST(StreamWriterTest, RejectsZeroCapacity)
+{
+    Pipe pipe;
+    EXPECT_THROW(StreamWriter(pipe.wr, 0), std::invalid_argument);
+}
+
+TEST(StreamWriterTest, BlockPolicyIsLossless)
+{
+    Pipe pipe;
+    PipeReader reader(pipe.rd);
+    {
+        StreamWriter w(pipe.wr, 2, OverflowPolicy::Block);
+        for (int i = 0; i < 20; i++)
+            write_frame(w, i);
+
+        const auto st = w.stats();
+        EXPECT_EQ(st.frames_dropped, 0u);
+        EXPECT_LE(st.high_water, 2u);
+    }
+    pipe.close_write();
+
+    const auto values = frame_values(reader.finish());
+    ASSERT_EQ(values.size(), 20u);
+    for (int i = 0; i < 20; i++)
+        EXPECT_EQ(values[static_cast<std::size_t>(i)], i);
+}
+
+TEST(StreamWriterTest, DropNewestKeepsQueuedFrames)
+{
+    const auto [values, stats] = overflow_run(OverflowPolicy::DropNewest);
+
+    EXPECT_EQ(stats.frames_dropped, 8u);
+    EXPECT_EQ(stats.high_water, 2u);
+    EXPECT_EQ(values, (std::vector<int>{0, 1}));
+}
+
+TEST(StreamWriterTest, DropOldestKeepsLatestFrame)
+{
+    const auto [values, stats] = overflow_run(OverflowPolicy::DropOldest);
+
+    // Frame 0 was already being written; every other frame displaced the last
+    EXPECT_EQ(stats.frames_dropped, 8u);
+    EXPECT_EQ(values, (std::vector<int>{0, 9}));
+}
+
+TEST(StreamWriterTest, RestoresDescriptorFlags)
+{
+    Pipe pipe;
+    ASSERT_FALSE(::fcntl(pipe.wr, F_GETFL) & O_NONBLOCK);
+    {
+        StreamWriter w(pipe.wr);
+        EXPECT_TRUE(::fcntl(pipe.wr, F_GETFL) & O_NONBLOCK);
+    }
+    EXPECT_FALSE(::fcntl(pipe.wr, F_GETFL) & O_NONBLOCK);
+}
@@ -0,0 +1,257 @@
+#include <gtest/gtest.h>
+#include "supervisor.hpp"
+#include "datagram_receiver.hpp"
+#include <endian.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+constexpr std::size_t kBlock = 2400;   // 1 ms at the default rate
+
+/// Source of @p blocks constant blocks; a live one returns {} afterwards
+/// like a failed refill, or runs forever with blocks = 0.
+class FakeDevice final : public SampleSource {
+public:
+    FakeDevice(bool live, std::size_t blocks) : live_{live}, blocks_left_{blocks}, block_(2 * kBlock, 500) {}
+
+    std::span<const int16_t> next_block() override
+    {
+        if (live_)
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        if (blocks_left_ == 1)
+            return {};
+        if (blocks_left_)
+            blocks_left_--;
+        return block_;
+    }
+
+    [[nodiscard]] std::size_t block_size() const noexcept override { return kBlock; }
+    [[nodiscard]] long long sample_rate() const noexcept override { return kDefaultRatePlan.input_rate_hz; }
+    [[nodiscard]] bool live() const noexcept override { return live_; }
+
+private:
+    bool live_;
+    std::size_t blocks_left_;   ///< Blocks plus one; 0 = endless
+    std::vector<int16_t> block_;
+};
+
+DeviceConfig device(std::string name, int port)
+{
+    DeviceConfig d;
+    d.name = std::move(name);
+    d.file = "fake";
+    d.udp.ip = "127.0.0.1";
+    d.udp.port = port;
+    return d;
+}
+
+SupervisorOptions fast_options()
+{
+    SupervisorOptions o;
+    o.pool_threads = 2;
+    o.block_size = kBlock;
+    o.restart_delay = std::chrono::milliseconds(1);
+    o.max_restart_delay = std::chrono::milliseconds(4);
+    return o;
+}
+
+} // namespace
+
+TEST(DeviceConfigTest, ParsesDevices)
+{
+    std::istringstream in(
+        "# two radios\n"
+        "name=north uri=ip:192.168.2.1 freq=100.1 gain=40 udp=127.0.0.1:5000\n"
+        "\n"
+        "   uri=usb:1.4.5 freq=94.5 udp=10.0.0.2:5001   # defaults\n"
+        "file=capture.iq udp=239.1.2.3:5002,ttl=4,if=eth1,loop\n");
+
+    const auto devs = parse_device_config(in);
+    ASSERT_EQ(devs.size(), 3u);
+
+    EXPECT_EQ(devs[0].name, "north");
+    EXPECT_EQ(devs[0].uri, "ip:192.168.2.1");
+    EXPECT_EQ(devs[0].frequency_hz, 100'100'000);
+    EXPECT_DOUBLE_EQ(devs[0].gain_db, 40.0);
+    EXPECT_EQ(devs[0].udp.ip, "127.0.0.1");
+    EXPECT_EQ(devs[0].udp.port, 5000);
+    EXPECT_EQ(devs[0].udp.ttl, 0);
+
+    EXPECT_EQ(devs[1].name, "dev1");
+    EXPECT_EQ(devs[1].uri, "usb:1.4.5");
+    EXPECT_DOUBLE_EQ(devs[1].gain_db, 0.0);
+    EXPECT_EQ(devs[1].udp.ip, "10.0.0.2");
+
+    EXPECT_EQ(devs[2].name, "dev2");
+    EXPECT_EQ(devs[2].file, "capture.iq");
+    EXPECT_TRUE(devs[2].uri.empty());
+    EXPECT_EQ(devs[2].udp.ip, "239.1.2.3");
+    EXPECT_EQ(devs[2].udp.ttl, 4);
+    EXPECT_EQ(devs[2].udp.interface, "eth1");
+    EXPECT_TRUE(devs[2].udp.loopback);
+}
+
+TEST(DeviceConfigTest, RejectsInvalidLines)
+{
+    const char* bad[] = {
+        "uri=ip:a freq=100 udp=1.2.3.4:5 bogus",        // not key=value
+        "uri=ip:a freq=100 udp=1.2.3.4:5 color=red",    // unknown key
+        "uri=ip:a udp=1.2.3.4:5",                       // no frequency
+        "freq=100 udp=1.2.3.4:5",                       // no source
+        "uri=ip:a file=x freq=100 udp=1.2.3.4:5",       // two sources
+        "uri=ip:a freq=100",                            // no destination
+        "uri=ip:a freq=100 udp=1.2.3.4:99999",          // bad port
+        "uri=ip:a freq=100 udp=1.2.3.4:5,ttl=0",        // bad TTL
+        "uri=ip:a freq=-3 udp=1.2.3.4:5",               // bad frequency
+        "uri=ip:a freq=100 gain=loud udp=1.2.3.4:5",    // bad gain
+    };
+    for (const char* line : bad) {
+        std::istringstream in(std::string("# header\n") + line + '\n');
+        try {
+            parse_device_config(in);
+            ADD_FAILURE() << line;
+        } catch (const std::runtime_error& e) {
+            EXPECT_EQ(std::string(e.what()).rfind("Line 2: ", 0), 0u) << e.what();
+        }
+    }
+
+    std::istringstream dup("name=a file=x udp=1.2.3.4:5\nname=a file=y udp=1.2.3.4:6\n");
+    EXPECT_THROW(parse_device_config(dup), std::runtime_error);
+
+    std::istringstream none("# nothing\n\n");
+    EXPECT_THROW(parse_device_config(none), std::runtime_error);
+}
+
+TEST(SupervisorTest, RunsEveryDeviceToTheEnd)
+{
+    Supervisor sup({device("a", 47001), device("b", 47002), device("c", 47003)},
+                   [](const DeviceConfig&) { return std::make_unique<FakeDevice>(false, 51); },
+                   DspOptions{}, OutputOptions{}, fast_options());
+    EXPECT_EQ(sup.size(), 3u);
+    EXPECT_EQ(sup.pool_threads(), 2u);
+
+    sup.run();
+
+    for (std::size_t i = 0; i < sup.size(); i++) {
+        const DeviceStats st = sup.stats(i);
+        EXPECT_EQ(st.state, DeviceState::Stopped);
+        EXPECT_EQ(st.blocks, 50u) << sup.name(i);
+        EXPECT_EQ(st.pairs, 50u * kBlock);
+        EXPECT_EQ(st.dropped, 0u);
+        EXPECT_EQ(st.restarts, 0u);
+    }
+}
+
+TEST(SupervisorTest, RestartsOnlyTheFailedDevice)
+{
+    std::atomic<int> opens{0};
+    auto open = [&](const DeviceConfig& cfg) -> std::unique_ptr<SampleSource> {
+        if (cfg.name == "steady")
+            return std::make_unique<FakeDevice>(false, 21);
+
+        // Fails after 5 blocks, then one failed open, 5 more blocks and
+        // nothing but failed opens
+        switch (opens++) {
+        case 0:
+        case 2:  return std::make_unique<FakeDevice>(true, 6);
+        default: throw std::runtime_error("no device");
+        }
+    };
+
+    SupervisorOptions opts = fast_options();
+    opts.max_retries = 2;
+    Supervisor sup({device("flaky", 47004), device("steady", 47005)}, open,
+                   DspOptions{}, OutputOptions{}, opts);
+    sup.run();
+
+    const DeviceStats flaky = sup.stats(0);
+    EXPECT_EQ(flaky.state, DeviceState::Stopped);
+    EXPECT_EQ(flaky.blocks + flaky.dropped, 10u);
+    EXPECT_EQ(flaky.restarts, 1u);
+    EXPECT_EQ(opens.load(), 5);
+
+    EXPECT_EQ(sup.stats(1).blocks, 20u);
+    EXPECT_EQ(sup.stats(1).restarts, 0u);
+}
+
+TEST(SupervisorTest, OutageLeavesAGapInTheIndex)
+{
+    DatagramReceiver rx;
+    std::atomic<int> opens{0};
+    auto open = [&](const DeviceConfig&) -> std::unique_ptr<SampleSource> {
+        if (opens++ < 2)
+            return std::make_unique<FakeDevice>(true, 6);
+        throw std::runtime_error("no device");
+    };
+
+    SupervisorOptions opts = fast_options();
+    opts.restart_delay = opts.max_restart_delay = std::chrono::milliseconds(20);
+    opts.max_retries = 1;
+    OutputOptions output;
+    output.max_datagram = kDefaultMaxDatagram;   // one datagram per block
+    Supervisor sup({device("flaky", rx.port())}, open, DspOptions{}, output, opts);
+    sup.run();
+    ASSERT_EQ(sup.stats(0).blocks, 10u);
+
+    // 48 frames per block, and at least the restart delay of silence
+    const auto got = rx.receive(10);
+    ASSERT_EQ(got.size(), 10u);
+    std::uint64_t index[10];
+    for (std::size_t d = 0; d < got.size(); d++) {
+        AudioPacketHeader h{};
+        std::memcpy(&h, got[d].data(), sizeof(h));
+        index[d] = be64toh(h.sample_index);
+    }
+    EXPECT_EQ(index[4], 4u * 48u);
+    EXPECT_GE(index[5], 5u * 48u + 20u * 48u);
+    EXPECT_EQ(index[9], index[5] + 4u * 48u);
+}
+
+TEST(SupervisorTest, RejectsWrongSampleRate)
+{
+    struct SlowRate final : SampleSource {
+        std::vector<int16_t> block = std::vector<int16_t>(2 * kBlock);
+        std::span<const int16_t> next_block() override { return block; }
+        std::size_t block_size() const noexcept override { return kBlock; }
+        long long sample_rate() const noexcept override { return 1'000'000; }
+        bool live() const noexcept override { return true; }
+    };
+
+    SupervisorOptions opts = fast_options();
+    opts.max_retries = 1;
+    Supervisor sup({device("a", 47006)},
+                   [](const DeviceConfig&) { return std::make_unique<SlowRate>(); },
+                   DspOptions{}, OutputOptions{}, opts);
+    sup.run();
+    EXPECT_EQ(sup.stats(0).blocks, 0u);
+    EXPECT_EQ(sup.stats(0).state, DeviceState::Stopped);
+}
+
+TEST(SupervisorTest, StopEndsLiveDevices)
+{
+    Supervisor sup({device("a", 47007), device("b", 47008)},
+                   [](const DeviceConfig&) { return std::make_unique<FakeDevice>(true, 0); },
+                   DspOptions{}, OutputOptions{}, fast_options());
+
+    std::jthread stopper([&] {
+        while (sup.stats(0).blocks < 20 || sup.stats(1).blocks < 20)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        sup.stop();
+    });
+    sup.run();
+
+    EXPECT_GE(sup.stats(0).blocks, 20u);
+    EXPECT_EQ(sup.stats(1).state, DeviceState::Stopped);
+}
+
+TEST(SupervisorTest, RejectsDeviceWithoutDestination)
+{
+    DeviceConfig d = device("a", 0);
+    EXPECT_THROW(Supervisor({d}, nullptr, DspOptions{}), std::invalid_argument);
+    EXPECT_THROW(Supervisor({}, nullptr, DspOptions{}), std::invalid_argument);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <numeric>
+#include <vector>
+
+#include "pipeline.hpp"
+
+/**
+ * @file test_signals.hpp
+ * @brief Synthetic input and audio blocks shared by the unit tests.
+ */
+
+/// 1 kHz tone, 75 kHz deviation, as int16 IQ of amplitude @p amp at @p fs.
+inline std::vector<int16_t> fm_tone(std::size_t pairs,
+                                    double fs = kDefaultRatePlan.input_rate_hz,
+                                    double amp = 1500.0)
+{
+    std::vector<int16_t> raw(2 * pairs);
+    for (std::size_t i = 0; i < pairs; i++) {
+        const double t = static_cast<double>(i) / fs;
+        const double phase = 75.0 * std::sin(2.0 * std::numbers::pi * 1e3 * t);
+        raw[2 * i]     = static_cast<int16_t>(std::lround(amp * std::cos(phase)));
+        raw[2 * i + 1] = static_cast<int16_t>(std::lround(amp * std::sin(phase)));
+    }
+    return raw;
+}
+
+/// @p n float samples counting up from @p start.
+inline std::vector<float> counting(std::size_t n, float start)
+{
+    std::vector<float> v(n);
+    std::iota(v.begin(), v.end(), start);
+    return v;
+}
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include "udp_fanout.hpp"
+#include "datagram_receiver.hpp"
+#include "test_signals.hpp"
+#include <arpa/inet.h>
+#include <cstring>
+#include <endian.h>
+#include <sys/socket.h>
+
+namespace {
+
+std::vector<UdpDestination> loopback(const std::vector<std::unique_ptr<DatagramReceiver>>& rx)
+{
+    std::vector<UdpDestination> d(rx.size());
+    for (std::size_t i = 0; i < rx.size(); i++) {
+        d[i].ip = "127.0.0.1";
+        d[i].port = rx[i]->port();
+    }
+    return d;
+}
+
+std::vector<std::unique_ptr<DatagramReceiver>> receivers(std::size_t n)
+{
+    std::vector<std::unique_ptr<DatagramReceiver>> rx;
+    for (std::size_t i = 0; i < n; i++)
+        rx.push_back(std::make_unique<DatagramReceiver>(std::chrono::milliseconds(50)));
+    return rx;
+}
+
+/// @return Fan-out on @p backend, or null if this kernel has no io_uring.
+std::unique_ptr<UdpFanout> open_fanout(const std::vector<UdpDestination>& dests, SendBackend backend)
+{
+    try {
+        return std::make_unique<UdpFanout>(dests, backend);
+    } catch (const std::runtime_error&) {
+        if (backend != SendBackend::IoUring) throw;
+        return nullptr;
+    }
+}
+
+class UdpFanoutTest : public ::testing::TestWithParam<SendBackend> {};
+
+} // namespace
+
+TEST(UdpDestinationTest, ParsesOptions)
+{
+    UdpDestination d;
+    ASSERT_TRUE(parse_udp_destination("239.1.2.3:5000,ttl=8,if=eth1,loop", d));
+    EXPECT_EQ(d.ip, "239.1.2.3");
+    EXPECT_EQ(d.port, 5000);
+    EXPECT_EQ(d.ttl, 8);
+    EXPECT_EQ(d.interface, "eth1");
+    EXPECT_TRUE(d.loopback);
+
+    ASSERT_TRUE(parse_udp_destination("10.0.0.7:5004", d));
+    EXPECT_EQ(d.ttl, 0);
+    EXPECT_TRUE(d.interface.empty());
+    EXPECT_FALSE(d.loopback);
+
+    for (const char* bad : {"10.0.0.7", ":5000", "10.0.0.7:0", "10.0.0.7:5000,ttl=0",
+                            "10.0.0.7:5000,ttl=300", "10.0.0.7:5000,if=", "10.0.0.7:5000,fast"})
+        EXPECT_FALSE(parse_udp_destination(bad, d)) << bad;
+}
+
+TEST(UdpFanoutGroupingTest, SharesSocketsBetweenEqualOptions)
+{
+    std::vector<UdpDestination> d(4);
+    for (std::size_t i = 0; i < d.size(); i++) {
+        d[i].ip = "127.0.0.1";
+        d[i].port = 40'000 + static_cast<int>(i);
+    }
+    d[2].ttl = 5;
+    d[3].ip = "239.255.0.1";
+
+    UdpFanout tx(d, SendBackend::Sendmmsg);
+    EXPECT_EQ(tx.size(), 4u);
+    EXPECT_EQ(tx.sockets(), 3u);
+
+    d[0].ip = "not-an-ip";
+    EXPECT_THROW(UdpFanout(d, SendBackend::Sendmmsg), std::runtime_error);
+}
+
+TEST(UdpFanoutGroupingTest, AutoUsesSendmmsgForOneSocket)
+{
+    auto rx = receivers(3);
+    UdpFanout tx(loopback(rx));
+    EXPECT_EQ(tx.sockets(), 1u);
+    EXPECT_EQ(tx.backend(), SendBackend::Sendmmsg);
+}
+
+TEST_P(UdpFanoutTest, EveryDestinationGetsTheSameStream)
+{
+    auto rx = receivers(5);
+    auto tx = open_fanout(loopback(rx), GetParam());
+    if (!tx) GTEST_SKIP() << "io_uring unavailable";
+    EXPECT_EQ(tx->backend(), GetParam());
+
+    tx->set_packetized();
+    tx->send(counting(2400, 0.0f));
+    tx->send_gap(100);
+    tx->send_frame("opus", 4, 480);
+    EXPECT_EQ(tx->sequence(), 9u);
+
+    const auto want = rx[0]->drain();
+    ASSERT_EQ(want.size(), 9u);
+    for (std::size_t i = 1; i < rx.size(); i++)
+        EXPECT_EQ(rx[i]->drain(), want) << "destination " << i;
+
+    AudioPacketHeader gap{};
+    std::memcpy(&gap, want[7].data(), sizeof(gap));
+    EXPECT_EQ(want[7].size(), sizeof(AudioPacketHeader));
+    EXPECT_EQ(be64toh(gap.sample_index), 2400u);
+    EXPECT_EQ(ntohl(gap.sequence), 7u);
+}
+
+TEST_P(UdpFanoutTest, BatchesDestinationsIntoOneSyscall)
+{
+    auto rx = receivers(50);
+    auto dests = loopback(rx);
+    dests[10].ttl = 9;   // a second socket
+
+    auto tx = open_fanout(dests, GetParam());
+    if (!tx) GTEST_SKIP() << "io_uring unavailable";
+
+    const auto audio = counting(2400, 0.0f);
+    tx->send(audio);
+
+    // One sendmmsg() per socket, or one io_uring_enter() for both
+    EXPECT_EQ(tx->syscalls(), GetParam() == SendBackend::IoUring ? 1u : 2u);
+    for (auto& r : rx) {
+        const auto got = r->drain();
+        ASSERT_EQ(got.size(), 1u);
+        ASSERT_EQ(got[0].size(), audio.size() * sizeof(float));
+        EXPECT_EQ(std::memcmp(got[0].data(), audio.data(), got[0].size()), 0);
+    }
+}
+
+TEST_P(UdpFanoutTest, LargeDatagramsArriveIntact)
+{
+    // Above kZeroCopyMinBytes: the zero-copy path where io_uring has it
+    auto rx = receivers(3);
+    auto tx = open_fanout(loopback(rx), GetParam());
+    if (!tx) GTEST_SKIP() << "io_uring unavailable";
+
+    const auto audio = counting(UdpFanout::kZeroCopyMinBytes / sizeof(float) + 100, 1.0f);
+    for (int k = 0; k < 3; k++)
+        tx->send(audio);
+
+    for (auto& r : rx) {
+        const auto got = r->drain();
+        ASSERT_EQ(got.size(), 3u);
+        for (const auto& g : got) {
+            ASSERT_EQ(g.size(), audio.size() * sizeof(float));
+            EXPECT_EQ(std::memcmp(g.data(), audio.data(), g.size()), 0);
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, UdpFanoutTest,
+                         ::testing::Values(SendBackend::Sendmmsg, SendBackend::IoUring),
+                         [](const auto& info) { return std::string(backend_name(info.param)) == "io_uring"
+                                                           ? std::string("IoUring")
+                                                           : std::string("Sendmmsg"); });
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "udp_sender.hpp"
+#include "datagram_receiver.hpp"
+#include "test_signals.hpp"
+#include <arpa/inet.h>
+#include <cstring>
+#include <endian.h>
+
+namespace {
+
+AudioPacketHeader decode_header(const std::vector<char>& datagram)
+{
+    AudioPacketHeader h{};
+    std::memcpy(&h, datagram.data(), sizeof(h));
+    return {ntohl(h.magic), ntohl(h.sequence), be64toh(h.sample_index), be64toh(h.capture_ns)};
+}
+
+} // namespace
+
+TEST(UdpSenderTest, RawModeSendsOneDatagramPerBlock) {
+    DatagramReceiver rx;
+    UdpSender tx("127.0.0.1", rx.port());
+    EXPECT_EQ(tx.max_datagram(), 0u);
+
+    const auto audio = counting(2400, 0.0f);
+    tx.send(audio);
+
+    const auto got = rx.drain();
+    ASSERT_EQ(got.size(), 1u);
+    ASSERT_EQ(got[0].size(), audio.size() * sizeof(float));
+    EXPECT_EQ(std::memcmp(got[0].data(), audio.data(), got[0].size()), 0);
+}
+
+TEST(UdpSenderTest, PacketizedSplitsOnSampleBoundaries) {
+    DatagramReceiver rx;
+    UdpSender tx("127.0.0.1", rx.port());
+    tx.set_packetized();
+
+    // (1472 - 24) / 4 = 362 samples per datagram
+    const std::size_t per_packet = (kDefaultMaxDatagram - sizeof(AudioPacketHeader)) / sizeof(float);
+    const auto first = counting(2400, 0.0f);
+    const auto second = counting(500, 2400.0f);
+    tx.send(first);
+    tx.send(second);
+
+    const auto got = rx.drain();
+    ASSERT_EQ(got.size(), 7u + 2u);
+    EXPECT_EQ(tx.sequence(), 9u);
+
+    std::vector<float> payload;
+    std::uint64_t expected_index = 0;
+
+    for (std::size_t d = 0; d < got.size(); d++) {
+        ASSERT_GT(got[d].size(), sizeof(AudioPacketHeader));
+        EXPECT_LE(got[d].size(), kDefaultMaxDatagram);
+
+        const auto h = decode_header(got[d]);
+        EXPECT_EQ(h.magic, kAudioPacketMagic);
+        EXPECT_EQ(h.sequence, d);
+        EXPECT_EQ(h.sample_index, expected_index);
+
+        const std::size_t n = (got[d].size() - sizeof(AudioPacketHeader)) / sizeof(float);
+        ASSERT_EQ(n * sizeof(float) + sizeof(AudioPacketHeader), got[d].size());
+        if (d != 6 && d != 8) {
+            EXPECT_EQ(n, per_packet) << "datagram " << d;
+        }
+
+        const std::size_t at = payload.size();
+        payload.resize(at + n);
+        std::memcpy(payload.data() + at, got[d].data() + sizeof(AudioPacketHeader), n * sizeof(float));
+        expected_index += n;
+    }
+
+    EXPECT_EQ(payload, counting(2900, 0.0f));
+}
+
+TEST(UdpSenderTest, PacketizedRestartsCountersAndValidatesSize) {
+    DatagramReceiver rx;
+    UdpSender tx("127.0.0.1", rx.port());
+
+    EXPECT_THROW(tx.set_packetized(sizeof(AudioPacketHeader)), std::invalid_argument);
+    EXPECT_THROW(tx.set_packetized(70'000), std::invalid_argument);
+
+    tx.set_packetized(sizeof(AudioPacketHeader) + 8 * sizeof(float));
+    tx.send(counting(20, 0.0f));
+    EXPECT_EQ(tx.sequence(), 3u);
+
+    tx.set_packetized(sizeof(AudioPacketHeader) + 8 * sizeof(float));
+    EXPECT_EQ(tx.sequence(), 0u);
+    tx.send(counting(8, 0.0f));
+
+    const auto got = rx.drain();
+    ASSERT_EQ(got.size(), 4u);
+    EXPECT_EQ(decode_header(got[3]).sequence, 0u);
+    EXPECT_EQ(decode_header(got[3]).sample_index, 0u);
+
+    tx.set_packetized(0);
+    tx.send(counting(20, 0.0f));
+    const auto raw = rx.drain();
+    ASSERT_EQ(raw.size(), 1u);
+    EXPECT_EQ(raw[0].size(), 20 * sizeof(float));
+}
+
+TEST(UdpSenderTest, StampPositionsTheStream) {
+    DatagramReceiver rx;
+    UdpSender tx("127.0.0.1", rx.port());
+    tx.set_packetized(sizeof(AudioPacketHeader) + 8 * sizeof(float));
+
+    tx.send(counting(8, 0.0f));
+    tx.stamp(1'000, 123'456'789);
+    tx.send(counting(12, 0.0f));
+    tx.send_gap(40);
+    tx.send(counting(4, 0.0f));
+
+    const auto got = rx.drain();
+    ASSERT_EQ(got.size(), 5u);
+    EXPECT_EQ(decode_header(got[0]).sample_index, 0u);
+    EXPECT_EQ(decode_header(got[0]).capture_ns, 0u);
+
+    // Datagrams after the stamp count on from it and share its capture time
+    for (std::size_t d = 1; d < got.size(); d++)
+        EXPECT_EQ(decode_header(got[d]).capture_ns, 123'456'789u) << d;
+    EXPECT_EQ(decode_header(got[1]).sample_index, 1'000u);
+    EXPECT_EQ(decode_header(got[2]).sample_index, 1'008u);
+    EXPECT_EQ(decode_header(got[3]).sample_index, 1'012u);
+    EXPECT_EQ(decode_header(got[4]).sample_index, 1'052u);
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "thread_util.hpp"
+#include "work_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+TEST(WorkPoolTest, RunsEveryTask)
+{
+    WorkPool pool(3);
+    EXPECT_EQ(pool.threads(), 3u);
+
+    std::atomic<int> done{0};
+    for (int i = 0; i < 1000; i++)
+        pool.submit([&] { done.fetch_add(1, std::memory_order_relaxed); });
+
+    pool.wait_idle();
+    EXPECT_EQ(done.load(), 1000);
+}
+
+TEST(WorkPoolTest, WaitsForNestedTasks)
+{
+    WorkPool pool(2);
+    std::atomic<int> done{0};
+
+    for (int i = 0; i < 10; i++) {
+        pool.submit([&] {
+            for (int k = 0; k < 10; k++)
+                pool.submit([&] { done.fetch_add(1, std::memory_order_relaxed); });
+        });
+    }
+
+    pool.wait_idle();
+    EXPECT_EQ(done.load(), 100);
+}
+
+TEST(WorkPoolTest, IdleWorkersSteal)
+{
+    WorkPool pool(4);
+    std::mutex mutex;
+    std::set<std::thread::id> ran_on;
+
+    // All subtasks land on the deque of the worker that runs the parent
+    pool.submit([&] {
+        for (int k = 0; k < 32; k++) {
+            pool.submit([&] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                std::lock_guard lock(mutex);
+                ran_on.insert(std::this_thread::get_id());
+            });
+        }
+    });
+
+    pool.wait_idle();
+    EXPECT_GT(pool.steals(), 0u);
+    EXPECT_GT(ran_on.size(), 1u);
+}
+
+TEST(WorkPoolTest, DestructorRunsQueuedTasks)
+{
+    std::atomic<int> done{0};
+    {
+        WorkPool pool(1);
+        for (int i = 0; i < 50; i++)
+            pool.submit([&] { done.fetch_add(1, std::memory_order_relaxed); });
+    }
+    EXPECT_EQ(done.load(), 50);
+}
+
+TEST(WorkPoolTest, DefaultsToHardwareThreads)
+{
+    WorkPool pool;
+    EXPECT_EQ(pool.threads(), std::max(1u, std::thread::hardware_concurrency()));
+}
+
+TEST(WorkPoolTest, WorkersCanFlushDenormals)
+{
+    if (!flush_to_zero_supported())
+        GTEST_SKIP() << "No flush-to-zero control on this target";
+
+    for (bool flush : {false, true}) {
+        WorkPool pool(2, flush);
+        std::atomic<int> flushed{0};
+        for (int i = 0; i < 20; i++)
+            pool.submit([&] { flushed.fetch_add(flush_to_zero_enabled(), std::memory_order_relaxed); });
+
+        pool.wait_idle();
+        EXPECT_EQ(flushed.load(), flush ? 20 : 0);
+    }
+}